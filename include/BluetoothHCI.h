@@ -1,9 +1,12 @@
 #ifndef BLUETOOTHHCI_H
 #define	BLUETOOTHHCI_H
 
+#include <algorithm>
 #include <cstdint>
-#include <functional>
+#include <deque>
 #include <list>
+#include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -12,6 +15,12 @@
 #include "bluetooth/hci.h"
 
 #include "Address.h"
+#include "Clock.h"
+#include "HCIBackend.h"
+#include "HCIReactor.h"
+#include "Metrics.h"
+#include "Probes.h"
+#include "Timing.h"
 
 // For exceptional errors caused by interactions with the Bluetooth controller
 // through the host-controller interface, which we cannot recover from
@@ -23,6 +32,10 @@ public:
   BluetoothHCIException(std::string message) : std::runtime_error(std::string("BluetoothHCIException - ") + message) { }
 };
 
+// Logs the error and throws a BluetoothHCIException
+void LOG_E_BT_CRASH(const std::string &tag, const std::string &msg, const std::string &file,
+                    const int line, const int errorCode);
+
 struct InquiryResponse
 {
   Address address;
@@ -37,14 +50,164 @@ struct EIRInquiryResponse : InquiryResponse
   int8_t rssi;
 };
 
+struct RemoteNameRequest
+{
+  Address address;
+  uint16_t clockOffset;
+  uint8_t pageScanMode;
+};
+
+struct RemoteNameResponse
+{
+  Address address;
+  uint8_t status;
+  std::string name;
+};
+
 struct ScanResponse
 {
   Address address;
   uint8_t *data;
   uint8_t length;
   int8_t rssi;
+  // Only set for extended advertising reports, where a payload that does not
+  // fit in one event is split across several, each but the last having more
+  // to come (and the last being truncated if the controller gave up on it)
+  bool hasMore;
+  bool isTruncated;
+};
+
+// Placeholder for event types that a caller does not handle
+struct HCIIgnore
+{
+  template<typename... Args>
+  void operator ()(Args&&...) const
+  {
+  }
+};
+
+// Decodes raw HCI events from the reactor into typed callbacks, which are
+// template callables so that dispatching each report is a direct call:
+//  - onScanResponse(const ScanResponse *) for each LE advertising report,
+//    legacy or extended (where extended reports may be fragments)
+//  - onEIRResponse(const EIRInquiryResponse *) for each EIR inquiry result
+//  - onCommandComplete(uint16_t opcode, uint8_t status) once a command has
+//    finished, which for an inquiry is the inquiry complete event (pending
+//    command status events are not reported)
+//  - onCommandStatus(uint16_t opcode, uint8_t status) for every command
+//    status event, including those for commands that are still pending
+//  - onRemoteName(const RemoteNameResponse *) for each finished remote name
+//    request
+template<typename OnScanResponse, typename OnEIRResponse, typename OnCommandComplete, typename OnCommandStatus = HCIIgnore, typename OnRemoteName = HCIIgnore>
+class HCIEventDispatcher
+{
+private:
+  OnScanResponse onScanResponse_;
+  OnEIRResponse onEIRResponse_;
+  OnCommandComplete onCommandComplete_;
+  OnCommandStatus onCommandStatus_;
+  OnRemoteName onRemoteName_;
+
+public:
+  HCIEventDispatcher(OnScanResponse onScanResponse, OnEIRResponse onEIRResponse, OnCommandComplete onCommandComplete, OnCommandStatus onCommandStatus, OnRemoteName onRemoteName);
+
+  void operator ()(uint8_t *packet, size_t length);
 };
 
+template<typename OnScanResponse, typename OnEIRResponse, typename OnCommandComplete, typename OnCommandStatus = HCIIgnore, typename OnRemoteName = HCIIgnore>
+HCIEventDispatcher<OnScanResponse, OnEIRResponse, OnCommandComplete, OnCommandStatus, OnRemoteName> makeHCIEventDispatcher(OnScanResponse onScanResponse, OnEIRResponse onEIRResponse, OnCommandComplete onCommandComplete, OnCommandStatus onCommandStatus = OnCommandStatus(), OnRemoteName onRemoteName = OnRemoteName())
+{
+  return HCIEventDispatcher<OnScanResponse, OnEIRResponse, OnCommandComplete, OnCommandStatus, OnRemoteName>(onScanResponse, onEIRResponse, onCommandComplete, onCommandStatus, onRemoteName);
+}
+
+// LE extended advertising and scanning, from the Bluetooth 5.0 specification
+// (Vol 2, Part E, 7.8.53 - 7.8.65 and 7.7.65.13)
+#define OCF_LE_SET_ADVERTISING_SET_RANDOM_ADDRESS 0x0035
+typedef struct {
+  uint8_t handle;
+  bdaddr_t bdaddr;
+} __attribute__ ((packed)) le_set_advertising_set_random_address_cp;
+#define LE_SET_ADVERTISING_SET_RANDOM_ADDRESS_CP_SIZE 7
+
+#define OCF_LE_SET_EXTENDED_ADVERTISING_PARAMETERS 0x0036
+typedef struct {
+  uint8_t handle;
+  uint16_t properties;
+  uint8_t min_interval[3];
+  uint8_t max_interval[3];
+  uint8_t chan_map;
+  uint8_t own_bdaddr_type;
+  uint8_t direct_bdaddr_type;
+  bdaddr_t direct_bdaddr;
+  uint8_t filter;
+  int8_t tx_power;
+  uint8_t primary_phy;
+  uint8_t secondary_max_skip;
+  uint8_t secondary_phy;
+  uint8_t sid;
+  uint8_t scan_req_notify;
+} __attribute__ ((packed)) le_set_extended_advertising_parameters_cp;
+#define LE_SET_EXTENDED_ADVERTISING_PARAMETERS_CP_SIZE 25
+
+#define LE_EXTENDED_ADVERTISING_DATA_MAX 251
+#define OCF_LE_SET_EXTENDED_ADVERTISING_DATA 0x0037
+typedef struct {
+  uint8_t handle;
+  uint8_t operation;
+  uint8_t fragment_preference;
+  uint8_t length;
+  uint8_t data[LE_EXTENDED_ADVERTISING_DATA_MAX];
+} __attribute__ ((packed)) le_set_extended_advertising_data_cp;
+#define LE_SET_EXTENDED_ADVERTISING_DATA_CP_SIZE 4
+
+#define OCF_LE_SET_EXTENDED_ADVERTISING_ENABLE 0x0039
+typedef struct {
+  uint8_t enable;
+  uint8_t num_sets;
+  uint8_t handle;
+  uint16_t duration;
+  uint8_t max_events;
+} __attribute__ ((packed)) le_set_extended_advertising_enable_cp;
+#define LE_SET_EXTENDED_ADVERTISING_ENABLE_CP_SIZE 6
+
+#define OCF_LE_SET_EXTENDED_SCAN_PARAMETERS 0x0041
+typedef struct {
+  uint8_t own_bdaddr_type;
+  uint8_t filter;
+  uint8_t phys;
+  uint8_t type;
+  uint16_t interval;
+  uint16_t window;
+} __attribute__ ((packed)) le_set_extended_scan_parameters_cp;
+#define LE_SET_EXTENDED_SCAN_PARAMETERS_CP_SIZE 8
+
+#define OCF_LE_SET_EXTENDED_SCAN_ENABLE 0x0042
+typedef struct {
+  uint8_t enable;
+  uint8_t filter_dup;
+  uint16_t duration;
+  uint16_t period;
+} __attribute__ ((packed)) le_set_extended_scan_enable_cp;
+#define LE_SET_EXTENDED_SCAN_ENABLE_CP_SIZE 6
+
+#define EVT_LE_EXTENDED_ADVERTISING_REPORT 0x0D
+typedef struct {
+  uint16_t evt_type;
+  uint8_t bdaddr_type;
+  bdaddr_t bdaddr;
+  uint8_t primary_phy;
+  uint8_t secondary_phy;
+  uint8_t sid;
+  int8_t tx_power;
+  int8_t rssi;
+  uint16_t periodic_interval;
+  uint8_t direct_bdaddr_type;
+  bdaddr_t direct_bdaddr;
+  uint8_t length;
+  uint8_t data[0];
+} __attribute__ ((packed)) le_extended_advertising_info;
+#define LE_EXTENDED_ADVERTISING_INFO_SIZE 24
+
 // Unfortunately the Bluetooth headers contained in the Android source do
 // not support the LE functionality that we require. Therefore, the
 // appropriate constants as contained in the specification are listed below.
@@ -136,7 +299,29 @@ public:
   };
   typedef Scan_::Type Scan;
 
+  // Round trip latencies (in us) are measured from writing the command to
+  // receiving its completion, so commands sent together in one batch include
+  // the time spent queued behind the earlier ones
+  struct CommandStats
+  {
+    size_t numSent;
+    size_t numSkipped;
+    uint64_t totalLatency;
+    uint64_t maxLatency;
+  };
+  typedef std::map<uint16_t, CommandStats> CommandStatsMap;
+
 private:
+  static const int64_t COMMAND_TIMEOUT = 1000;
+
+  struct PendingName
+  {
+    size_t index;
+    uint64_t sendTime;
+    uint64_t deadline;
+    bool isAccepted;
+  };
+
   struct LastKnownState
   {
     bool publicAddressStored;
@@ -149,6 +334,11 @@ private:
     bool advertDataStored;
     bool responseDataStored;
     bool advertParamsStored;
+    bool extInquiryResponseStored;
+    bool extAdvertParamsStored;
+    bool extAdvertAddressStored;
+    bool extAdvertDataStored;
+    bool isExtAdvertisingStored;
 
     Address publicAddress;
     Address randomAddress;
@@ -160,20 +350,62 @@ private:
     le_set_advertising_data_cp advertData;
     le_set_scan_response_data_cp responseData;
     le_set_advertising_parameters_cp advertParams;
+    uint8_t extInquiryResponse[HCI_MAX_EIR_LENGTH];
+    le_set_extended_advertising_parameters_cp extAdvertParams;
+    Address extAdvertAddress;
+    le_set_extended_advertising_data_cp extAdvertData;
+    bool isExtAdvertising;
+  };
+
+  // Advertising changes requested since beginAdvertUpdate(), which are only
+  // sent to the controller once the outermost update has ended
+  struct AdvertUpdate
+  {
+    size_t depth;
+    bool hasRandomAddress;
+    bool hasAdvertData;
+    bool hasResponseData;
+    bool hasAdvertParams;
+    bool hasAdvertising;
+
+    Address randomAddress;
+    le_set_advertising_data_cp advertData;
+    le_set_scan_response_data_cp responseData;
+    le_set_advertising_parameters_cp advertParams;
+    bool isAdvertising;
+  };
+
+  struct PendingCommand
+  {
+    uint16_t opcode;
+    const void *params;
+    uint8_t length;
+    uint64_t sendTime;
+    bool isComplete;
   };
 
 private:
   int adapterID_;
-  int sock_;
+  std::shared_ptr<HCIBackend> backend_;
+  std::shared_ptr<Clock> clock_;
+  HCIReactor reactor_;
 
   // Holds state (e.g. EIR payload) that gets overwritten after the Bluetooth
   // controller is reset. In the event that we need to recover the adapter due
   // to a fatal error, we will attempt to reinitialize the adapter based on this
   // state information.
   LastKnownState lastKnownState_;
+  // What the controller currently holds as far as we know, which commands are
+  // checked against so that those which would not change anything are not
+  // sent at all. Unlike lastKnownState_, this is cleared when the controller
+  // is reset.
+  LastKnownState appliedState_;
+  AdvertUpdate advertUpdate_;
+  CommandStatsMap commandStats_;
 
 public:
   BluetoothHCI(int adapterID);
+  explicit BluetoothHCI(std::shared_ptr<HCIBackend> backend);
   ~BluetoothHCI();
 
   int getAdapterID() const;
@@ -193,29 +425,96 @@ public:
   bool readRemoteName(std::string &name, const Address &address, uint16_t clockOffset, uint8_t pageScanMode, uint64_t timeout);
   void writeLocalName(std::string name);
 
+  // Pipelines remote name requests, keeping up to 'maxPending' of them
+  // outstanding at once and matching each completion to its request by
+  // address. Calls callback(index, const RemoteNameResponse *) for every
+  // request that was started, as soon as it finishes (or after 'timeout' ms,
+  // with a page timeout status). No new requests are started once
+  // 'startDuration' ms have passed. The number outstanding is reduced if the
+  // controller refuses one, since most can only page a few devices at once.
+  template<typename Callback>
+  void readRemoteNames(const std::vector<RemoteNameRequest> &requests, size_t maxPending, int64_t timeout, int64_t startDuration, Callback callback);
+
   void writeExtInquiryResponse(uint8_t *data);
 
   std::list<InquiryResponse> performInquiry(int periods = 8);
-  void performEIRInquiry(std::function<void(const EIRInquiryResponse *)> callback, int periods = 8);
-  void performScan(Scan type, DuplicateFilter filter, uint64_t duration, std::function<void(const ScanResponse *)> callback);
+  template<typename Callback>
+  void performEIRInquiry(Callback callback, int periods = 8);
+  template<typename Callback>
+  void performScan(Scan type, DuplicateFilter filter, uint64_t duration, Callback callback);
 
   void setAdvertData(const uint8_t *data, uint8_t length);
   void setScanResponseData(const uint8_t *data, uint8_t length);
   void setUndirectedAdvertParams(UndirectedAdvert type, AdvertFilter filter, uint16_t minInterval, uint16_t maxInterval);
   void enableAdvertising(bool enable);
 
+  // LE extended advertising (Bluetooth 5.0) from a single advertising set,
+  // which carries up to LE_EXTENDED_ADVERTISING_DATA_MAX bytes of data on the
+  // secondary channels. The set has its own random address, which is changed
+  // along with the data so that both always match. Nothing is sent that the
+  // controller already holds, and the set is disabled around any changes.
+  void setExtAdvertParams(bool isConnectable, uint16_t minInterval, uint16_t maxInterval);
+  void setExtAdvert(const Address &address, const uint8_t *data, uint8_t length);
+  void enableExtAdvertising(bool enable);
+  // Scans with the extended commands, which also report extended adverts.
+  // Fragmented reports are joined back together, so the callback only sees
+  // complete payloads (truncated ones are dropped).
+  template<typename Callback>
+  void performExtendedScan(Scan type, uint64_t duration, Callback callback);
+
+  // Groups the advertising changes made until the matching endAdvertUpdate()
+  // (which may be nested), so that they are sent together in dependency order
+  // (disable, random address, parameters, data, enable). Changes matching the
+  // controller's current state are dropped, and advertising is only disabled
+  // around changes that require it.
+  void beginAdvertUpdate();
+  void endAdvertUpdate();
+
+  const CommandStatsMap& getCommandStats() const;
+  void logCommandStats() const;
+
+  // Resets the controller (restarting the adapter if a reset is not enough)
+  // and then restores everything in the last known state, so that the caller
+  // can carry on as before. Returns the time taken (in ms).
+  uint64_t recover();
+
 private:
+  void restartAdapter(bool writePublicAddress);
+  void reopen();
+  void replayState();
   void setScan(bool pscan, bool iscan);
-  void recover();
+  void flushAdvertUpdate();
+  void flushExtAdvert();
+  void sendCommands(PendingCommand *commands, size_t numCommands);
+  // Sends a single command and waits for its reply (or for 'event', if given,
+  // rather than the command completion), failing with EIO if the status in
+  // the reply is non-zero
+  int sendRequest(uint16_t opcode, const void *params, uint8_t length, void *reply, uint8_t replyLength, int timeout, int event = 0);
+  int sendScanParameters(Scan type, uint64_t duration);
+  int sendScanEnable(bool enable, DuplicateFilter filter);
+  // Returns the command's latency (us)
+  uint64_t recordCommand(uint16_t opcode, uint64_t sendTime);
+  void recordSkipped(uint16_t opcode);
+
+  void startRemoteName(const RemoteNameRequest &request);
+  void cancelRemoteName(const Address &address);
+
+  void startEIRInquiry(int periods);
+  void finishEIRInquiry(bool isComplete, uint8_t status);
+  void startScan(Scan type, DuplicateFilter filter, uint64_t duration);
+  void finishScan();
+  void startExtendedScan(Scan type, uint64_t duration);
+  void finishExtendedScan();
 
 public:
   // TODO: Should move this functionality into other classes
-  static int connectBT2(const Address &address, uint8_t port, int64_t timeout);
-  static int connectBT4(const Address &address, int64_t timeout);
-  static int listenBT2(uint8_t port);
-  static int listenBT4();
-  static std::pair<int, Address> acceptBT2(int sockListen);
-  static std::pair<int, Address> acceptBT4(int sockListen);
+  int connectBT2(const Address &address, uint8_t port, int64_t timeout);
+  int connectBT4(const Address &address, int64_t timeout);
+  int startConnectBT4(const Address &address);
+  int listenBT2(uint8_t port);
+  int listenBT4();
+  std::pair<int, Address> acceptBT2(int sockListen);
+  std::pair<int, Address> acceptBT4(int sockListen);
   static bool send(int sock, const uint8_t *message, size_t size, int64_t timeout);
   static bool recv(int sock, uint8_t *dest, size_t size, int64_t timeout);
   static bool waitClose(int sock, int64_t timeout);
@@ -226,4 +525,450 @@ inline int BluetoothHCI::getAdapterID() const
   return adapterID_;
 }
 
+inline const BluetoothHCI::CommandStatsMap& BluetoothHCI::getCommandStats() const
+{
+  return commandStats_;
+}
+
+template<typename Callback>
+void BluetoothHCI::readRemoteNames(const std::vector<RemoteNameRequest> &requests, size_t maxPending, int64_t timeout, int64_t startDuration, Callback callback)
+{
+  const uint16_t nameOpcode = cmd_opcode_pack(OGF_LINK_CTL, OCF_REMOTE_NAME_REQ);
+
+  std::vector<PendingName> pending;
+  std::deque<size_t> toStart;
+  for(size_t r = 0; r < requests.size(); r++)
+  {
+    toStart.push_back(r);
+  }
+
+  size_t numAllowed = std::max<size_t>(maxPending, 1);
+  const uint64_t startDeadline = clock_->getMonoMS() + std::max<int64_t>(startDuration, 0);
+
+  auto finish = [&](size_t index, uint8_t status)
+  {
+    RemoteNameResponse response;
+    response.address = requests[index].address;
+    response.status = status;
+    callback(index, &response);
+  };
+
+  auto dispatcher = makeHCIEventDispatcher(HCIIgnore(), HCIIgnore(), HCIIgnore(), [&](uint16_t opcode, uint8_t status)
+  {
+    if(opcode != nameOpcode)
+    {
+      return;
+    }
+
+    // Command status events arrive in the order the requests were sent, so
+    // this belongs to the earliest one that has not had its status yet
+    auto it = std::find_if(pending.begin(), pending.end(), [](const PendingName &p) { return !p.isAccepted; });
+    if(it == pending.end())
+    {
+      return;
+    }
+
+    if(status == 0)
+    {
+      it->isAccepted = true;
+      return;
+    }
+
+    // Refused while others are outstanding, so the controller cannot page
+    // that many at once. Retrying it once there is room, with fewer allowed.
+    size_t index = it->index;
+    pending.erase(it);
+    if(!pending.empty())
+    {
+      numAllowed = pending.size();
+      toStart.push_front(index);
+    }
+    else
+    {
+      finish(index, status);
+    }
+  },
+  [&](const RemoteNameResponse *response)
+  {
+    auto it = std::find_if(pending.begin(), pending.end(), [&](const PendingName &p) { return requests[p.index].address == response->address; });
+    if(it == pending.end())
+    {
+      return;
+    }
+
+    recordCommand(nameOpcode, it->sendTime);
+
+    size_t index = it->index;
+    pending.erase(it);
+    callback(index, response);
+  });
+
+  // Discarding stale completions, so they are not mistaken for ours
+  reactor_.flush();
+
+  while(!pending.empty() || (!toStart.empty() && (clock_->getMonoMS() < startDeadline)))
+  {
+    uint64_t curTime = clock_->getMonoMS();
+    while(!toStart.empty() && (pending.size() < numAllowed) && (curTime < startDeadline))
+    {
+      size_t index = toStart.front();
+      toStart.pop_front();
+
+      startRemoteName(requests[index]);
+      pending.push_back({index, clock_->getMonoUS(), curTime + timeout, false});
+    }
+
+    if(pending.empty())
+    {
+      break;
+    }
+
+    uint64_t wakeTime = pending.front().deadline;
+    for(auto it = pending.begin(); it != pending.end(); it++)
+    {
+      wakeTime = std::min(wakeTime, it->deadline);
+    }
+
+    reactor_.poll((wakeTime > curTime) ? (wakeTime - curTime) : 0, dispatcher);
+
+    // Cancelling any requests that have run out of time
+    curTime = clock_->getMonoMS();
+    for(auto it = pending.begin(); it != pending.end();)
+    {
+      if(curTime >= it->deadline)
+      {
+        size_t index = it->index;
+        cancelRemoteName(requests[index].address);
+        it = pending.erase(it);
+        finish(index, HCI_PAGE_TIMEOUT);
+      }
+      else
+      {
+        it++;
+      }
+    }
+  }
+}
+
+template<typename Callback>
+void BluetoothHCI::performEIRInquiry(Callback callback, int periods)
+{
+  const uint16_t inquiryOpcode = cmd_opcode_pack(OGF_LINK_CTL, OCF_INQUIRY);
+
+  Metrics::Timer timer(Metrics::Histogram::ScanDuration);
+  size_t numReports = 0;
+
+  bool isComplete = false;
+  uint8_t status = 0;
+  auto dispatcher = makeHCIEventDispatcher(HCIIgnore(), [&](const EIRInquiryResponse *response)
+  {
+    numReports++;
+    PROBE3(scan_report, response->address.toByteArray(), response->rssi, HCI_MAX_EIR_LENGTH);
+    callback(response);
+  }, [&](uint16_t opcode, uint8_t commandStatus)
+  {
+    if(opcode == inquiryOpcode)
+    {
+      isComplete = true;
+      status = commandStatus;
+    }
+  });
+
+  startEIRInquiry(periods);
+
+  uint64_t startTime = clock_->getTimeMS();
+  int64_t remainingTime;
+
+  // Polls can return early without any events (e.g. on a spurious wakeup),
+  // so only the time remaining ends the inquiry
+  while(!isComplete && ((remainingTime = (periods * 1280) - (clock_->getTimeMS() - startTime)) > 0))
+  {
+    reactor_.poll(remainingTime, dispatcher);
+  }
+
+  finishEIRInquiry(isComplete, status);
+
+  Metrics::record(Metrics::Histogram::ReportsPerScan, numReports);
+  PROBE1(scan_complete, numReports);
+}
+
+template<typename Callback>
+void BluetoothHCI::performScan(Scan type, DuplicateFilter filter, uint64_t duration, Callback callback)
+{
+  Metrics::Timer timer(Metrics::Histogram::ScanDuration);
+  size_t numReports = 0;
+
+  auto dispatcher = makeHCIEventDispatcher([&](const ScanResponse *response)
+  {
+    numReports++;
+    PROBE3(scan_report, response->address.toByteArray(), response->rssi, response->length);
+    callback(response);
+  }, HCIIgnore(), HCIIgnore());
+
+  startScan(type, filter, duration);
+
+  uint64_t startTime = clock_->getTimeMS();
+  int64_t remainingTime;
+
+  // Polls can return early without any events (e.g. on a spurious wakeup),
+  // so only the time remaining ends the scan
+  while((remainingTime = duration - (clock_->getTimeMS() - startTime)) > 0)
+  {
+    reactor_.poll(remainingTime, dispatcher);
+  }
+
+  finishScan();
+
+  Metrics::record(Metrics::Histogram::ReportsPerScan, numReports);
+  PROBE1(scan_complete, numReports);
+}
+
+template<typename Callback>
+void BluetoothHCI::performExtendedScan(Scan type, uint64_t duration, Callback callback)
+{
+  Metrics::Timer timer(Metrics::Histogram::ScanDuration);
+  size_t numReports = 0;
+
+  // Payloads too long for one event arrive as consecutive fragments from the
+  // same address, which are collected here until the last one
+  std::vector<std::pair<Address, std::vector<uint8_t> > > fragments;
+
+  auto dispatcher = makeHCIEventDispatcher([&](const ScanResponse *response)
+  {
+    numReports++;
+    PROBE3(scan_report, response->address.toByteArray(), response->rssi, response->length);
+    auto it = std::find_if(fragments.begin(), fragments.end(), [&](const std::pair<Address, std::vector<uint8_t> > &f) { return f.first == response->address; });
+    if((it == fragments.end()) && !response->hasMore && !response->isTruncated)
+    {
+      callback(response);
+      return;
+    }
+
+    if(response->isTruncated)
+    {
+      if(it != fragments.end())
+      {
+        fragments.erase(it);
+      }
+      return;
+    }
+
+    if(it == fragments.end())
+    {
+      fragments.push_back(std::make_pair(response->address, std::vector<uint8_t>()));
+      it = fragments.end() - 1;
+    }
+    it->second.insert(it->second.end(), response->data, response->data + response->length);
+
+    if(!response->hasMore)
+    {
+      if(it->second.size() <= 0xFF)
+      {
+        ScanResponse joined = *response;
+        joined.data = it->second.data();
+        joined.length = it->second.size();
+        callback(&joined);
+      }
+      fragments.erase(it);
+    }
+  }, HCIIgnore(), HCIIgnore());
+
+  startExtendedScan(type, duration);
+
+  uint64_t startTime = clock_->getTimeMS();
+  int64_t remainingTime;
+
+  // Polls can return early without any events (e.g. on a spurious wakeup),
+  // so only the time remaining ends the scan
+  while((remainingTime = duration - (clock_->getTimeMS() - startTime)) > 0)
+  {
+    reactor_.poll(remainingTime, dispatcher);
+  }
+
+  finishExtendedScan();
+
+  Metrics::record(Metrics::Histogram::ReportsPerScan, numReports);
+  PROBE1(scan_complete, numReports);
+}
+
+template<typename OnScanResponse, typename OnEIRResponse, typename OnCommandComplete, typename OnCommandStatus, typename OnRemoteName>
+HCIEventDispatcher<OnScanResponse, OnEIRResponse, OnCommandComplete, OnCommandStatus, OnRemoteName>::HCIEventDispatcher(OnScanResponse onScanResponse, OnEIRResponse onEIRResponse, OnCommandComplete onCommandComplete, OnCommandStatus onCommandStatus, OnRemoteName onRemoteName)
+   : onScanResponse_(onScanResponse),
+     onEIRResponse_(onEIRResponse),
+     onCommandComplete_(onCommandComplete),
+     onCommandStatus_(onCommandStatus),
+     onRemoteName_(onRemoteName)
+{
+}
+
+template<typename OnScanResponse, typename OnEIRResponse, typename OnCommandComplete, typename OnCommandStatus, typename OnRemoteName>
+void HCIEventDispatcher<OnScanResponse, OnEIRResponse, OnCommandComplete, OnCommandStatus, OnRemoteName>::operator ()(uint8_t *packet, size_t length)
+{
+  if((length < (1 + HCI_EVENT_HDR_SIZE)) || (packet[0] != HCI_EVENT_PKT))
+  {
+    return;
+  }
+
+  hci_event_hdr *eventHeader = (hci_event_hdr *)(packet + 1);
+  uint8_t *eventBody = packet + 1 + HCI_EVENT_HDR_SIZE;
+
+  // Reports are only parsed as far as both the event's own length and the
+  // packet actually received cover, stopping at the first that overruns
+  const uint8_t *eventEnd = eventBody + std::min<size_t>(eventHeader->plen, length - (1 + HCI_EVENT_HDR_SIZE));
+
+  switch(eventHeader->evt)
+  {
+  case EVT_LE_META_EVENT:
+  {
+    if((eventEnd - eventBody) < (EVT_LE_META_EVENT_SIZE + 1))
+    {
+      break;
+    }
+
+    const evt_le_meta_event *metaEventHeader = (evt_le_meta_event *)eventBody;
+    const uint8_t *metaEventBody = metaEventHeader->data;
+
+    if(metaEventHeader->subevent == EVT_LE_ADVERTISING_REPORT)
+    {
+      uint8_t numReports = *(metaEventBody++);
+
+      for(int r = 0; r < numReports; r++)
+      {
+        // Each report is followed by its RSSI byte
+        if(((eventEnd - metaEventBody) < LE_ADVERTISING_INFO_SIZE) ||
+           ((eventEnd - metaEventBody) < (LE_ADVERTISING_INFO_SIZE + ((le_advertising_info *)metaEventBody)->length + 1)))
+        {
+          break;
+        }
+
+        le_advertising_info *info = (le_advertising_info *)(metaEventBody);
+
+        ScanResponse response;
+        response.address = Address(6, info->bdaddr.b);
+        response.data = info->data;
+        response.length = info->length;
+        response.rssi = ((int8_t *)info->data)[info->length];
+        response.hasMore = false;
+        response.isTruncated = false;
+
+        onScanResponse_(&response);
+
+        metaEventBody += LE_ADVERTISING_INFO_SIZE + info->length + 1;
+      }
+    }
+    else if(metaEventHeader->subevent == EVT_LE_EXTENDED_ADVERTISING_REPORT)
+    {
+      uint8_t numReports = *(metaEventBody++);
+
+      for(int r = 0; r < numReports; r++)
+      {
+        if(((eventEnd - metaEventBody) < LE_EXTENDED_ADVERTISING_INFO_SIZE) ||
+           ((eventEnd - metaEventBody) < (LE_EXTENDED_ADVERTISING_INFO_SIZE + ((le_extended_advertising_info *)metaEventBody)->length)))
+        {
+          break;
+        }
+
+        le_extended_advertising_info *info = (le_extended_advertising_info *)(metaEventBody);
+
+        // Data status is held in bits 5-6 of the event type, where 1 means
+        // more data is to come and 2 that the rest was lost
+        uint8_t dataStatus = (btohs(info->evt_type) >> 5) & 0x3;
+
+        ScanResponse response;
+        response.address = Address(6, info->bdaddr.b);
+        response.data = info->data;
+        response.length = info->length;
+        response.rssi = info->rssi;
+        response.hasMore = (dataStatus == 1);
+        response.isTruncated = (dataStatus == 2);
+
+        onScanResponse_(&response);
+
+        metaEventBody += LE_EXTENDED_ADVERTISING_INFO_SIZE + info->length;
+      }
+    }
+    break;
+  }
+
+  case EVT_EXTENDED_INQUIRY_RESULT:
+  {
+    if((eventEnd - eventBody) < (1 + EXTENDED_INQUIRY_INFO_SIZE))
+    {
+      break;
+    }
+
+    extended_inquiry_info *eii = (extended_inquiry_info *)(eventBody + 1);
+
+    EIRInquiryResponse response;
+    response.address = Address(6, eii->bdaddr.b);
+    response.clockOffset = eii->clock_offset;
+    response.pageScanMode = eii->pscan_rep_mode;
+    response.pageScanPeriodMode = eii->pscan_period_mode;
+    response.data = eii->data;
+    response.rssi = eii->rssi;
+
+    onEIRResponse_(&response);
+    break;
+  }
+
+  case EVT_INQUIRY_COMPLETE:
+    if((eventEnd - eventBody) < 1)
+    {
+      break;
+    }
+
+    onCommandComplete_(cmd_opcode_pack(OGF_LINK_CTL, OCF_INQUIRY), eventBody[0]);
+    break;
+
+  case EVT_CMD_COMPLETE:
+  {
+    if((eventEnd - eventBody) < EVT_CMD_COMPLETE_SIZE)
+    {
+      break;
+    }
+
+    const evt_cmd_complete *complete = (evt_cmd_complete *)eventBody;
+    uint8_t status = ((eventEnd - eventBody) > EVT_CMD_COMPLETE_SIZE) ? eventBody[EVT_CMD_COMPLETE_SIZE] : 0;
+    onCommandComplete_(btohs(complete->opcode), status);
+    break;
+  }
+
+  case EVT_CMD_STATUS:
+  {
+    if((eventEnd - eventBody) < EVT_CMD_STATUS_SIZE)
+    {
+      break;
+    }
+
+    const evt_cmd_status *commandStatus = (evt_cmd_status *)eventBody;
+    onCommandStatus_(btohs(commandStatus->opcode), commandStatus->status);
+    if(commandStatus->status != 0)
+    {
+      onCommandComplete_(btohs(commandStatus->opcode), commandStatus->status);
+    }
+    break;
+  }
+
+  case EVT_REMOTE_NAME_REQ_COMPLETE:
+  {
+    // Status and address, followed by as much of the name as was sent
+    if((eventEnd - eventBody) < (1 + 6))
+    {
+      break;
+    }
+
+    const evt_remote_name_req_complete *nameComplete = (evt_remote_name_req_complete *)eventBody;
+    size_t nameLength = std::min<size_t>((eventEnd - eventBody) - (1 + 6), HCI_MAX_NAME_LENGTH);
+
+    RemoteNameResponse response;
+    response.address = Address(6, nameComplete->bdaddr.b);
+    response.status = nameComplete->status;
+    response.name = std::string((const char *)nameComplete->name, strnlen((const char *)nameComplete->name, nameLength));
+
+    onRemoteName_(&response);
+    break;
+  }
+  }
+}
+
 #endif  // BLUETOOTHHCI_H
@@ -0,0 +1,51 @@
+#ifndef CAPTUREHCIBACKEND_H
+#define CAPTUREHCIBACKEND_H
+
+#include <memory>
+
+#include "HCIBackend.h"
+#include "HCICapture.h"
+
+// Passes everything through to another backend, while recording the
+// discovery events that it reads to an HCICaptureWriter. A new session is
+// marked whenever a scan, extended scan or inquiry is started, so that the
+// capture can later be replayed one discovery at a time.
+class CaptureHCIBackend : public HCIBackend
+{
+private:
+  std::shared_ptr<HCIBackend> backend_;
+  std::shared_ptr<HCICaptureWriter> capture_;
+
+public:
+  CaptureHCIBackend(std::shared_ptr<HCIBackend> backend, std::shared_ptr<HCICaptureWriter> capture);
+
+  CaptureHCIBackend(const CaptureHCIBackend &) = delete;
+  CaptureHCIBackend& operator = (const CaptureHCIBackend &) = delete;
+
+  int getAdapterID() const;
+
+  int open();
+  void close();
+  int reset();
+  void restart(const Address *publicAddress);
+  int readDeviceInfo(struct hci_dev_info *info);
+  int setScanEnable(uint8_t scanEnable);
+
+  int sendCommand(uint16_t opcode, const void *params, uint8_t length);
+  int sendRequest(struct hci_request *request, int timeout);
+  int inquiry(int periods, std::vector<inquiry_info> &responses);
+
+  void openEvents(const struct hci_filter &filter);
+  void closeEvents();
+  size_t readEvents(int64_t timeout, uint8_t *buffer, size_t *lengths, size_t maxEvents);
+  size_t flushEvents();
+
+  int startConnect(Transport transport, const Address &address, uint8_t port);
+  int listen(Transport transport, uint8_t port);
+  std::pair<int, Address> accept(Transport transport, int sockListen);
+
+private:
+  void checkSession(uint16_t opcode, const void *params, uint8_t length);
+};
+
+#endif // CAPTUREHCIBACKEND_H
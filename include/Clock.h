@@ -0,0 +1,50 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Source of time for everything that schedules actions (the controller,
+// radios, hysteresis policy, devices and the HCI layer beneath them), so that
+// a simulation can substitute a VirtualClock which skips over the idle time
+// between actions. Objects take the default clock as they are created, which
+// is the system clock unless it has been replaced beforehand.
+class Clock
+{
+private:
+  static std::shared_ptr<Clock> default_;
+
+public:
+  static std::shared_ptr<Clock> getDefault();
+  static void setDefault(std::shared_ptr<Clock> clock);
+  static std::shared_ptr<Clock> getSystem();
+
+  virtual ~Clock();
+
+  // Wall-clock time (since the epoch), as used for reported times
+  virtual uint64_t getTimeMS() const = 0;
+  // Monotonic time, as used for deadlines and latencies
+  virtual uint64_t getMonoMS() const = 0;
+  virtual uint64_t getMonoUS() const = 0;
+
+  virtual void sleepMS(uint64_t time) = 0;
+  // Waits for a notification on 'cond' (with 'lock' held on entry and return)
+  // for up to 'timeout' ms, or indefinitely if UINT64_MAX. Callers need to
+  // recheck whatever they are waiting for, since this may return early.
+  virtual void waitFor(std::unique_lock<std::mutex> &lock, std::condition_variable &cond, uint64_t timeout) = 0;
+};
+
+class SystemClock : public Clock
+{
+public:
+  uint64_t getTimeMS() const;
+  uint64_t getMonoMS() const;
+  uint64_t getMonoUS() const;
+
+  void sleepMS(uint64_t time);
+  void waitFor(std::unique_lock<std::mutex> &lock, std::condition_variable &cond, uint64_t timeout);
+};
+
+#endif // CLOCK_H
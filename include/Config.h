@@ -14,6 +14,7 @@ struct Config
     EbNRadio::Version version;
     EbNRadio::ConfirmScheme confirm;
     EbNRadio::MemoryScheme memory;
+    size_t numAdapters;
   } radio;
 
   struct HystPolicy
@@ -31,14 +32,26 @@ struct Config
     uint64_t rssiInterval; // ms
   } reporting;
 
+  // Benchmarking many devices at once on a virtual medium (none if zero)
+  struct Simulation
+  {
+    size_t numDevices;
+    double range;          // m
+    double lossRate;
+    uint64_t duration;     // ms
+    uint32_t seed;         // Random if zero
+    bool isRealTime;       // Otherwise runs on a VirtualClock
+  } simulation;
+
   void dump() const;
 };
 
 constexpr Config configDefaults =
 {
-  {192, EbNRadio::Version::Bluetooth2, {EbNRadio::ConfirmScheme::Passive, 0.05}, EbNRadio::MemoryScheme::Standard},
+  {192, EbNRadio::Version::Bluetooth2, {EbNRadio::ConfirmScheme::Passive, 0.05}, EbNRadio::MemoryScheme::Standard, 1},
   {EbNHystPolicy::Scheme::Standard, TIME_MIN_TO_MS(2), TIME_MIN_TO_MS(5), 2, TIME_MIN_TO_MS(10), -85},
-  {TIME_MIN_TO_MS(1)}
+  {TIME_MIN_TO_MS(1)},
+  {0, 20, 0.1, TIME_MIN_TO_MS(10), 0, false}
 };
 
 #endif // CONFIG_H
@@ -0,0 +1,132 @@
+#ifndef CONNECTIONACCEPTOR_H
+#define CONNECTIONACCEPTOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Address.h"
+
+// Serves incoming connections from a non-blocking listen socket, running
+// each as its own state machine (a Session) from a single epoll loop, so that
+// many clients can be in the middle of an exchange at once. A session moves
+// through a series of steps (sends, receives, waiting for the remote side to
+// close), where any heavy computation between steps is run on a pool of
+// worker threads, leaving the loop free to serve the other connections.
+class ConnectionAcceptor
+{
+public:
+  struct Step
+  {
+    struct Type_
+    {
+      enum Type
+      {
+        Send,
+        Receive,
+        // Receives a 4 byte (host order) length, followed by that many bytes
+        ReceiveFramed,
+        WaitClose,
+        Compute,
+        Close
+      };
+    };
+    typedef Type_::Type Type;
+
+    Type type;
+    std::vector<uint8_t> data;
+    size_t size;
+    int64_t timeout;
+    bool isSuccess;
+
+    static Step send(std::vector<uint8_t> data, int64_t timeout);
+    static Step receive(size_t size, int64_t timeout);
+    static Step receiveFramed(int64_t timeout);
+    static Step waitClose(int64_t timeout);
+    static Step compute();
+    static Step close(bool isSuccess);
+  };
+
+  class Session
+  {
+  public:
+    virtual ~Session();
+
+    // Returns the first step, called once the connection is accepted
+    virtual Step start() = 0;
+    // Called once the current step has finished, with the data from a receive
+    // step (otherwise empty), returning the next step
+    virtual Step advance(std::vector<uint8_t> &received) = 0;
+    // Called on a worker thread for a compute step, which is then followed by
+    // advance() (with nothing received)
+    virtual void compute();
+    // Called when the connection is closed, either by a close step or due to
+    // an error or timeout
+    virtual void finish(bool isSuccess) = 0;
+  };
+
+  typedef std::function<std::pair<int, Address>(int sockListen)> Accept;
+  typedef std::function<std::unique_ptr<Session>(const Address &address)> SessionFactory;
+
+private:
+  static const size_t MAX_EVENTS = 16;
+  static const size_t MAX_FRAME_SIZE = 1 << 20;
+
+  struct Connection
+  {
+    int sock;
+    Address address;
+    std::unique_ptr<Session> session;
+    Step step;
+    std::vector<uint8_t> buffer;
+    size_t pos;
+    bool hasFrameSize;
+    uint64_t deadline;
+    bool isComputing;
+  };
+
+private:
+  Accept accept_;
+  SessionFactory sessionFactory_;
+  const char *wakeName_;
+  int epoll_;
+  int wakeFD_;
+  std::unordered_map<int, Connection> connections_;
+  std::vector<std::thread> workers_;
+  std::deque<std::pair<int, Session *> > workQueue_;
+  std::deque<int> computedQueue_;
+  std::mutex workMutex_;
+  std::condition_variable workCond_;
+  bool isStopping_;
+
+public:
+  ConnectionAcceptor(Accept accept, SessionFactory sessionFactory, size_t numWorkers, const char *wakeName);
+  ~ConnectionAcceptor();
+
+  ConnectionAcceptor(const ConnectionAcceptor &) = delete;
+  ConnectionAcceptor& operator = (const ConnectionAcceptor &) = delete;
+
+  // Serves connections until the listen socket fails, after which any open
+  // connections are closed
+  void run(int sockListen);
+
+private:
+  void acceptClient(int sockListen);
+  void beginStep(Connection &connection, Step step);
+  void handleEvent(Connection &connection, uint32_t events);
+  void finishStep(Connection &connection);
+  void closeConnection(int sock, bool isSuccess);
+  void updateEvents(Connection &connection, uint32_t events);
+  void expireConnections();
+  void collectComputed(bool isClosing);
+  void work();
+};
+
+#endif // CONNECTIONACCEPTOR_H
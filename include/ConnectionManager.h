@@ -0,0 +1,81 @@
+#ifndef CONNECTIONMANAGER_H
+#define CONNECTIONMANAGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Address.h"
+#include "Clock.h"
+
+// Runs a set of short request/reply exchanges with remote devices over
+// non-blocking sockets, keeping up to 'maxConnections' of them in flight at
+// once from a single epoll loop. Each exchange connects, sends the message,
+// waits for a fixed-size reply and then closes the connection, with separate
+// deadlines for the connection and for each of the send and receive steps.
+class ConnectionManager
+{
+public:
+  // Begins a non-blocking connection, returning the socket or -1 on failure
+  // (with errno set to EBUSY if it should be retried later)
+  typedef std::function<int(const Address &address)> StartConnect;
+
+  struct Result
+  {
+    bool isAttempted;
+    bool isSuccess;
+    std::vector<uint8_t> reply;
+  };
+
+private:
+  static const size_t MAX_EVENTS = 8;
+  static const int64_t RETRY_INTERVAL = 100;
+
+  struct State_
+  {
+    enum Type
+    {
+      Connecting,
+      Sending,
+      Receiving
+    };
+  };
+  typedef State_::Type State;
+
+  struct Connection
+  {
+    size_t index;
+    int sock;
+    State state;
+    uint64_t deadline;
+    size_t pos;
+  };
+
+private:
+  StartConnect startConnect_;
+  size_t maxConnections_;
+  int64_t connectTimeout_;
+  int64_t exchangeTimeout_;
+  std::shared_ptr<Clock> clock_;
+  int epoll_;
+
+public:
+  ConnectionManager(StartConnect startConnect, size_t maxConnections, int64_t connectTimeout, int64_t exchangeTimeout);
+  ~ConnectionManager();
+
+  ConnectionManager(const ConnectionManager &) = delete;
+  ConnectionManager& operator = (const ConnectionManager &) = delete;
+
+  // Performs the exchange with each address, in order of starting. No new
+  // connections are started once 'startTimeout' ms have passed, in which case
+  // the remaining results are marked as not attempted.
+  std::vector<Result> run(const std::vector<Address> &addresses, const std::vector<uint8_t> &message, size_t replySize, int64_t startTimeout);
+
+private:
+  bool handleEvent(Connection &connection, uint32_t events, const std::vector<uint8_t> &message, Result &result);
+  void finish(Connection &connection, Result &result, bool isSuccess);
+};
+
+#endif // CONNECTIONMANAGER_H
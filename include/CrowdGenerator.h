@@ -0,0 +1,87 @@
+#ifndef CROWDGENERATOR_H
+#define CROWDGENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Clock.h"
+#include "EbNRadio.h"
+#include "LinkValue.h"
+
+// Creates a crowd of synthetic peers for a listening radio to discover, in
+// order to measure how the cost of each discovery grows with the number of
+// nearby devices. Each peer is a full radio (with its own ECDH keys, address
+// and advertised set) on its own simulated adapter, put on the air through
+// EbNRadio::initializePeer(). Each entry of a peer's advertised set is taken
+// from the listener's set with probability 'overlap', and is otherwise
+// random. Peers sit at their own phase within the epoch, so that their
+// address changes are spread out rather than happening all at once.
+class CrowdGenerator
+{
+public:
+  typedef std::function<std::shared_ptr<EbNRadio>(int adapterID)> RadioFactory;
+
+  struct Config
+  {
+    size_t numPeers;
+    size_t setSize;
+    double overlap;
+    size_t linkValueSize; // bytes
+    int firstAdapterID;
+    uint32_t seed;
+  };
+
+private:
+  struct Peer
+  {
+    std::shared_ptr<EbNRadio> radio;
+    uint64_t nextChangeEpoch; // ms
+  };
+
+private:
+  Config config_;
+  std::shared_ptr<Clock> clock_;
+  std::vector<Peer> peers_;
+  std::mt19937 random_;
+  size_t numMatching_;
+  size_t numEpochChanges_;
+
+public:
+  CrowdGenerator(const Config &config, RadioFactory radioFactory, const LinkValueList &listenSet);
+
+  CrowdGenerator(const CrowdGenerator &) = delete;
+  CrowdGenerator& operator = (const CrowdGenerator &) = delete;
+
+  // Brings every peer up to the current time, changing the epoch of any whose
+  // phase has come around, and then moving each on to its next advert
+  void advance();
+
+  size_t getNumPeers() const;
+  // Number of peers advertising at least one entry of the listen set
+  size_t getNumMatching() const;
+  size_t getNumEpochChanges() const;
+
+private:
+  LinkValueList generateAdvertisedSet(const std::vector<LinkValue> &listenValues, bool &isMatching);
+};
+
+inline size_t CrowdGenerator::getNumPeers() const
+{
+  return peers_.size();
+}
+
+inline size_t CrowdGenerator::getNumMatching() const
+{
+  return numMatching_;
+}
+
+inline size_t CrowdGenerator::getNumEpochChanges() const
+{
+  return numEpochChanges_;
+}
+
+#endif // CROWDGENERATOR_H
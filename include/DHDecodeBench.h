@@ -0,0 +1,35 @@
+#ifndef DHDECODEBENCH_H
+#define DHDECODEBENCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "EbNRadioBT4.h"
+
+// Simulates how long a listener takes to decode a BT4 radio's DH public value
+// when each advert is independently lost, following the same advert schedule
+// as the radio itself: a new advert and scan response at each (jittered) scan,
+// a stall once an epoch runs out of symbols, and K-1 symbols carried over into
+// the next epoch. Only the radio's coding parameters are used, so no adapter
+// is needed.
+class DHDecodeBench
+{
+private:
+  const RSMatrix &matrix_;
+  size_t numEpochSymbols_;
+  size_t numScanAdverts_;
+  uint64_t scanInterval_;
+
+public:
+  DHDecodeBench(const EbNRadioBT4 &radio);
+
+  DHDecodeBench(const DHDecodeBench &) = delete;
+  DHDecodeBench& operator = (const DHDecodeBench &) = delete;
+
+  // Returns the time to decode for each trial (ms), or UINT64_MAX if it did
+  // not decode within a few epochs
+  std::vector<uint64_t> run(float lossRate, size_t numTrials);
+};
+
+#endif // DHDECODEBENCH_H
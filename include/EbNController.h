@@ -3,11 +3,20 @@
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
+#include "Address.h"
+#include "Clock.h"
 #include "Config.h"
 #include "EbNHystPolicy.h"
 #include "EbNRadio.h"
 
+// Drives one or more radios, each on its own adapter. Every radio keeps its
+// own schedule of actions, where discovery is staggered across them so that
+// only one adapter is scanning at a time while the others are advertising.
+// Devices are merged across radios by address, so that a remote device seen
+// through several adapters is reported as a single encounter.
 class EbNController
 {
 private:
@@ -22,16 +31,37 @@ private:
   };
   typedef RunningState_::Type RunningState;
 
+  static const int MAX_RECOVERY_ATTEMPTS = 3;
+
+  struct MergedDevice
+  {
+    // Radio index and the radio's own ID for the device
+    std::vector<std::pair<size_t, DeviceID> > members;
+    Address address;
+    bool isStarted;
+  };
+
+  typedef std::unordered_map<DeviceID, MergedDevice> MergedDeviceMap;
+  typedef std::unordered_map<DeviceID, DeviceID> DeviceIDMap;
+  typedef std::unordered_map<Address, DeviceID, Address::Hash, Address::Equal> AddressToIDMap;
+
 private:
-  std::shared_ptr<EbNRadio> radio_;
+  std::vector<std::shared_ptr<EbNRadio> > radios_;
   EbNHystPolicy hystPolicy_;
   uint64_t rssiReportInterval_;
+  std::shared_ptr<Clock> clock_;
   std::function<void(const EncounterEvent&)> encounterCallback_;
   std::function<void(uint64_t)> sleepCallback_;
   volatile bool isRunning_;
 
+  MergedDeviceMap mergedDevices_;
+  std::vector<DeviceIDMap> radioToMerged_;
+  AddressToIDMap addressToMerged_;
+  DeviceID nextMergedID_;
+
 public:
   EbNController(std::shared_ptr<EbNRadio> radio, EbNHystPolicy hystPolicy, uint64_t rssiReportInterval);
+  EbNController(const std::vector<std::shared_ptr<EbNRadio> > &radios, EbNHystPolicy hystPolicy, uint64_t rssiReportInterval);
 
   void setEncounterCallback(const std::function<void(const EncounterEvent&)> &callback);
   void setSleepCallback(const std::function<void(uint64_t)> &callback);
@@ -43,17 +73,32 @@ public:
   void stop();
 
 private:
+  void discover(size_t radioIndex);
+  void recover(size_t radioIndex);
+
+  DeviceID toMergedID(size_t radioIndex, DeviceID id);
+  AddressToIDMap::iterator findMergedAddress(const Address &address);
+  void setMergedAddress(DeviceID mergedID, const Address &address);
+  bool toRadioID(size_t radioIndex, DeviceID mergedID, DeviceID &id) const;
+  EncounterEvent doneWithDevice(DeviceID mergedID);
+
   static void encounterDefault(const EncounterEvent &event);
 };
 
 inline void EbNController::setAdvertisedSet(const LinkValueList &advertisedSet)
 {
-  radio_->setAdvertisedSet(advertisedSet);
+  for(auto it = radios_.begin(); it != radios_.end(); it++)
+  {
+    (*it)->setAdvertisedSet(advertisedSet);
+  }
 }
 
 inline void EbNController::setListenSet(const LinkValueList &listenSet)
 {
-  radio_->setListenSet(listenSet);
+  for(auto it = radios_.begin(); it != radios_.end(); it++)
+  {
+    (*it)->setListenSet(listenSet);
+  }
 }
 
 inline void EbNController::stop()
@@ -4,12 +4,14 @@
 #include <algorithm>
 #include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 
 #include "Address.h"
 #include "BloomFilter.h"
+#include "Clock.h"
 #include "EbNEvents.h"
 #include "LinkValue.h"
 #include "SharedArray.h"
@@ -27,9 +29,19 @@ protected:
   std::mutex sharedSecretsMutex_;
   std::list<RSSIEvent> rssiToReport_;
   uint64_t lastReportTime_;
+  std::shared_ptr<Clock> clock_;
   bool confirmed_;
   bool shakenHands_;
   bool reported_;
+  uint64_t discoveredTime_;
+  uint32_t numAdverts_;
+  RecognitionLatency latency_;
+
+public:
+  // Chance of a non-shared entry remaining in the matching set, below which
+  // the matching set is considered to have converged (same as the default
+  // passive confirmation threshold)
+  static constexpr float MATCHING_CONVERGED_PFALSE = 0.05;
 
 public:
   EbNDevice(DeviceID id, const Address &address, const LinkValueList &listenSet);
@@ -56,8 +68,17 @@ public:
 
   void addRSSIMeasurement(uint64_t time, uint8_t rssi);
 
+  // Called by the radios for each advert received from the device, and once
+  // they have its DH public value for the current epoch
+  void addAdvert();
+  void setDHDecoded();
+  const RecognitionLatency& getLatency() const;
+
   bool getEncounterInfo(EncounterEvent &dest, bool expired = false);
   bool getEncounterInfo(EncounterEvent &dest, uint64_t rssiReportingInterval, bool expired = false);
+
+protected:
+  void reachStage(RecognitionLatency::Stage stage);
 };
 
 inline DeviceID EbNDevice::getID() const
@@ -111,4 +132,19 @@ inline void EbNDevice::addRSSIMeasurement(uint64_t time, uint8_t rssi)
   rssiToReport_.push_back(RSSIEvent(time, rssi));
 }
 
+inline void EbNDevice::addAdvert()
+{
+  numAdverts_++;
+}
+
+inline void EbNDevice::setDHDecoded()
+{
+  reachStage(RecognitionLatency::DHDecoded);
+}
+
+inline const RecognitionLatency& EbNDevice::getLatency() const
+{
+  return latency_;
+}
+
 #endif // EBNDEVICE_H
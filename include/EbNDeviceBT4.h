@@ -2,10 +2,12 @@
 #define EBNDEVICEBT4_H
 
 #include <cstdint>
-#include <list>
+#include <utility>
+#include <vector>
 
 #include "EbNDevice.h"
 #include "ECDH.h"
+#include "InlineArray.h"
 #include "SegmentedBloomFilter.h"
 #include "RSErasureDecoder.h"
 
@@ -16,14 +18,24 @@ class EbNDeviceBT4 : public EbNDevice
   friend EbNRadioBT4;
 
 private:
-  typedef std::list<std::pair<size_t, SegmentedBloomFilter> > BloomList;
+  // Bounds on the per-device epoch state. At most the current and previous
+  // epochs are kept once processed (plus a new one while processing an
+  // advert), and one DH exchange is added per local epoch change until
+  // decoding. Exceeding either evicts the oldest entry (see EbNRadioBT4).
+  static const size_t MAX_EPOCHS = 3;
+  static const size_t MAX_DH_EXCHANGES = 3;
+
+  // Bloom filters are much larger than the rest of an epoch, and how many are
+  // kept depends on the radio's K, so they are held on the heap (reserved up
+  // to the radio's limit) rather than inline
+  typedef std::vector<std::pair<size_t, SegmentedBloomFilter> > BloomList;
 
   struct Epoch
   {
     uint32_t lastAdvertNum;
     uint64_t lastAdvertTime;
     RSErasureDecoder dhDecoder;
-    std::list<ECDH> dhExchanges;
+    InlineArray<ECDH, MAX_DH_EXCHANGES> dhExchanges;
     bool dhExchangeYCoord;
     BloomList blooms;
     uint32_t decodeBloomNum;
@@ -32,7 +44,7 @@ private:
   };
 
 private:
-  std::list<Epoch> epochs_;
+  InlineArray<Epoch, MAX_EPOCHS> epochs_;
 
 public:
   EbNDeviceBT4(DeviceID id, const Address &address, const LinkValueList &listenSet);
@@ -0,0 +1,38 @@
+#ifndef EBNDEVICEBT5_H
+#define EBNDEVICEBT5_H
+
+#include <cstdint>
+#include <list>
+#include <vector>
+
+#include "BloomFilter.h"
+#include "EbNDevice.h"
+#include "ECDH.h"
+
+class EbNRadioBT5;
+
+class EbNDeviceBT5 : public EbNDevice
+{
+  friend EbNRadioBT5;
+
+private:
+  // The whole public key arrives with every advert, so unlike BT4 there is
+  // nothing to decode, and only the current epoch needs to be kept
+  struct Epoch
+  {
+    uint32_t lastAdvertNum;
+    uint64_t lastAdvertTime;
+    std::vector<uint8_t> dhRemotePublic;
+    bool dhRemoteYCoord;
+
+    Epoch(uint32_t advertNum, uint64_t advertTime, size_t keySize, bool dhRemoteYCoord);
+  };
+
+private:
+  std::list<Epoch> epochs_;
+
+public:
+  EbNDeviceBT5(DeviceID id, const Address &address, const LinkValueList &listenSet);
+};
+
+#endif // EBNDEVICEBT5_H
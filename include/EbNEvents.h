@@ -45,6 +45,39 @@ struct RSSIEvent
   }
 };
 
+// How long it took to reach each stage of recognizing a device, measured from
+// when it was first discovered, in both time and adverts received
+struct RecognitionLatency
+{
+  enum Stage
+  {
+    DHDecoded = 0,
+    SecretComputed = 1,
+    MatchingConverged = 2,
+    Confirmed = 3,
+    NUM_STAGES
+  };
+
+  struct Milestone
+  {
+    bool reached;
+    uint64_t time; // ms since discovery
+    uint32_t numAdverts;
+  };
+
+  Milestone milestones[NUM_STAGES];
+
+  RecognitionLatency()
+  {
+    for(int s = 0; s < NUM_STAGES; s++)
+    {
+      milestones[s].reached = false;
+      milestones[s].time = 0;
+      milestones[s].numAdverts = 0;
+    }
+  }
+};
+
 struct EncounterEvent
 {
   enum Type
@@ -64,6 +97,7 @@ struct EncounterEvent
   std::list<SharedSecret> sharedSecrets;
   bool matchingSetUpdated;
   bool sharedSecretsUpdated;
+  RecognitionLatency latency; // Only set for Ended events
 
   EncounterEvent(uint64_t time)
      : time(time),
@@ -2,9 +2,11 @@
 #define EBNHYSTPOLICY_H
 
 #include <list>
+#include <memory>
 #include <set>
 #include <unordered_map>
 
+#include "Clock.h"
 #include "EbNDevice.h"
 #include "EbNEvents.h"
 
@@ -68,6 +70,7 @@ private:
   size_t startSeen_;
   uint64_t endTime_;
   int8_t rssiThreshold_;
+  std::shared_ptr<Clock> clock_;
 
   DeviceInfoMap deviceInfo_;
 
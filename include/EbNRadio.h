@@ -9,6 +9,7 @@
 #include <set>
 #include <unordered_map>
 
+#include "Clock.h"
 #include "EbNDevice.h"
 #include "Timing.h"
 
@@ -29,6 +30,8 @@ public:
       Bluetooth2PSI,
       Bluetooth4,
       Bluetooth4AR,
+      Bluetooth4RL,
+      Bluetooth5,
       END
     };
   };
@@ -92,6 +95,7 @@ protected:
   typedef std::priority_queue<SharedSecret, std::vector<SharedSecret>, SharedSecret::Compare> SharedSecretQueue;
 
 protected:
+  std::shared_ptr<Clock> clock_;
   DeviceID nextDeviceID_;
   size_t keySize_;
   ConfirmScheme confirmScheme_;
@@ -119,8 +123,27 @@ public:
   virtual void changeEpoch() = 0;
   virtual std::set<DeviceID> handshake(const std::set<DeviceID> &ids) = 0;
   virtual EncounterEvent doneWithDevice(DeviceID id) = 0;
+  // Restores the adapter after an action failed with a BluetoothHCIException,
+  // keeping all device state
+  virtual void recover() = 0;
+  // Nominal time between discoveries (in ms)
+  virtual uint64_t getDiscoverInterval() const = 0;
+
+  // Puts the radio on the air for other radios to discover, without starting
+  // any of its own threads, and later moves it on to the next advert as a
+  // discovery would. Used to act as one of many synthetic peers (see
+  // CrowdGenerator), where not all radio versions support it.
+  virtual void initializePeer();
+  virtual void changePeerAdvert();
+
+  // Pushes back the next discovery, used to stagger discovery across radios
+  // on different adapters
+  void delayDiscover(uint64_t delay);
+
+  static uint64_t getEpochInterval();
 
   bool getDeviceEvent(EncounterEvent &event, DeviceID id, uint64_t rssiReportInterval);
+  bool getDeviceAddress(DeviceID id, Address &address) const;
 
 protected:
   DeviceID generateDeviceID();
@@ -133,6 +156,16 @@ protected:
   void removeRecentDevice(DeviceID id);
 };
 
+inline void EbNRadio::delayDiscover(uint64_t delay)
+{
+  nextDiscover_ += delay;
+}
+
+inline uint64_t EbNRadio::getEpochInterval()
+{
+  return EPOCH_INTERVAL;
+}
+
 inline DeviceID EbNRadio::generateDeviceID()
 {
   return nextDeviceID_++;
@@ -43,10 +43,19 @@ public:
   void changeEpoch();
   std::set<DeviceID> handshake(const std::set<DeviceID> &deviceIDs);
   EncounterEvent doneWithDevice(DeviceID id);
+  void recover();
+  uint64_t getDiscoverInterval() const;
+  void initializePeer();
+  void changePeerAdvert();
 
   BitMap generateAdvert(size_t advertNum);
   bool processAdvert(EbNDeviceBT2 *device, uint64_t time, const uint8_t *data, bool computeSecret = true);
   void processEpochs(EbNDeviceBT2 *device);
+  // Number of distinct adverts sent over an epoch
+  size_t getNumAdverts() const;
+  // Address that remote devices currently see us at, which carries the Y
+  // coordinate bit of our DH public value
+  Address getLocalAddress();
 
 private:
   void changeAdvert();
@@ -55,5 +64,15 @@ private:
   void listen();
 };
 
+inline size_t EbNRadioBT2::getNumAdverts() const
+{
+  return ADV_N;
+}
+
+inline Address EbNRadioBT2::getLocalAddress()
+{
+  return hci_.getPublicAddress();
+}
+
 #endif  // EBNRADIOBT2_H
 
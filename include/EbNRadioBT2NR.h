@@ -22,6 +22,11 @@ private:
   static const uint32_t DISC_PERIODS = 8;
   static const uint32_t NAME_DECODED_SIZE = 1723;
 
+  // Remote name requests are pipelined, up to the number of devices the
+  // controller will page at once (fewer if it refuses any)
+  static const size_t MAX_NAME_REQUESTS = 4;
+  static const int64_t NAME_REQUEST_TIMEOUT = 2500; // ms
+
 private:
   const uint32_t BF_M;
   const uint32_t BF_K;
@@ -40,6 +45,13 @@ public:
   void changeEpoch();
   std::set<DeviceID> handshake(const std::set<DeviceID> &deviceIDs);
   EncounterEvent doneWithDevice(DeviceID id);
+  void recover();
+  uint64_t getDiscoverInterval() const;
+  void initializePeer();
+  void changePeerAdvert();
+
+  BitMap generateAdvert();
+  bool processAdvert(EbNDeviceBT2 *device, const uint8_t *data);
 
 private:
   void changeAdvert();
@@ -2,6 +2,8 @@
 #define EBNRADIOBT2PSI_H
 
 #include <list>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <unordered_set>
 
@@ -13,6 +15,7 @@
 
 #include "BluetoothHCI.h"
 #include "CompileMath.h"
+#include "ConnectionAcceptor.h"
 #include "EbNDeviceBT2.h"
 #include "EbNDeviceMap.h"
 #include "EbNRadio.h"
@@ -30,6 +33,15 @@ private:
   static const uint32_t ADV_N = (EPOCH_INTERVAL + (DISC_INTERVAL - 1)) / DISC_INTERVAL;
   static const uint32_t ADV_N_LOG2 = CLog<ADV_N>::value;
 
+  // Incoming handshakes are served concurrently by the listen thread, with
+  // the PSI computations run on a worker. The JL10 code shares a memory pool
+  // across instances, so they are kept to a single worker.
+  static const size_t LISTEN_WORKERS = 1;
+  static const int64_t LISTEN_EXCHANGE_TIMEOUT = 30000; // ms
+
+private:
+  class ListenSession;
+
 private:
   const uint32_t BF_M;
   const uint32_t BF_K;
@@ -56,11 +68,14 @@ public:
   void changeEpoch();
   std::set<DeviceID> handshake(const std::set<DeviceID> &deviceIDs);
   EncounterEvent doneWithDevice(DeviceID id);
+  void recover();
+  uint64_t getDiscoverInterval() const;
 
 private:
   void processEIRResponse(std::list<DiscoverEvent> *discovered, const EIRInquiryResponse *response);
 
   void listen();
+  std::unique_ptr<ConnectionAcceptor::Session> createListenSession(const Address &address);
 
   void constructPSIMessage(std::vector<uint8_t> &message, std::vector<string> input);
   std::vector<string> parsePSIMessage(const std::vector<uint8_t> &message);
@@ -1,25 +1,37 @@
 #ifndef EBNRADIOBT4_H
 #define EBNRADIOBT4_H
 
+#include <atomic>
+#include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "BluetoothHCI.h"
 #include "CompileMath.h"
+#include "ConnectionAcceptor.h"
+#include "ConnectionManager.h"
 #include "EbNDeviceBT4.h"
 #include "EbNDeviceMap.h"
 #include "EbNRadio.h"
 #include "ECDH.h"
 #include "Logger.h"
 #include "RSErasureEncoder.h"
+#include "SPSCRing.h"
 
 class EbNRadioBT4 : public EbNRadio
 {
 public:
   static ConfirmScheme getDefaultConfirmScheme();
 
+  // Number of inverted decoding matrices shared across all devices' decoders,
+  // for the backends that decode by inverting a matrix (not GF8 or Rateless,
+  // which eliminate as symbols arrive)
+  static const size_t RS_DECODING_CACHE_SIZE = 64;
+
 private:
   static const uint16_t ADVERT_MIN_INTERVAL = 650; // ms
   static const uint16_t ADVERT_MAX_INTERVAL = 700; // ms
@@ -34,17 +46,93 @@ private:
   static const size_t ACTIVE_BF_K = 3;
   static const bool ACTIVE_BF_ENABLED = true;
 
+  // Coding backend for the DH public value, which must match across devices.
+  // The rateless advert format instead uses RSMatrix::Backend::Rateless
+  static const RSMatrix::Backend RS_BACKEND = RSMatrix::Backend::GF8;
+
+  // Advertising reports are copied into a ring by the scanning thread, and
+  // processed by a separate thread (see discover())
+  static const size_t SCAN_REPORT_RING_SIZE = 256;
+  // Upper bound on the number of processing threads, each of which owns the
+  // devices in its shard
+  static const size_t MAX_PROCESS_SHARDS = 8;
+
+  // Active handshakes are run concurrently, where most LE controllers can
+  // hold a handful of connections at once (but create them one at a time)
+  static const size_t MAX_HANDSHAKE_CONNECTIONS = 4;
+  static const int64_t HANDSHAKE_CONNECT_TIMEOUT = 2000; // ms
+  static const int64_t HANDSHAKE_EXCHANGE_TIMEOUT = 1000; // ms
+
+  // Incoming handshakes are served concurrently by the listen thread, with the
+  // handshake messages generated on a worker, and the received messages handed
+  // to the controller's thread through a ring (see handshake())
+  static const size_t LISTEN_WORKERS = 1;
+  static const size_t LISTEN_RESULT_RING_SIZE = 64;
+  static const int64_t LISTEN_EXCHANGE_TIMEOUT = 1000; // ms
+
+private:
+  struct ScanReport
+  {
+    uint64_t time;
+    uint8_t address[6];
+    uint8_t data[31];
+    uint8_t length;
+    int8_t rssi;
+  };
+
+  // Devices are partitioned across shards by address, where each shard's
+  // device map and results are only touched by its own processing thread
+  // while scanning, and by the controller's thread otherwise
+  struct ProcessShard
+  {
+    EbNDeviceMap<EbNDeviceBT4> deviceMap;
+    SPSCRing<ScanReport, SCAN_REPORT_RING_SIZE> reports;
+    size_t numReports;
+    std::atomic<size_t> numReportsProcessed;
+    std::list<DiscoverEvent> discovered;
+    std::vector<std::pair<uint64_t, EbNDeviceBT4 *> > recentDevices;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::condition_variable drainedCond;
+    std::atomic<bool> isWaiting;
+    bool isStopping;
+
+    ProcessShard();
+  };
+
+  struct ListenResult
+  {
+    Address address;
+    std::vector<uint8_t> message;
+  };
+
+  class ListenSession;
+
+  typedef std::unordered_map<Address, size_t, Address::Hash, Address::Equal> AddressToShardMap;
+
 private:
+  // Version bit and the advert number, with a format bit in between for the
+  // rateless format only, so that the RS format is unchanged
+  const size_t ADV_HEADER_BITS;
   const size_t RS_W;
   const size_t RS_K;
   const size_t RS_M;
   const size_t BF_SM;
   const size_t BF_K;
   const size_t BF_B;
+  // Bloom filters kept per epoch, being one per advert until decoding (K, or
+  // K+1 when a rateless symbol turns out to be dependent) plus the latest one
+  const size_t BF_MAX_KEPT;
+  const bool DH_RATELESS;
 
   BluetoothHCI hci_;
-  EbNDeviceMap<EbNDeviceBT4> deviceMap_;
+  // Declared before the shards, since each device's decoders reference it
   RSMatrix dhCodeMatrix_;
+  // Only set up by initialize(), so that synthetic peers, which never scan or
+  // handshake, stay light
+  std::vector<std::unique_ptr<ProcessShard> > shards_;
+  AddressToShardMap shardRoutes_;
   RSErasureEncoder dhEncoder_;
   std::vector<uint8_t> dhPrevSymbols_;
   ECDH dhExchange_;
@@ -53,11 +141,12 @@ private:
   SegmentedBloomFilter advertBloom_;
   size_t advertBloomNum_;
   std::thread listenThread_;
-  std::list<std::pair<Address, std::vector<uint8_t> > > listenAdverts_;
-  std::mutex listenAdvertsMutex_;
+  SPSCRing<ListenResult, LISTEN_RESULT_RING_SIZE> listenResults_;
+  std::unique_ptr<ConnectionManager> handshakeConnections_;
 
 public:
-  EbNRadioBT4(size_t keySize, ConfirmScheme confirmScheme, MemoryScheme memoryScheme, int adapterID);
+  EbNRadioBT4(size_t keySize, ConfirmScheme confirmScheme, MemoryScheme memoryScheme, int adapterID, bool dhRateless = false);
+  ~EbNRadioBT4();
 
   // EbNRadio interface
   void initialize();
@@ -65,25 +154,68 @@ public:
   void changeEpoch();
   std::set<DeviceID> handshake(const std::set<DeviceID> &deviceIDs);
   EncounterEvent doneWithDevice(DeviceID id);
+  void recover();
+  uint64_t getDiscoverInterval() const;
+  void initializePeer();
+  void changePeerAdvert();
 
   BitMap generateAdvert(size_t advertNum);
   bool processAdvert(EbNDeviceBT4 *device, uint64_t time, const uint8_t *data);
   void processEpochs(EbNDeviceBT4 *device);
+  // Number of distinct adverts in an epoch, which for the rateless format is
+  // every advert number that fits, in case the epoch runs long
+  size_t getNumAdverts() const;
+  // Address that remote devices currently see us at, which carries the Y
+  // coordinate bit of our DH public value
+  Address getLocalAddress();
+
+  // Number of distinct adverts sent at each scan
+  size_t getNumScanAdverts() const;
+
+  const RSMatrix& getDHCodeMatrix() const;
 
 private:
   BluetoothHCI::UndirectedAdvert getAdvertType(bool canAllowConnections = true);
 
   void changeAdvert();
-  void processScanResponse(std::list<DiscoverEvent> *discovered, const ScanResponse *resp);
+  void processScanResponse(ProcessShard *shard, uint64_t scanTime, const ScanResponse *resp);
+
+  ProcessShard& routeToShard(const Address &address);
+  EbNDeviceBT4* getDevice(DeviceID id);
+
+  void pushScanReport(const ScanResponse *resp);
+  void waitScanReports(ProcessShard *shard);
+  void processScanReports(ProcessShard *shard);
 
   std::vector<uint8_t> generateActiveHandshake(const ECDH &dhExchange);
   void processActiveHandshake(const std::vector<uint8_t> &message, EbNDeviceBT4 *device);
 
   void listen();
+  std::unique_ptr<ConnectionAcceptor::Session> createListenSession(const Address &address);
 
 private:
   static size_t computeRSSymbolSize(size_t keySize, size_t advertBits);
 };
 
+inline const RSMatrix& EbNRadioBT4::getDHCodeMatrix() const
+{
+  return dhCodeMatrix_;
+}
+
+inline size_t EbNRadioBT4::getNumAdverts() const
+{
+  return RS_K + RS_M;
+}
+
+inline size_t EbNRadioBT4::getNumScanAdverts() const
+{
+  return SCAN_ACTIVE ? 2 : 1;
+}
+
+inline Address EbNRadioBT4::getLocalAddress()
+{
+  return hci_.getRandomAddress();
+}
+
 #endif // EBNRADIOBT4_H
 
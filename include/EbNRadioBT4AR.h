@@ -29,12 +29,21 @@ private:
 public:
   EbNRadioBT4AR(size_t keySize, ConfirmScheme confirmScheme, MemoryScheme memoryScheme, int adapterID);
 
+  // The identity resolving key is taken from the first advertised entry, so
+  // that anyone listening for that entry can resolve our addresses
+  void setAdvertisedSet(const LinkValueList &advertisedSet);
+
   // EbNRadio interface
   void initialize();
   std::list<DiscoverEvent> discover();
   void changeEpoch();
   std::set<DeviceID> handshake(const std::set<DeviceID> &deviceIDs);
   EncounterEvent doneWithDevice(DeviceID id);
+  void recover();
+  uint64_t getDiscoverInterval() const;
+
+  // Generates a new resolvable private address from our key
+  Address generateAddress() const;
 
 private:
   void processScanResponse(std::list<DiscoverEvent> *discovered, const ScanResponse *resp);
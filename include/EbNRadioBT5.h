@@ -0,0 +1,82 @@
+#ifndef EBNRADIOBT5_H
+#define EBNRADIOBT5_H
+
+#include <list>
+#include <unordered_set>
+
+#include "BluetoothHCI.h"
+#include "CompileMath.h"
+#include "EbNDeviceBT5.h"
+#include "EbNDeviceMap.h"
+#include "EbNRadio.h"
+#include "ECDH.h"
+#include "Logger.h"
+
+// Uses LE extended advertising (Bluetooth 5.0), where each advert holds up to
+// 251 bytes rather than 31. That is enough for the whole compressed public key
+// alongside a Bloom filter about as large as BT2's, so a device can compute
+// the shared secret from the first advert it receives (with no erasure coding
+// across adverts as in BT4), and confirm it passively from the next one.
+class EbNRadioBT5 : public EbNRadio
+{
+public:
+  static ConfirmScheme getDefaultConfirmScheme();
+
+private:
+  static const uint16_t ADVERT_MIN_INTERVAL = 650; // ms
+  static const uint16_t ADVERT_MAX_INTERVAL = 700; // ms
+  static const uint16_t SCAN_INTERVAL = 13500; // ms
+  static const uint16_t SCAN_WINDOW = 1500; // ms
+
+  static const size_t ADV_N = (EPOCH_INTERVAL + (SCAN_INTERVAL - 1)) / SCAN_INTERVAL;
+  static const size_t ADV_N_LOG2 = CLog<ADV_N>::value;
+  // Length and type bytes, followed by the manufacturer specific payload
+  static const size_t ADV_SIZE = LE_EXTENDED_ADVERTISING_DATA_MAX;
+
+private:
+  const uint32_t BF_M;
+  const uint32_t BF_K;
+
+  BluetoothHCI hci_;
+  EbNDeviceMap<EbNDeviceBT5> deviceMap_;
+  ECDH dhExchange_;
+  Address address_;
+  uint32_t advertNum_;
+
+public:
+  EbNRadioBT5(size_t keySize, ConfirmScheme confirmScheme, MemoryScheme memoryScheme, int adapterID);
+
+  // EbNRadio interface
+  void initialize();
+  std::list<DiscoverEvent> discover();
+  void changeEpoch();
+  std::set<DeviceID> handshake(const std::set<DeviceID> &deviceIDs);
+  EncounterEvent doneWithDevice(DeviceID id);
+  void recover();
+  uint64_t getDiscoverInterval() const;
+
+  BitMap generateAdvert(size_t advertNum);
+  bool processAdvert(EbNDeviceBT5 *device, uint64_t time, const uint8_t *data, bool computeSecret = true);
+  void processEpochs(EbNDeviceBT5 *device);
+  // Number of distinct adverts sent over an epoch
+  size_t getNumAdverts() const;
+  // Address that remote devices currently see us at, which carries the Y
+  // coordinate bit of our DH public value
+  Address getLocalAddress();
+
+private:
+  void changeAdvert();
+  void processScanResponse(std::list<DiscoverEvent> *discovered, std::unordered_set<DeviceID> *scanned, const ScanResponse *response);
+};
+
+inline size_t EbNRadioBT5::getNumAdverts() const
+{
+  return ADV_N;
+}
+
+inline Address EbNRadioBT5::getLocalAddress()
+{
+  return address_;
+}
+
+#endif  // EBNRADIOBT5_H
@@ -0,0 +1,61 @@
+#ifndef GF256_H
+#define GF256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Arithmetic over GF(2^8), using the same primitive polynomial as jerasure
+// (0x11D) so that coding matrices generated by jerasure for w = 8 can be used
+// directly. Region operations use split 4-bit product tables, so that a full
+// 16-byte (SSSE3) or 8-byte (NEON) vector can be multiplied with a pair of
+// table lookup instructions.
+class GF256
+{
+public:
+  static const uint16_t POLYNOMIAL = 0x11D;
+
+private:
+  uint8_t log_[256];
+  uint8_t exp_[512];
+  uint8_t splitLow_[256][16];
+  uint8_t splitHigh_[256][16];
+
+public:
+  GF256();
+
+  uint8_t multiply(uint8_t a, uint8_t b) const;
+  uint8_t divide(uint8_t a, uint8_t b) const;
+  uint8_t inverse(uint8_t a) const;
+
+  // dest = value * source
+  void multiplyRegion(uint8_t *dest, const uint8_t *source, uint8_t value, size_t length) const;
+  // dest ^= value * source
+  void multiplyAddRegion(uint8_t *dest, const uint8_t *source, uint8_t value, size_t length) const;
+  // dest ^= source
+  void addRegion(uint8_t *dest, const uint8_t *source, size_t length) const;
+
+  static const char* getImplementation();
+};
+
+inline const GF256& GGF256()
+{
+  static GF256 instance;
+  return instance;
+}
+
+inline uint8_t GF256::multiply(uint8_t a, uint8_t b) const
+{
+  return ((a == 0) || (b == 0)) ? 0 : exp_[log_[a] + log_[b]];
+}
+
+inline uint8_t GF256::divide(uint8_t a, uint8_t b) const
+{
+  return (a == 0) ? 0 : exp_[log_[a] + 255 - log_[b]];
+}
+
+inline uint8_t GF256::inverse(uint8_t a) const
+{
+  return exp_[255 - log_[a]];
+}
+
+#endif // GF256_H
@@ -0,0 +1,78 @@
+#ifndef GF256ELIMINATOR_H
+#define GF256ELIMINATOR_H
+
+#include <cstdint>
+
+// Incremental Gaussian elimination over GF(2^8) for recovering K symbols of W
+// bytes from linear combinations of them. Each added combination costs one
+// forward elimination step, keeping the rows in echelon form (row c, if
+// present, has its leading coefficient of 1 in column c), so that only
+// back-substitution remains once K independent combinations have arrived.
+// The eliminator does not own its storage, so that a decoder can keep it in
+// the same buffer as its other state (see getStorageSize()). Checking whether
+// a combination is useful keeps its reduction, so that adding it straight
+// after only has to apply the same steps to its payload.
+class GF256Eliminator
+{
+private:
+  size_t K_;
+  size_t W_;
+  uint8_t *rows_;
+  uint8_t *payloads_;
+  uint8_t *row_;
+  uint8_t *payload_;
+  uint8_t *factors_;
+  size_t rank_;
+
+  // Last combination reduced into row_ by isUseful(), while still valid
+  const uint8_t *reducedCoefficients_;
+  size_t reducedRank_;
+  size_t reducedPivot_;
+
+public:
+  static size_t getStorageSize(size_t K, size_t W);
+
+public:
+  GF256Eliminator();
+  GF256Eliminator(size_t K, size_t W, uint8_t *storage);
+
+  size_t K() const;
+  size_t W() const;
+  size_t getRank() const;
+  bool isComplete() const;
+
+  // Returns true if the combination was linearly independent of those added
+  // so far (and thus increased the rank)
+  bool add(const uint8_t *coefficients, const uint8_t *payload);
+  bool isUseful(const uint8_t *coefficients);
+  bool solve(uint8_t *data);
+
+  void reset();
+
+private:
+  // Reduces row_, recording the multiple of each row taken away in factors_,
+  // and returns its pivot (or K if it became all zeros)
+  size_t reduce();
+};
+
+inline size_t GF256Eliminator::K() const
+{
+  return K_;
+}
+
+inline size_t GF256Eliminator::W() const
+{
+  return W_;
+}
+
+inline size_t GF256Eliminator::getRank() const
+{
+  return rank_;
+}
+
+inline bool GF256Eliminator::isComplete() const
+{
+  return (rank_ == K_);
+}
+
+#endif // GF256ELIMINATOR_H
@@ -0,0 +1,89 @@
+#ifndef HCIBACKEND_H
+#define HCIBACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "bluetooth/bluetooth.h"
+#include "bluetooth/hci.h"
+
+#include "Address.h"
+
+struct hci_request;
+
+// Everything that BluetoothHCI (and its reactor) needs from a controller, so
+// that radios can run either on a real adapter through the kernel's Bluetooth
+// sockets (KernelHCIBackend), or on a simulated one (VirtualHCIBackend). Each
+// call mirrors the kernel or libbluetooth function that it stands in for,
+// returning -1 with errno set on failure.
+class HCIBackend
+{
+public:
+  struct Transport_
+  {
+    enum Type
+    {
+      RFCOMM,
+      LE
+    };
+  };
+  typedef Transport_::Type Transport;
+
+  typedef std::function<std::shared_ptr<HCIBackend>(int adapterID)> Factory;
+
+private:
+  static Factory factory_;
+
+public:
+  // Creates the backend for an adapter, which is a KernelHCIBackend unless a
+  // different factory has been set (e.g. to simulate many devices at once)
+  static std::shared_ptr<HCIBackend> create(int adapterID);
+  static void setFactory(Factory factory);
+
+  virtual ~HCIBackend();
+
+  virtual int getAdapterID() const = 0;
+
+  // Opens (or reopens) the channel that commands are sent on
+  virtual int open() = 0;
+  virtual void close() = 0;
+  // Resets the controller, as the HCIDEVRESET ioctl
+  virtual int reset() = 0;
+  // Takes the adapter down and brings it back up, first writing the public
+  // address that it should come up with (if given)
+  virtual void restart(const Address *publicAddress) = 0;
+  virtual int readDeviceInfo(struct hci_dev_info *info) = 0;
+  // As the HCISETSCAN ioctl, taking SCAN_PAGE and/or SCAN_INQUIRY
+  virtual int setScanEnable(uint8_t scanEnable) = 0;
+
+  // Sends a command without waiting on it, where its completion (or status)
+  // arrives later as an event
+  virtual int sendCommand(uint16_t opcode, const void *params, uint8_t length) = 0;
+  // Sends a command and waits for the reply, as hci_send_req()
+  virtual int sendRequest(struct hci_request *request, int timeout) = 0;
+  // Runs a standard inquiry to completion, as hci_inquiry()
+  virtual int inquiry(int periods, std::vector<inquiry_info> &responses) = 0;
+
+  // Events are read separately from commands, passing only those in the
+  // filter. Reads wait up to 'timeout' ms, and then read every event that is
+  // ready (up to 'maxEvents') into consecutive HCI_MAX_EVENT_SIZE slots of the
+  // buffer, where each begins with the HCI packet type.
+  virtual void openEvents(const struct hci_filter &filter) = 0;
+  virtual void closeEvents() = 0;
+  virtual size_t readEvents(int64_t timeout, uint8_t *buffer, size_t *lengths, size_t maxEvents) = 0;
+  // Discards any events that have already arrived, returning how many
+  virtual size_t flushEvents() = 0;
+
+  // Connections are non-blocking sockets, which callers may poll or add to an
+  // epoll set. Starting a connection returns -1 on failure, with errno set to
+  // EBUSY if it should be retried later.
+  virtual int startConnect(Transport transport, const Address &address, uint8_t port) = 0;
+  virtual int listen(Transport transport, uint8_t port) = 0;
+  virtual std::pair<int, Address> accept(Transport transport, int sockListen) = 0;
+};
+
+#endif // HCIBACKEND_H
@@ -0,0 +1,126 @@
+#ifndef HCICAPTURE_H
+#define HCICAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Clock.h"
+
+// Compact binary capture of the discovery events an adapter receives (LE
+// advertising reports, legacy and extended, and extended inquiry results),
+// grouped into sessions by the scan or inquiry that they were received in.
+// The file begins with an 8 byte magic and the wall-clock start time (ms,
+// little endian), followed by the records, each of which is:
+//  - a record type (an event, or the start of a session of some type)
+//  - the time since the previous record (us), as an unsigned LEB128 varint
+//  - for an event, the event code, parameter length and parameters (that is,
+//    the HCI event packet without its leading packet type)
+class HCICapture
+{
+public:
+  static const char MAGIC[8];
+
+  struct Session_
+  {
+    enum Type
+    {
+      Scan,
+      ExtendedScan,
+      Inquiry,
+      END
+    };
+  };
+  typedef Session_::Type Session;
+  static const char *sessionStrings[];
+
+  struct Record
+  {
+    bool isSession;
+    Session session;
+    uint64_t time; // us since the start of the capture
+    // HCI event packet, beginning with the packet type (for events only)
+    std::vector<uint8_t> packet;
+  };
+
+  // Whether an HCI event packet (beginning with the packet type) is one that
+  // is captured
+  static bool isCaptured(const uint8_t *packet, size_t length);
+};
+
+class HCICaptureWriter
+{
+private:
+  FILE *file_;
+  std::shared_ptr<Clock> clock_;
+  uint64_t lastTime_; // us
+  size_t numEvents_;
+  std::mutex mutex_;
+
+public:
+  explicit HCICaptureWriter(const std::string &path);
+  ~HCICaptureWriter();
+
+  HCICaptureWriter(const HCICaptureWriter &) = delete;
+  HCICaptureWriter& operator = (const HCICaptureWriter &) = delete;
+
+  bool isOpen() const;
+  size_t getNumEvents() const;
+
+  // Marks the start of a scan or inquiry, flushing what was captured in the
+  // previous one to the file
+  void beginSession(HCICapture::Session session);
+  // Records the event if it is one that is captured
+  void addEvent(const uint8_t *packet, size_t length);
+
+private:
+  void writeHeader(uint8_t type);
+};
+
+class HCICaptureReader
+{
+private:
+  FILE *file_;
+  uint64_t startTime_; // ms
+  uint64_t time_;      // us
+
+public:
+  explicit HCICaptureReader(const std::string &path);
+  ~HCICaptureReader();
+
+  HCICaptureReader(const HCICaptureReader &) = delete;
+  HCICaptureReader& operator = (const HCICaptureReader &) = delete;
+
+  bool isOpen() const;
+  uint64_t getStartTime() const;
+
+  // Reads the next record, returning false at the end of the capture (or on
+  // a truncated record)
+  bool next(HCICapture::Record &record);
+};
+
+inline bool HCICaptureWriter::isOpen() const
+{
+  return file_ != NULL;
+}
+
+inline size_t HCICaptureWriter::getNumEvents() const
+{
+  return numEvents_;
+}
+
+inline bool HCICaptureReader::isOpen() const
+{
+  return file_ != NULL;
+}
+
+inline uint64_t HCICaptureReader::getStartTime() const
+{
+  return startTime_;
+}
+
+#endif // HCICAPTURE_H
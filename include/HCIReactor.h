@@ -0,0 +1,66 @@
+#ifndef HCIREACTOR_H
+#define HCIREACTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bluetooth/bluetooth.h"
+#include "bluetooth/hci.h"
+
+#include "HCIBackend.h"
+
+// Long-lived reader for HCI events from a single adapter. Keeps the backend's
+// event channel (filtered to the events used for discovery and command
+// completion) open for the lifetime of the adapter, rather than opening and
+// filtering a new one for every scan or inquiry. Events that are ready
+// together are read in a single batch into a preallocated buffer, and then
+// passed to the handler in order.
+class HCIReactor
+{
+public:
+  static const size_t MAX_BATCH = 16;
+
+private:
+  HCIBackend &backend_;
+  std::vector<uint8_t> buffer_;
+  size_t lengths_[MAX_BATCH];
+
+public:
+  HCIReactor(HCIBackend &backend);
+  ~HCIReactor();
+
+  HCIReactor(const HCIReactor &) = delete;
+  HCIReactor& operator = (const HCIReactor &) = delete;
+
+  // Reopens the event channel, which is needed if the adapter was disabled
+  void open();
+  void close();
+
+  // Discards any events received while nobody was waiting on them
+  void flush();
+
+  // Waits up to 'timeout' ms for events, then calls handler(packet, length)
+  // on each event in the batch, where the packet begins with the HCI packet
+  // type. Returns the number of events handled, which may be 0 before the
+  // timeout is up.
+  template<typename Handler>
+  size_t poll(int64_t timeout, Handler &&handler);
+
+private:
+  size_t readBatch(int64_t timeout);
+};
+
+template<typename Handler>
+size_t HCIReactor::poll(int64_t timeout, Handler &&handler)
+{
+  size_t numEvents = readBatch(timeout);
+  for(size_t e = 0; e < numEvents; e++)
+  {
+    handler(&buffer_[e * HCI_MAX_EVENT_SIZE], lengths_[e]);
+  }
+
+  return numEvents;
+}
+
+#endif // HCIREACTOR_H
@@ -0,0 +1,73 @@
+#ifndef HCIREPLAY_H
+#define HCIREPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "HCICapture.h"
+
+// Hands out the sessions of a capture to a VirtualHCIBackend, in place of the
+// reports it would otherwise generate from the medium, so that a radio and
+// its controller process real traffic as fast as they are able to. Sessions
+// are given out in order to scans or inquiries of the same type, skipping
+// any of other types. The real time that each session takes to process, from
+// its events being queued until the backend has delivered all of them and
+// sees its next command, is recorded.
+class HCIReplay
+{
+public:
+  struct Event
+  {
+    uint64_t offset; // ms since the start of the session
+    std::vector<uint8_t> packet;
+  };
+
+private:
+  HCICaptureReader reader_;
+  HCICapture::Record next_;
+  bool hasNext_;
+  bool isFinished_;
+  bool isInSession_;
+  uint64_t sessionStart_; // us (real time)
+  size_t numSessions_;
+  size_t numSkipped_;
+  size_t numEvents_;
+  std::vector<uint64_t> sessionTimes_; // us
+  mutable std::mutex mutex_;
+
+public:
+  explicit HCIReplay(const std::string &path);
+
+  HCIReplay(const HCIReplay &) = delete;
+  HCIReplay& operator = (const HCIReplay &) = delete;
+
+  bool isOpen() const;
+  bool isFinished() const;
+  // Wall-clock time (ms) that the capture was started
+  uint64_t getStartTime() const;
+
+  // Fills 'events' with the next session of the given type, returning false
+  // once the capture has run out
+  bool nextSession(HCICapture::Session session, std::vector<Event> &events);
+  void finishSession();
+
+  size_t getNumSessions() const;
+  size_t getNumSkipped() const;
+  size_t getNumEvents() const;
+  std::vector<uint64_t> getSessionTimes() const;
+};
+
+inline bool HCIReplay::isOpen() const
+{
+  return reader_.isOpen();
+}
+
+inline uint64_t HCIReplay::getStartTime() const
+{
+  return reader_.getStartTime();
+}
+
+#endif // HCIREPLAY_H
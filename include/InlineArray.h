@@ -0,0 +1,204 @@
+#ifndef INLINEARRAY_H
+#define INLINEARRAY_H
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Fixed-capacity array with its elements stored inline, used in place of
+// std::list for small per-device collections with a known bound, avoiding a
+// heap allocation (and node overhead) per element. Erasing shifts the later
+// elements down, so order is preserved but iterators past the erased element
+// are invalidated.
+template<typename T, size_t N>
+class InlineArray
+{
+public:
+  typedef T* iterator;
+  typedef const T* const_iterator;
+
+private:
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_[N];
+  size_t size_;
+
+public:
+  InlineArray()
+     : size_(0)
+  {
+  }
+
+  InlineArray(const InlineArray &other)
+     : size_(0)
+  {
+    for(const T &value : other)
+    {
+      push_back(value);
+    }
+  }
+
+  InlineArray(InlineArray &&other)
+     : size_(0)
+  {
+    for(T &value : other)
+    {
+      push_back(std::move(value));
+    }
+    other.clear();
+  }
+
+  ~InlineArray()
+  {
+    clear();
+  }
+
+  InlineArray& operator = (const InlineArray &other)
+  {
+    if(this != &other)
+    {
+      clear();
+      for(const T &value : other)
+      {
+        push_back(value);
+      }
+    }
+    return *this;
+  }
+
+  InlineArray& operator = (InlineArray &&other)
+  {
+    if(this != &other)
+    {
+      clear();
+      for(T &value : other)
+      {
+        push_back(std::move(value));
+      }
+      other.clear();
+    }
+    return *this;
+  }
+
+  static constexpr size_t capacity()
+  {
+    return N;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  bool empty() const
+  {
+    return (size_ == 0);
+  }
+
+  bool full() const
+  {
+    return (size_ == N);
+  }
+
+  iterator begin()
+  {
+    return data();
+  }
+
+  const_iterator begin() const
+  {
+    return data();
+  }
+
+  iterator end()
+  {
+    return data() + size_;
+  }
+
+  const_iterator end() const
+  {
+    return data() + size_;
+  }
+
+  T& operator [](size_t index)
+  {
+    return data()[index];
+  }
+
+  const T& operator [](size_t index) const
+  {
+    return data()[index];
+  }
+
+  T& front()
+  {
+    return data()[0];
+  }
+
+  const T& front() const
+  {
+    return data()[0];
+  }
+
+  T& back()
+  {
+    return data()[size_ - 1];
+  }
+
+  const T& back() const
+  {
+    return data()[size_ - 1];
+  }
+
+  void push_back(const T &value)
+  {
+    emplace_back(value);
+  }
+
+  void push_back(T &&value)
+  {
+    emplace_back(std::move(value));
+  }
+
+  template<typename... Args>
+  void emplace_back(Args&&... args)
+  {
+    assert(size_ < N);
+    new (&storage_[size_]) T(std::forward<Args>(args)...);
+    size_++;
+  }
+
+  iterator erase(iterator position)
+  {
+    for(iterator it = position; (it + 1) != end(); it++)
+    {
+      *it = std::move(*(it + 1));
+    }
+    back().~T();
+    size_--;
+
+    return position;
+  }
+
+  void clear()
+  {
+    while(size_ > 0)
+    {
+      back().~T();
+      size_--;
+    }
+  }
+
+private:
+  T* data()
+  {
+    return reinterpret_cast<T *>(&storage_[0]);
+  }
+
+  const T* data() const
+  {
+    return reinterpret_cast<const T *>(&storage_[0]);
+  }
+};
+
+#endif // INLINEARRAY_H
@@ -0,0 +1,52 @@
+#ifndef KERNELHCIBACKEND_H
+#define KERNELHCIBACKEND_H
+
+#include "HCIBackend.h"
+
+// Talks to a real adapter through the kernel's Bluetooth stack, with commands
+// sent on one raw HCI socket and events read from another (filtered) one that
+// stays registered with epoll, and connections over RFCOMM or L2CAP sockets
+class KernelHCIBackend : public HCIBackend
+{
+private:
+  int adapterID_;
+  int sock_;
+  int eventSock_;
+  int epoll_;
+
+public:
+  KernelHCIBackend(int adapterID);
+  ~KernelHCIBackend();
+
+  KernelHCIBackend(const KernelHCIBackend &) = delete;
+  KernelHCIBackend& operator = (const KernelHCIBackend &) = delete;
+
+  int getAdapterID() const;
+
+  int open();
+  void close();
+  int reset();
+  void restart(const Address *publicAddress);
+  int readDeviceInfo(struct hci_dev_info *info);
+  int setScanEnable(uint8_t scanEnable);
+
+  int sendCommand(uint16_t opcode, const void *params, uint8_t length);
+  int sendRequest(struct hci_request *request, int timeout);
+  int inquiry(int periods, std::vector<inquiry_info> &responses);
+
+  void openEvents(const struct hci_filter &filter);
+  void closeEvents();
+  size_t readEvents(int64_t timeout, uint8_t *buffer, size_t *lengths, size_t maxEvents);
+  size_t flushEvents();
+
+  int startConnect(Transport transport, const Address &address, uint8_t port);
+  int listen(Transport transport, uint8_t port);
+  std::pair<int, Address> accept(Transport transport, int sockListen);
+};
+
+inline int KernelHCIBackend::getAdapterID() const
+{
+  return adapterID_;
+}
+
+#endif // KERNELHCIBACKEND_H
@@ -1,18 +1,36 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
 #include <cstdint>
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <pthread.h>
 #include <string>
 #include <sstream>
 #include <sys/time.h>
+#include <thread>
+#include <vector>
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
 #include "Timing.h"
 
+// Messages are not formatted or written by the logging thread. Instead, each
+// thread queues a binary record (the tag and format pointers, plus the raw
+// arguments) into its own lock-free ring, and a background thread formats and
+// writes them out in batches. Records are variable-length, taking only as
+// much of the ring as their arguments (including copied strings) need. The
+// tag and format are kept as pointers, so they must outlive the call (as
+// string literals do), except for errors. An error is written out before
+// write() returns, along with everything queued before it, in case a crash
+// follows. Messages are dropped (and counted) if a thread's ring fills up
+// before the flusher gets to it, and any with more than MAX_ARGS_SIZE of
+// arguments are cut short, marked "[truncated]", and counted too.
 class Logger
 {
 public:
@@ -21,19 +39,81 @@ public:
 
   static const int androidMessageTypes[];
 
+  static const size_t MAX_ARGS_SIZE = 2048; // bytes, with strings copied in
+  static const size_t RING_SIZE = 64 * 1024; // bytes, per thread
+  static const uint64_t FLUSH_INTERVAL = 100; // ms
+
 private:
   typedef std::unique_ptr<FILE, decltype(&fclose)> FilePtr;
 
+  // Header of each record, which its arguments directly follow
+  struct Record
+  {
+    uint32_t size; // bytes, including the arguments and padding, or 0 to wrap
+    uint16_t argsSize;
+    bool isTruncated;
+    MessageType type;
+    uint64_t time; // ms since the logger was created
+    const char *tag;
+    const char *format;
+  };
+
+  // Byte ring for exactly one producer (the logging thread) and the flusher,
+  // holding records back to back. A record never wraps around the end, which
+  // is skipped over instead.
+  struct ThreadRing
+  {
+    static const size_t CACHE_LINE = 64;
+
+    alignas(Record) uint8_t data[RING_SIZE];
+    std::atomic<size_t> head;
+    char headPad[CACHE_LINE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail;
+    char tailPad[CACHE_LINE - sizeof(std::atomic<size_t>)];
+    std::atomic<uint64_t> numDropped;
+    std::atomic<uint64_t> numTruncated;
+    std::atomic<bool> isRetired; // Freed by the flusher once drained
+
+    ThreadRing();
+
+    // Producer only. Returns false (leaving the ring unchanged) if it is full
+    bool push(const Record &record, const uint8_t *args);
+    // Consumer only. Appends the next record (and its arguments) to 'dest',
+    // returning false if the ring is empty
+    bool pop(std::vector<uint8_t> &dest);
+    // Bytes in use. Approximate when called concurrently with push() or pop()
+    size_t size() const;
+  };
+
 private:
   bool screenEnabled_;
   bool logcatEnabled_;
   bool fileEnabled_;
   FilePtr fout_;
   uint64_t initTime_;
+  std::mutex outputMutex_;
+
+  std::vector<ThreadRing *> rings_;
+  std::mutex ringsMutex_;
+  pthread_key_t ringKey_;
+  std::vector<uint8_t> batch_;
+  std::vector<size_t> batchOffsets_;
+
+  std::thread flusher_;
+  std::mutex flushMutex_;
+  std::condition_variable flushCondition_;
+  uint64_t numFlushRequests_;
+  uint64_t numFlushed_;
+  std::atomic<bool> isWakeRequested_;
+  bool isStopping_;
 
 public:
   Logger();
   Logger(const char *filename);
+  ~Logger();
+
+  Logger(const Logger &) = delete;
+  Logger& operator = (const Logger &) = delete;
 
   void setScreenEnabled(bool value);
   void setLogcatEnabled(bool value);
@@ -44,10 +124,25 @@ public:
   bool isFileEnabled() const;
 
   void write(MessageType type, const char *tag, const char *format, ...);
+
+  // Blocks until everything queued so far (by any thread) has been written
+  void flush();
+
+private:
+  void start();
+  ThreadRing* getThreadRing();
+  static void retireRing(void *ring);
+
+  void runFlusher();
+  void writeBatch();
+
+  static void encodeArgs(Record &record, uint8_t *args, va_list argList);
+  static void formatRecord(const Record &record, const uint8_t *args, std::string &dest);
 };
 
 inline void Logger::setLogcatEnabled(bool value)
 {
+  std::lock_guard<std::mutex> outputLock(outputMutex_);
   logcatEnabled_ = value;
 }
 
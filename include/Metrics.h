@@ -0,0 +1,209 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <pthread.h>
+#include <vector>
+
+#include "Probes.h"
+#include "Timing.h"
+
+// Low overhead counters and histograms for seeing where time goes on a
+// device. Each thread records into its own set (found through a pthread key),
+// only ever written by that thread, so recording is a couple of relaxed
+// loads and stores with no locking or shared cache lines. A snapshot merges
+// every thread's set under a lock, along with the totals of threads that have
+// since exited.
+//
+// Histograms keep HDR-style buckets: values below 16 each have their own
+// bucket, and each power of two above that is split into 16 linear buckets,
+// so any recorded value is known to within 1/16th. Durations are recorded in
+// ns, up to 2^40 (about 18 minutes), beyond which they are clamped, except for
+// the time to recognize a device, which is in ms.
+class Metrics
+{
+public:
+  struct Counter_
+  {
+    enum Type
+    {
+      DevicesDiscovered,
+      DevicesHandshaken,
+      DevicesEncountered,
+      SharedSecrets,
+      SharedSecretFailures,
+      RSDecodeFailures,
+      Recoveries,
+      EpochStateEvictions,
+      END
+    };
+  };
+  typedef Counter_::Type Counter;
+  static const char *counterStrings[];
+
+  struct Histogram_
+  {
+    enum Type
+    {
+      ScanDuration, // ns
+      ReportsPerScan,
+      AdvertProcess, // ns
+      RSDecode, // ns
+      ECDHGenerate, // ns
+      ECDHSharedSecret, // ns
+      BloomFill, // ns
+      BloomQuery, // ns, per set of queries against one filter
+      Handshake, // ns
+      EpochChange, // ns
+      EventDelivery, // ns
+      // Per device, in the order of RecognitionLatency::Stage
+      TimeToDHDecoded, // ms
+      TimeToSecretComputed, // ms
+      TimeToMatchingConverged, // ms
+      TimeToConfirmed, // ms
+      AdvertsToDHDecoded,
+      AdvertsToSecretComputed,
+      AdvertsToMatchingConverged,
+      AdvertsToConfirmed,
+      END
+    };
+  };
+  typedef Histogram_::Type Histogram;
+  static const char *histogramStrings[];
+
+  static const size_t SUB_BUCKET_BITS = 4;
+  static const size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static const size_t MAX_VALUE_BITS = 40;
+  static const size_t NUM_BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  struct HistogramSnapshot
+  {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    std::vector<uint64_t> buckets;
+
+    // Lower bound of the bucket holding the given percentile (0-100), or 0
+    // if nothing has been recorded
+    uint64_t getPercentile(double percentile) const;
+  };
+
+  struct Snapshot
+  {
+    uint64_t time; // ms
+    std::vector<uint64_t> counters;
+    std::vector<HistogramSnapshot> histograms;
+  };
+
+  // Records the time spent in the enclosing scope
+  class Timer
+  {
+  private:
+    Histogram histogram_;
+    uint64_t startTime_; // ns
+
+  public:
+    Timer(Histogram histogram);
+    ~Timer();
+
+    Timer(const Timer &) = delete;
+    Timer& operator = (const Timer &) = delete;
+  };
+
+private:
+  struct ThreadHistogram
+  {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> min;
+    std::atomic<uint64_t> max;
+    std::atomic<uint64_t> buckets[NUM_BUCKETS];
+  };
+
+  struct ThreadMetrics
+  {
+    std::atomic<uint64_t> counters[Counter::END];
+    ThreadHistogram histograms[Histogram::END];
+
+    ThreadMetrics();
+  };
+
+  // Never destroyed, since threads may still exit after static destructors
+  // have run
+  struct Registry
+  {
+    std::mutex mutex;
+    std::vector<ThreadMetrics *> threads;
+    Snapshot retired;
+    pthread_key_t threadKey;
+  };
+
+private:
+  static Registry *registry_;
+  static pthread_once_t registryOnce_;
+
+public:
+  static void increment(Counter counter, uint64_t amount = 1);
+  static void record(Histogram histogram, uint64_t value);
+
+  static Snapshot getSnapshot();
+
+  static size_t getBucket(uint64_t value);
+  // Smallest value that falls into the bucket
+  static uint64_t getBucketValue(size_t bucket);
+
+private:
+  static Registry* getRegistry();
+  static void createRegistry();
+  static ThreadMetrics* getThreadMetrics();
+  static void releaseThreadMetrics(void *metrics);
+
+  static Snapshot createSnapshot();
+  static void merge(Snapshot &snapshot, const ThreadMetrics &metrics);
+};
+
+inline Metrics::Timer::Timer(Histogram histogram)
+   : histogram_(histogram),
+     startTime_(getMonoNS())
+{
+}
+
+inline Metrics::Timer::~Timer()
+{
+  uint64_t duration = getMonoNS() - startTime_;
+  record(histogram_, duration);
+  PROBE2(stage_duration, histogram_, duration);
+}
+
+inline size_t Metrics::getBucket(uint64_t value)
+{
+  if(value < SUB_BUCKETS)
+  {
+    return value;
+  }
+  if(value >= (1ULL << MAX_VALUE_BITS))
+  {
+    return NUM_BUCKETS - 1;
+  }
+
+  size_t msb = 63 - __builtin_clzll(value);
+  size_t shift = msb - SUB_BUCKET_BITS;
+  return ((shift + 1) * SUB_BUCKETS) + ((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+inline uint64_t Metrics::getBucketValue(size_t bucket)
+{
+  if(bucket < SUB_BUCKETS)
+  {
+    return bucket;
+  }
+
+  size_t shift = (bucket / SUB_BUCKETS) - 1;
+  return (uint64_t)(SUB_BUCKETS + (bucket % SUB_BUCKETS)) << shift;
+}
+
+#endif // METRICS_H
@@ -0,0 +1,99 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Times small operations on our hot paths, for the sddr_bench executable.
+// Each case runs its operation in batches, doubling the batch until it takes
+// at least 'minTime' ms, and then keeps the fastest of several batches of
+// that size. Allocations are counted by the executable's global operator new
+// (through countAllocation()), and are reported per operation along with the
+// time.
+class Microbench
+{
+public:
+  struct Format_
+  {
+    enum Type
+    {
+      Text,
+      CSV,
+      JSON,
+      END
+    };
+  };
+  typedef Format_::Type Format;
+  static const char *formatStrings[];
+  static Format stringToFormat(const char *name);
+
+  // Runs the operation 'iterations' times
+  typedef std::function<void(uint64_t iterations)> Body;
+
+  struct Result
+  {
+    std::string name;
+    uint64_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+  };
+
+private:
+  static const uint64_t MAX_ITERATIONS = 1ULL << 30;
+
+  struct Case
+  {
+    std::string name;
+    Body body;
+  };
+
+private:
+  static std::atomic<uint64_t> numAllocs_;
+  static std::atomic<uint64_t> numAllocBytes_;
+
+  uint64_t minTime_; // ms
+  size_t numRepeats_;
+  std::string filter_;
+  std::vector<Case> cases_;
+
+public:
+  Microbench(uint64_t minTime, size_t numRepeats, const std::string &filter);
+
+  // Cases whose names do not contain the filter are skipped
+  void add(const std::string &name, Body body);
+  // Runs every case in the order added, printing each result to stdout as
+  // soon as it is known
+  std::vector<Result> run(Format format);
+
+  static void countAllocation(size_t size);
+
+  // Keeps the compiler from optimizing away a result that is never used
+  template <typename T>
+  static void keep(const T &value);
+
+private:
+  Result runCase(const Case &benchCase);
+
+  static void printHeader(Format format);
+  static void printResult(const Result &result, Format format, bool isFirst);
+  static void printFooter(Format format);
+};
+
+inline void Microbench::countAllocation(size_t size)
+{
+  numAllocs_.fetch_add(1, std::memory_order_relaxed);
+  numAllocBytes_.fetch_add(size, std::memory_order_relaxed);
+}
+
+template <typename T>
+inline void Microbench::keep(const T &value)
+{
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+#endif // MICROBENCH_H
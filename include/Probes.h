@@ -0,0 +1,66 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+// Static (USDT) tracepoints on the hot paths, for attaching perf or bpftrace
+// on a Linux host, e.g.
+//
+//   bpftrace -e 'usdt:./sddr:sddr:advert_process { @[arg0] = count(); }'
+//
+// Each probe is a single nop until a tracer attaches to it, so they are left
+// in for all builds. Its arguments are still evaluated though, so they should
+// be values already at hand. Built with PROBES_ENABLED, or automatically
+// wherever <sys/sdt.h> (systemtap-sdt-dev) can be found; otherwise the
+// probes compile to nothing at all, with their arguments never evaluated
+// (but still counted as used).
+//
+// Durations are in ns unless noted, and addresses are passed as pointers to
+// their 6 bytes.
+#if !defined(PROBES_ENABLED) && !defined(PROBES_DISABLED) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define PROBES_ENABLED
+#endif
+#endif
+
+#ifdef PROBES_ENABLED
+#include <sys/sdt.h>
+
+#define PROBE0(name) DTRACE_PROBE(sddr, name)
+#define PROBE1(name, a1) DTRACE_PROBE1(sddr, name, a1)
+#define PROBE2(name, a1, a2) DTRACE_PROBE2(sddr, name, a1, a2)
+#define PROBE3(name, a1, a2, a3) DTRACE_PROBE3(sddr, name, a1, a2, a3)
+#define PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(sddr, name, a1, a2, a3, a4)
+#define PROBE5(name, a1, a2, a3, a4, a5) DTRACE_PROBE5(sddr, name, a1, a2, a3, a4, a5)
+#else
+#define PROBE0(name) do { } while(0)
+#define PROBE1(name, a1) do { if(0) { (void)(a1); } } while(0)
+#define PROBE2(name, a1, a2) do { if(0) { (void)(a1); (void)(a2); } } while(0)
+#define PROBE3(name, a1, a2, a3) do { if(0) { (void)(a1); (void)(a2); (void)(a3); } } while(0)
+#define PROBE4(name, a1, a2, a3, a4) do { if(0) { (void)(a1); (void)(a2); (void)(a3); (void)(a4); } } while(0)
+#define PROBE5(name, a1, a2, a3, a4, a5) do { if(0) { (void)(a1); (void)(a2); (void)(a3); (void)(a4); (void)(a5); } } while(0)
+#endif
+
+// Probes, with their arguments:
+//
+//   stage_duration(histogram, duration)
+//     From every Metrics::Timer, where the histogram is a Metrics::Histogram
+//     value, covering scans, advert processing, RS decoding, ECDH, Bloom
+//     filters, handshakes, epoch changes and event delivery
+//   scan_report(address, rssi, length)
+//     Each LE advertising or EIR inquiry report received during a scan
+//   scan_complete(numReports)
+//   hci_command_issue(adapterID, opcode)
+//   hci_command_complete(adapterID, opcode, status, latency (us))
+//     For both pipelined commands and blocking requests
+//   advert_generate(advertNum, size (bytes))
+//   advert_process(deviceID, advertNum)
+//   epoch_create(radioIndex)
+//   epoch_decode(deviceID, bloomNum)
+//     When a device's DH public value for an epoch is first decoded
+//   bloom_query(deviceID, numQueries, numRemaining)
+//     One batch of queries for a device against a received Bloom filter
+//   shared_secret(isComputed)
+//   hyst_transition(deviceID, fromState, toState)
+//     Where the states are EbNHystPolicy's, or -1 for a device not (or no
+//     longer) being tracked
+
+#endif // PROBES_H
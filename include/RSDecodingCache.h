@@ -0,0 +1,66 @@
+#ifndef RSDECODINGCACHE_H
+#define RSDECODINGCACHE_H
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BitMap.h"
+
+// Bounded LRU of inverted decoding matrices, keyed by the set of symbols used
+// for decoding. Shared by all decoders created from the same RSMatrix, since
+// most devices are decoded from the same few received-symbol patterns.
+class RSDecodingCache
+{
+public:
+  struct Entry
+  {
+    std::vector<int> ids;
+    std::vector<std::vector<int> > matrices;
+  };
+
+private:
+  typedef std::list<std::pair<std::string, std::shared_ptr<const Entry> > > EntryList;
+
+  size_t capacity_;
+  EntryList entries_;
+  std::unordered_map<std::string, EntryList::iterator> index_;
+  std::mutex mutex_;
+  // Read without the lock, for reporting
+  std::atomic<size_t> numHits_;
+  std::atomic<size_t> numMisses_;
+
+public:
+  RSDecodingCache(size_t capacity);
+
+  std::shared_ptr<const Entry> get(const BitMap &key);
+  void put(const BitMap &key, std::shared_ptr<const Entry> entry);
+
+  size_t getCapacity() const;
+  size_t getNumHits() const;
+  size_t getNumMisses() const;
+
+private:
+  static std::string toKey(const BitMap &bitmap);
+};
+
+inline size_t RSDecodingCache::getCapacity() const
+{
+  return capacity_;
+}
+
+inline size_t RSDecodingCache::getNumHits() const
+{
+  return numHits_.load(std::memory_order_relaxed);
+}
+
+inline size_t RSDecodingCache::getNumMisses() const
+{
+  return numMisses_.load(std::memory_order_relaxed);
+}
+
+#endif // RSDECODINGCACHE_H
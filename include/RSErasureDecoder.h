@@ -5,58 +5,82 @@
 #include <memory>
 #include <vector>
 
-#include "BitMap.h"
+#include "GF256Eliminator.h"
 #include "RSMatrix.h"
 
+// Decoders are kept per device and per epoch, so they only reference the
+// (immutable) matrix, which must outlive them, and keep all of their symbol
+// state in a single aligned buffer. As such, they can be moved but not copied.
 class RSErasureDecoder
 {
 private:
-  RSMatrix matrix_;
-  std::vector<std::vector<char> > partSymbols_;
-  std::vector<std::vector<char*> > partSymbolPtrs_;
-  std::vector<uint8_t> data_;
-  BitMap received_;
+  static const size_t BUFFER_ALIGN = 16;
+
+private:
+  const RSMatrix *matrix_;
+  std::unique_ptr<uint8_t[]> buffer_;
+  uint8_t *data_;
+  uint8_t *received_;
+  char *partSymbols_;
+  GF256Eliminator eliminator_;
   size_t numReceived_;
   bool isDecoded_;
 
 public:
   RSErasureDecoder(const RSMatrix &matrix);
   RSErasureDecoder(RSErasureDecoder &&) = default;
-  RSErasureDecoder(const RSErasureDecoder &other); 
+  RSErasureDecoder(const RSErasureDecoder &other) = delete;
 
   RSErasureDecoder& operator = (RSErasureDecoder &&) = default;
-  RSErasureDecoder& operator = (const RSErasureDecoder &other); 
+  RSErasureDecoder& operator = (const RSErasureDecoder &other) = delete;
 
   size_t K() const;
-  size_t M() const; 
-  size_t W() const; 
+  size_t M() const;
+  size_t W() const;
 
   bool setSymbol(size_t index, const uint8_t *data);
+  // Whether the symbol would still help decode. For progressive backends,
+  // setting the same symbol straight after reuses the work done here.
+  bool isUseful(size_t index);
   const uint8_t* decode();
   bool canDecode() const;
   bool isDecoded() const;
 
   void reset();
+
+private:
+  bool isReceived(size_t index) const;
+  char* getPartSymbol(size_t part, size_t index) const;
+  std::shared_ptr<const RSDecodingCache::Entry> getDecodingEntry() const;
+  bool decodeJerasure(const RSDecodingCache::Entry &entry);
+  bool decodeCauchyXOR(const RSDecodingCache::Entry &entry);
 };
 
-inline uint32_t RSErasureDecoder::K() const
+inline size_t RSErasureDecoder::K() const
 {
-  return matrix_.K();
+  return matrix_->K();
 }
 
-inline uint32_t RSErasureDecoder::M() const
+inline size_t RSErasureDecoder::M() const
 {
-  return matrix_.M(); 
+  return matrix_->M();
 }
 
-inline uint32_t RSErasureDecoder::W() const
+inline size_t RSErasureDecoder::W() const
 {
-  return matrix_.W();
+  return matrix_->W();
 }
 
 inline bool RSErasureDecoder::canDecode() const
 {
-  return (numReceived_ >= matrix_.K()); 
+  // Progressive backends eliminate symbols as they arrive, and so only count
+  // those that were linearly independent
+  if(matrix_->isProgressive())
+  {
+    return eliminator_.isComplete();
+  }
+
+  return (numReceived_ >= matrix_->K());
 }
 
 inline bool RSErasureDecoder::isDecoded() const
@@ -64,4 +88,14 @@ inline bool RSErasureDecoder::isDecoded() const
   return isDecoded_;
 }
 
+inline bool RSErasureDecoder::isReceived(size_t index) const
+{
+  return ((received_[index >> 3] >> (index & 0x7)) & 0x1) != 0;
+}
+
+inline char* RSErasureDecoder::getPartSymbol(size_t part, size_t index) const
+{
+  return partSymbols_ + (((part * (matrix_->K() + matrix_->M())) + index) * matrix_->getPartSize());
+}
+
 #endif // RSERASUREDECODER_H
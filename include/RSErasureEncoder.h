@@ -29,6 +29,12 @@ public:
 
   void encode(const uint8_t *data);
   const uint8_t* getSymbol(size_t index) const;
+
+private:
+  void setupPartPointers();
+  void encodeJerasure(const uint8_t *data);
+  void encodeGenerator(const uint8_t *data);
+  void encodeCauchyXOR(const uint8_t *data);
 };
 
 inline size_t RSErasureEncoder::K() const
@@ -1,31 +1,95 @@
 #ifndef RSMATRIX_H
 #define RSMATRIX_H
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "RSDecodingCache.h"
+
 class RSMatrix
 {
+public:
+  // Coding backends. All backends are systematic, but they produce different
+  // coding symbols, so all devices must agree on the backend in use.
+  //  - Jerasure: Splits each W-byte symbol into parts of 4/2/1 bytes, each
+  //    coded with a Vandermonde matrix over GF(2^(8*w)) (original scheme)
+  //  - GF8: Codes each byte of a symbol independently with a Vandermonde
+  //    matrix over GF(2^8), using SIMD split-table region multiplication, and
+  //    decodes progressively as symbols arrive
+  //  - CauchyXOR: Bit-slices each symbol into 8 packets and codes them with a
+  //    Cauchy bitmatrix schedule over GF(2^8), using only XOR operations
+  //  - Rateless: Random linear fountain over GF(2^8), where the coefficients
+  //    of each coding symbol are derived from its index alone, so M is not
+  //    bounded by the field size. Decodes progressively from any K linearly
+  //    independent symbols (occasionally needing one or two extra)
+  struct Backend_
+  {
+    enum Type
+    {
+      Jerasure,
+      GF8,
+      CauchyXOR,
+      Rateless,
+      END
+    };
+  };
+  typedef Backend_::Type Backend;
+  static const char *backendStrings[];
+  static Backend stringToBackend(const char* name);
+
 private:
+  Backend backend_;
   size_t K_;
-  size_t M_; 
-  size_t W_; 
-  std::vector<size_t> partW_; 
+  size_t M_;
+  size_t W_;
+  std::vector<size_t> partW_;
   std::vector<std::shared_ptr<int> > partMatrices_;
+  std::shared_ptr<int> codingMatrix_;
+  std::shared_ptr<std::vector<uint8_t> > generatorMatrix_;
+  std::shared_ptr<int> bitMatrix_;
+  std::shared_ptr<int *> schedule_;
+  size_t packetSize_;
+  std::shared_ptr<RSDecodingCache> decodingCache_;
 
 public:
-  RSMatrix(size_t K, size_t M, size_t W); 
+  RSMatrix(size_t K, size_t M, size_t W, Backend backend = Backend::Jerasure, size_t decodingCacheSize = 0);
 
-  size_t K() const; 
-  size_t M() const; 
-  size_t W() const; 
+  Backend getBackend() const;
+  size_t K() const;
+  size_t M() const;
+  size_t W() const;
 
+  // Jerasure uses one part per split of the symbol, CauchyXOR uses a single
+  // part holding the bit-sliced symbol, and GF8 works on the symbols directly
   size_t getNumParts() const;
-  size_t getPartW(size_t index) const; 
-  int* getMatrix(size_t index); 
-  const int* getMatrix(size_t index) const; 
+  size_t getPartW(size_t index) const;
+  size_t getPartSize() const;
+  int* getMatrix(size_t index);
+  const int* getMatrix(size_t index) const;
+
+  // The M x K coding matrix over GF(2^8), for the GF8 and CauchyXOR backends
+  const int* getCodingMatrix() const;
+  // Row of the (K + M) x K systematic generator matrix, for the GF8 and
+  // Rateless backends, which decode progressively using these rows
+  bool isProgressive() const;
+  const uint8_t* getGeneratorRow(size_t index) const;
+  int* getBitMatrix() const;
+  int** getSchedule() const;
+  size_t getPacketSize() const;
+
+  // Shared by all copies of this matrix, or NULL if caching is disabled
+  RSDecodingCache* getDecodingCache() const;
+
+  void toBitPlanes(const uint8_t *symbol, char *planes) const;
+  void fromBitPlanes(const char *planes, uint8_t *symbol) const;
 };
 
+inline RSMatrix::Backend RSMatrix::getBackend() const
+{
+  return backend_;
+}
+
 inline size_t RSMatrix::K() const
 {
   return K_;
@@ -51,14 +115,54 @@ inline size_t RSMatrix::getPartW(size_t index) const
   return partW_[index];
 }
 
+inline size_t RSMatrix::getPartSize() const
+{
+  return (backend_ == Backend::CauchyXOR) ? (8 * packetSize_) : sizeof(long);
+}
+
 inline int* RSMatrix::getMatrix(size_t index)
 {
-  return partMatrices_[index].get(); 
+  return partMatrices_[index].get();
 }
 
 inline const int* RSMatrix::getMatrix(size_t index) const
 {
-  return partMatrices_[index].get(); 
+  return partMatrices_[index].get();
+}
+
+inline const int* RSMatrix::getCodingMatrix() const
+{
+  return codingMatrix_.get();
+}
+
+inline bool RSMatrix::isProgressive() const
+{
+  return (generatorMatrix_ != NULL);
+}
+
+inline const uint8_t* RSMatrix::getGeneratorRow(size_t index) const
+{
+  return &(*generatorMatrix_)[index * K_];
+}
+
+inline int* RSMatrix::getBitMatrix() const
+{
+  return bitMatrix_.get();
+}
+
+inline int** RSMatrix::getSchedule() const
+{
+  return schedule_.get();
+}
+
+inline size_t RSMatrix::getPacketSize() const
+{
+  return packetSize_;
+}
+
+inline RSDecodingCache* RSMatrix::getDecodingCache() const
+{
+  return decodingCache_.get();
 }
 
 #endif // RSMATRIX_H
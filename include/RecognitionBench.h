@@ -0,0 +1,83 @@
+#ifndef RECOGNITIONBENCH_H
+#define RECOGNITIONBENCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "EbNDevice.h"
+#include "EbNRadio.h"
+#include "LinkValue.h"
+
+// Runs the sender to receiver half of the protocol offline, in order to
+// compare how much work each radio version does to recognize a device, and
+// after how many adverts. Each trial uses a fresh sender (with its own ECDH
+// keys and address) and a fresh device on the receiver's side. The sender
+// generates the adverts of one epoch in turn, each of which is lost with
+// probability 'lossRate', and the receiver processes the rest until the
+// device's matching set is exactly the entries shared between the sets (with
+// a shared secret as well, for the radios that compute them). Only the
+// receiver's processing is timed, using the CPU time of this thread.
+class RecognitionBench
+{
+public:
+  typedef std::function<std::shared_ptr<EbNRadio>(int adapterID)> RadioFactory;
+
+  struct Config
+  {
+    size_t setSize;
+    double lossRate;
+    size_t numTrials;
+    size_t linkValueSize; // bytes
+    int firstAdapterID;
+    uint32_t seed;
+  };
+
+  struct Result
+  {
+    // For the recognized trials only, where the adverts include those lost
+    std::vector<uint64_t> cpuTimes; // us
+    std::vector<size_t> numAdverts;
+    size_t numFailed;
+  };
+
+private:
+  struct Trial
+  {
+    LinkValueList advertisedSet;
+    LinkValueList listenSet;
+    LinkValueSet shared;
+    bool isRecognized;
+    uint64_t cpuTime; // us
+    size_t numAdverts;
+  };
+
+private:
+  Config config_;
+  RadioFactory radioFactory_;
+  std::mt19937 random_;
+
+public:
+  RecognitionBench(const Config &config, RadioFactory radioFactory);
+
+  RecognitionBench(const RecognitionBench &) = delete;
+  RecognitionBench& operator = (const RecognitionBench &) = delete;
+
+  // Throws a runtime_error for radio versions without an offline advert path
+  Result run();
+
+private:
+  Trial generateTrial();
+  LinkValue generateLinkValue();
+  bool isLost();
+
+  template <typename Radio, typename Device>
+  void processAdverts(Radio *sender, Radio *receiver, Device *device, bool hasSecrets, Trial &trial);
+
+  static bool isRecognized(EbNDevice *device, const LinkValueSet &shared, bool hasSecrets);
+};
+
+#endif // RECOGNITIONBENCH_H
@@ -0,0 +1,96 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free ring buffer for exactly one producer thread and one
+// consumer thread. All slots are allocated up front, and values are copied in
+// and out, so pushing never allocates. The producer and consumer indices are
+// kept on separate cache lines, since each is written by a different thread.
+template<typename T, size_t N>
+class SPSCRing
+{
+  static_assert((N > 0) && ((N & (N - 1)) == 0), "SPSCRing size must be a power of two");
+
+private:
+  static const size_t CACHE_LINE = 64;
+
+private:
+  T slots_[N];
+  std::atomic<size_t> head_;
+  char headPad_[CACHE_LINE - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> tail_;
+  char tailPad_[CACHE_LINE - sizeof(std::atomic<size_t>)];
+
+public:
+  SPSCRing();
+
+  SPSCRing(const SPSCRing &) = delete;
+  SPSCRing& operator = (const SPSCRing &) = delete;
+
+  static constexpr size_t capacity()
+  {
+    return N;
+  }
+
+  // Producer only. Returns false (leaving the ring unchanged) if it is full
+  bool push(const T &value);
+  // Consumer only. Returns false if the ring is empty
+  bool pop(T &value);
+
+  // Approximate when called concurrently with push() or pop()
+  size_t size() const;
+  bool empty() const;
+};
+
+template<typename T, size_t N>
+SPSCRing<T, N>::SPSCRing()
+   : head_(0),
+     tail_(0)
+{
+}
+
+template<typename T, size_t N>
+bool SPSCRing<T, N>::push(const T &value)
+{
+  size_t head = head_.load(std::memory_order_relaxed);
+  if((head - tail_.load(std::memory_order_acquire)) == N)
+  {
+    return false;
+  }
+
+  slots_[head & (N - 1)] = value;
+  head_.store(head + 1, std::memory_order_release);
+
+  return true;
+}
+
+template<typename T, size_t N>
+bool SPSCRing<T, N>::pop(T &value)
+{
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  if(tail == head_.load(std::memory_order_acquire))
+  {
+    return false;
+  }
+
+  value = slots_[tail & (N - 1)];
+  tail_.store(tail + 1, std::memory_order_release);
+
+  return true;
+}
+
+template<typename T, size_t N>
+size_t SPSCRing<T, N>::size() const
+{
+  return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+}
+
+template<typename T, size_t N>
+bool SPSCRing<T, N>::empty() const
+{
+  return (size() == 0);
+}
+
+#endif // SPSCRING_H
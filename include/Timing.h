@@ -15,6 +15,7 @@
 #define TIME_MS_TO_MIN(t) ((t) / 60000)
 #define TIME_MS_TO_SEC(t) ((t) / 1000)
 #define TIME_MS_TO_US(t) ((t) * 1000)
+#define TIME_US_TO_MS(t) ((t) / 1000)
 
 inline uint64_t getTimeSec()
 {
@@ -58,6 +59,21 @@ inline uint64_t getMonoUS()
   return ((uint64_t)curTime.tv_sec * 1000000) + (curTime.tv_nsec / 1000);
 }
 
+inline uint64_t getMonoNS()
+{
+  struct timespec curTime;
+  clock_gettime(CLOCK_MONOTONIC, &curTime);
+  return ((uint64_t)curTime.tv_sec * 1000000000) + curTime.tv_nsec;
+}
+
+// CPU time used by the calling thread alone
+inline uint64_t getThreadCPUUS()
+{
+  struct timespec curTime;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &curTime);
+  return ((uint64_t)curTime.tv_sec * 1000000) + (curTime.tv_nsec / 1000);
+}
+
 inline void sleepSec(uint64_t time)
 {
   usleep(time * 1000000);
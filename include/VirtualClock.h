@@ -0,0 +1,72 @@
+#ifndef VIRTUALCLOCK_H
+#define VIRTUALCLOCK_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "Clock.h"
+
+// Discrete-event clock for simulations, where time stands still while any
+// participating thread is running, and then jumps straight to the earliest
+// time that one of them is sleeping until. Participants run one at a time, in
+// order of wake time and then of ID, so a run follows the same schedule no
+// matter how the system happens to schedule the threads.
+//
+// Threads which have not joined (e.g. those serving incoming connections) run
+// in real time alongside, taking no virtual time, while any sleep they make
+// ends once the virtual time has passed.
+class VirtualClock : public Clock
+{
+private:
+  static const size_t NONE = SIZE_MAX;
+
+  typedef std::set<std::pair<uint64_t, size_t> > WaitSet;
+  typedef std::unordered_map<std::thread::id, size_t> ThreadToIDMap;
+
+private:
+  uint64_t epoch_; // ms (wall-clock time at virtual time zero)
+  uint64_t time_;  // ms
+  size_t nextID_;
+  size_t numStarting_;
+  size_t running_;
+  WaitSet waiting_;
+  ThreadToIDMap threadToID_;
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+
+public:
+  explicit VirtualClock(uint64_t epoch);
+
+  VirtualClock(const VirtualClock &) = delete;
+  VirtualClock& operator = (const VirtualClock &) = delete;
+
+  // Reserves a participant ID, where time does not move until every reserved
+  // participant has joined (so they should be added before starting any)
+  size_t addParticipant();
+  // Makes the calling thread the given participant, returning once it is its
+  // turn to run
+  void join(size_t id);
+  // Removes the calling thread from the participants
+  void leave();
+
+  uint64_t getTimeMS() const;
+  uint64_t getMonoMS() const;
+  uint64_t getMonoUS() const;
+
+  void sleepMS(uint64_t time);
+  // Participants cannot be woken early by another thread, since the notifying
+  // thread would need the time to stand still to do so, and so this only
+  // returns once the timeout has passed
+  void waitFor(std::unique_lock<std::mutex> &lock, std::condition_variable &cond, uint64_t timeout);
+
+private:
+  void dispatch();
+};
+
+#endif // VIRTUALCLOCK_H
@@ -0,0 +1,135 @@
+#ifndef VIRTUALHCIBACKEND_H
+#define VIRTUALHCIBACKEND_H
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "Clock.h"
+#include "HCIBackend.h"
+#include "HCIReplay.h"
+#include "VirtualMedium.h"
+
+// Simulated controller on a VirtualMedium, which answers the commands that
+// BluetoothHCI sends much as a real controller would, and generates the
+// resulting events (advertising reports, inquiry results, remote names) from
+// what the other controllers in range have on the air. Events are scheduled
+// ahead of time (e.g. every report for the scan window is placed once the
+// scan is enabled), and then released by readEvents() as they become due.
+// All timing follows the default clock, so that under a VirtualClock a scan
+// or page takes no real time at all. Given an HCIReplay, scans and inquiries
+// report the events of the captured sessions instead of the medium's.
+class VirtualHCIBackend : public HCIBackend
+{
+private:
+  static const uint64_t NAME_LATENCY = 50;    // ms
+  static const uint64_t PAGE_TIMEOUT = 5120;  // ms
+  static const size_t MAX_PENDING_NAMES = 4;
+  static const uint64_t ADVERT_JITTER = 10;   // ms
+  static const size_t EXT_FRAGMENT_SIZE = 229;
+
+  struct Source_
+  {
+    enum Type
+    {
+      Command,
+      Scan,
+      Inquiry,
+      RemoteName
+    };
+  };
+  typedef Source_::Type Source;
+
+  struct PendingEvent
+  {
+    Source source;
+    Address address;
+    std::vector<uint8_t> packet;
+  };
+
+private:
+  std::shared_ptr<VirtualMedium> medium_;
+  std::shared_ptr<Clock> clock_;
+  std::shared_ptr<HCIReplay> replay_;
+  int adapterID_;
+  bool isOpen_;
+  bool isEventsOpen_;
+  struct hci_filter filter_;
+
+  VirtualMedium::OnAir state_;
+  uint8_t inquiryMode_;
+  bool isScanning_;
+  bool isExtendedScan_;
+  uint8_t scanType_;
+  bool scanFilterDup_;
+  uint64_t scanWindow_; // ms
+  uint8_t extScanType_;
+  uint64_t extScanWindow_; // ms
+  size_t numPendingNames_;
+
+  std::multimap<uint64_t, PendingEvent> events_;
+  std::mutex mutex_;
+  std::condition_variable eventsCond_;
+
+public:
+  VirtualHCIBackend(std::shared_ptr<VirtualMedium> medium, int adapterID);
+  ~VirtualHCIBackend();
+
+  VirtualHCIBackend(const VirtualHCIBackend &) = delete;
+  VirtualHCIBackend& operator = (const VirtualHCIBackend &) = delete;
+
+  int getAdapterID() const;
+  void setReplay(std::shared_ptr<HCIReplay> replay);
+
+  int open();
+  void close();
+  int reset();
+  void restart(const Address *publicAddress);
+  int readDeviceInfo(struct hci_dev_info *info);
+  int setScanEnable(uint8_t scanEnable);
+
+  int sendCommand(uint16_t opcode, const void *params, uint8_t length);
+  int sendRequest(struct hci_request *request, int timeout);
+  int inquiry(int periods, std::vector<inquiry_info> &responses);
+
+  void openEvents(const struct hci_filter &filter);
+  void closeEvents();
+  size_t readEvents(int64_t timeout, uint8_t *buffer, size_t *lengths, size_t maxEvents);
+  size_t flushEvents();
+
+  int startConnect(Transport transport, const Address &address, uint8_t port);
+  int listen(Transport transport, uint8_t port);
+  std::pair<int, Address> accept(Transport transport, int sockListen);
+
+private:
+  // Applies a command to the controller state, filling in any return
+  // parameters (after the status) and returning the status
+  uint8_t handleCommand(uint16_t opcode, const uint8_t *params, uint8_t length, std::vector<uint8_t> &reply, uint64_t curTime);
+  void resetState(const Address &publicAddress);
+  void publish();
+
+  void scheduleScan(uint64_t curTime);
+  void scheduleExtendedScan(uint64_t curTime);
+  void scheduleInquiry(uint64_t curTime, uint8_t periods);
+  void scheduleRemoteName(uint64_t curTime, const Address &address);
+  void scheduleReplay(uint64_t curTime, HCICapture::Session session, Source source, uint64_t duration);
+  // Ends the replayed session once all of its events have been read
+  void checkReplay();
+  void cancelEvents(Source source);
+  void cancelEvents(Source source, const Address &address);
+  void queueEvent(uint64_t time, Source source, const Address &address, uint8_t event, const uint8_t *body, size_t length);
+  void queueCommandComplete(uint64_t time, uint16_t opcode, uint8_t status, const std::vector<uint8_t> &reply);
+  void queueCommandStatus(uint64_t time, uint16_t opcode, uint8_t status);
+
+  // Name the remote name complete event would carry (if found in range)
+  bool lookupName(const Address &address, evt_remote_name_req_complete &complete);
+  int bindConnectName(int sock, const Address &address);
+};
+
+inline int VirtualHCIBackend::getAdapterID() const
+{
+  return adapterID_;
+}
+
+#endif // VIRTUALHCIBACKEND_H
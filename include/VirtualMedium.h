@@ -0,0 +1,136 @@
+#ifndef VIRTUALMEDIUM_H
+#define VIRTUALMEDIUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bluetooth/bluetooth.h"
+#include "bluetooth/hci.h"
+
+#include "Address.h"
+#include "HCIBackend.h"
+
+// Shared radio environment for many simulated controllers in one process, so
+// that a set of EbNRadio instances (each on its own VirtualHCIBackend) can
+// discover and connect to one another without any Bluetooth hardware. Each
+// controller is placed at random in a square area, and publishes what it
+// currently has on the air (inquiry scan, EIR, LE adverts) as an immutable
+// snapshot, which scanners then read without copying. Reception is limited to
+// 'range' metres, loses each packet with probability 'lossRate', and reports
+// an RSSI from a log-distance path loss model with Gaussian shadowing.
+//
+// Connections are carried over abstract unix sockets, whose names embed the
+// address of the initiator so that the listener can recover it on accept.
+class VirtualMedium : public std::enable_shared_from_this<VirtualMedium>
+{
+public:
+  struct Config
+  {
+    double areaSize;         // m (length of each side)
+    double range;            // m
+    double lossRate;
+    double rssiAtOneMetre;   // dBm
+    double pathLossExponent;
+    double rssiDeviation;    // dB
+    uint32_t seed;
+  };
+
+  // Everything a controller currently exposes to others
+  struct OnAir
+  {
+    Address publicAddress;
+    bool isDiscoverable;
+    bool isConnectable;
+    std::string localName;
+    std::vector<uint8_t> extInquiryResponse;
+
+    bool isAdvertising;
+    Address randomAddress;
+    uint8_t advertType;
+    uint64_t advertInterval; // ms
+    std::vector<uint8_t> advertData;
+    std::vector<uint8_t> responseData;
+
+    bool isExtAdvertising;
+    Address extAdvertAddress;
+    bool isExtConnectable;
+    uint64_t extAdvertInterval; // ms
+    std::vector<uint8_t> extAdvertData;
+  };
+
+  struct Neighbour
+  {
+    int adapterID;
+    double distance;
+    std::shared_ptr<const OnAir> onAir;
+  };
+
+private:
+  struct Node
+  {
+    bool isPresent;
+    double x;
+    double y;
+    std::shared_ptr<const OnAir> onAir;
+  };
+
+private:
+  Config config_;
+  std::vector<Node> nodes_;
+  std::mt19937 random_;
+  std::normal_distribution<double> rssiNoise_;
+  std::uniform_real_distribution<double> uniform_;
+  std::string namePrefix_;
+  size_t numConnects_;
+  mutable std::mutex mutex_;
+
+public:
+  VirtualMedium(const Config &config);
+
+  VirtualMedium(const VirtualMedium &) = delete;
+  VirtualMedium& operator = (const VirtualMedium &) = delete;
+
+  static Config getDefaultConfig();
+
+  const Config& getConfig() const;
+
+  // Creates the controller for an adapter, placing it at random in the area
+  std::shared_ptr<HCIBackend> createBackend(int adapterID);
+  // Factory for HCIBackend::setFactory(), so that radios create their
+  // backends on this medium rather than on real adapters
+  HCIBackend::Factory getFactory();
+
+  void setPosition(int adapterID, double x, double y);
+  void publish(int adapterID, std::shared_ptr<const OnAir> onAir);
+
+  // All other controllers within range of the given one
+  std::vector<Neighbour> getNeighbours(int adapterID) const;
+  // Finds the controller in range which is reachable at the given address,
+  // being its public address for RFCOMM (or a remote name request), and its
+  // current random (or extended advertising) address for LE. Returns the
+  // adapter ID, or -1 if there is none.
+  int findNeighbour(int adapterID, const Address &address, HCIBackend::Transport transport, std::shared_ptr<const OnAir> *onAir = NULL) const;
+
+  int8_t sampleRSSI(double distance);
+  bool sampleLoss();
+  double sampleUniform();
+
+  std::string getListenName(int adapterID, HCIBackend::Transport transport, uint8_t port) const;
+  std::string getConnectName(const Address &address);
+  static bool parseConnectName(const std::string &name, Address &address);
+
+private:
+  double getDistance(const Node &a, const Node &b) const;
+};
+
+inline const VirtualMedium::Config& VirtualMedium::getConfig() const
+{
+  return config_;
+}
+
+#endif // VIRTUALMEDIUM_H
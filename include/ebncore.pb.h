@@ -39,7 +39,13 @@ class Event_LinkabilityEvent;
 class Event_LinkabilityEvent_Entry;
 class Event_EncounterEvent;
 class Event_EncounterEvent_RSSIEvent;
+class Event_EncounterEvent_Milestone;
 class Event_SleepEvent;
+class Event_MetricsRequestEvent;
+class Event_MetricsEvent;
+class Event_MetricsEvent_Counter;
+class Event_MetricsEvent_Histogram;
+class Event_MetricsEvent_Histogram_Bucket;
 
 enum Event_LinkabilityEvent_Entry_ModeType {
   Event_LinkabilityEvent_Entry_ModeType_Listen = 0,
@@ -60,6 +66,27 @@ inline bool Event_LinkabilityEvent_Entry_ModeType_Parse(
   return ::google::protobuf::internal::ParseNamedEnum<Event_LinkabilityEvent_Entry_ModeType>(
     Event_LinkabilityEvent_Entry_ModeType_descriptor(), name, value);
 }
+enum Event_EncounterEvent_Milestone_StageType {
+  Event_EncounterEvent_Milestone_StageType_DHDecoded = 0,
+  Event_EncounterEvent_Milestone_StageType_SecretComputed = 1,
+  Event_EncounterEvent_Milestone_StageType_MatchingConverged = 2,
+  Event_EncounterEvent_Milestone_StageType_Confirmed = 3
+};
+bool Event_EncounterEvent_Milestone_StageType_IsValid(int value);
+const Event_EncounterEvent_Milestone_StageType Event_EncounterEvent_Milestone_StageType_StageType_MIN = Event_EncounterEvent_Milestone_StageType_DHDecoded;
+const Event_EncounterEvent_Milestone_StageType Event_EncounterEvent_Milestone_StageType_StageType_MAX = Event_EncounterEvent_Milestone_StageType_Confirmed;
+const int Event_EncounterEvent_Milestone_StageType_StageType_ARRAYSIZE = Event_EncounterEvent_Milestone_StageType_StageType_MAX + 1;
+
+const ::google::protobuf::EnumDescriptor* Event_EncounterEvent_Milestone_StageType_descriptor();
+inline const ::std::string& Event_EncounterEvent_Milestone_StageType_Name(Event_EncounterEvent_Milestone_StageType value) {
+  return ::google::protobuf::internal::NameOfEnum(
+    Event_EncounterEvent_Milestone_StageType_descriptor(), value);
+}
+inline bool Event_EncounterEvent_Milestone_StageType_Parse(
+    const ::std::string& name, Event_EncounterEvent_Milestone_StageType* value) {
+  return ::google::protobuf::internal::ParseNamedEnum<Event_EncounterEvent_Milestone_StageType>(
+    Event_EncounterEvent_Milestone_StageType_descriptor(), name, value);
+}
 enum Event_EncounterEvent_EventType {
   Event_EncounterEvent_EventType_UnconfirmedStart = 3,
   Event_EncounterEvent_EventType_Start = 0,
@@ -383,6 +410,134 @@ class Event_EncounterEvent_RSSIEvent : public ::google::protobuf::Message {
 };
 // -------------------------------------------------------------------
 
+class Event_EncounterEvent_Milestone : public ::google::protobuf::Message {
+ public:
+  Event_EncounterEvent_Milestone();
+  virtual ~Event_EncounterEvent_Milestone();
+
+  Event_EncounterEvent_Milestone(const Event_EncounterEvent_Milestone& from);
+
+  inline Event_EncounterEvent_Milestone& operator=(const Event_EncounterEvent_Milestone& from) {
+    CopyFrom(from);
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const Event_EncounterEvent_Milestone& default_instance();
+
+  void Swap(Event_EncounterEvent_Milestone* other);
+
+  // implements Message ----------------------------------------------
+
+  Event_EncounterEvent_Milestone* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const Event_EncounterEvent_Milestone& from);
+  void MergeFrom(const Event_EncounterEvent_Milestone& from);
+  void Clear();
+  bool IsInitialized() const;
+
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const;
+
+  // nested types ----------------------------------------------------
+
+  typedef Event_EncounterEvent_Milestone_StageType StageType;
+  static const StageType DHDecoded = Event_EncounterEvent_Milestone_StageType_DHDecoded;
+  static const StageType SecretComputed = Event_EncounterEvent_Milestone_StageType_SecretComputed;
+  static const StageType MatchingConverged = Event_EncounterEvent_Milestone_StageType_MatchingConverged;
+  static const StageType Confirmed = Event_EncounterEvent_Milestone_StageType_Confirmed;
+  static inline bool StageType_IsValid(int value) {
+    return Event_EncounterEvent_Milestone_StageType_IsValid(value);
+  }
+  static const StageType StageType_MIN =
+    Event_EncounterEvent_Milestone_StageType_StageType_MIN;
+  static const StageType StageType_MAX =
+    Event_EncounterEvent_Milestone_StageType_StageType_MAX;
+  static const int StageType_ARRAYSIZE =
+    Event_EncounterEvent_Milestone_StageType_StageType_ARRAYSIZE;
+  static inline const ::google::protobuf::EnumDescriptor*
+  StageType_descriptor() {
+    return Event_EncounterEvent_Milestone_StageType_descriptor();
+  }
+  static inline const ::std::string& StageType_Name(StageType value) {
+    return Event_EncounterEvent_Milestone_StageType_Name(value);
+  }
+  static inline bool StageType_Parse(const ::std::string& name,
+      StageType* value) {
+    return Event_EncounterEvent_Milestone_StageType_Parse(name, value);
+  }
+
+  // accessors -------------------------------------------------------
+
+  // required .EbNCore.Event.EncounterEvent.Milestone.StageType stage = 1;
+  inline bool has_stage() const;
+  inline void clear_stage();
+  static const int kStageFieldNumber = 1;
+  inline ::EbNCore::Event_EncounterEvent_Milestone_StageType stage() const;
+  inline void set_stage(::EbNCore::Event_EncounterEvent_Milestone_StageType value);
+
+  // required uint64 time = 2;
+  inline bool has_time() const;
+  inline void clear_time();
+  static const int kTimeFieldNumber = 2;
+  inline ::google::protobuf::uint64 time() const;
+  inline void set_time(::google::protobuf::uint64 value);
+
+  // required uint32 numAdverts = 3;
+  inline bool has_numadverts() const;
+  inline void clear_numadverts();
+  static const int kNumAdvertsFieldNumber = 3;
+  inline ::google::protobuf::uint32 numadverts() const;
+  inline void set_numadverts(::google::protobuf::uint32 value);
+
+  // @@protoc_insertion_point(class_scope:EbNCore.Event.EncounterEvent.Milestone)
+ private:
+  inline void set_has_stage();
+  inline void clear_has_stage();
+  inline void set_has_time();
+  inline void clear_has_time();
+  inline void set_has_numadverts();
+  inline void clear_has_numadverts();
+
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+
+  ::google::protobuf::uint64 time_;
+  int stage_;
+  ::google::protobuf::uint32 numadverts_;
+
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
+
+  friend void  protobuf_AddDesc_ebncore_2eproto();
+  friend void protobuf_AssignDesc_ebncore_2eproto();
+  friend void protobuf_ShutdownFile_ebncore_2eproto();
+
+  void InitAsDefaultInstance();
+  static Event_EncounterEvent_Milestone* default_instance_;
+};
+// -------------------------------------------------------------------
+
 class Event_EncounterEvent : public ::google::protobuf::Message {
  public:
   Event_EncounterEvent();
@@ -436,6 +591,7 @@ class Event_EncounterEvent : public ::google::protobuf::Message {
   // nested types ----------------------------------------------------
 
   typedef Event_EncounterEvent_RSSIEvent RSSIEvent;
+  typedef Event_EncounterEvent_Milestone Milestone;
 
   typedef Event_EncounterEvent_EventType EventType;
   static const EventType UnconfirmedStart = Event_EncounterEvent_EventType_UnconfirmedStart;
@@ -556,6 +712,18 @@ class Event_EncounterEvent : public ::google::protobuf::Message {
   inline bool matchingsetupdated() const;
   inline void set_matchingsetupdated(bool value);
 
+  // repeated .EbNCore.Event.EncounterEvent.Milestone milestones = 10;
+  inline int milestones_size() const;
+  inline void clear_milestones();
+  static const int kMilestonesFieldNumber = 10;
+  inline const ::EbNCore::Event_EncounterEvent_Milestone& milestones(int index) const;
+  inline ::EbNCore::Event_EncounterEvent_Milestone* mutable_milestones(int index);
+  inline ::EbNCore::Event_EncounterEvent_Milestone* add_milestones();
+  inline const ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_EncounterEvent_Milestone >&
+      milestones() const;
+  inline ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_EncounterEvent_Milestone >*
+      mutable_milestones();
+
   // @@protoc_insertion_point(class_scope:EbNCore.Event.EncounterEvent)
  private:
   inline void set_has_type();
@@ -581,10 +749,11 @@ class Event_EncounterEvent : public ::google::protobuf::Message {
   ::google::protobuf::RepeatedPtrField< ::std::string> matchingset_;
   ::google::protobuf::RepeatedPtrField< ::std::string> sharedsecrets_;
   ::google::protobuf::uint64 pkid_;
+  ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_EncounterEvent_Milestone > milestones_;
   bool matchingsetupdated_;
 
   mutable int _cached_size_;
-  ::google::protobuf::uint32 _has_bits_[(9 + 31) / 32];
+  ::google::protobuf::uint32 _has_bits_[(10 + 31) / 32];
 
   friend void  protobuf_AddDesc_ebncore_2eproto();
   friend void protobuf_AssignDesc_ebncore_2eproto();
@@ -677,14 +846,14 @@ class Event_SleepEvent : public ::google::protobuf::Message {
 };
 // -------------------------------------------------------------------
 
-class Event : public ::google::protobuf::Message {
+class Event_MetricsRequestEvent : public ::google::protobuf::Message {
  public:
-  Event();
-  virtual ~Event();
+  Event_MetricsRequestEvent();
+  virtual ~Event_MetricsRequestEvent();
 
-  Event(const Event& from);
+  Event_MetricsRequestEvent(const Event_MetricsRequestEvent& from);
 
-  inline Event& operator=(const Event& from) {
+  inline Event_MetricsRequestEvent& operator=(const Event_MetricsRequestEvent& from) {
     CopyFrom(from);
     return *this;
   }
@@ -698,17 +867,17 @@ class Event : public ::google::protobuf::Message {
   }
 
   static const ::google::protobuf::Descriptor* descriptor();
-  static const Event& default_instance();
+  static const Event_MetricsRequestEvent& default_instance();
 
-  void Swap(Event* other);
+  void Swap(Event_MetricsRequestEvent* other);
 
   // implements Message ----------------------------------------------
 
-  Event* New() const;
+  Event_MetricsRequestEvent* New() const;
   void CopyFrom(const ::google::protobuf::Message& from);
   void MergeFrom(const ::google::protobuf::Message& from);
-  void CopyFrom(const Event& from);
-  void MergeFrom(const Event& from);
+  void CopyFrom(const Event_MetricsRequestEvent& from);
+  void MergeFrom(const Event_MetricsRequestEvent& from);
   void Clear();
   bool IsInitialized() const;
 
@@ -729,180 +898,750 @@ class Event : public ::google::protobuf::Message {
 
   // nested types ----------------------------------------------------
 
-  typedef Event_LinkabilityEvent LinkabilityEvent;
-  typedef Event_EncounterEvent EncounterEvent;
-  typedef Event_SleepEvent SleepEvent;
-
   // accessors -------------------------------------------------------
 
-  // optional .EbNCore.Event.LinkabilityEvent linkabilityEvent = 1;
-  inline bool has_linkabilityevent() const;
-  inline void clear_linkabilityevent();
-  static const int kLinkabilityEventFieldNumber = 1;
-  inline const ::EbNCore::Event_LinkabilityEvent& linkabilityevent() const;
-  inline ::EbNCore::Event_LinkabilityEvent* mutable_linkabilityevent();
-  inline ::EbNCore::Event_LinkabilityEvent* release_linkabilityevent();
-  inline void set_allocated_linkabilityevent(::EbNCore::Event_LinkabilityEvent* linkabilityevent);
-
-  // optional .EbNCore.Event.EncounterEvent encounterEvent = 2;
-  inline bool has_encounterevent() const;
-  inline void clear_encounterevent();
-  static const int kEncounterEventFieldNumber = 2;
-  inline const ::EbNCore::Event_EncounterEvent& encounterevent() const;
-  inline ::EbNCore::Event_EncounterEvent* mutable_encounterevent();
-  inline ::EbNCore::Event_EncounterEvent* release_encounterevent();
-  inline void set_allocated_encounterevent(::EbNCore::Event_EncounterEvent* encounterevent);
-
-  // optional .EbNCore.Event.SleepEvent sleepEvent = 3;
-  inline bool has_sleepevent() const;
-  inline void clear_sleepevent();
-  static const int kSleepEventFieldNumber = 3;
-  inline const ::EbNCore::Event_SleepEvent& sleepevent() const;
-  inline ::EbNCore::Event_SleepEvent* mutable_sleepevent();
-  inline ::EbNCore::Event_SleepEvent* release_sleepevent();
-  inline void set_allocated_sleepevent(::EbNCore::Event_SleepEvent* sleepevent);
-
-  // @@protoc_insertion_point(class_scope:EbNCore.Event)
+  // @@protoc_insertion_point(class_scope:EbNCore.Event.MetricsRequestEvent)
  private:
-  inline void set_has_linkabilityevent();
-  inline void clear_has_linkabilityevent();
-  inline void set_has_encounterevent();
-  inline void clear_has_encounterevent();
-  inline void set_has_sleepevent();
-  inline void clear_has_sleepevent();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
-  ::EbNCore::Event_LinkabilityEvent* linkabilityevent_;
-  ::EbNCore::Event_EncounterEvent* encounterevent_;
-  ::EbNCore::Event_SleepEvent* sleepevent_;
 
   mutable int _cached_size_;
-  ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
+  ::google::protobuf::uint32 _has_bits_[1];
 
   friend void  protobuf_AddDesc_ebncore_2eproto();
   friend void protobuf_AssignDesc_ebncore_2eproto();
   friend void protobuf_ShutdownFile_ebncore_2eproto();
 
   void InitAsDefaultInstance();
-  static Event* default_instance_;
+  static Event_MetricsRequestEvent* default_instance_;
 };
-// ===================================================================
-
+// -------------------------------------------------------------------
 
-// ===================================================================
+class Event_MetricsEvent_Counter : public ::google::protobuf::Message {
+ public:
+  Event_MetricsEvent_Counter();
+  virtual ~Event_MetricsEvent_Counter();
 
-// Event_LinkabilityEvent_Entry
+  Event_MetricsEvent_Counter(const Event_MetricsEvent_Counter& from);
 
-// required bytes linkValue = 1;
-inline bool Event_LinkabilityEvent_Entry::has_linkvalue() const {
-  return (_has_bits_[0] & 0x00000001u) != 0;
-}
-inline void Event_LinkabilityEvent_Entry::set_has_linkvalue() {
-  _has_bits_[0] |= 0x00000001u;
-}
-inline void Event_LinkabilityEvent_Entry::clear_has_linkvalue() {
-  _has_bits_[0] &= ~0x00000001u;
-}
-inline void Event_LinkabilityEvent_Entry::clear_linkvalue() {
-  if (linkvalue_ != &::google::protobuf::internal::kEmptyString) {
-    linkvalue_->clear();
-  }
-  clear_has_linkvalue();
-}
-inline const ::std::string& Event_LinkabilityEvent_Entry::linkvalue() const {
-  return *linkvalue_;
-}
-inline void Event_LinkabilityEvent_Entry::set_linkvalue(const ::std::string& value) {
-  set_has_linkvalue();
-  if (linkvalue_ == &::google::protobuf::internal::kEmptyString) {
-    linkvalue_ = new ::std::string;
-  }
-  linkvalue_->assign(value);
-}
-inline void Event_LinkabilityEvent_Entry::set_linkvalue(const char* value) {
-  set_has_linkvalue();
-  if (linkvalue_ == &::google::protobuf::internal::kEmptyString) {
-    linkvalue_ = new ::std::string;
-  }
-  linkvalue_->assign(value);
-}
-inline void Event_LinkabilityEvent_Entry::set_linkvalue(const void* value, size_t size) {
-  set_has_linkvalue();
-  if (linkvalue_ == &::google::protobuf::internal::kEmptyString) {
-    linkvalue_ = new ::std::string;
-  }
-  linkvalue_->assign(reinterpret_cast<const char*>(value), size);
-}
-inline ::std::string* Event_LinkabilityEvent_Entry::mutable_linkvalue() {
-  set_has_linkvalue();
-  if (linkvalue_ == &::google::protobuf::internal::kEmptyString) {
-    linkvalue_ = new ::std::string;
-  }
-  return linkvalue_;
-}
-inline ::std::string* Event_LinkabilityEvent_Entry::release_linkvalue() {
-  clear_has_linkvalue();
-  if (linkvalue_ == &::google::protobuf::internal::kEmptyString) {
-    return NULL;
-  } else {
-    ::std::string* temp = linkvalue_;
-    linkvalue_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
-    return temp;
+  inline Event_MetricsEvent_Counter& operator=(const Event_MetricsEvent_Counter& from) {
+    CopyFrom(from);
+    return *this;
   }
-}
-inline void Event_LinkabilityEvent_Entry::set_allocated_linkvalue(::std::string* linkvalue) {
-  if (linkvalue_ != &::google::protobuf::internal::kEmptyString) {
-    delete linkvalue_;
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
   }
-  if (linkvalue) {
-    set_has_linkvalue();
-    linkvalue_ = linkvalue;
-  } else {
-    clear_has_linkvalue();
-    linkvalue_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
   }
-}
 
-// required .EbNCore.Event.LinkabilityEvent.Entry.ModeType mode = 2;
-inline bool Event_LinkabilityEvent_Entry::has_mode() const {
-  return (_has_bits_[0] & 0x00000002u) != 0;
-}
-inline void Event_LinkabilityEvent_Entry::set_has_mode() {
-  _has_bits_[0] |= 0x00000002u;
-}
-inline void Event_LinkabilityEvent_Entry::clear_has_mode() {
-  _has_bits_[0] &= ~0x00000002u;
-}
-inline void Event_LinkabilityEvent_Entry::clear_mode() {
-  mode_ = 0;
-  clear_has_mode();
-}
-inline ::EbNCore::Event_LinkabilityEvent_Entry_ModeType Event_LinkabilityEvent_Entry::mode() const {
-  return static_cast< ::EbNCore::Event_LinkabilityEvent_Entry_ModeType >(mode_);
-}
-inline void Event_LinkabilityEvent_Entry::set_mode(::EbNCore::Event_LinkabilityEvent_Entry_ModeType value) {
-  assert(::EbNCore::Event_LinkabilityEvent_Entry_ModeType_IsValid(value));
-  set_has_mode();
-  mode_ = value;
-}
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const Event_MetricsEvent_Counter& default_instance();
 
-// -------------------------------------------------------------------
+  void Swap(Event_MetricsEvent_Counter* other);
 
-// Event_LinkabilityEvent
+  // implements Message ----------------------------------------------
 
-// repeated .EbNCore.Event.LinkabilityEvent.Entry entries = 1;
-inline int Event_LinkabilityEvent::entries_size() const {
-  return entries_.size();
-}
-inline void Event_LinkabilityEvent::clear_entries() {
-  entries_.Clear();
-}
-inline const ::EbNCore::Event_LinkabilityEvent_Entry& Event_LinkabilityEvent::entries(int index) const {
-  return entries_.Get(index);
-}
-inline ::EbNCore::Event_LinkabilityEvent_Entry* Event_LinkabilityEvent::mutable_entries(int index) {
-  return entries_.Mutable(index);
+  Event_MetricsEvent_Counter* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const Event_MetricsEvent_Counter& from);
+  void MergeFrom(const Event_MetricsEvent_Counter& from);
+  void Clear();
+  bool IsInitialized() const;
+
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  // required string name = 1;
+  inline bool has_name() const;
+  inline void clear_name();
+  static const int kNameFieldNumber = 1;
+  inline const ::std::string& name() const;
+  inline void set_name(const ::std::string& value);
+  inline void set_name(const char* value);
+  inline void set_name(const char* value, size_t size);
+  inline ::std::string* mutable_name();
+  inline ::std::string* release_name();
+  inline void set_allocated_name(::std::string* name);
+
+  // required uint64 value = 2;
+  inline bool has_value() const;
+  inline void clear_value();
+  static const int kValueFieldNumber = 2;
+  inline ::google::protobuf::uint64 value() const;
+  inline void set_value(::google::protobuf::uint64 value);
+
+  // @@protoc_insertion_point(class_scope:EbNCore.Event.MetricsEvent.Counter)
+ private:
+  inline void set_has_name();
+  inline void clear_has_name();
+  inline void set_has_value();
+  inline void clear_has_value();
+
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+
+  ::std::string* name_;
+  ::google::protobuf::uint64 value_;
+
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
+
+  friend void  protobuf_AddDesc_ebncore_2eproto();
+  friend void protobuf_AssignDesc_ebncore_2eproto();
+  friend void protobuf_ShutdownFile_ebncore_2eproto();
+
+  void InitAsDefaultInstance();
+  static Event_MetricsEvent_Counter* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class Event_MetricsEvent_Histogram_Bucket : public ::google::protobuf::Message {
+ public:
+  Event_MetricsEvent_Histogram_Bucket();
+  virtual ~Event_MetricsEvent_Histogram_Bucket();
+
+  Event_MetricsEvent_Histogram_Bucket(const Event_MetricsEvent_Histogram_Bucket& from);
+
+  inline Event_MetricsEvent_Histogram_Bucket& operator=(const Event_MetricsEvent_Histogram_Bucket& from) {
+    CopyFrom(from);
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const Event_MetricsEvent_Histogram_Bucket& default_instance();
+
+  void Swap(Event_MetricsEvent_Histogram_Bucket* other);
+
+  // implements Message ----------------------------------------------
+
+  Event_MetricsEvent_Histogram_Bucket* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const Event_MetricsEvent_Histogram_Bucket& from);
+  void MergeFrom(const Event_MetricsEvent_Histogram_Bucket& from);
+  void Clear();
+  bool IsInitialized() const;
+
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  // required uint64 lowerBound = 1;
+  inline bool has_lowerbound() const;
+  inline void clear_lowerbound();
+  static const int kLowerBoundFieldNumber = 1;
+  inline ::google::protobuf::uint64 lowerbound() const;
+  inline void set_lowerbound(::google::protobuf::uint64 value);
+
+  // required uint64 count = 2;
+  inline bool has_count() const;
+  inline void clear_count();
+  static const int kCountFieldNumber = 2;
+  inline ::google::protobuf::uint64 count() const;
+  inline void set_count(::google::protobuf::uint64 value);
+
+  // @@protoc_insertion_point(class_scope:EbNCore.Event.MetricsEvent.Histogram.Bucket)
+ private:
+  inline void set_has_lowerbound();
+  inline void clear_has_lowerbound();
+  inline void set_has_count();
+  inline void clear_has_count();
+
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+
+  ::google::protobuf::uint64 lowerbound_;
+  ::google::protobuf::uint64 count_;
+
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(2 + 31) / 32];
+
+  friend void  protobuf_AddDesc_ebncore_2eproto();
+  friend void protobuf_AssignDesc_ebncore_2eproto();
+  friend void protobuf_ShutdownFile_ebncore_2eproto();
+
+  void InitAsDefaultInstance();
+  static Event_MetricsEvent_Histogram_Bucket* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class Event_MetricsEvent_Histogram : public ::google::protobuf::Message {
+ public:
+  Event_MetricsEvent_Histogram();
+  virtual ~Event_MetricsEvent_Histogram();
+
+  Event_MetricsEvent_Histogram(const Event_MetricsEvent_Histogram& from);
+
+  inline Event_MetricsEvent_Histogram& operator=(const Event_MetricsEvent_Histogram& from) {
+    CopyFrom(from);
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const Event_MetricsEvent_Histogram& default_instance();
+
+  void Swap(Event_MetricsEvent_Histogram* other);
+
+  // implements Message ----------------------------------------------
+
+  Event_MetricsEvent_Histogram* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const Event_MetricsEvent_Histogram& from);
+  void MergeFrom(const Event_MetricsEvent_Histogram& from);
+  void Clear();
+  bool IsInitialized() const;
+
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const;
+
+  // nested types ----------------------------------------------------
+
+  typedef Event_MetricsEvent_Histogram_Bucket Bucket;
+
+  // accessors -------------------------------------------------------
+
+  // required string name = 1;
+  inline bool has_name() const;
+  inline void clear_name();
+  static const int kNameFieldNumber = 1;
+  inline const ::std::string& name() const;
+  inline void set_name(const ::std::string& value);
+  inline void set_name(const char* value);
+  inline void set_name(const char* value, size_t size);
+  inline ::std::string* mutable_name();
+  inline ::std::string* release_name();
+  inline void set_allocated_name(::std::string* name);
+
+  // required uint64 count = 2;
+  inline bool has_count() const;
+  inline void clear_count();
+  static const int kCountFieldNumber = 2;
+  inline ::google::protobuf::uint64 count() const;
+  inline void set_count(::google::protobuf::uint64 value);
+
+  // required uint64 sum = 3;
+  inline bool has_sum() const;
+  inline void clear_sum();
+  static const int kSumFieldNumber = 3;
+  inline ::google::protobuf::uint64 sum() const;
+  inline void set_sum(::google::protobuf::uint64 value);
+
+  // required uint64 min = 4;
+  inline bool has_min() const;
+  inline void clear_min();
+  static const int kMinFieldNumber = 4;
+  inline ::google::protobuf::uint64 min() const;
+  inline void set_min(::google::protobuf::uint64 value);
+
+  // required uint64 max = 5;
+  inline bool has_max() const;
+  inline void clear_max();
+  static const int kMaxFieldNumber = 5;
+  inline ::google::protobuf::uint64 max() const;
+  inline void set_max(::google::protobuf::uint64 value);
+
+  // required uint64 p50 = 6;
+  inline bool has_p50() const;
+  inline void clear_p50();
+  static const int kP50FieldNumber = 6;
+  inline ::google::protobuf::uint64 p50() const;
+  inline void set_p50(::google::protobuf::uint64 value);
+
+  // required uint64 p90 = 7;
+  inline bool has_p90() const;
+  inline void clear_p90();
+  static const int kP90FieldNumber = 7;
+  inline ::google::protobuf::uint64 p90() const;
+  inline void set_p90(::google::protobuf::uint64 value);
+
+  // required uint64 p99 = 8;
+  inline bool has_p99() const;
+  inline void clear_p99();
+  static const int kP99FieldNumber = 8;
+  inline ::google::protobuf::uint64 p99() const;
+  inline void set_p99(::google::protobuf::uint64 value);
+
+  // repeated .EbNCore.Event.MetricsEvent.Histogram.Bucket buckets = 9;
+  inline int buckets_size() const;
+  inline void clear_buckets();
+  static const int kBucketsFieldNumber = 9;
+  inline const ::EbNCore::Event_MetricsEvent_Histogram_Bucket& buckets(int index) const;
+  inline ::EbNCore::Event_MetricsEvent_Histogram_Bucket* mutable_buckets(int index);
+  inline ::EbNCore::Event_MetricsEvent_Histogram_Bucket* add_buckets();
+  inline const ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Histogram_Bucket >&
+      buckets() const;
+  inline ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Histogram_Bucket >*
+      mutable_buckets();
+
+  // @@protoc_insertion_point(class_scope:EbNCore.Event.MetricsEvent.Histogram)
+ private:
+  inline void set_has_name();
+  inline void clear_has_name();
+  inline void set_has_count();
+  inline void clear_has_count();
+  inline void set_has_sum();
+  inline void clear_has_sum();
+  inline void set_has_min();
+  inline void clear_has_min();
+  inline void set_has_max();
+  inline void clear_has_max();
+  inline void set_has_p50();
+  inline void clear_has_p50();
+  inline void set_has_p90();
+  inline void clear_has_p90();
+  inline void set_has_p99();
+  inline void clear_has_p99();
+
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+
+  ::std::string* name_;
+  ::google::protobuf::uint64 count_;
+  ::google::protobuf::uint64 sum_;
+  ::google::protobuf::uint64 min_;
+  ::google::protobuf::uint64 max_;
+  ::google::protobuf::uint64 p50_;
+  ::google::protobuf::uint64 p90_;
+  ::google::protobuf::uint64 p99_;
+  ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Histogram_Bucket > buckets_;
+
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(9 + 31) / 32];
+
+  friend void  protobuf_AddDesc_ebncore_2eproto();
+  friend void protobuf_AssignDesc_ebncore_2eproto();
+  friend void protobuf_ShutdownFile_ebncore_2eproto();
+
+  void InitAsDefaultInstance();
+  static Event_MetricsEvent_Histogram* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class Event_MetricsEvent : public ::google::protobuf::Message {
+ public:
+  Event_MetricsEvent();
+  virtual ~Event_MetricsEvent();
+
+  Event_MetricsEvent(const Event_MetricsEvent& from);
+
+  inline Event_MetricsEvent& operator=(const Event_MetricsEvent& from) {
+    CopyFrom(from);
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const Event_MetricsEvent& default_instance();
+
+  void Swap(Event_MetricsEvent* other);
+
+  // implements Message ----------------------------------------------
+
+  Event_MetricsEvent* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const Event_MetricsEvent& from);
+  void MergeFrom(const Event_MetricsEvent& from);
+  void Clear();
+  bool IsInitialized() const;
+
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const;
+
+  // nested types ----------------------------------------------------
+
+  typedef Event_MetricsEvent_Counter Counter;
+  typedef Event_MetricsEvent_Histogram Histogram;
+
+  // accessors -------------------------------------------------------
+
+  // required uint64 time = 1;
+  inline bool has_time() const;
+  inline void clear_time();
+  static const int kTimeFieldNumber = 1;
+  inline ::google::protobuf::uint64 time() const;
+  inline void set_time(::google::protobuf::uint64 value);
+
+  // repeated .EbNCore.Event.MetricsEvent.Counter counters = 2;
+  inline int counters_size() const;
+  inline void clear_counters();
+  static const int kCountersFieldNumber = 2;
+  inline const ::EbNCore::Event_MetricsEvent_Counter& counters(int index) const;
+  inline ::EbNCore::Event_MetricsEvent_Counter* mutable_counters(int index);
+  inline ::EbNCore::Event_MetricsEvent_Counter* add_counters();
+  inline const ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Counter >&
+      counters() const;
+  inline ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Counter >*
+      mutable_counters();
+
+  // repeated .EbNCore.Event.MetricsEvent.Histogram histograms = 3;
+  inline int histograms_size() const;
+  inline void clear_histograms();
+  static const int kHistogramsFieldNumber = 3;
+  inline const ::EbNCore::Event_MetricsEvent_Histogram& histograms(int index) const;
+  inline ::EbNCore::Event_MetricsEvent_Histogram* mutable_histograms(int index);
+  inline ::EbNCore::Event_MetricsEvent_Histogram* add_histograms();
+  inline const ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Histogram >&
+      histograms() const;
+  inline ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Histogram >*
+      mutable_histograms();
+
+  // @@protoc_insertion_point(class_scope:EbNCore.Event.MetricsEvent)
+ private:
+  inline void set_has_time();
+  inline void clear_has_time();
+
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+
+  ::google::protobuf::uint64 time_;
+  ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Counter > counters_;
+  ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Histogram > histograms_;
+
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(3 + 31) / 32];
+
+  friend void  protobuf_AddDesc_ebncore_2eproto();
+  friend void protobuf_AssignDesc_ebncore_2eproto();
+  friend void protobuf_ShutdownFile_ebncore_2eproto();
+
+  void InitAsDefaultInstance();
+  static Event_MetricsEvent* default_instance_;
+};
+// -------------------------------------------------------------------
+
+class Event : public ::google::protobuf::Message {
+ public:
+  Event();
+  virtual ~Event();
+
+  Event(const Event& from);
+
+  inline Event& operator=(const Event& from) {
+    CopyFrom(from);
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const Event& default_instance();
+
+  void Swap(Event* other);
+
+  // implements Message ----------------------------------------------
+
+  Event* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const Event& from);
+  void MergeFrom(const Event& from);
+  void Clear();
+  bool IsInitialized() const;
+
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+
+  ::google::protobuf::Metadata GetMetadata() const;
+
+  // nested types ----------------------------------------------------
+
+  typedef Event_LinkabilityEvent LinkabilityEvent;
+  typedef Event_EncounterEvent EncounterEvent;
+  typedef Event_SleepEvent SleepEvent;
+  typedef Event_MetricsRequestEvent MetricsRequestEvent;
+  typedef Event_MetricsEvent MetricsEvent;
+
+  // accessors -------------------------------------------------------
+
+  // optional .EbNCore.Event.LinkabilityEvent linkabilityEvent = 1;
+  inline bool has_linkabilityevent() const;
+  inline void clear_linkabilityevent();
+  static const int kLinkabilityEventFieldNumber = 1;
+  inline const ::EbNCore::Event_LinkabilityEvent& linkabilityevent() const;
+  inline ::EbNCore::Event_LinkabilityEvent* mutable_linkabilityevent();
+  inline ::EbNCore::Event_LinkabilityEvent* release_linkabilityevent();
+  inline void set_allocated_linkabilityevent(::EbNCore::Event_LinkabilityEvent* linkabilityevent);
+
+  // optional .EbNCore.Event.EncounterEvent encounterEvent = 2;
+  inline bool has_encounterevent() const;
+  inline void clear_encounterevent();
+  static const int kEncounterEventFieldNumber = 2;
+  inline const ::EbNCore::Event_EncounterEvent& encounterevent() const;
+  inline ::EbNCore::Event_EncounterEvent* mutable_encounterevent();
+  inline ::EbNCore::Event_EncounterEvent* release_encounterevent();
+  inline void set_allocated_encounterevent(::EbNCore::Event_EncounterEvent* encounterevent);
+
+  // optional .EbNCore.Event.SleepEvent sleepEvent = 3;
+  inline bool has_sleepevent() const;
+  inline void clear_sleepevent();
+  static const int kSleepEventFieldNumber = 3;
+  inline const ::EbNCore::Event_SleepEvent& sleepevent() const;
+  inline ::EbNCore::Event_SleepEvent* mutable_sleepevent();
+  inline ::EbNCore::Event_SleepEvent* release_sleepevent();
+  inline void set_allocated_sleepevent(::EbNCore::Event_SleepEvent* sleepevent);
+
+  // optional .EbNCore.Event.MetricsRequestEvent metricsRequestEvent = 4;
+  inline bool has_metricsrequestevent() const;
+  inline void clear_metricsrequestevent();
+  static const int kMetricsRequestEventFieldNumber = 4;
+  inline const ::EbNCore::Event_MetricsRequestEvent& metricsrequestevent() const;
+  inline ::EbNCore::Event_MetricsRequestEvent* mutable_metricsrequestevent();
+  inline ::EbNCore::Event_MetricsRequestEvent* release_metricsrequestevent();
+  inline void set_allocated_metricsrequestevent(::EbNCore::Event_MetricsRequestEvent* metricsrequestevent);
+
+  // optional .EbNCore.Event.MetricsEvent metricsEvent = 5;
+  inline bool has_metricsevent() const;
+  inline void clear_metricsevent();
+  static const int kMetricsEventFieldNumber = 5;
+  inline const ::EbNCore::Event_MetricsEvent& metricsevent() const;
+  inline ::EbNCore::Event_MetricsEvent* mutable_metricsevent();
+  inline ::EbNCore::Event_MetricsEvent* release_metricsevent();
+  inline void set_allocated_metricsevent(::EbNCore::Event_MetricsEvent* metricsevent);
+
+  // @@protoc_insertion_point(class_scope:EbNCore.Event)
+ private:
+  inline void set_has_linkabilityevent();
+  inline void clear_has_linkabilityevent();
+  inline void set_has_encounterevent();
+  inline void clear_has_encounterevent();
+  inline void set_has_sleepevent();
+  inline void clear_has_sleepevent();
+  inline void set_has_metricsrequestevent();
+  inline void clear_has_metricsrequestevent();
+  inline void set_has_metricsevent();
+  inline void clear_has_metricsevent();
+
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+
+  ::EbNCore::Event_LinkabilityEvent* linkabilityevent_;
+  ::EbNCore::Event_EncounterEvent* encounterevent_;
+  ::EbNCore::Event_SleepEvent* sleepevent_;
+  ::EbNCore::Event_MetricsRequestEvent* metricsrequestevent_;
+  ::EbNCore::Event_MetricsEvent* metricsevent_;
+
+  mutable int _cached_size_;
+  ::google::protobuf::uint32 _has_bits_[(5 + 31) / 32];
+
+  friend void  protobuf_AddDesc_ebncore_2eproto();
+  friend void protobuf_AssignDesc_ebncore_2eproto();
+  friend void protobuf_ShutdownFile_ebncore_2eproto();
+
+  void InitAsDefaultInstance();
+  static Event* default_instance_;
+};
+// ===================================================================
+
+
+// ===================================================================
+
+// Event_LinkabilityEvent_Entry
+
+// required bytes linkValue = 1;
+inline bool Event_LinkabilityEvent_Entry::has_linkvalue() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void Event_LinkabilityEvent_Entry::set_has_linkvalue() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void Event_LinkabilityEvent_Entry::clear_has_linkvalue() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void Event_LinkabilityEvent_Entry::clear_linkvalue() {
+  if (linkvalue_ != &::google::protobuf::internal::kEmptyString) {
+    linkvalue_->clear();
+  }
+  clear_has_linkvalue();
+}
+inline const ::std::string& Event_LinkabilityEvent_Entry::linkvalue() const {
+  return *linkvalue_;
+}
+inline void Event_LinkabilityEvent_Entry::set_linkvalue(const ::std::string& value) {
+  set_has_linkvalue();
+  if (linkvalue_ == &::google::protobuf::internal::kEmptyString) {
+    linkvalue_ = new ::std::string;
+  }
+  linkvalue_->assign(value);
+}
+inline void Event_LinkabilityEvent_Entry::set_linkvalue(const char* value) {
+  set_has_linkvalue();
+  if (linkvalue_ == &::google::protobuf::internal::kEmptyString) {
+    linkvalue_ = new ::std::string;
+  }
+  linkvalue_->assign(value);
+}
+inline void Event_LinkabilityEvent_Entry::set_linkvalue(const void* value, size_t size) {
+  set_has_linkvalue();
+  if (linkvalue_ == &::google::protobuf::internal::kEmptyString) {
+    linkvalue_ = new ::std::string;
+  }
+  linkvalue_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* Event_LinkabilityEvent_Entry::mutable_linkvalue() {
+  set_has_linkvalue();
+  if (linkvalue_ == &::google::protobuf::internal::kEmptyString) {
+    linkvalue_ = new ::std::string;
+  }
+  return linkvalue_;
+}
+inline ::std::string* Event_LinkabilityEvent_Entry::release_linkvalue() {
+  clear_has_linkvalue();
+  if (linkvalue_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = linkvalue_;
+    linkvalue_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+inline void Event_LinkabilityEvent_Entry::set_allocated_linkvalue(::std::string* linkvalue) {
+  if (linkvalue_ != &::google::protobuf::internal::kEmptyString) {
+    delete linkvalue_;
+  }
+  if (linkvalue) {
+    set_has_linkvalue();
+    linkvalue_ = linkvalue;
+  } else {
+    clear_has_linkvalue();
+    linkvalue_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  }
+}
+
+// required .EbNCore.Event.LinkabilityEvent.Entry.ModeType mode = 2;
+inline bool Event_LinkabilityEvent_Entry::has_mode() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void Event_LinkabilityEvent_Entry::set_has_mode() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void Event_LinkabilityEvent_Entry::clear_has_mode() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void Event_LinkabilityEvent_Entry::clear_mode() {
+  mode_ = 0;
+  clear_has_mode();
+}
+inline ::EbNCore::Event_LinkabilityEvent_Entry_ModeType Event_LinkabilityEvent_Entry::mode() const {
+  return static_cast< ::EbNCore::Event_LinkabilityEvent_Entry_ModeType >(mode_);
+}
+inline void Event_LinkabilityEvent_Entry::set_mode(::EbNCore::Event_LinkabilityEvent_Entry_ModeType value) {
+  assert(::EbNCore::Event_LinkabilityEvent_Entry_ModeType_IsValid(value));
+  set_has_mode();
+  mode_ = value;
+}
+
+// -------------------------------------------------------------------
+
+// Event_LinkabilityEvent
+
+// repeated .EbNCore.Event.LinkabilityEvent.Entry entries = 1;
+inline int Event_LinkabilityEvent::entries_size() const {
+  return entries_.size();
+}
+inline void Event_LinkabilityEvent::clear_entries() {
+  entries_.Clear();
+}
+inline const ::EbNCore::Event_LinkabilityEvent_Entry& Event_LinkabilityEvent::entries(int index) const {
+  return entries_.Get(index);
+}
+inline ::EbNCore::Event_LinkabilityEvent_Entry* Event_LinkabilityEvent::mutable_entries(int index) {
+  return entries_.Mutable(index);
 }
 inline ::EbNCore::Event_LinkabilityEvent_Entry* Event_LinkabilityEvent::add_entries() {
   return entries_.Add();
@@ -937,31 +1676,102 @@ inline void Event_EncounterEvent_RSSIEvent::clear_time() {
 inline ::google::protobuf::uint64 Event_EncounterEvent_RSSIEvent::time() const {
   return time_;
 }
-inline void Event_EncounterEvent_RSSIEvent::set_time(::google::protobuf::uint64 value) {
+inline void Event_EncounterEvent_RSSIEvent::set_time(::google::protobuf::uint64 value) {
+  set_has_time();
+  time_ = value;
+}
+
+// required sint32 rssi = 2;
+inline bool Event_EncounterEvent_RSSIEvent::has_rssi() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void Event_EncounterEvent_RSSIEvent::set_has_rssi() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void Event_EncounterEvent_RSSIEvent::clear_has_rssi() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void Event_EncounterEvent_RSSIEvent::clear_rssi() {
+  rssi_ = 0;
+  clear_has_rssi();
+}
+inline ::google::protobuf::int32 Event_EncounterEvent_RSSIEvent::rssi() const {
+  return rssi_;
+}
+inline void Event_EncounterEvent_RSSIEvent::set_rssi(::google::protobuf::int32 value) {
+  set_has_rssi();
+  rssi_ = value;
+}
+
+// -------------------------------------------------------------------
+
+// Event_EncounterEvent_Milestone
+
+// required .EbNCore.Event.EncounterEvent.Milestone.StageType stage = 1;
+inline bool Event_EncounterEvent_Milestone::has_stage() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void Event_EncounterEvent_Milestone::set_has_stage() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void Event_EncounterEvent_Milestone::clear_has_stage() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void Event_EncounterEvent_Milestone::clear_stage() {
+  stage_ = 0;
+  clear_has_stage();
+}
+inline ::EbNCore::Event_EncounterEvent_Milestone_StageType Event_EncounterEvent_Milestone::stage() const {
+  return static_cast< ::EbNCore::Event_EncounterEvent_Milestone_StageType >(stage_);
+}
+inline void Event_EncounterEvent_Milestone::set_stage(::EbNCore::Event_EncounterEvent_Milestone_StageType value) {
+  assert(::EbNCore::Event_EncounterEvent_Milestone_StageType_IsValid(value));
+  set_has_stage();
+  stage_ = value;
+}
+
+// required uint64 time = 2;
+inline bool Event_EncounterEvent_Milestone::has_time() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void Event_EncounterEvent_Milestone::set_has_time() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void Event_EncounterEvent_Milestone::clear_has_time() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void Event_EncounterEvent_Milestone::clear_time() {
+  time_ = GOOGLE_ULONGLONG(0);
+  clear_has_time();
+}
+inline ::google::protobuf::uint64 Event_EncounterEvent_Milestone::time() const {
+  return time_;
+}
+inline void Event_EncounterEvent_Milestone::set_time(::google::protobuf::uint64 value) {
   set_has_time();
   time_ = value;
 }
 
-// required sint32 rssi = 2;
-inline bool Event_EncounterEvent_RSSIEvent::has_rssi() const {
-  return (_has_bits_[0] & 0x00000002u) != 0;
+// required uint32 numAdverts = 3;
+inline bool Event_EncounterEvent_Milestone::has_numadverts() const {
+  return (_has_bits_[0] & 0x00000004u) != 0;
 }
-inline void Event_EncounterEvent_RSSIEvent::set_has_rssi() {
-  _has_bits_[0] |= 0x00000002u;
+inline void Event_EncounterEvent_Milestone::set_has_numadverts() {
+  _has_bits_[0] |= 0x00000004u;
 }
-inline void Event_EncounterEvent_RSSIEvent::clear_has_rssi() {
-  _has_bits_[0] &= ~0x00000002u;
+inline void Event_EncounterEvent_Milestone::clear_has_numadverts() {
+  _has_bits_[0] &= ~0x00000004u;
 }
-inline void Event_EncounterEvent_RSSIEvent::clear_rssi() {
-  rssi_ = 0;
-  clear_has_rssi();
+inline void Event_EncounterEvent_Milestone::clear_numadverts() {
+  numadverts_ = 0u;
+  clear_has_numadverts();
 }
-inline ::google::protobuf::int32 Event_EncounterEvent_RSSIEvent::rssi() const {
-  return rssi_;
+inline ::google::protobuf::uint32 Event_EncounterEvent_Milestone::numadverts() const {
+  return numadverts_;
 }
-inline void Event_EncounterEvent_RSSIEvent::set_rssi(::google::protobuf::int32 value) {
-  set_has_rssi();
-  rssi_ = value;
+inline void Event_EncounterEvent_Milestone::set_numadverts(::google::protobuf::uint32 value) {
+  set_has_numadverts();
+  numadverts_ = value;
 }
 
 // -------------------------------------------------------------------
@@ -1262,6 +2072,31 @@ inline void Event_EncounterEvent::set_matchingsetupdated(bool value) {
   matchingsetupdated_ = value;
 }
 
+// repeated .EbNCore.Event.EncounterEvent.Milestone milestones = 10;
+inline int Event_EncounterEvent::milestones_size() const {
+  return milestones_.size();
+}
+inline void Event_EncounterEvent::clear_milestones() {
+  milestones_.Clear();
+}
+inline const ::EbNCore::Event_EncounterEvent_Milestone& Event_EncounterEvent::milestones(int index) const {
+  return milestones_.Get(index);
+}
+inline ::EbNCore::Event_EncounterEvent_Milestone* Event_EncounterEvent::mutable_milestones(int index) {
+  return milestones_.Mutable(index);
+}
+inline ::EbNCore::Event_EncounterEvent_Milestone* Event_EncounterEvent::add_milestones() {
+  return milestones_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_EncounterEvent_Milestone >&
+Event_EncounterEvent::milestones() const {
+  return milestones_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_EncounterEvent_Milestone >*
+Event_EncounterEvent::mutable_milestones() {
+  return &milestones_;
+}
+
 // -------------------------------------------------------------------
 
 // Event_SleepEvent
@@ -1290,6 +2125,483 @@ inline void Event_SleepEvent::set_duration(::google::protobuf::uint64 value) {
 
 // -------------------------------------------------------------------
 
+// Event_MetricsRequestEvent
+
+// -------------------------------------------------------------------
+
+// Event_MetricsEvent_Counter
+
+// required string name = 1;
+inline bool Event_MetricsEvent_Counter::has_name() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void Event_MetricsEvent_Counter::set_has_name() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void Event_MetricsEvent_Counter::clear_has_name() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void Event_MetricsEvent_Counter::clear_name() {
+  if (name_ != &::google::protobuf::internal::kEmptyString) {
+    name_->clear();
+  }
+  clear_has_name();
+}
+inline const ::std::string& Event_MetricsEvent_Counter::name() const {
+  return *name_;
+}
+inline void Event_MetricsEvent_Counter::set_name(const ::std::string& value) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(value);
+}
+inline void Event_MetricsEvent_Counter::set_name(const char* value) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(value);
+}
+inline void Event_MetricsEvent_Counter::set_name(const char* value, size_t size) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* Event_MetricsEvent_Counter::mutable_name() {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  return name_;
+}
+inline ::std::string* Event_MetricsEvent_Counter::release_name() {
+  clear_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = name_;
+    name_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+inline void Event_MetricsEvent_Counter::set_allocated_name(::std::string* name) {
+  if (name_ != &::google::protobuf::internal::kEmptyString) {
+    delete name_;
+  }
+  if (name) {
+    set_has_name();
+    name_ = name;
+  } else {
+    clear_has_name();
+    name_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  }
+}
+
+// required uint64 value = 2;
+inline bool Event_MetricsEvent_Counter::has_value() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void Event_MetricsEvent_Counter::set_has_value() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void Event_MetricsEvent_Counter::clear_has_value() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void Event_MetricsEvent_Counter::clear_value() {
+  value_ = GOOGLE_ULONGLONG(0);
+  clear_has_value();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent_Counter::value() const {
+  return value_;
+}
+inline void Event_MetricsEvent_Counter::set_value(::google::protobuf::uint64 value) {
+  set_has_value();
+  value_ = value;
+}
+
+// -------------------------------------------------------------------
+
+// Event_MetricsEvent_Histogram_Bucket
+
+// required uint64 lowerBound = 1;
+inline bool Event_MetricsEvent_Histogram_Bucket::has_lowerbound() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void Event_MetricsEvent_Histogram_Bucket::set_has_lowerbound() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void Event_MetricsEvent_Histogram_Bucket::clear_has_lowerbound() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void Event_MetricsEvent_Histogram_Bucket::clear_lowerbound() {
+  lowerbound_ = GOOGLE_ULONGLONG(0);
+  clear_has_lowerbound();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent_Histogram_Bucket::lowerbound() const {
+  return lowerbound_;
+}
+inline void Event_MetricsEvent_Histogram_Bucket::set_lowerbound(::google::protobuf::uint64 value) {
+  set_has_lowerbound();
+  lowerbound_ = value;
+}
+
+// required uint64 count = 2;
+inline bool Event_MetricsEvent_Histogram_Bucket::has_count() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void Event_MetricsEvent_Histogram_Bucket::set_has_count() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void Event_MetricsEvent_Histogram_Bucket::clear_has_count() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void Event_MetricsEvent_Histogram_Bucket::clear_count() {
+  count_ = GOOGLE_ULONGLONG(0);
+  clear_has_count();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent_Histogram_Bucket::count() const {
+  return count_;
+}
+inline void Event_MetricsEvent_Histogram_Bucket::set_count(::google::protobuf::uint64 value) {
+  set_has_count();
+  count_ = value;
+}
+
+// -------------------------------------------------------------------
+
+// Event_MetricsEvent_Histogram
+
+// required string name = 1;
+inline bool Event_MetricsEvent_Histogram::has_name() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void Event_MetricsEvent_Histogram::set_has_name() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void Event_MetricsEvent_Histogram::clear_has_name() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void Event_MetricsEvent_Histogram::clear_name() {
+  if (name_ != &::google::protobuf::internal::kEmptyString) {
+    name_->clear();
+  }
+  clear_has_name();
+}
+inline const ::std::string& Event_MetricsEvent_Histogram::name() const {
+  return *name_;
+}
+inline void Event_MetricsEvent_Histogram::set_name(const ::std::string& value) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(value);
+}
+inline void Event_MetricsEvent_Histogram::set_name(const char* value) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(value);
+}
+inline void Event_MetricsEvent_Histogram::set_name(const char* value, size_t size) {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  name_->assign(reinterpret_cast<const char*>(value), size);
+}
+inline ::std::string* Event_MetricsEvent_Histogram::mutable_name() {
+  set_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    name_ = new ::std::string;
+  }
+  return name_;
+}
+inline ::std::string* Event_MetricsEvent_Histogram::release_name() {
+  clear_has_name();
+  if (name_ == &::google::protobuf::internal::kEmptyString) {
+    return NULL;
+  } else {
+    ::std::string* temp = name_;
+    name_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+    return temp;
+  }
+}
+inline void Event_MetricsEvent_Histogram::set_allocated_name(::std::string* name) {
+  if (name_ != &::google::protobuf::internal::kEmptyString) {
+    delete name_;
+  }
+  if (name) {
+    set_has_name();
+    name_ = name;
+  } else {
+    clear_has_name();
+    name_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  }
+}
+
+// required uint64 count = 2;
+inline bool Event_MetricsEvent_Histogram::has_count() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void Event_MetricsEvent_Histogram::set_has_count() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void Event_MetricsEvent_Histogram::clear_has_count() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void Event_MetricsEvent_Histogram::clear_count() {
+  count_ = GOOGLE_ULONGLONG(0);
+  clear_has_count();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent_Histogram::count() const {
+  return count_;
+}
+inline void Event_MetricsEvent_Histogram::set_count(::google::protobuf::uint64 value) {
+  set_has_count();
+  count_ = value;
+}
+
+// required uint64 sum = 3;
+inline bool Event_MetricsEvent_Histogram::has_sum() const {
+  return (_has_bits_[0] & 0x00000004u) != 0;
+}
+inline void Event_MetricsEvent_Histogram::set_has_sum() {
+  _has_bits_[0] |= 0x00000004u;
+}
+inline void Event_MetricsEvent_Histogram::clear_has_sum() {
+  _has_bits_[0] &= ~0x00000004u;
+}
+inline void Event_MetricsEvent_Histogram::clear_sum() {
+  sum_ = GOOGLE_ULONGLONG(0);
+  clear_has_sum();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent_Histogram::sum() const {
+  return sum_;
+}
+inline void Event_MetricsEvent_Histogram::set_sum(::google::protobuf::uint64 value) {
+  set_has_sum();
+  sum_ = value;
+}
+
+// required uint64 min = 4;
+inline bool Event_MetricsEvent_Histogram::has_min() const {
+  return (_has_bits_[0] & 0x00000008u) != 0;
+}
+inline void Event_MetricsEvent_Histogram::set_has_min() {
+  _has_bits_[0] |= 0x00000008u;
+}
+inline void Event_MetricsEvent_Histogram::clear_has_min() {
+  _has_bits_[0] &= ~0x00000008u;
+}
+inline void Event_MetricsEvent_Histogram::clear_min() {
+  min_ = GOOGLE_ULONGLONG(0);
+  clear_has_min();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent_Histogram::min() const {
+  return min_;
+}
+inline void Event_MetricsEvent_Histogram::set_min(::google::protobuf::uint64 value) {
+  set_has_min();
+  min_ = value;
+}
+
+// required uint64 max = 5;
+inline bool Event_MetricsEvent_Histogram::has_max() const {
+  return (_has_bits_[0] & 0x00000010u) != 0;
+}
+inline void Event_MetricsEvent_Histogram::set_has_max() {
+  _has_bits_[0] |= 0x00000010u;
+}
+inline void Event_MetricsEvent_Histogram::clear_has_max() {
+  _has_bits_[0] &= ~0x00000010u;
+}
+inline void Event_MetricsEvent_Histogram::clear_max() {
+  max_ = GOOGLE_ULONGLONG(0);
+  clear_has_max();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent_Histogram::max() const {
+  return max_;
+}
+inline void Event_MetricsEvent_Histogram::set_max(::google::protobuf::uint64 value) {
+  set_has_max();
+  max_ = value;
+}
+
+// required uint64 p50 = 6;
+inline bool Event_MetricsEvent_Histogram::has_p50() const {
+  return (_has_bits_[0] & 0x00000020u) != 0;
+}
+inline void Event_MetricsEvent_Histogram::set_has_p50() {
+  _has_bits_[0] |= 0x00000020u;
+}
+inline void Event_MetricsEvent_Histogram::clear_has_p50() {
+  _has_bits_[0] &= ~0x00000020u;
+}
+inline void Event_MetricsEvent_Histogram::clear_p50() {
+  p50_ = GOOGLE_ULONGLONG(0);
+  clear_has_p50();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent_Histogram::p50() const {
+  return p50_;
+}
+inline void Event_MetricsEvent_Histogram::set_p50(::google::protobuf::uint64 value) {
+  set_has_p50();
+  p50_ = value;
+}
+
+// required uint64 p90 = 7;
+inline bool Event_MetricsEvent_Histogram::has_p90() const {
+  return (_has_bits_[0] & 0x00000040u) != 0;
+}
+inline void Event_MetricsEvent_Histogram::set_has_p90() {
+  _has_bits_[0] |= 0x00000040u;
+}
+inline void Event_MetricsEvent_Histogram::clear_has_p90() {
+  _has_bits_[0] &= ~0x00000040u;
+}
+inline void Event_MetricsEvent_Histogram::clear_p90() {
+  p90_ = GOOGLE_ULONGLONG(0);
+  clear_has_p90();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent_Histogram::p90() const {
+  return p90_;
+}
+inline void Event_MetricsEvent_Histogram::set_p90(::google::protobuf::uint64 value) {
+  set_has_p90();
+  p90_ = value;
+}
+
+// required uint64 p99 = 8;
+inline bool Event_MetricsEvent_Histogram::has_p99() const {
+  return (_has_bits_[0] & 0x00000080u) != 0;
+}
+inline void Event_MetricsEvent_Histogram::set_has_p99() {
+  _has_bits_[0] |= 0x00000080u;
+}
+inline void Event_MetricsEvent_Histogram::clear_has_p99() {
+  _has_bits_[0] &= ~0x00000080u;
+}
+inline void Event_MetricsEvent_Histogram::clear_p99() {
+  p99_ = GOOGLE_ULONGLONG(0);
+  clear_has_p99();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent_Histogram::p99() const {
+  return p99_;
+}
+inline void Event_MetricsEvent_Histogram::set_p99(::google::protobuf::uint64 value) {
+  set_has_p99();
+  p99_ = value;
+}
+
+// repeated .EbNCore.Event.MetricsEvent.Histogram.Bucket buckets = 9;
+inline int Event_MetricsEvent_Histogram::buckets_size() const {
+  return buckets_.size();
+}
+inline void Event_MetricsEvent_Histogram::clear_buckets() {
+  buckets_.Clear();
+}
+inline const ::EbNCore::Event_MetricsEvent_Histogram_Bucket& Event_MetricsEvent_Histogram::buckets(int index) const {
+  return buckets_.Get(index);
+}
+inline ::EbNCore::Event_MetricsEvent_Histogram_Bucket* Event_MetricsEvent_Histogram::mutable_buckets(int index) {
+  return buckets_.Mutable(index);
+}
+inline ::EbNCore::Event_MetricsEvent_Histogram_Bucket* Event_MetricsEvent_Histogram::add_buckets() {
+  return buckets_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Histogram_Bucket >&
+Event_MetricsEvent_Histogram::buckets() const {
+  return buckets_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Histogram_Bucket >*
+Event_MetricsEvent_Histogram::mutable_buckets() {
+  return &buckets_;
+}
+
+// -------------------------------------------------------------------
+
+// Event_MetricsEvent
+
+// required uint64 time = 1;
+inline bool Event_MetricsEvent::has_time() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void Event_MetricsEvent::set_has_time() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void Event_MetricsEvent::clear_has_time() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void Event_MetricsEvent::clear_time() {
+  time_ = GOOGLE_ULONGLONG(0);
+  clear_has_time();
+}
+inline ::google::protobuf::uint64 Event_MetricsEvent::time() const {
+  return time_;
+}
+inline void Event_MetricsEvent::set_time(::google::protobuf::uint64 value) {
+  set_has_time();
+  time_ = value;
+}
+
+// repeated .EbNCore.Event.MetricsEvent.Counter counters = 2;
+inline int Event_MetricsEvent::counters_size() const {
+  return counters_.size();
+}
+inline void Event_MetricsEvent::clear_counters() {
+  counters_.Clear();
+}
+inline const ::EbNCore::Event_MetricsEvent_Counter& Event_MetricsEvent::counters(int index) const {
+  return counters_.Get(index);
+}
+inline ::EbNCore::Event_MetricsEvent_Counter* Event_MetricsEvent::mutable_counters(int index) {
+  return counters_.Mutable(index);
+}
+inline ::EbNCore::Event_MetricsEvent_Counter* Event_MetricsEvent::add_counters() {
+  return counters_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Counter >&
+Event_MetricsEvent::counters() const {
+  return counters_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Counter >*
+Event_MetricsEvent::mutable_counters() {
+  return &counters_;
+}
+
+// repeated .EbNCore.Event.MetricsEvent.Histogram histograms = 3;
+inline int Event_MetricsEvent::histograms_size() const {
+  return histograms_.size();
+}
+inline void Event_MetricsEvent::clear_histograms() {
+  histograms_.Clear();
+}
+inline const ::EbNCore::Event_MetricsEvent_Histogram& Event_MetricsEvent::histograms(int index) const {
+  return histograms_.Get(index);
+}
+inline ::EbNCore::Event_MetricsEvent_Histogram* Event_MetricsEvent::mutable_histograms(int index) {
+  return histograms_.Mutable(index);
+}
+inline ::EbNCore::Event_MetricsEvent_Histogram* Event_MetricsEvent::add_histograms() {
+  return histograms_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Histogram >&
+Event_MetricsEvent::histograms() const {
+  return histograms_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::EbNCore::Event_MetricsEvent_Histogram >*
+Event_MetricsEvent::mutable_histograms() {
+  return &histograms_;
+}
+
+// -------------------------------------------------------------------
+
 // Event
 
 // optional .EbNCore.Event.LinkabilityEvent linkabilityEvent = 1;
@@ -1406,6 +2718,82 @@ inline void Event::set_allocated_sleepevent(::EbNCore::Event_SleepEvent* sleepev
   }
 }
 
+// optional .EbNCore.Event.MetricsRequestEvent metricsRequestEvent = 4;
+inline bool Event::has_metricsrequestevent() const {
+  return (_has_bits_[0] & 0x00000008u) != 0;
+}
+inline void Event::set_has_metricsrequestevent() {
+  _has_bits_[0] |= 0x00000008u;
+}
+inline void Event::clear_has_metricsrequestevent() {
+  _has_bits_[0] &= ~0x00000008u;
+}
+inline void Event::clear_metricsrequestevent() {
+  if (metricsrequestevent_ != NULL) metricsrequestevent_->::EbNCore::Event_MetricsRequestEvent::Clear();
+  clear_has_metricsrequestevent();
+}
+inline const ::EbNCore::Event_MetricsRequestEvent& Event::metricsrequestevent() const {
+  return metricsrequestevent_ != NULL ? *metricsrequestevent_ : *default_instance_->metricsrequestevent_;
+}
+inline ::EbNCore::Event_MetricsRequestEvent* Event::mutable_metricsrequestevent() {
+  set_has_metricsrequestevent();
+  if (metricsrequestevent_ == NULL) metricsrequestevent_ = new ::EbNCore::Event_MetricsRequestEvent;
+  return metricsrequestevent_;
+}
+inline ::EbNCore::Event_MetricsRequestEvent* Event::release_metricsrequestevent() {
+  clear_has_metricsrequestevent();
+  ::EbNCore::Event_MetricsRequestEvent* temp = metricsrequestevent_;
+  metricsrequestevent_ = NULL;
+  return temp;
+}
+inline void Event::set_allocated_metricsrequestevent(::EbNCore::Event_MetricsRequestEvent* metricsrequestevent) {
+  delete metricsrequestevent_;
+  metricsrequestevent_ = metricsrequestevent;
+  if (metricsrequestevent) {
+    set_has_metricsrequestevent();
+  } else {
+    clear_has_metricsrequestevent();
+  }
+}
+
+// optional .EbNCore.Event.MetricsEvent metricsEvent = 5;
+inline bool Event::has_metricsevent() const {
+  return (_has_bits_[0] & 0x00000010u) != 0;
+}
+inline void Event::set_has_metricsevent() {
+  _has_bits_[0] |= 0x00000010u;
+}
+inline void Event::clear_has_metricsevent() {
+  _has_bits_[0] &= ~0x00000010u;
+}
+inline void Event::clear_metricsevent() {
+  if (metricsevent_ != NULL) metricsevent_->::EbNCore::Event_MetricsEvent::Clear();
+  clear_has_metricsevent();
+}
+inline const ::EbNCore::Event_MetricsEvent& Event::metricsevent() const {
+  return metricsevent_ != NULL ? *metricsevent_ : *default_instance_->metricsevent_;
+}
+inline ::EbNCore::Event_MetricsEvent* Event::mutable_metricsevent() {
+  set_has_metricsevent();
+  if (metricsevent_ == NULL) metricsevent_ = new ::EbNCore::Event_MetricsEvent;
+  return metricsevent_;
+}
+inline ::EbNCore::Event_MetricsEvent* Event::release_metricsevent() {
+  clear_has_metricsevent();
+  ::EbNCore::Event_MetricsEvent* temp = metricsevent_;
+  metricsevent_ = NULL;
+  return temp;
+}
+inline void Event::set_allocated_metricsevent(::EbNCore::Event_MetricsEvent* metricsevent) {
+  delete metricsevent_;
+  metricsevent_ = metricsevent;
+  if (metricsevent) {
+    set_has_metricsevent();
+  } else {
+    clear_has_metricsevent();
+  }
+}
+
 
 // @@protoc_insertion_point(namespace_scope)
 
@@ -1420,6 +2808,10 @@ inline const EnumDescriptor* GetEnumDescriptor< ::EbNCore::Event_LinkabilityEven
   return ::EbNCore::Event_LinkabilityEvent_Entry_ModeType_descriptor();
 }
 template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::EbNCore::Event_EncounterEvent_Milestone_StageType>() {
+  return ::EbNCore::Event_EncounterEvent_Milestone_StageType_descriptor();
+}
+template <>
 inline const EnumDescriptor* GetEnumDescriptor< ::EbNCore::Event_EncounterEvent_EventType>() {
   return ::EbNCore::Event_EncounterEvent_EventType_descriptor();
 }
@@ -32,6 +32,58 @@ LOCAL_MODULE := crypto
 LOCAL_SRC_FILES := $(AOSP_ROOT)/out/target/product/$(PHONEMODEL)/obj/lib/libcrypto.so
 include $(PREBUILT_SHARED_LIBRARY)
 
+# Source file information, shared by the application and the benchmarks
+COMMON_SOURCE_FILES := $(SOURCE_ROOT)/Address.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/AndroidBluetooth.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/AndroidWake.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/Base64.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/BinaryToUTF8.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/BitMap.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/BloomFilter.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/BluetoothHCI.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/CaptureHCIBackend.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/Clock.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/Config.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/ConnectionAcceptor.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/ConnectionManager.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/CrowdGenerator.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/DHDecodeBench.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNController.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNDevice.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNDeviceBT2.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNDeviceBT4.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNDeviceBT4AR.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNDeviceBT5.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNHystPolicy.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNRadio.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNRadioBT2.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNRadioBT2NR.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNRadioBT2PSI.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNRadioBT4.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNRadioBT4AR.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/EbNRadioBT5.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/ECDH.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/GF256.cpp.neon
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/GF256Eliminator.cpp.neon
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/HCIBackend.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/HCICapture.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/HCIReactor.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/HCIReplay.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/KernelHCIBackend.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/Logger.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/Metrics.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/RecognitionBench.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/RSDecodingCache.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/RSErasureDecoder.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/RSErasureEncoder.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/RSMatrix.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/SegmentedBloomFilter.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/SharedArray.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/SipHash.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/VirtualClock.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/VirtualHCIBackend.cpp
+COMMON_SOURCE_FILES += $(SOURCE_ROOT)/VirtualMedium.cpp
+
 # Executable - Main SDDR application
 include $(CLEAR_VARS)
 
@@ -39,35 +91,7 @@ LOCAL_MODULE := sddr
 
 LOCAL_CFLAGS += -D$(PHONEMODEL_CAPS) -DLOG_W_ENABLED -DLOG_D_ENABLED -DLOG_P_ENABLED
 
-LOCAL_SRC_FILES := $(SOURCE_ROOT)/Address.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/AndroidBluetooth.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/AndroidWake.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/Base64.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/BinaryToUTF8.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/BitMap.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/BloomFilter.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/BluetoothHCI.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/Config.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNController.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNDevice.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNDeviceBT2.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNDeviceBT4.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNDeviceBT4AR.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNHystPolicy.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNRadio.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNRadioBT2.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNRadioBT2NR.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNRadioBT2PSI.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNRadioBT4.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/EbNRadioBT4AR.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/ECDH.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/Logger.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/RSErasureDecoder.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/RSErasureEncoder.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/RSMatrix.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/SegmentedBloomFilter.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/SharedArray.cpp
-LOCAL_SRC_FILES += $(SOURCE_ROOT)/SipHash.cpp
+LOCAL_SRC_FILES := $(COMMON_SOURCE_FILES)
 LOCAL_SRC_FILES += $(SOURCE_ROOT)/Main.cpp
 LOCAL_SRC_FILES += $(SOURCE_ROOT)/ebncore.pb.cc
 
@@ -84,6 +108,31 @@ LOCAL_STATIC_LIBRARIES += jl10psi gmp protobuf jerasure csiphash
 
 include $(BUILD_EXECUTABLE)
 
+# Executable - Microbenchmarks for the primitives on our hot paths. Built
+# without debug and parse logging, which would otherwise dominate the timings.
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := sddr_bench
+
+LOCAL_CFLAGS += -D$(PHONEMODEL_CAPS) -DLOG_W_ENABLED
+
+LOCAL_SRC_FILES := $(COMMON_SOURCE_FILES)
+LOCAL_SRC_FILES += $(SOURCE_ROOT)/Microbench.cpp
+LOCAL_SRC_FILES += $(SOURCE_ROOT)/BenchMain.cpp
+
+LOCAL_C_INCLUDES += $(INCLUDE_ROOT)
+LOCAL_C_INCLUDES += $(THIRDPARTY_ROOT)
+LOCAL_C_INCLUDES += $(THIRDPARTY_ROOT)/google/src
+LOCAL_C_INCLUDES += $(AOSP_ROOT)/external/openssl/include
+LOCAL_C_INCLUDES += $(AOSP_ROOT)/system/core/include
+
+LOCAL_LDLIBS += -llog
+
+LOCAL_SHARED_LIBRARIES += bluetooth crypto c cutils dl
+LOCAL_STATIC_LIBRARIES += jl10psi gmp protobuf jerasure csiphash
+
+include $(BUILD_EXECUTABLE)
+
 # Building necessary third-party modules
 include $(THIRDPARTY_ROOT)/Android.mk
 
@@ -0,0 +1,517 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <optionparser/optionparser.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Address.h"
+#include "Base64.h"
+#include "BinaryToUTF8.h"
+#include "BitMap.h"
+#include "BloomFilter.h"
+#include "Config.h"
+#include "ECDH.h"
+#include "EbNRadioBT2.h"
+#include "EbNRadioBT2NR.h"
+#include "EbNRadioBT4.h"
+#include "EbNRadioBT5.h"
+#include "Logger.h"
+#include "Microbench.h"
+#include "RSErasureDecoder.h"
+#include "RSErasureEncoder.h"
+#include "SegmentedBloomFilter.h"
+#include "SipHash.h"
+#include "Timing.h"
+#include "VirtualMedium.h"
+
+using namespace std;
+
+uint64_t sddrStartTimestamp = getTimeMS();
+
+// Counting every allocation made by the benchmarks (and anything they call
+// into), where the array and nothrow forms all end up here
+void* operator new(size_t size)
+{
+  Microbench::countAllocation(size);
+
+  void *ptr = malloc((size > 0) ? size : 1);
+  if(ptr == NULL)
+  {
+    throw bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+  free(ptr);
+}
+
+struct Arg: public option::Arg
+{
+  static option::ArgStatus NonEmpty(const option::Option &opt, bool msg)
+  {
+    if((opt.arg != NULL) && (opt.arg[0] != 0))
+    {
+      return option::ARG_OK;
+    }
+
+    if(msg)
+    {
+      LOG_E("Options", "Option %s requires an argument.", opt.name);
+    }
+    return option::ARG_ILLEGAL;
+  }
+
+  static option::ArgStatus Numeric(const option::Option &opt, bool msg)
+  {
+    char *end = NULL;
+    if(opt.arg != 0)
+    {
+      strtol(opt.arg, &end, 10);
+    }
+    if((end != opt.arg) && (*end == 0))
+    {
+      return option::ARG_OK;
+    }
+
+    if(msg)
+    {
+      LOG_E("Options", "Option %s requires a numeric argument.\n", opt.name);
+    }
+    return option::ARG_ILLEGAL;
+  }
+
+  static option::ArgStatus Format(const option::Option &opt, bool msg)
+  {
+    if((opt.arg != NULL) && (Microbench::stringToFormat(opt.arg) != Microbench::Format::END))
+    {
+      return option::ARG_OK;
+    }
+
+    if(msg)
+    {
+      LOG_E("Options", "Option %s is invalid, must use one of: Text, CSV, JSON", opt.name);
+    }
+    return option::ARG_ILLEGAL;
+  }
+
+  static option::ArgStatus Unknown(const option::Option& opt, bool msg)
+  {
+    if(msg)
+    {
+      LOG_E("Options", "Unknown option %s.\n", opt.name);
+    }
+    return option::ARG_ILLEGAL;
+  }
+};
+
+enum optionIndex { UNKNOWN, HELP, FILTER, FORMAT, MINTIME, REPEATS, ENTRIES };
+const option::Descriptor usage[] =
+{
+  {UNKNOWN, 0,  "",        "", Arg::Unknown,  "USAGE: sddr_bench [options]\n\nOptions:\n"},
+  {HELP,    0, "h",    "help", Arg::None,     " --help     (-h)  Print this help information.\n"},
+  {FILTER,  0, "f",  "filter", Arg::NonEmpty, " --filter=<text> (-f) Only run the benchmarks whose names contain the text.\n"},
+  {FORMAT,  0,  "",  "format", Arg::Format,   " --format=<format> (  ) Output format: Text, CSV, JSON. The default is 'Text'.\n"},
+  {MINTIME, 0,  "", "min-time", Arg::Numeric, " --min-time=# (  ) Minimum time (in ms) of each timed batch. The default is\n"
+                                              "                  200.\n"},
+  {REPEATS, 0,  "", "repeats", Arg::Numeric,  " --repeats=# (  )  Number of timed batches, keeping the fastest. The default\n"
+                                              "                  is 5.\n"},
+  {ENTRIES, 0, "e", "entries", Arg::Numeric,  " --entries=# (-e)  Number of random entries in the advertised/listen sets\n"
+                                              "                  used by the radio benchmarks. The default is 32.\n"},
+  {0, 0, 0, 0, 0, 0}
+};
+
+vector<uint8_t> randomBytes(size_t size)
+{
+  vector<uint8_t> bytes(size);
+  for(size_t b = 0; b < size; b++)
+  {
+    bytes[b] = rand() & 0xFF;
+  }
+  return bytes;
+}
+
+void addPrimitives(Microbench &bench, size_t keySize)
+{
+  const size_t valueSize = keySize / 8;
+  const size_t numValues = 64;
+
+  shared_ptr<vector<vector<uint8_t> > > values(new vector<vector<uint8_t> >());
+  for(size_t v = 0; v < numValues; v++)
+  {
+    values->push_back(randomBytes(valueSize));
+  }
+  shared_ptr<vector<uint8_t> > prefix(new vector<uint8_t>(randomBytes(valueSize)));
+
+  // Same shape as the Bloom filter in a BT2 advert
+  shared_ptr<BloomFilter> bloom(new BloomFilter(256, 1536, 4));
+  for(size_t v = 0; v < numValues; v += 2)
+  {
+    bloom->add(prefix->data(), prefix->size(), (*values)[v].data(), valueSize);
+  }
+
+  bench.add("BloomFilter/Add", [=](uint64_t iterations)
+  {
+    BloomFilter added(256, 1536, 4);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      added.add(prefix->data(), prefix->size(), (*values)[i % numValues].data(), valueSize);
+    }
+    Microbench::keep(added);
+  });
+
+  bench.add("BloomFilter/Query", [=](uint64_t iterations)
+  {
+    size_t numFound = 0;
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      numFound += bloom->query(prefix->data(), prefix->size(), (*values)[i % numValues].data(), valueSize);
+    }
+    Microbench::keep(numFound);
+  });
+
+  bench.add("SegmentedBloomFilter/SetSegment", [=](uint64_t iterations)
+  {
+    vector<uint8_t> segment(randomBytes(64));
+    SegmentedBloomFilter segmented(256, 2 * 200, 1, 2);
+    float pFalse = 0;
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      pFalse += segmented.setSegment(i % 2, segment.data(), i % 8);
+    }
+    Microbench::keep(pFalse);
+  });
+
+  // Unaligned copies, which go through BitMap::bitcpy()
+  bench.add("BitMap/CopyFrom", [=](uint64_t iterations)
+  {
+    BitMap bits(31 * 8);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      bits.copyFrom((*values)[i % numValues].data(), 3, 5 + (i % 8), keySize - 8);
+    }
+    Microbench::keep(bits);
+  });
+
+  bench.add("BitMap/CopyTo", [=](uint64_t iterations)
+  {
+    BitMap bits(31 * 8, randomBytes(31).data());
+    vector<uint8_t> dest(valueSize);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      bits.copyTo(dest.data(), 0, 5 + (i % 8), keySize);
+    }
+    Microbench::keep(dest);
+  });
+
+  bench.add("SipHash/Digest", [=](uint64_t iterations)
+  {
+    uint64_t digest = 0;
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      digest ^= GSipHash().digest((*values)[i % numValues].data(), valueSize);
+    }
+    Microbench::keep(digest);
+  });
+
+  shared_ptr<vector<Address> > addresses(new vector<Address>());
+  for(size_t a = 0; a < numValues; a++)
+  {
+    addresses->push_back(Address::generate(6));
+  }
+
+  bench.add("Address/Hash", [=](uint64_t iterations)
+  {
+    Address::Hash hash;
+    size_t digest = 0;
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      digest ^= hash((*addresses)[i % numValues]);
+    }
+    Microbench::keep(digest);
+  });
+
+  shared_ptr<ECDH> local(new ECDH(keySize));
+  shared_ptr<ECDH> remote(new ECDH(keySize));
+
+  bench.add("ECDH/GenerateSecret", [=](uint64_t iterations)
+  {
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      local->generateSecret();
+    }
+  });
+
+  bench.add("ECDH/ComputeSharedSecret", [=](uint64_t iterations)
+  {
+    size_t numComputed = 0;
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      SharedSecret secret;
+      numComputed += local->computeSharedSecret(secret, remote->getPublicX(), remote->getPublicY());
+    }
+    Microbench::keep(numComputed);
+  });
+
+  // Same sizes as a BT2NR name and a BT2 EIR advert
+  const size_t utf8Bits = 1723;
+  shared_ptr<vector<uint8_t> > utf8Data(new vector<uint8_t>(randomBytes((utf8Bits + 7) / 8)));
+  shared_ptr<string> utf8Encoded(new string(BinaryToUTF8::encode(utf8Data->data(), utf8Bits)));
+
+  bench.add("BinaryToUTF8/Encode", [=](uint64_t iterations)
+  {
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      string encoded = BinaryToUTF8::encode(utf8Data->data(), utf8Bits);
+      Microbench::keep(encoded);
+    }
+  });
+
+  bench.add("BinaryToUTF8/Decode", [=](uint64_t iterations)
+  {
+    vector<uint8_t> decoded(utf8Data->size() + 1);
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      BinaryToUTF8::decode(decoded.data(), *utf8Encoded);
+    }
+    Microbench::keep(decoded);
+  });
+
+  shared_ptr<vector<uint8_t> > base64Data(new vector<uint8_t>(randomBytes(240)));
+  shared_ptr<string> base64Encoded(new string(Base64::encode(base64Data->data(), base64Data->size())));
+
+  bench.add("Base64/Encode", [=](uint64_t iterations)
+  {
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      string encoded = Base64::encode(base64Data->data(), base64Data->size());
+      Microbench::keep(encoded);
+    }
+  });
+
+  bench.add("Base64/Decode", [=](uint64_t iterations)
+  {
+    vector<uint8_t> decoded(Base64::getDecodedSize(*base64Encoded));
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      Base64::decode(decoded.data(), *base64Encoded);
+    }
+    Microbench::keep(decoded);
+  });
+}
+
+// Uses the parameters of the BT4 radio's code for the DH public value, where
+// decoding is from coding symbols only (the worst case)
+void addErasureCoding(Microbench &bench, shared_ptr<EbNRadioBT4> radio)
+{
+  const RSMatrix &matrix = radio->getDHCodeMatrix();
+  shared_ptr<vector<uint8_t> > data(new vector<uint8_t>(randomBytes(matrix.K() * matrix.W())));
+
+  bench.add("RSErasureEncoder/Encode", [=](uint64_t iterations)
+  {
+    RSErasureEncoder encoder(radio->getDHCodeMatrix());
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      encoder.encode(data->data());
+    }
+    Microbench::keep(encoder);
+  });
+
+  bench.add("RSErasureDecoder/Decode", [=](uint64_t iterations)
+  {
+    const RSMatrix &matrix = radio->getDHCodeMatrix();
+    RSErasureEncoder encoder(matrix);
+    encoder.encode(data->data());
+
+    RSErasureDecoder decoder(matrix);
+    size_t numDecoded = 0;
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      size_t start = matrix.K() + (i % (matrix.M() - matrix.K() + 1));
+      decoder.reset();
+      for(size_t k = 0; k < matrix.K(); k++)
+      {
+        decoder.setSymbol(start + k, encoder.getSymbol(start + k));
+      }
+      numDecoded += (decoder.decode() != NULL);
+    }
+    Microbench::keep(numDecoded);
+  });
+}
+
+// Generating every advert of an epoch in turn, and processing them in the
+// same order into a device, which is replaced at the start of each epoch so
+// that every pass does the full amount of work
+template <typename Radio, typename Device>
+void addAdverts(Microbench &bench, const string &name, shared_ptr<Radio> sender, shared_ptr<Radio> receiver, const LinkValueList &listenSet)
+{
+  const size_t numAdverts = sender->getNumAdverts();
+  const uint64_t interval = sender->getDiscoverInterval();
+
+  shared_ptr<vector<BitMap> > adverts(new vector<BitMap>());
+  for(size_t a = 0; a < numAdverts; a++)
+  {
+    adverts->push_back(sender->generateAdvert(a));
+  }
+
+  bench.add(name + "/GenerateAdvert", [=](uint64_t iterations)
+  {
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      BitMap advert = sender->generateAdvert(i % numAdverts);
+      Microbench::keep(advert);
+    }
+  });
+
+  bench.add(name + "/ProcessAdvert", [=](uint64_t iterations)
+  {
+    unique_ptr<Device> device;
+    uint64_t startTime = getTimeMS();
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      size_t a = i % numAdverts;
+      if(a == 0)
+      {
+        device.reset(new Device(0, Address(), listenSet));
+      }
+
+      receiver->processAdvert(device.get(), startTime + (a * interval), (*adverts)[a].toByteArray());
+      receiver->processEpochs(device.get());
+    }
+  });
+}
+
+template <typename Radio>
+shared_ptr<Radio> createRadio(size_t keySize, int adapterID, const LinkValueList &linkValues)
+{
+  shared_ptr<Radio> radio(new Radio(keySize, Radio::getDefaultConfirmScheme(), EbNRadio::MemoryScheme::Standard, adapterID));
+  radio->setAdvertisedSet(linkValues);
+  radio->setListenSet(linkValues);
+  return radio;
+}
+
+// BT2 devices carry the remote's clock offset and page scan mode as well
+struct BenchDeviceBT2 : public EbNDeviceBT2
+{
+  BenchDeviceBT2(DeviceID id, const Address &address, const LinkValueList &listenSet)
+     : EbNDeviceBT2(id, address, 0, 0, listenSet)
+  {
+  }
+};
+
+void addRadios(Microbench &bench, size_t keySize, const LinkValueList &linkValues)
+{
+  int adapterID = 0;
+
+  shared_ptr<EbNRadioBT2> senderBT2 = createRadio<EbNRadioBT2>(keySize, adapterID++, linkValues);
+  shared_ptr<EbNRadioBT2> receiverBT2 = createRadio<EbNRadioBT2>(keySize, adapterID++, linkValues);
+  addAdverts<EbNRadioBT2, BenchDeviceBT2>(bench, "BT2", senderBT2, receiverBT2, linkValues);
+
+  // A BT2NR advert is the whole of its name, so there is only one per epoch
+  shared_ptr<EbNRadioBT2NR> senderBT2NR = createRadio<EbNRadioBT2NR>(keySize, adapterID++, linkValues);
+  shared_ptr<EbNRadioBT2NR> receiverBT2NR = createRadio<EbNRadioBT2NR>(keySize, adapterID++, linkValues);
+  shared_ptr<BitMap> advertBT2NR(new BitMap(senderBT2NR->generateAdvert()));
+
+  bench.add("BT2NR/GenerateAdvert", [=](uint64_t iterations)
+  {
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      BitMap advert = senderBT2NR->generateAdvert();
+      Microbench::keep(advert);
+    }
+  });
+
+  bench.add("BT2NR/ProcessAdvert", [=](uint64_t iterations)
+  {
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+      EbNDeviceBT2 device(0, Address(), 0, 0, linkValues);
+      receiverBT2NR->processAdvert(&device, advertBT2NR->toByteArray());
+    }
+  });
+
+  shared_ptr<EbNRadioBT4> senderBT4 = createRadio<EbNRadioBT4>(keySize, adapterID++, linkValues);
+  shared_ptr<EbNRadioBT4> receiverBT4 = createRadio<EbNRadioBT4>(keySize, adapterID++, linkValues);
+  addAdverts<EbNRadioBT4, EbNDeviceBT4>(bench, "BT4", senderBT4, receiverBT4, linkValues);
+
+  shared_ptr<EbNRadioBT4> senderBT4RL(new EbNRadioBT4(keySize, EbNRadioBT4::getDefaultConfirmScheme(), EbNRadio::MemoryScheme::Standard, adapterID++, true));
+  shared_ptr<EbNRadioBT4> receiverBT4RL(new EbNRadioBT4(keySize, EbNRadioBT4::getDefaultConfirmScheme(), EbNRadio::MemoryScheme::Standard, adapterID++, true));
+  senderBT4RL->setAdvertisedSet(linkValues);
+  receiverBT4RL->setListenSet(linkValues);
+  addAdverts<EbNRadioBT4, EbNDeviceBT4>(bench, "BT4RL", senderBT4RL, receiverBT4RL, linkValues);
+
+  shared_ptr<EbNRadioBT5> senderBT5 = createRadio<EbNRadioBT5>(keySize, adapterID++, linkValues);
+  shared_ptr<EbNRadioBT5> receiverBT5 = createRadio<EbNRadioBT5>(keySize, adapterID++, linkValues);
+  addAdverts<EbNRadioBT5, EbNDeviceBT5>(bench, "BT5", senderBT5, receiverBT5, linkValues);
+
+  addErasureCoding(bench, senderBT4);
+}
+
+int main(int argc, char **argv)
+{
+  srand(getTimeUS());
+  logger->setLogcatEnabled(false);
+  logger->setScreenEnabled(true);
+
+  argc -= (argc > 0); argv += (argc > 0);
+  option::Stats stats(usage, argc, argv);
+  option::Option options[stats.options_max], buffer[stats.buffer_max];
+  option::Parser parse(usage, argc, argv, options, buffer);
+
+  try
+  {
+    if(parse.error())
+    {
+      return 1;
+    }
+
+    if(options[HELP])
+    {
+      option::printUsage(cout, usage);
+      return 0;
+    }
+
+    string filter = options[FILTER] ? options[FILTER].arg : "";
+    Microbench::Format format = options[FORMAT] ? Microbench::stringToFormat(options[FORMAT].arg) : Microbench::Format::Text;
+    uint64_t minTime = options[MINTIME] ? strtoul(options[MINTIME].arg, NULL, 10) : 200;
+    size_t numRepeats = options[REPEATS] ? max<long>(strtol(options[REPEATS].arg, NULL, 10), 1) : 5;
+    size_t numEntries = options[ENTRIES] ? strtoul(options[ENTRIES].arg, NULL, 10) : 32;
+
+    const size_t keySize = configDefaults.radio.keySize;
+    const size_t linkValueSize = keySize / 8;
+
+    LinkValueList linkValues;
+    for(size_t n = 0; n < numEntries; n++)
+    {
+      LinkValue linkValue(new uint8_t[linkValueSize], linkValueSize);
+      for(size_t b = 0; b < linkValueSize; b++)
+      {
+        linkValue[b] = rand() & 0xFF;
+      }
+      linkValues.push_back(linkValue);
+    }
+
+    // The radios are only used for their advert generation and processing,
+    // but still need an adapter to be created on
+    shared_ptr<VirtualMedium> medium(new VirtualMedium(VirtualMedium::getDefaultConfig()));
+    HCIBackend::setFactory(medium->getFactory());
+
+    Microbench bench(minTime, numRepeats, filter);
+    addPrimitives(bench, keySize);
+    addRadios(bench, keySize, linkValues);
+    bench.run(format);
+  }
+  catch(const std::exception &ex)
+  {
+    LOG_E("Main", "Exception Occurred: %s", ex.what());
+    return 1;
+  }
+
+  return 0;
+}
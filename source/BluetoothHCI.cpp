@@ -1,20 +1,13 @@
 #include "BluetoothHCI.h"
 
 #include <cerrno>
-#include <fcntl.h>
-#include <future>
 #include <poll.h>
-#include <stdlib.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 #include <vector>
 #include <sstream>
 
 #include "bluetooth/hci_lib.h"
-#include "bluetooth/l2cap.h"
-#include "bluetooth/rfcomm.h"
 
-#include "AndroidBluetooth.h"
 #include "Logger.h"
 #include "Timing.h"
 
@@ -30,12 +23,21 @@ void LOG_E_BT_CRASH(const std::string &tag, const std::string &msg, const std::s
 }
 
 BluetoothHCI::BluetoothHCI(int adapterID)
-   : adapterID_(adapterID),
-     sock_(-1),
-     lastKnownState_()
+   : BluetoothHCI(HCIBackend::create(adapterID))
 {
-  sock_ = hci_open_dev(adapterID);
-  if(sock_ < 0)
+}
+
+BluetoothHCI::BluetoothHCI(shared_ptr<HCIBackend> backend)
+   : adapterID_(backend->getAdapterID()),
+     backend_(backend),
+     clock_(Clock::getDefault()),
+     reactor_(*backend),
+     lastKnownState_(),
+     appliedState_(),
+     advertUpdate_(),
+     commandStats_()
+{
+  if(backend_->open() < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
@@ -50,11 +52,14 @@ BluetoothHCI::~BluetoothHCI()
   {
     enableAdvertising(false);
   }
-
-  if(sock_ != -1)
+  if(lastKnownState_.isExtAdvertisingStored && lastKnownState_.isExtAdvertising)
   {
-    hci_close_dev(sock_);
+    enableExtAdvertising(false);
   }
+
+  logCommandStats();
+
+  backend_->close();
 }
 
 void BluetoothHCI::readState()
@@ -63,7 +68,7 @@ void BluetoothHCI::readState()
   memset(&deviceInfo, 0, sizeof(deviceInfo));
 
   int error;
-  if((error = hci_devinfo(adapterID_, &deviceInfo)) < 0)
+  if((error = backend_->readDeviceInfo(&deviceInfo)) < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
@@ -75,14 +80,34 @@ void BluetoothHCI::readState()
     return;
   }
 
-  lastKnownState_.publicAddress = Address(6, deviceInfo.bdaddr.b);
-  lastKnownState_.publicAddressStored = true;
+  appliedState_.publicAddress = Address(6, deviceInfo.bdaddr.b);
+  appliedState_.publicAddressStored = true;
 
-  lastKnownState_.isConnectable = (hci_test_bit(HCI_PSCAN, &deviceInfo.flags) != 0);
-  lastKnownState_.isConnectableStored = true;
+  appliedState_.isConnectable = (hci_test_bit(HCI_PSCAN, &deviceInfo.flags) != 0);
+  appliedState_.isConnectableStored = true;
 
-  lastKnownState_.isDiscoverable = (hci_test_bit(HCI_ISCAN, &deviceInfo.flags) != 0);
-  lastKnownState_.isDiscoverableStored = true;
+  appliedState_.isDiscoverable = (hci_test_bit(HCI_ISCAN, &deviceInfo.flags) != 0);
+  appliedState_.isDiscoverableStored = true;
+
+  // Only taking on the controller's values if we have not set our own, since
+  // otherwise they are the ones to restore after a reset
+  if(!lastKnownState_.publicAddressStored)
+  {
+    lastKnownState_.publicAddress = appliedState_.publicAddress;
+    lastKnownState_.publicAddressStored = true;
+  }
+
+  if(!lastKnownState_.isConnectableStored)
+  {
+    lastKnownState_.isConnectable = appliedState_.isConnectable;
+    lastKnownState_.isConnectableStored = true;
+  }
+
+  if(!lastKnownState_.isDiscoverableStored)
+  {
+    lastKnownState_.isDiscoverable = appliedState_.isDiscoverable;
+    lastKnownState_.isDiscoverableStored = true;
+  }
 }
 
 void BluetoothHCI::setConnectable(bool value)
@@ -103,27 +128,50 @@ void BluetoothHCI::setDiscoverable(bool value)
 
 void BluetoothHCI::setInquiryMode(InquiryMode value)
 {
+  const uint16_t opcode = cmd_opcode_pack(OGF_HOST_CTL, OCF_WRITE_INQUIRY_MODE);
+
   lastKnownState_.inquiryMode = value;
   lastKnownState_.inquiryModeStored = true;
 
+  if(appliedState_.inquiryModeStored && (appliedState_.inquiryMode == value))
+  {
+    recordSkipped(opcode);
+    return;
+  }
+
+  uint64_t sendTime = clock_->getMonoUS();
+
+  write_inquiry_mode_cp param;
+  param.mode = value;
+
   int error;
-  if((error = hci_write_inquiry_mode(sock_, value, 0)) < 0)
+  if((error = sendRequest(opcode, &param, WRITE_INQUIRY_MODE_CP_SIZE, NULL, 0, COMMAND_TIMEOUT)) < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
+
+  recordCommand(opcode, sendTime);
+
+  appliedState_.inquiryMode = value;
+  appliedState_.inquiryModeStored = true;
 }
 
 Address BluetoothHCI::getPublicAddress()
 {
-  bdaddr_t address;
-  int error;
+  const uint16_t opcode = cmd_opcode_pack(OGF_INFO_PARAM, OCF_READ_BD_ADDR);
 
-  if((error = hci_read_bd_addr(sock_, &address, 0)) < 0)
+  read_bd_addr_rp reply;
+  uint64_t sendTime = clock_->getMonoUS();
+
+  int error;
+  if((error = sendRequest(opcode, NULL, 0, &reply, READ_BD_ADDR_RP_SIZE, COMMAND_TIMEOUT)) < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
 
-  return Address(6, address.b);
+  recordCommand(opcode, sendTime);
+
+  return Address(6, reply.bdaddr.b);
 }
 
 Address BluetoothHCI::getRandomAddress()
@@ -143,86 +191,58 @@ void BluetoothHCI::setPublicAddress(const Address &address)
   lastKnownState_.publicAddress = address;
   lastKnownState_.publicAddressStored = true;
 
-  // TODO: NOT compatible across systems with different host byte orders
-  Address swappedAddress = address.swap();
-
-  close(sock_);
-  bt_disable(adapterID_);
-  system(("echo \"" + swappedAddress.toString() + "\" > `getprop ro.bt.bdaddr_path`").c_str());
-  while(true)
-  {
-    try
-    {
-      bt_enable(adapterID_);
-      break;
-    }
-    catch(BluetoothHCIException ex)
-    {
-      LOG_D("BluetoothHCI", "Failed to enable adapter %d - %s", adapterID_, ex.what());
-      bt_disable(adapterID_);
-    }
-  }
-
-  sock_ = hci_open_dev(adapterID_);
-  if(sock_ < 0)
-  {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
-  }
+  restartAdapter(true);
 
   LOG_P("BluetoothHCI", "Changed public address to %s", address.toString().c_str());
 }
 
 void BluetoothHCI::setRandomAddress(const Address &address)
 {
-  struct hci_request request;
-  le_set_random_address_cp params;
-  uint8_t status;
-
-  memset(&request, 0, sizeof(request));
-  memset(&params, 0, sizeof(params));
-
-  memcpy(params.bdaddr.b, address.toByteArray(), 6);
+  lastKnownState_.randomAddress = address;
+  lastKnownState_.randomAddressStored = true;
 
-  request.ogf = OGF_LE_CTL;
-  request.ocf = OCF_LE_SET_RANDOM_ADDRESS;
-  request.cparam = &params;
-  request.clen = sizeof(params);
-  request.rparam = &status;
-  request.rlen = 1;
+  advertUpdate_.randomAddress = address;
+  advertUpdate_.hasRandomAddress = true;
 
-  int error;
-  if((error = hci_send_req(sock_, &request, 0)) < 0)
+  if(advertUpdate_.depth == 0)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    flushAdvertUpdate();
   }
-
-  lastKnownState_.randomAddress = address;
-  lastKnownState_.randomAddressStored = true;
-
-  LOG_P("BluetoothHCI", "Changed random address to %s", address.toString().c_str());
 }
 
 string BluetoothHCI::readLocalName()
 {
-  char name[HCI_MAX_NAME_LENGTH] = { 0 };
+  const uint16_t opcode = cmd_opcode_pack(OGF_HOST_CTL, OCF_READ_LOCAL_NAME);
+
+  read_local_name_rp reply;
+  uint64_t sendTime = clock_->getMonoUS();
+
   int error;
-  if((error = hci_read_local_name(sock_, HCI_MAX_NAME_LENGTH, name, 0)) < 0)
+  if((error = sendRequest(opcode, NULL, 0, &reply, READ_LOCAL_NAME_RP_SIZE, COMMAND_TIMEOUT)) < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
 
-  return string(name);
+  recordCommand(opcode, sendTime);
+
+  return string((const char *)reply.name, strnlen((const char *)reply.name, HCI_MAX_NAME_LENGTH));
 }
 
 bool BluetoothHCI::readRemoteName(string &name, const Address &address, uint16_t clockOffset, uint8_t pageScanMode, uint64_t timeout)
 {
-  char remoteName[HCI_MAX_NAME_LENGTH] = { 0 };
+  const uint16_t opcode = cmd_opcode_pack(OGF_LINK_CTL, OCF_REMOTE_NAME_REQ);
+
+  remote_name_req_cp param;
+  memcpy(param.bdaddr.b, address.toByteArray(), 6);
+  param.pscan_rep_mode = pageScanMode;
+  param.pscan_mode = 0;
+  param.clock_offset = clockOffset;
 
-  bdaddr_t addressBT;
-  memcpy(addressBT.b, address.toByteArray(), 6);
+  evt_remote_name_req_complete reply;
+  uint64_t sendTime = clock_->getMonoUS();
 
   int error;
-  if((error = hci_read_remote_name_with_clock_offset(sock_, &addressBT, pageScanMode, clockOffset, HCI_MAX_NAME_LENGTH, remoteName, timeout)) < 0)
+  if((error = sendRequest(opcode, &param, REMOTE_NAME_REQ_CP_SIZE, &reply, EVT_REMOTE_NAME_REQ_COMPLETE_SIZE, timeout, EVT_REMOTE_NAME_REQ_COMPLETE)) < 0)
   {
     // Connection timed out or I/O error are not fatal, just return that
     // we failed to complete the name request
@@ -236,48 +256,126 @@ bool BluetoothHCI::readRemoteName(string &name, const Address &address, uint16_t
     }
   }
 
-  name = string(remoteName);
+  recordCommand(opcode, sendTime);
+
+  name = string((const char *)reply.name, strnlen((const char *)reply.name, HCI_MAX_NAME_LENGTH));
 
   return true;
 }
 
+void BluetoothHCI::startRemoteName(const RemoteNameRequest &request)
+{
+  remote_name_req_cp param;
+  memcpy(param.bdaddr.b, request.address.toByteArray(), 6);
+  param.pscan_rep_mode = request.pageScanMode;
+  param.pscan_mode = 0;
+  param.clock_offset = request.clockOffset;
+
+  int error;
+  if((error = backend_->sendCommand(cmd_opcode_pack(OGF_LINK_CTL, OCF_REMOTE_NAME_REQ), &param, REMOTE_NAME_REQ_CP_SIZE)) < 0)
+  {
+    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+}
+
+void BluetoothHCI::cancelRemoteName(const Address &address)
+{
+  // Not waiting on the completion, since the request may have just finished
+  // anyway (in which case the controller rejects the cancel)
+  remote_name_req_cancel_cp param;
+  memcpy(param.bdaddr.b, address.toByteArray(), 6);
+
+  int error;
+  if((error = backend_->sendCommand(cmd_opcode_pack(OGF_LINK_CTL, OCF_REMOTE_NAME_REQ_CANCEL), &param, REMOTE_NAME_REQ_CANCEL_CP_SIZE)) < 0)
+  {
+    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+}
+
 void BluetoothHCI::writeLocalName(string name)
 {
+  const uint16_t opcode = cmd_opcode_pack(OGF_HOST_CTL, OCF_CHANGE_LOCAL_NAME);
+
+  lastKnownState_.localName = name;
+  lastKnownState_.localNameStored = true;
+
+  if(appliedState_.localNameStored && (appliedState_.localName == name))
+  {
+    recordSkipped(opcode);
+    return;
+  }
+
+  uint64_t sendTime = clock_->getMonoUS();
+
+  change_local_name_cp param;
+  memset(&param, 0, sizeof(param));
+  strncpy((char *)param.name, name.c_str(), sizeof(param.name));
+
   int error;
-  if((error = hci_write_local_name(sock_, name.c_str(), 0)) < 0)
+  if((error = sendRequest(opcode, &param, CHANGE_LOCAL_NAME_CP_SIZE, NULL, 0, COMMAND_TIMEOUT)) < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
+
+  recordCommand(opcode, sendTime);
+
+  appliedState_.localName = name;
+  appliedState_.localNameStored = true;
 }
 
 void BluetoothHCI::writeExtInquiryResponse(uint8_t *data)
 {
-  // TODO: Check if this holds after hardware reset, or if we need to keep
-  // track of it ourselves in the last known state
+  const uint16_t opcode = cmd_opcode_pack(OGF_HOST_CTL, OCF_WRITE_EXT_INQUIRY_RESPONSE);
+
+  memcpy(lastKnownState_.extInquiryResponse, data, HCI_MAX_EIR_LENGTH);
+  lastKnownState_.extInquiryResponseStored = true;
+
+  if(appliedState_.extInquiryResponseStored && (memcmp(appliedState_.extInquiryResponse, data, HCI_MAX_EIR_LENGTH) == 0))
+  {
+    recordSkipped(opcode);
+    return;
+  }
+
+  uint64_t sendTime = clock_->getMonoUS();
+
+  write_ext_inquiry_response_cp param;
+  param.fec = 0;
+  memcpy(param.data, data, HCI_MAX_EIR_LENGTH);
 
   int error;
-  if((error = hci_write_ext_inquiry_response(sock_, 0, data, 0)) < 0)
+  if((error = sendRequest(opcode, &param, WRITE_EXT_INQUIRY_RESPONSE_CP_SIZE, NULL, 0, COMMAND_TIMEOUT)) < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
+
+  recordCommand(opcode, sendTime);
+
+  memcpy(appliedState_.extInquiryResponse, data, HCI_MAX_EIR_LENGTH);
+  appliedState_.extInquiryResponseStored = true;
 }
 
 list<InquiryResponse> BluetoothHCI::performInquiry(int periods)
 {
   LOG_D("BluetoothHCI", "Starting discovery for %d periods...", periods);
 
-  inquiry_info *rawResponses = new inquiry_info[255];
-  int numResponses = hci_inquiry(adapterID_, periods, 255, NULL, &rawResponses, IREQ_CACHE_FLUSH);
+  Metrics::Timer timer(Metrics::Histogram::ScanDuration);
+
+  vector<inquiry_info> rawResponses;
+  int numResponses = backend_->inquiry(periods, rawResponses);
   if(numResponses < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
 
   LOG_D("BluetoothHCI", "Finished discovery. Found %d devices.", numResponses);
+  Metrics::record(Metrics::Histogram::ReportsPerScan, numResponses);
+  PROBE1(scan_complete, numResponses);
 
   list<InquiryResponse> responses;
   for(int r = 0; r < numResponses; r++)
   {
+    PROBE3(scan_report, rawResponses[r].bdaddr.b, 0, 0);
+
     InquiryResponse response;
     response.address = Address(6, rawResponses[r].bdaddr.b);
     response.clockOffset = rawResponses[r].clock_offset;
@@ -287,114 +385,71 @@ list<InquiryResponse> BluetoothHCI::performInquiry(int periods)
     responses.push_back(response);
   }
 
-  delete rawResponses;
-
   return responses;
 }
 
-void BluetoothHCI::performEIRInquiry(function<void(const EIRInquiryResponse *)> callback, int periods)
+void BluetoothHCI::startEIRInquiry(int periods)
 {
-  int sockEIR = hci_open_dev(adapterID_);
-  if(sockEIR < 0)
-  {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
-  }
+  inquiry_cp params;
+  memset(&params, 0, sizeof(params));
 
-  struct hci_filter filter;
-  hci_filter_clear(&filter);
-  hci_filter_set_ptype(HCI_EVENT_PKT, &filter);
-  hci_filter_set_event(EVT_EXTENDED_INQUIRY_RESULT, &filter);
+  // General inquiry access code
+  params.lap[0] = 0x33;
+  params.lap[1] = 0x8B;
+  params.lap[2] = 0x9E;
+  params.length = periods;
+  params.num_rsp = 0;
+
+  // Issuing the inquiry command directly rather than through inquiry(),
+  // which blocks until completion, so that results and completion are both
+  // read from the reactor
+  reactor_.flush();
 
   int error;
-  if((error = setsockopt(sockEIR, SOL_HCI, HCI_FILTER, &filter, sizeof(filter))) < 0)
+  if((error = backend_->sendCommand(cmd_opcode_pack(OGF_LINK_CTL, OCF_INQUIRY), &params, INQUIRY_CP_SIZE)) < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
+}
 
-  inquiry_info *rawResponses = new inquiry_info[255];
-  auto handle = async(launch::async, hci_inquiry, adapterID_, periods, 255, (const uint8_t *)NULL, &rawResponses, IREQ_CACHE_FLUSH);
-
-  uint8_t buffer[HCI_MAX_EVENT_SIZE];
-  uint64_t startTime = getTimeMS();
-  int64_t remainingTime;
-
-  while((remainingTime = (periods * 1280) - (getTimeMS() - startTime)) >= 0)
+void BluetoothHCI::finishEIRInquiry(bool isComplete, uint8_t status)
+{
+  if(!isComplete)
   {
-    struct pollfd pollDesc;
-    pollDesc.fd = sockEIR;
-    pollDesc.events = POLLIN;
+    LOG_W("BluetoothHCI", "Inquiry did not complete in time, cancelling");
 
-    error = poll(&pollDesc, 1, remainingTime);
-    if(error == -1)
+    int error;
+    if((error = backend_->sendCommand(cmd_opcode_pack(OGF_LINK_CTL, OCF_INQUIRY_CANCEL), NULL, 0)) < 0)
     {
       LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
-      break;
-    }
-    else if(error == 0)
-    {
-      break;
-    }
-
-    int len = ::recv(sockEIR, buffer, sizeof(buffer), MSG_DONTWAIT);
-    if(len > 0)
-    {
-      extended_inquiry_info *eii = (extended_inquiry_info *)(buffer + 2 + HCI_EVENT_HDR_SIZE);
-
-      EIRInquiryResponse response;
-      response.address = Address(6, eii->bdaddr.b);
-      response.clockOffset = eii->clock_offset;
-      response.pageScanMode = eii->pscan_rep_mode;
-      response.pageScanPeriodMode = eii->pscan_period_mode;
-      response.data = eii->data;
-      response.rssi = eii->rssi;
-
-      callback(&response);
-    }
-    else
-    {
-      break;
     }
   }
-
-  if(!handle.valid() || (handle.get() < 0))
+  else if(status != 0)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    LOG_E_BT_CRASH("BluetoothHCI", "Inquiry failed", __FILE__, __LINE__, bt_error(status));
   }
-
-  delete rawResponses;
-
-  hci_close_dev(sockEIR);
 }
 
-void BluetoothHCI::performScan(Scan type, DuplicateFilter filter, uint64_t duration, function<void(const ScanResponse *)> callback)
+void BluetoothHCI::startScan(Scan type, DuplicateFilter filter, uint64_t duration)
 {
   LOG_D("BluetoothHCI", "Performing a scan");
-  const int sockScan = hci_open_dev(adapterID_);
-  if(sockScan < 0)
-  {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
-  }
 
-  struct hci_filter eventFilter;
-  hci_filter_clear(&eventFilter);
-  hci_filter_set_ptype(HCI_EVENT_PKT, &eventFilter);
-  hci_filter_set_event(EVT_LE_META_EVENT, &eventFilter);
+  // Discarding any reports or command completions that arrived while we were
+  // not scanning, so that only this scan's reports are dispatched
+  reactor_.flush();
 
-  int error;
-  if((error = setsockopt(sockScan, SOL_HCI, HCI_FILTER, &eventFilter, sizeof(eventFilter))) < 0)
-  {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
-  }
+  uint64_t sendTime = clock_->getMonoUS();
 
-  if((error = hci_le_set_scan_parameters(sock_, type, htobs((uint16_t)(duration / 0.625)), htobs((uint16_t)(duration / 0.625)), LE_RANDOM_ADDRESS, ScanFilter::All, 0)) < 0)
+  int error;
+  if((error = sendScanParameters(type, duration)) < 0)
   {
     // EIO is returned in the case that a scan was already running. We should just disable scanning and rerun
     if(errno == EIO)
     {
       LOG_W("BluetoothHCI", "Scan was already running... Disabling, then starting new scan");
 
-      hci_le_set_scan_enable(sock_, 0, 0, 0);
-      if((error = hci_le_set_scan_parameters(sock_, type, htobs((uint16_t)(duration / 0.625)), htobs((uint16_t)(duration / 0.625)), LE_RANDOM_ADDRESS, ScanFilter::All, 0)) < 0)
+      sendScanEnable(false, DuplicateFilter::Off);
+      if((error = sendScanParameters(type, duration)) < 0)
       {
         LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
       }
@@ -405,138 +460,112 @@ void BluetoothHCI::performScan(Scan type, DuplicateFilter filter, uint64_t durat
     }
   }
 
-  if((error = hci_le_set_scan_enable(sock_, 1, filter, 0)) < 0)
+  recordCommand(cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_SCAN_PARAMETERS), sendTime);
+
+  sendTime = clock_->getMonoUS();
+  if((error = sendScanEnable(true, filter)) < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
+  recordCommand(cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_SCAN_ENABLE), sendTime);
+}
 
-  uint8_t buffer[HCI_MAX_EVENT_SIZE];
-  uint64_t startTime = getTimeMS();
-  int64_t remainingTime;
-
-  while((remainingTime = duration - (getTimeMS() - startTime)) >= 0)
-  {
-    struct pollfd pollDesc;
-    pollDesc.fd = sockScan;
-    pollDesc.events = POLLIN;
-
-    error = poll(&pollDesc, 1, remainingTime);
-    if(error == -1)
-    {
-      LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
-      break;
-    }
-    else if(error == 0)
-    {
-      break;
-    }
-
-    ::recv(sockScan, buffer, sizeof(buffer), MSG_DONTWAIT);
-
-    hci_event_hdr *eventHeader = (hci_event_hdr *)(buffer + 1);
-    void *eventBody = (void *)(buffer + 1 + HCI_EVENT_HDR_SIZE);
-
-    if(eventHeader->evt == EVT_LE_META_EVENT)
-    {
-      const evt_le_meta_event *metaEventHeader = (evt_le_meta_event *)(eventBody);
-      const uint8_t *metaEventBody = metaEventHeader->data;
-
-      //Bluetooth LE advertising report event
-      if(metaEventHeader->subevent == 0x02)
-      {
-        uint8_t numReports = *(metaEventBody++);
-
-        for(int r = 0; r < numReports; r++)
-        {
-          le_advertising_info *info = (le_advertising_info *)(metaEventBody);
-
-          ScanResponse response;
-          response.address = Address(6, info->bdaddr.b);
-          response.data = info->data;
-          response.length = info->length;
-          response.rssi = ((int8_t *)info->data)[info->length];
-
-          callback(&response);
-
-          metaEventBody += LE_ADVERTISING_INFO_SIZE + info->length + 1;
-        }
-      }
-    }
-  }
+void BluetoothHCI::finishScan()
+{
+  uint64_t sendTime = clock_->getMonoUS();
 
-  if((error = hci_le_set_scan_enable(sock_, 0, 0, 0)) < 0)
+  int error;
+  if((error = sendScanEnable(false, DuplicateFilter::Off)) < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
-  close(sockScan);
+  recordCommand(cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_SCAN_ENABLE), sendTime);
   LOG_D("BluetoothHCI", "Scan finished");
 }
 
+void BluetoothHCI::startExtendedScan(Scan type, uint64_t duration)
+{
+  LOG_D("BluetoothHCI", "Performing an extended scan");
+
+  reactor_.flush();
+
+  // Scanning on the 1M PHY, which is where extended adverts are announced
+  // (with the data itself then sent on a secondary channel)
+  le_set_extended_scan_parameters_cp paramsParam;
+  paramsParam.own_bdaddr_type = LE_RANDOM_ADDRESS;
+  paramsParam.filter = ScanFilter::All;
+  paramsParam.phys = 0x01;
+  paramsParam.type = type;
+  paramsParam.interval = htobs((uint16_t)(duration / 0.625));
+  paramsParam.window = htobs((uint16_t)(duration / 0.625));
+
+  // Duplicates are not filtered, since the controller would also drop the
+  // fragments of adverts it has already reported in part
+  le_set_extended_scan_enable_cp enableParam;
+  enableParam.enable = 1;
+  enableParam.filter_dup = DuplicateFilter::Off;
+  enableParam.duration = 0;
+  enableParam.period = 0;
+
+  PendingCommand commands[2];
+  commands[0] = { cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_SCAN_PARAMETERS), &paramsParam, LE_SET_EXTENDED_SCAN_PARAMETERS_CP_SIZE, 0, false };
+  commands[1] = { cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_SCAN_ENABLE), &enableParam, LE_SET_EXTENDED_SCAN_ENABLE_CP_SIZE, 0, false };
+  sendCommands(commands, 2);
+}
+
+void BluetoothHCI::finishExtendedScan()
+{
+  le_set_extended_scan_enable_cp disableParam;
+  memset(&disableParam, 0, sizeof(disableParam));
+
+  PendingCommand command = { cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_SCAN_ENABLE), &disableParam, LE_SET_EXTENDED_SCAN_ENABLE_CP_SIZE, 0, false };
+  sendCommands(&command, 1);
+  LOG_D("BluetoothHCI", "Extended scan finished");
+}
+
 void BluetoothHCI::setAdvertData(const uint8_t *data, uint8_t length)
 {
-  struct hci_request req;
   le_set_advertising_data_cp param;
-  uint8_t status;
-
-  memset(&req, 0, sizeof(req));
   memset(&param, 0, sizeof(param));
 
   param.length = length;
   memcpy(param.data, data, length);
 
-  req.ogf = OGF_LE_CTL;
-  req.ocf = OCF_LE_SET_ADVERTISING_DATA;
-  req.cparam = &param;
-  req.clen = sizeof(param);
-  req.rparam = &status;
-  req.rlen = 1;
+  lastKnownState_.advertData = param;
+  lastKnownState_.advertDataStored = true;
+
+  advertUpdate_.advertData = param;
+  advertUpdate_.hasAdvertData = true;
 
-  int error;
-  if((error = hci_send_req(sock_, &req, 0)) < 0)
+  if(advertUpdate_.depth == 0)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    flushAdvertUpdate();
   }
-
-  lastKnownState_.advertData = param;
-  lastKnownState_.advertDataStored = true;
 }
 
 void BluetoothHCI::setScanResponseData(const uint8_t *data, uint8_t length)
 {
-  struct hci_request req;
   le_set_scan_response_data_cp param;
-  uint8_t status;
-
-  memset(&req, 0, sizeof(req));
   memset(&param, 0, sizeof(param));
 
   param.length = length;
   memcpy(param.data, data, length);
 
-  req.ogf = OGF_LE_CTL;
-  req.ocf = OCF_LE_SET_SCAN_RESPONSE_DATA;
-  req.cparam = &param;
-  req.clen = sizeof(param);
-  req.rparam = &status;
-  req.rlen = 1;
+  lastKnownState_.responseData = param;
+  lastKnownState_.responseDataStored = true;
 
-  int error;
-  if((error = hci_send_req(sock_, &req, 0)) < 0)
+  advertUpdate_.responseData = param;
+  advertUpdate_.hasResponseData = true;
+
+  if(advertUpdate_.depth == 0)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    flushAdvertUpdate();
   }
-
-  lastKnownState_.responseData = param;
-  lastKnownState_.responseDataStored = true;
 }
 
 void BluetoothHCI::setUndirectedAdvertParams(UndirectedAdvert type, AdvertFilter filter, uint16_t minInterval, uint16_t maxInterval)
 {
-  struct hci_request req;
   le_set_advertising_parameters_cp param;
-  uint8_t status;
-
-  memset(&req, 0, sizeof(req));
   memset(&param, 0, sizeof(param));
 
   param.min_interval = htobs((uint16_t)(minInterval / 0.625));
@@ -546,299 +575,778 @@ void BluetoothHCI::setUndirectedAdvertParams(UndirectedAdvert type, AdvertFilter
   param.chan_map = ChannelMap::All;
   param.filter = filter;
 
-  enableAdvertising(false);
+  lastKnownState_.advertParams = param;
+  lastKnownState_.advertParamsStored = true;
+  lastKnownState_.isAdvertising = true;
+  lastKnownState_.isAdvertisingStored = true;
 
-  req.ogf = OGF_LE_CTL;
-  req.ocf = OCF_LE_SET_ADVERTISING_PARAMETERS;
-  req.cparam = &param;
-  req.clen = sizeof(param);
-  req.rparam = &status;
-  req.rlen = 1;
+  // Advertising is (re-)enabled with the new parameters
+  advertUpdate_.advertParams = param;
+  advertUpdate_.hasAdvertParams = true;
+  advertUpdate_.isAdvertising = true;
+  advertUpdate_.hasAdvertising = true;
 
-  int error;
-  if(((error = hci_send_req(sock_, &req, 0)) < 0) || (error = status))
+  if(advertUpdate_.depth == 0)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    flushAdvertUpdate();
   }
+}
 
-  lastKnownState_.advertParams = param;
-  lastKnownState_.advertParamsStored = true;
+void BluetoothHCI::enableAdvertising(bool enable)
+{
+  lastKnownState_.isAdvertising = enable;
+  lastKnownState_.isAdvertisingStored = true;
+
+  advertUpdate_.isAdvertising = enable;
+  advertUpdate_.hasAdvertising = true;
 
-  enableAdvertising(true);
+  if(advertUpdate_.depth == 0)
+  {
+    flushAdvertUpdate();
+  }
 }
 
-void BluetoothHCI::enableAdvertising(bool enable)
+void BluetoothHCI::setExtAdvertParams(bool isConnectable, uint16_t minInterval, uint16_t maxInterval)
 {
-  LOG_D("BluetoothHCI", "Setting advertising to %d", enable);
-  int error;
-  if((error = hci_le_set_advertise_enable(sock_, enable, 0)) < 0)
+  le_set_extended_advertising_parameters_cp param;
+  memset(&param, 0, sizeof(param));
+
+  // Intervals are 3 bytes (little endian) in units of 0.625 ms
+  uint32_t minUnits = minInterval / 0.625;
+  uint32_t maxUnits = maxInterval / 0.625;
+  for(int b = 0; b < 3; b++)
   {
-    // EIO is returned in the case that advertising was already enabled/disabled
-    if(errno == EIO)
-    {
-      LOG_W("BluetoothHCI", "Advertising was already %s", enable ? "enabled" : "disabled");
-    }
-    else
-    {
-      LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
-    }
+    param.min_interval[b] = (minUnits >> (8 * b)) & 0xFF;
+    param.max_interval[b] = (maxUnits >> (8 * b)) & 0xFF;
   }
 
-  lastKnownState_.isAdvertising = enable;
-  lastKnownState_.isAdvertisingStored = true;
+  // Extended (non-legacy) adverts cannot be both connectable and scannable,
+  // and are otherwise neither
+  param.handle = 0;
+  param.properties = htobs((uint16_t)(isConnectable ? 0x0001 : 0x0000));
+  param.chan_map = ChannelMap::All;
+  param.own_bdaddr_type = LE_RANDOM_ADDRESS;
+  param.filter = AdvertFilter::ScanAllConnectAll;
+  param.tx_power = 0x7F;
+  param.primary_phy = 0x01;
+  param.secondary_phy = 0x01;
+
+  lastKnownState_.extAdvertParams = param;
+  lastKnownState_.extAdvertParamsStored = true;
+
+  flushExtAdvert();
+}
+
+void BluetoothHCI::setExtAdvert(const Address &address, const uint8_t *data, uint8_t length)
+{
+  le_set_extended_advertising_data_cp param;
+  memset(&param, 0, sizeof(param));
+
+  param.handle = 0;
+  param.operation = 0x03;
+  param.fragment_preference = 0x01;
+  param.length = min<uint8_t>(length, LE_EXTENDED_ADVERTISING_DATA_MAX);
+  memcpy(param.data, data, param.length);
+
+  lastKnownState_.extAdvertAddress = address;
+  lastKnownState_.extAdvertAddressStored = true;
+  lastKnownState_.extAdvertData = param;
+  lastKnownState_.extAdvertDataStored = true;
+
+  flushExtAdvert();
+}
+
+void BluetoothHCI::enableExtAdvertising(bool enable)
+{
+  lastKnownState_.isExtAdvertising = enable;
+  lastKnownState_.isExtAdvertisingStored = true;
+
+  flushExtAdvert();
+}
+
+void BluetoothHCI::beginAdvertUpdate()
+{
+  advertUpdate_.depth++;
+}
+
+void BluetoothHCI::endAdvertUpdate()
+{
+  if(--advertUpdate_.depth == 0)
+  {
+    flushAdvertUpdate();
+  }
+}
+
+void BluetoothHCI::logCommandStats() const
+{
+  for(auto it = commandStats_.begin(); it != commandStats_.end(); it++)
+  {
+    const CommandStats &stats = it->second;
+    uint64_t avgLatency = (stats.numSent > 0) ? (stats.totalLatency / stats.numSent) : 0;
+    LOG_D("BluetoothHCI", "Command 0x%04x: %zu sent, %zu skipped, %" PRIu64 " us avg, %" PRIu64 " us max",
+          it->first, stats.numSent, stats.numSkipped, avgLatency, stats.maxLatency);
+  }
 }
 
 void BluetoothHCI::setScan(bool pscan, bool iscan)
 {
-  struct hci_dev_req request;
-  memset(&request, 0, sizeof(request));
+  const uint16_t opcode = cmd_opcode_pack(OGF_HOST_CTL, OCF_WRITE_SCAN_ENABLE);
 
-  request.dev_id  = adapterID_;
-  request.dev_opt = SCAN_DISABLED;
+  if(appliedState_.isConnectableStored && appliedState_.isDiscoverableStored &&
+     (appliedState_.isConnectable == pscan) && (appliedState_.isDiscoverable == iscan))
+  {
+    recordSkipped(opcode);
+    return;
+  }
+
+  uint8_t scanEnable = SCAN_DISABLED;
 
   if(pscan && iscan)
   {
-    request.dev_opt = SCAN_PAGE | SCAN_INQUIRY;
+    scanEnable = SCAN_PAGE | SCAN_INQUIRY;
   }
   else if(pscan)
   {
-    request.dev_opt = SCAN_PAGE;
+    scanEnable = SCAN_PAGE;
   }
   else if(iscan)
   {
-    request.dev_opt = SCAN_INQUIRY;
+    scanEnable = SCAN_INQUIRY;
   }
 
+  uint64_t sendTime = clock_->getMonoUS();
+
   int error;
-  if((error = ioctl(sock_, HCISETSCAN, (unsigned long)&request)) < 0)
+  if((error = backend_->setScanEnable(scanEnable)) < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
-}
 
-void BluetoothHCI::recover()
-{
-  LOG_E_BT_CRASH("BluetoothHCI", "recover() not implemented", __FILE__, __LINE__, 0);
+  recordCommand(opcode, sendTime);
+
+  appliedState_.isConnectable = pscan;
+  appliedState_.isConnectableStored = true;
+  appliedState_.isDiscoverable = iscan;
+  appliedState_.isDiscoverableStored = true;
 }
 
-int BluetoothHCI::connectBT2(const Address &address, uint8_t port, int64_t timeout)
+void BluetoothHCI::flushAdvertUpdate()
 {
-  int error;
+  const uint16_t addressOpcode = cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_RANDOM_ADDRESS);
+  const uint16_t paramsOpcode = cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_ADVERTISING_PARAMETERS);
+  const uint16_t dataOpcode = cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_ADVERTISING_DATA);
+  const uint16_t responseOpcode = cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_SCAN_RESPONSE_DATA);
+  const uint16_t enableOpcode = cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_ADVERTISE_ENABLE);
+
+  AdvertUpdate update = advertUpdate_;
+  advertUpdate_.hasRandomAddress = false;
+  advertUpdate_.hasAdvertData = false;
+  advertUpdate_.hasResponseData = false;
+  advertUpdate_.hasAdvertParams = false;
+  advertUpdate_.hasAdvertising = false;
+
+  // Dropping anything that the controller already holds
+  bool sendAddress = update.hasRandomAddress && !(appliedState_.randomAddressStored && (appliedState_.randomAddress == update.randomAddress));
+  bool sendParams = update.hasAdvertParams && !(appliedState_.advertParamsStored && (memcmp(&appliedState_.advertParams, &update.advertParams, sizeof(update.advertParams)) == 0));
+  bool sendData = update.hasAdvertData && !(appliedState_.advertDataStored && (memcmp(&appliedState_.advertData, &update.advertData, sizeof(update.advertData)) == 0));
+  bool sendResponse = update.hasResponseData && !(appliedState_.responseDataStored && (memcmp(&appliedState_.responseData, &update.responseData, sizeof(update.responseData)) == 0));
+
+  // The random address and parameters can only be changed while advertising
+  // is disabled, which we also assume to be possible if we do not know
+  bool isAdvertising = appliedState_.isAdvertisingStored && appliedState_.isAdvertising;
+  bool mayBeAdvertising = !appliedState_.isAdvertisingStored || appliedState_.isAdvertising;
+  bool willAdvertise = update.hasAdvertising ? update.isAdvertising : isAdvertising;
+
+  bool sendDisable = mayBeAdvertising && ((sendAddress || sendParams) || (update.hasAdvertising && !update.isAdvertising));
+  bool sendEnable = willAdvertise && (sendDisable || !isAdvertising);
+
+  uint8_t disableParam = 0;
+  uint8_t enableParam = 1;
+  le_set_random_address_cp addressParam;
+  memset(&addressParam, 0, sizeof(addressParam));
+  if(sendAddress)
+  {
+    memcpy(addressParam.bdaddr.b, update.randomAddress.toByteArray(), 6);
+  }
 
-  int sockConn = socket(AF_BLUETOOTH, SOCK_STREAM, BTPROTO_RFCOMM);
-  if(sockConn < 0)
+  PendingCommand commands[6];
+  size_t numCommands = 0;
+  if(sendDisable)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    commands[numCommands++] = { enableOpcode, &disableParam, LE_SET_ADVERTISE_ENABLE_CP_SIZE, 0, false };
+  }
+  if(sendAddress)
+  {
+    commands[numCommands++] = { addressOpcode, &addressParam, LE_SET_RANDOM_ADDRESS_CP_SIZE, 0, false };
+  }
+  if(sendParams)
+  {
+    commands[numCommands++] = { paramsOpcode, &update.advertParams, LE_SET_ADVERTISING_PARAMETERS_CP_SIZE, 0, false };
+  }
+  if(sendData)
+  {
+    commands[numCommands++] = { dataOpcode, &update.advertData, LE_SET_ADVERTISING_DATA_CP_SIZE, 0, false };
+  }
+  if(sendResponse)
+  {
+    commands[numCommands++] = { responseOpcode, &update.responseData, LE_SET_SCAN_RESPONSE_DATA_CP_SIZE, 0, false };
+  }
+  if(sendEnable)
+  {
+    commands[numCommands++] = { enableOpcode, &enableParam, LE_SET_ADVERTISE_ENABLE_CP_SIZE, 0, false };
   }
 
-  int flags = fcntl(sockConn, F_GETFL, 0);
-  if((error = fcntl(sockConn, F_SETFL, flags | O_NONBLOCK)) < 0)
+  if(update.hasRandomAddress && !sendAddress)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    recordSkipped(addressOpcode);
+  }
+  if(update.hasAdvertParams && !sendParams)
+  {
+    recordSkipped(paramsOpcode);
+  }
+  if(update.hasAdvertData && !sendData)
+  {
+    recordSkipped(dataOpcode);
+  }
+  if(update.hasResponseData && !sendResponse)
+  {
+    recordSkipped(responseOpcode);
+  }
+  if(update.hasAdvertising && !sendDisable && !sendEnable)
+  {
+    recordSkipped(enableOpcode);
   }
 
-  struct sockaddr_rc addr = { 0 };
-  addr.rc_family = AF_BLUETOOTH;
-  memcpy(addr.rc_bdaddr.b, address.toByteArray(), 6);
-  addr.rc_channel = port;
+  sendCommands(commands, numCommands);
 
-  if(((error = connect(sockConn, (struct sockaddr *)&addr, sizeof(addr))) < 0) && (errno != EINPROGRESS))
+  if(sendAddress)
   {
-    // EBUSY will occur when an incoming connection is already being handled,
-    // and so we can safely ignore it
-    if(errno != EBUSY)
-    {
-      LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
-    }
-    return -1;
+    appliedState_.randomAddress = update.randomAddress;
+    appliedState_.randomAddressStored = true;
+    LOG_P("BluetoothHCI", "Changed random address to %s", update.randomAddress.toString().c_str());
+  }
+  if(sendParams)
+  {
+    appliedState_.advertParams = update.advertParams;
+    appliedState_.advertParamsStored = true;
   }
+  if(sendData)
+  {
+    appliedState_.advertData = update.advertData;
+    appliedState_.advertDataStored = true;
+  }
+  if(sendResponse)
+  {
+    appliedState_.responseData = update.responseData;
+    appliedState_.responseDataStored = true;
+  }
+  if(sendDisable || sendEnable)
+  {
+    appliedState_.isAdvertising = willAdvertise;
+    appliedState_.isAdvertisingStored = true;
+    LOG_D("BluetoothHCI", "Setting advertising to %d", willAdvertise);
+  }
+}
 
-  // Waiting for a connection until timeout occurs, if the connection is still
-  // in progress
-  if(errno == EINPROGRESS)
+void BluetoothHCI::flushExtAdvert()
+{
+  const uint16_t addressOpcode = cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_ADVERTISING_SET_RANDOM_ADDRESS);
+  const uint16_t paramsOpcode = cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_ADVERTISING_PARAMETERS);
+  const uint16_t dataOpcode = cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_ADVERTISING_DATA);
+  const uint16_t enableOpcode = cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_ADVERTISING_ENABLE);
+
+  const LastKnownState &state = lastKnownState_;
+
+  // Dropping anything that the controller already holds
+  bool sendParams = state.extAdvertParamsStored && !(appliedState_.extAdvertParamsStored && (memcmp(&appliedState_.extAdvertParams, &state.extAdvertParams, sizeof(state.extAdvertParams)) == 0));
+  bool sendAddress = state.extAdvertAddressStored && !(appliedState_.extAdvertAddressStored && (appliedState_.extAdvertAddress == state.extAdvertAddress));
+  bool sendData = state.extAdvertDataStored && !(appliedState_.extAdvertDataStored && (memcmp(&appliedState_.extAdvertData, &state.extAdvertData, sizeof(state.extAdvertData)) == 0));
+
+  // The set must have parameters before anything else can be sent for it,
+  // and may only be changed while it is disabled
+  if(!state.extAdvertParamsStored)
   {
-    struct pollfd pollDesc;
-    pollDesc.fd = sockConn;
-    pollDesc.events = POLLOUT;
+    return;
+  }
 
-    error = poll(&pollDesc, 1, timeout);
-    if(error <= 0)
-    {
-      close(sockConn);
-      sockConn = -1;
-    }
+  bool isAdvertising = appliedState_.isExtAdvertisingStored && appliedState_.isExtAdvertising;
+  bool mayBeAdvertising = !appliedState_.isExtAdvertisingStored || appliedState_.isExtAdvertising;
+  bool willAdvertise = state.isExtAdvertisingStored && state.isExtAdvertising;
+
+  bool sendDisable = mayBeAdvertising && (sendParams || sendAddress || sendData || !willAdvertise);
+  bool sendEnable = willAdvertise && (sendDisable || !isAdvertising);
+
+  // Disabling all sets (of which we only use one) is always allowed
+  le_set_extended_advertising_enable_cp disableParam;
+  memset(&disableParam, 0, sizeof(disableParam));
+
+  le_set_extended_advertising_enable_cp enableParam;
+  memset(&enableParam, 0, sizeof(enableParam));
+  enableParam.enable = 1;
+  enableParam.num_sets = 1;
+
+  le_set_advertising_set_random_address_cp addressParam;
+  memset(&addressParam, 0, sizeof(addressParam));
+  if(sendAddress)
+  {
+    memcpy(addressParam.bdaddr.b, state.extAdvertAddress.toByteArray(), 6);
   }
 
-  return sockConn;
-}
+  PendingCommand commands[5];
+  size_t numCommands = 0;
+  if(sendDisable)
+  {
+    commands[numCommands++] = { enableOpcode, &disableParam, 2, 0, false };
+  }
+  if(sendParams)
+  {
+    commands[numCommands++] = { paramsOpcode, &state.extAdvertParams, LE_SET_EXTENDED_ADVERTISING_PARAMETERS_CP_SIZE, 0, false };
+  }
+  if(sendAddress)
+  {
+    commands[numCommands++] = { addressOpcode, &addressParam, LE_SET_ADVERTISING_SET_RANDOM_ADDRESS_CP_SIZE, 0, false };
+  }
+  if(sendData)
+  {
+    commands[numCommands++] = { dataOpcode, &state.extAdvertData, (uint8_t)(LE_SET_EXTENDED_ADVERTISING_DATA_CP_SIZE + state.extAdvertData.length), 0, false };
+  }
+  if(sendEnable)
+  {
+    commands[numCommands++] = { enableOpcode, &enableParam, LE_SET_EXTENDED_ADVERTISING_ENABLE_CP_SIZE, 0, false };
+  }
 
-int BluetoothHCI::connectBT4(const Address &address, int64_t timeout)
-{
-  int error;
+  if(state.extAdvertAddressStored && !sendAddress)
+  {
+    recordSkipped(addressOpcode);
+  }
+  if(state.extAdvertDataStored && !sendData)
+  {
+    recordSkipped(dataOpcode);
+  }
+  if(state.isExtAdvertisingStored && !sendDisable && !sendEnable)
+  {
+    recordSkipped(enableOpcode);
+  }
 
-  int sockConn = socket(AF_BLUETOOTH, SOCK_SEQPACKET, BTPROTO_L2CAP);
-  if(sockConn < 0)
+  sendCommands(commands, numCommands);
+
+  if(sendParams)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    appliedState_.extAdvertParams = state.extAdvertParams;
+    appliedState_.extAdvertParamsStored = true;
+  }
+  if(sendAddress)
+  {
+    appliedState_.extAdvertAddress = state.extAdvertAddress;
+    appliedState_.extAdvertAddressStored = true;
+    LOG_P("BluetoothHCI", "Changed advertising set address to %s", state.extAdvertAddress.toString().c_str());
+  }
+  if(sendData)
+  {
+    appliedState_.extAdvertData = state.extAdvertData;
+    appliedState_.extAdvertDataStored = true;
+  }
+  if(sendDisable || sendEnable)
+  {
+    appliedState_.isExtAdvertising = willAdvertise;
+    appliedState_.isExtAdvertisingStored = true;
+    LOG_D("BluetoothHCI", "Setting extended advertising to %d", willAdvertise);
   }
+}
+
+void BluetoothHCI::sendCommands(PendingCommand *commands, size_t numCommands)
+{
+  const uint16_t enableOpcode = cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_ADVERTISE_ENABLE);
 
-  int flags = fcntl(sockConn, F_GETFL, 0);
-  if((error = fcntl(sockConn, F_SETFL, flags | O_NONBLOCK)) < 0)
+  if(numCommands == 0)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    return;
   }
 
-  struct sockaddr_l2 addr = { 0 };
-  addr.l2_family = AF_BLUETOOTH;
-  memcpy(addr.l2_bdaddr.b, address.toByteArray(), 6);
-  addr.l2_bdaddr_type = BDADDR_LE_RANDOM;
-  addr.l2_cid = htobs(0x0004);
+  // Discarding stale completions, so they are not mistaken for ours
+  reactor_.flush();
 
-  if(((error = connect(sockConn, (struct sockaddr *)&addr, sizeof(addr))) < 0) && (errno != EINPROGRESS))
+  // Writing all of the commands up front rather than waiting on each in turn,
+  // since the kernel queues them and sends each as soon as the controller can
+  // accept another command
+  for(size_t c = 0; c < numCommands; c++)
   {
-    // EBUSY will occur when an incoming connection is already being handled,
-    // and so we can safely ignore it
-    if(errno != EBUSY)
+    commands[c].sendTime = clock_->getMonoUS();
+    commands[c].isComplete = false;
+    PROBE2(hci_command_issue, adapterID_, commands[c].opcode);
+
+    int error;
+    if((error = backend_->sendCommand(commands[c].opcode, commands[c].params, commands[c].length)) < 0)
     {
       LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
     }
-    return -1;
   }
 
-  // Waiting for a connection until timeout occurs, if the connection is still
-  // in progress
-  if(errno == EINPROGRESS)
+  size_t numComplete = 0;
+  auto dispatcher = makeHCIEventDispatcher(HCIIgnore(), HCIIgnore(), [&](uint16_t opcode, uint8_t status)
   {
-    struct pollfd pollDesc;
-    pollDesc.fd = sockConn;
-    pollDesc.events = POLLOUT;
-
-    error = poll(&pollDesc, 1, timeout);
-    if(error <= 0)
+    // Completions arrive in the order sent, so the first incomplete command
+    // with the same opcode is the one that finished
+    for(size_t c = 0; c < numCommands; c++)
     {
-      close(sockConn);
-      sockConn = -1;
+      if(!commands[c].isComplete && (commands[c].opcode == opcode))
+      {
+        commands[c].isComplete = true;
+        numComplete++;
+        uint64_t latency = recordCommand(opcode, commands[c].sendTime);
+        PROBE4(hci_command_complete, adapterID_, opcode, status, latency);
+
+        if(status != 0)
+        {
+          // Command disallowed is returned in the case that advertising was
+          // already enabled/disabled
+          if(opcode == enableOpcode)
+          {
+            LOG_W("BluetoothHCI", "Advertising was already %s", (*(const uint8_t *)commands[c].params != 0) ? "enabled" : "disabled");
+          }
+          else
+          {
+            LOG_E_BT_CRASH("BluetoothHCI", "Command failed", __FILE__, __LINE__, bt_error(status));
+          }
+        }
+        break;
+      }
     }
+  });
+
+  uint64_t startTime = clock_->getMonoMS();
+  int64_t remainingTime;
+
+  while((numComplete < numCommands) && ((remainingTime = COMMAND_TIMEOUT - (clock_->getMonoMS() - startTime)) >= 0))
+  {
+    reactor_.poll(remainingTime, dispatcher);
   }
 
-  return sockConn;
+  if(numComplete < numCommands)
+  {
+    LOG_E_BT_CRASH("BluetoothHCI", "Command timed out", __FILE__, __LINE__, ETIMEDOUT);
+  }
 }
 
-int BluetoothHCI::listenBT2(uint8_t port)
+int BluetoothHCI::sendRequest(uint16_t opcode, const void *params, uint8_t length, void *reply, uint8_t replyLength, int timeout, int event)
 {
-  int sockListen = socket(AF_BLUETOOTH, SOCK_STREAM, BTPROTO_RFCOMM);
-  if(sockListen < 0)
+  // Commands with no reply of their own still return a status
+  uint8_t status = 0;
+
+  struct hci_request request;
+  memset(&request, 0, sizeof(request));
+  request.ogf = cmd_opcode_ogf(opcode);
+  request.ocf = cmd_opcode_ocf(opcode);
+  request.event = event;
+  request.cparam = (void *)params;
+  request.clen = length;
+  request.rparam = (reply != NULL) ? reply : &status;
+  request.rlen = (reply != NULL) ? replyLength : 1;
+
+  // Callers record their own command stats, so the clock is only read here
+  // for the probe
+#ifdef PROBES_ENABLED
+  uint64_t sendTime = clock_->getMonoUS();
+#endif
+  PROBE2(hci_command_issue, adapterID_, opcode);
+
+  if(backend_->sendRequest(&request, timeout) < 0)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    return -1;
   }
 
-  struct sockaddr_rc addr = { 0 };
-  addr.rc_family = AF_BLUETOOTH;
-  addr.rc_channel = port;
+#ifdef PROBES_ENABLED
+  PROBE4(hci_command_complete, adapterID_, opcode, *(const uint8_t *)request.rparam, clock_->getMonoUS() - sendTime);
+#endif
 
-  int error;
-  if((error = bind(sockListen, (struct sockaddr *)&addr, sizeof(addr))) < 0)
+  if(*(const uint8_t *)request.rparam != 0)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    errno = EIO;
+    return -1;
   }
 
-  if((error = listen(sockListen, 5)) < 0)
+  return 0;
+}
+
+int BluetoothHCI::sendScanParameters(Scan type, uint64_t duration)
+{
+  le_set_scan_parameters_cp param;
+  memset(&param, 0, sizeof(param));
+  param.type = type;
+  param.interval = htobs((uint16_t)(duration / 0.625));
+  param.window = htobs((uint16_t)(duration / 0.625));
+  param.own_bdaddr_type = LE_RANDOM_ADDRESS;
+  param.filter = ScanFilter::All;
+
+  return sendRequest(cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_SCAN_PARAMETERS), &param, LE_SET_SCAN_PARAMETERS_CP_SIZE, NULL, 0, COMMAND_TIMEOUT);
+}
+
+int BluetoothHCI::sendScanEnable(bool enable, DuplicateFilter filter)
+{
+  le_set_scan_enable_cp param;
+  memset(&param, 0, sizeof(param));
+  param.enable = enable ? 1 : 0;
+  param.filter_dup = enable ? filter : 0;
+
+  return sendRequest(cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_SCAN_ENABLE), &param, LE_SET_SCAN_ENABLE_CP_SIZE, NULL, 0, COMMAND_TIMEOUT);
+}
+
+uint64_t BluetoothHCI::recordCommand(uint16_t opcode, uint64_t sendTime)
+{
+  uint64_t latency = clock_->getMonoUS() - sendTime;
+
+  CommandStats &stats = commandStats_[opcode];
+  stats.numSent++;
+  stats.totalLatency += latency;
+  if(latency > stats.maxLatency)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    stats.maxLatency = latency;
   }
 
-  int flags = fcntl(sockListen, F_GETFL, 0);
-  if((error = fcntl(sockListen, F_SETFL, flags | O_NONBLOCK)) < 0)
+  return latency;
+}
+
+void BluetoothHCI::recordSkipped(uint16_t opcode)
+{
+  commandStats_[opcode].numSkipped++;
+}
+
+uint64_t BluetoothHCI::recover()
+{
+  LOG_W("BluetoothHCI", "Recovering adapter %d", adapterID_);
+
+  uint64_t startTime = clock_->getMonoMS();
+
+  // Trying a controller reset first, which is much faster since the adapter
+  // stays up (and its firmware loaded), then falling back to a restart
+  bool isReset = false;
+  if(backend_->reset() == 0)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    isReset = true;
+  }
+  else
+  {
+    LOG_W("BluetoothHCI", "Failed to reset adapter %d (Error %d: %s), restarting it instead", adapterID_, errno, strerror(errno));
+  }
+
+  if(isReset)
+  {
+    reopen();
+
+    if(lastKnownState_.publicAddressStored && (appliedState_.publicAddress != lastKnownState_.publicAddress))
+    {
+      LOG_W("BluetoothHCI", "Public address was lost in the reset, restarting adapter %d", adapterID_);
+      restartAdapter(true);
+    }
+  }
+  else
+  {
+    restartAdapter(lastKnownState_.publicAddressStored);
   }
 
-  return sockListen;
+  replayState();
+
+  uint64_t recoveryTime = clock_->getMonoMS() - startTime;
+  LOG_P("BluetoothHCI", "Recovered adapter %d in %" PRIu64 " ms (%s)", adapterID_, recoveryTime, isReset ? "reset" : "restart");
+
+  return recoveryTime;
 }
 
-int BluetoothHCI::listenBT4()
+void BluetoothHCI::restartAdapter(bool writePublicAddress)
 {
-  int sockListen = socket(AF_BLUETOOTH, SOCK_SEQPACKET, BTPROTO_L2CAP);
-  if(sockListen < 0)
+  backend_->close();
+  reactor_.close();
+
+  backend_->restart(writePublicAddress ? &lastKnownState_.publicAddress : NULL);
+
+  reopen();
+}
+
+void BluetoothHCI::reopen()
+{
+  if(backend_->open() < 0)
   {
     LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
   }
+  reactor_.open();
+
+  // The controller was reset, so nothing we previously set can be assumed to
+  // still be in place, other than advertising certainly being disabled
+  appliedState_ = LastKnownState();
+  appliedState_.isAdvertising = false;
+  appliedState_.isAdvertisingStored = true;
+  appliedState_.isExtAdvertising = false;
+  appliedState_.isExtAdvertisingStored = true;
+
+  advertUpdate_.hasRandomAddress = false;
+  advertUpdate_.hasAdvertData = false;
+  advertUpdate_.hasResponseData = false;
+  advertUpdate_.hasAdvertParams = false;
+  advertUpdate_.hasAdvertising = false;
 
-  struct sockaddr_l2 addr = { 0 };
-  addr.l2_family = AF_BLUETOOTH;
-  addr.l2_bdaddr_type = BDADDR_LE_RANDOM;
-  addr.l2_cid = htobs(0x0004);
+  readState();
+}
 
-  int error;
-  if((error = bind(sockListen, (struct sockaddr *)&addr, sizeof(addr))) < 0)
+void BluetoothHCI::replayState()
+{
+  const uint16_t scanOpcode = cmd_opcode_pack(OGF_HOST_CTL, OCF_WRITE_SCAN_ENABLE);
+  const uint16_t inquiryModeOpcode = cmd_opcode_pack(OGF_HOST_CTL, OCF_WRITE_INQUIRY_MODE);
+  const uint16_t localNameOpcode = cmd_opcode_pack(OGF_HOST_CTL, OCF_CHANGE_LOCAL_NAME);
+  const uint16_t eirOpcode = cmd_opcode_pack(OGF_HOST_CTL, OCF_WRITE_EXT_INQUIRY_RESPONSE);
+
+  // The classic settings are sent together in one batch, followed by the
+  // advertising settings in another (which have their own ordering)
+  uint8_t scanParam = SCAN_DISABLED;
+  if(lastKnownState_.isConnectable)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    scanParam |= SCAN_PAGE;
   }
+  if(lastKnownState_.isDiscoverable)
+  {
+    scanParam |= SCAN_INQUIRY;
+  }
+
+  write_inquiry_mode_cp inquiryModeParam;
+  inquiryModeParam.mode = lastKnownState_.inquiryMode;
+
+  change_local_name_cp localNameParam;
+  memset(&localNameParam, 0, sizeof(localNameParam));
+  strncpy((char *)localNameParam.name, lastKnownState_.localName.c_str(), sizeof(localNameParam.name));
+
+  write_ext_inquiry_response_cp eirParam;
+  eirParam.fec = 0;
+  memcpy(eirParam.data, lastKnownState_.extInquiryResponse, HCI_MAX_EIR_LENGTH);
 
-  if((error = listen(sockListen, 5)) < 0)
+  bool sendScan = (appliedState_.isConnectable != lastKnownState_.isConnectable) || (appliedState_.isDiscoverable != lastKnownState_.isDiscoverable);
+
+  PendingCommand commands[4];
+  size_t numCommands = 0;
+  if(sendScan)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    commands[numCommands++] = { scanOpcode, &scanParam, 1, 0, false };
+  }
+  if(lastKnownState_.inquiryModeStored)
+  {
+    commands[numCommands++] = { inquiryModeOpcode, &inquiryModeParam, WRITE_INQUIRY_MODE_CP_SIZE, 0, false };
+  }
+  if(lastKnownState_.localNameStored)
+  {
+    commands[numCommands++] = { localNameOpcode, &localNameParam, CHANGE_LOCAL_NAME_CP_SIZE, 0, false };
+  }
+  if(lastKnownState_.extInquiryResponseStored)
+  {
+    commands[numCommands++] = { eirOpcode, &eirParam, WRITE_EXT_INQUIRY_RESPONSE_CP_SIZE, 0, false };
   }
 
-  int flags = fcntl(sockListen, F_GETFL, 0);
-  if((error = fcntl(sockListen, F_SETFL, flags | O_NONBLOCK)) < 0)
+  sendCommands(commands, numCommands);
+
+  appliedState_.isConnectable = lastKnownState_.isConnectable;
+  appliedState_.isDiscoverable = lastKnownState_.isDiscoverable;
+  if(lastKnownState_.inquiryModeStored)
   {
-    LOG_E_BT_CRASH("BluetoothHCI", "Recovery needed", __FILE__, __LINE__, errno);
+    appliedState_.inquiryMode = lastKnownState_.inquiryMode;
+    appliedState_.inquiryModeStored = true;
+  }
+  if(lastKnownState_.localNameStored)
+  {
+    appliedState_.localName = lastKnownState_.localName;
+    appliedState_.localNameStored = true;
+  }
+  if(lastKnownState_.extInquiryResponseStored)
+  {
+    memcpy(appliedState_.extInquiryResponse, lastKnownState_.extInquiryResponse, HCI_MAX_EIR_LENGTH);
+    appliedState_.extInquiryResponseStored = true;
   }
 
-  return sockListen;
+  advertUpdate_.randomAddress = lastKnownState_.randomAddress;
+  advertUpdate_.hasRandomAddress = lastKnownState_.randomAddressStored;
+  advertUpdate_.advertParams = lastKnownState_.advertParams;
+  advertUpdate_.hasAdvertParams = lastKnownState_.advertParamsStored;
+  advertUpdate_.advertData = lastKnownState_.advertData;
+  advertUpdate_.hasAdvertData = lastKnownState_.advertDataStored;
+  advertUpdate_.responseData = lastKnownState_.responseData;
+  advertUpdate_.hasResponseData = lastKnownState_.responseDataStored;
+  advertUpdate_.isAdvertising = lastKnownState_.isAdvertising;
+  advertUpdate_.hasAdvertising = lastKnownState_.isAdvertisingStored;
+
+  flushAdvertUpdate();
+
+  // Extended advertising is kept entirely in the last known state, so it only
+  // needs to be flushed again (which does nothing if it was never used)
+  flushExtAdvert();
 }
 
-pair<int, Address> BluetoothHCI::acceptBT2(int sockListen)
+int BluetoothHCI::connectBT2(const Address &address, uint8_t port, int64_t timeout)
 {
+  int sockConn = backend_->startConnect(HCIBackend::Transport::RFCOMM, address, port);
+  if(sockConn < 0)
+  {
+    return -1;
+  }
+
+  // Waiting for a connection until timeout occurs, if the connection is still
+  // in progress
   struct pollfd pollDesc;
-  pollDesc.fd = sockListen;
-  pollDesc.events = POLLIN;
+  pollDesc.fd = sockConn;
+  pollDesc.events = POLLOUT;
 
-  int error = poll(&pollDesc, 1, -1);
+  int error = poll(&pollDesc, 1, timeout);
   if(error <= 0)
   {
-    return make_pair(-1, Address());
+    close(sockConn);
+    sockConn = -1;
   }
-  else
-  {
-    struct sockaddr_rc addr;
-    socklen_t addrLength = sizeof(sockaddr_rc);
-    int sockClient = accept(sockListen, (struct sockaddr *)&addr, &addrLength);
-    Address address;
-    if(sockClient >= 0)
-    {
-      address = Address(6, addr.rc_bdaddr.b);
-    }
 
-    return make_pair(sockClient, address);
-  }
+  return sockConn;
 }
 
-pair<int, Address> BluetoothHCI::acceptBT4(int sockListen)
+int BluetoothHCI::connectBT4(const Address &address, int64_t timeout)
 {
+  int sockConn = startConnectBT4(address);
+  if(sockConn < 0)
+  {
+    return -1;
+  }
+
+  // Waiting for a connection until timeout occurs, if the connection is still
+  // in progress
   struct pollfd pollDesc;
-  pollDesc.fd = sockListen;
-  pollDesc.events = POLLIN;
+  pollDesc.fd = sockConn;
+  pollDesc.events = POLLOUT;
 
-  int error = poll(&pollDesc, 1, -1);
+  int error = poll(&pollDesc, 1, timeout);
   if(error <= 0)
   {
-    return make_pair(-1, Address());
+    close(sockConn);
+    sockConn = -1;
   }
-  else
-  {
-    struct sockaddr_l2 addr;
-    socklen_t addrLength = sizeof(sockaddr_l2);
-    int sockClient = accept(sockListen, (struct sockaddr *)&addr, &addrLength);
-    Address address;
-    if(sockClient >= 0)
-    {
-      address = Address(6, addr.l2_bdaddr.b);
-    }
 
-    return make_pair(sockClient, address);
-  }
+  return sockConn;
+}
+
+int BluetoothHCI::startConnectBT4(const Address &address)
+{
+  return backend_->startConnect(HCIBackend::Transport::LE, address, 0);
+}
+
+int BluetoothHCI::listenBT2(uint8_t port)
+{
+  return backend_->listen(HCIBackend::Transport::RFCOMM, port);
+}
+
+int BluetoothHCI::listenBT4()
+{
+  return backend_->listen(HCIBackend::Transport::LE, 0);
+}
+
+pair<int, Address> BluetoothHCI::acceptBT2(int sockListen)
+{
+  return backend_->accept(HCIBackend::Transport::RFCOMM, sockListen);
+}
+
+pair<int, Address> BluetoothHCI::acceptBT4(int sockListen)
+{
+  return backend_->accept(HCIBackend::Transport::LE, sockListen);
 }
 
 bool BluetoothHCI::send(int sock, const uint8_t *message, size_t size, int64_t timeout)
@@ -0,0 +1,124 @@
+#include "CaptureHCIBackend.h"
+
+#include "bluetooth/hci_lib.h"
+
+#include "BluetoothHCI.h"
+
+using namespace std;
+
+CaptureHCIBackend::CaptureHCIBackend(shared_ptr<HCIBackend> backend, shared_ptr<HCICaptureWriter> capture)
+   : backend_(backend),
+     capture_(capture)
+{
+}
+
+int CaptureHCIBackend::getAdapterID() const
+{
+  return backend_->getAdapterID();
+}
+
+int CaptureHCIBackend::open()
+{
+  return backend_->open();
+}
+
+void CaptureHCIBackend::close()
+{
+  backend_->close();
+}
+
+int CaptureHCIBackend::reset()
+{
+  return backend_->reset();
+}
+
+void CaptureHCIBackend::restart(const Address *publicAddress)
+{
+  backend_->restart(publicAddress);
+}
+
+int CaptureHCIBackend::readDeviceInfo(struct hci_dev_info *info)
+{
+  return backend_->readDeviceInfo(info);
+}
+
+int CaptureHCIBackend::setScanEnable(uint8_t scanEnable)
+{
+  return backend_->setScanEnable(scanEnable);
+}
+
+int CaptureHCIBackend::sendCommand(uint16_t opcode, const void *params, uint8_t length)
+{
+  checkSession(opcode, params, length);
+  return backend_->sendCommand(opcode, params, length);
+}
+
+int CaptureHCIBackend::sendRequest(struct hci_request *request, int timeout)
+{
+  checkSession(cmd_opcode_pack(request->ogf, request->ocf), request->cparam, request->clen);
+  return backend_->sendRequest(request, timeout);
+}
+
+int CaptureHCIBackend::inquiry(int periods, vector<inquiry_info> &responses)
+{
+  return backend_->inquiry(periods, responses);
+}
+
+void CaptureHCIBackend::openEvents(const struct hci_filter &filter)
+{
+  backend_->openEvents(filter);
+}
+
+void CaptureHCIBackend::closeEvents()
+{
+  backend_->closeEvents();
+}
+
+size_t CaptureHCIBackend::readEvents(int64_t timeout, uint8_t *buffer, size_t *lengths, size_t maxEvents)
+{
+  size_t numEvents = backend_->readEvents(timeout, buffer, lengths, maxEvents);
+  for(size_t e = 0; e < numEvents; e++)
+  {
+    capture_->addEvent(buffer + (e * HCI_MAX_EVENT_SIZE), lengths[e]);
+  }
+
+  return numEvents;
+}
+
+size_t CaptureHCIBackend::flushEvents()
+{
+  return backend_->flushEvents();
+}
+
+int CaptureHCIBackend::startConnect(Transport transport, const Address &address, uint8_t port)
+{
+  return backend_->startConnect(transport, address, port);
+}
+
+int CaptureHCIBackend::listen(Transport transport, uint8_t port)
+{
+  return backend_->listen(transport, port);
+}
+
+pair<int, Address> CaptureHCIBackend::accept(Transport transport, int sockListen)
+{
+  return backend_->accept(transport, sockListen);
+}
+
+void CaptureHCIBackend::checkSession(uint16_t opcode, const void *params, uint8_t length)
+{
+  if((opcode == cmd_opcode_pack(OGF_LINK_CTL, OCF_INQUIRY)) && (length >= INQUIRY_CP_SIZE))
+  {
+    capture_->beginSession(HCICapture::Session::Inquiry);
+  }
+  else if((opcode == cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_SCAN_ENABLE)) && (length >= LE_SET_SCAN_ENABLE_CP_SIZE) &&
+          ((const le_set_scan_enable_cp *)params)->enable)
+  {
+    capture_->beginSession(HCICapture::Session::Scan);
+  }
+  else if((opcode == cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_SCAN_ENABLE)) && (length >= LE_SET_EXTENDED_SCAN_ENABLE_CP_SIZE) &&
+          ((const le_set_extended_scan_enable_cp *)params)->enable)
+  {
+    capture_->beginSession(HCICapture::Session::ExtendedScan);
+  }
+}
@@ -0,0 +1,66 @@
+#include "Clock.h"
+
+#include <chrono>
+
+#include "Timing.h"
+
+using namespace std;
+
+shared_ptr<Clock> Clock::default_;
+
+shared_ptr<Clock> Clock::getDefault()
+{
+  if(default_)
+  {
+    return default_;
+  }
+
+  return getSystem();
+}
+
+void Clock::setDefault(shared_ptr<Clock> clock)
+{
+  default_ = clock;
+}
+
+shared_ptr<Clock> Clock::getSystem()
+{
+  static shared_ptr<Clock> system(new SystemClock());
+  return system;
+}
+
+Clock::~Clock()
+{
+}
+
+uint64_t SystemClock::getTimeMS() const
+{
+  return ::getTimeMS();
+}
+
+uint64_t SystemClock::getMonoMS() const
+{
+  return ::getMonoMS();
+}
+
+uint64_t SystemClock::getMonoUS() const
+{
+  return ::getMonoUS();
+}
+
+void SystemClock::sleepMS(uint64_t time)
+{
+  ::sleepMS(time);
+}
+
+void SystemClock::waitFor(unique_lock<mutex> &lock, condition_variable &cond, uint64_t timeout)
+{
+  if(timeout == UINT64_MAX)
+  {
+    cond.wait(lock);
+  }
+  else
+  {
+    cond.wait_for(lock, chrono::milliseconds(timeout));
+  }
+}
@@ -11,6 +11,7 @@ void Config::dump() const
   LOG_P("Config", "  Confirm Scheme = %s", EbNRadio::confirmSchemeStrings[radio.confirm.type]);
   LOG_P("Config", "  Threshold = %g", radio.confirm.threshold);
   LOG_P("Config", "  Memory Scheme = %s", EbNRadio::memorySchemeStrings[radio.memory]);
+  LOG_P("Config", "  Adapters = %zu", radio.numAdapters);
   LOG_P("Config", "Hysteresis Policy");
   LOG_P("Config", "  Scheme = %s", EbNHystPolicy::schemeStrings[hyst.scheme]);
   LOG_P("Config", "  Start Time (Min) = %" PRIu64 " min", TIME_MS_TO_MIN(hyst.minStartTime));
@@ -20,5 +21,15 @@ void Config::dump() const
   LOG_P("Config", "  RSSI Threshold = %d", hyst.rssiThreshold);
   LOG_P("Config", "Reporting");
   LOG_P("Config", "  RSSI Interval = %" PRIu64 " sec", TIME_MS_TO_SEC(reporting.rssiInterval));
+  if(simulation.numDevices > 0)
+  {
+    LOG_P("Config", "Simulation");
+    LOG_P("Config", "  Devices = %zu", simulation.numDevices);
+    LOG_P("Config", "  Range = %g m", simulation.range);
+    LOG_P("Config", "  Loss Rate = %g", simulation.lossRate);
+    LOG_P("Config", "  Duration = %" PRIu64 " min", TIME_MS_TO_MIN(simulation.duration));
+    LOG_P("Config", "  Seed = %" PRIu32, simulation.seed);
+    LOG_P("Config", "  Clock = %s", simulation.isRealTime ? "Real" : "Virtual");
+  }
 }
 
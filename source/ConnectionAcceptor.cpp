@@ -0,0 +1,580 @@
+#include "ConnectionAcceptor.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "AndroidWake.h"
+#include "BluetoothHCI.h"
+#include "Logger.h"
+#include "Timing.h"
+
+using namespace std;
+
+ConnectionAcceptor::Step ConnectionAcceptor::Step::send(vector<uint8_t> data, int64_t timeout)
+{
+  Step step;
+  step.type = Type::Send;
+  step.data = std::move(data);
+  step.size = step.data.size();
+  step.timeout = timeout;
+  step.isSuccess = false;
+  return step;
+}
+
+ConnectionAcceptor::Step ConnectionAcceptor::Step::receive(size_t size, int64_t timeout)
+{
+  Step step;
+  step.type = Type::Receive;
+  step.size = size;
+  step.timeout = timeout;
+  step.isSuccess = false;
+  return step;
+}
+
+ConnectionAcceptor::Step ConnectionAcceptor::Step::receiveFramed(int64_t timeout)
+{
+  Step step;
+  step.type = Type::ReceiveFramed;
+  step.size = 0;
+  step.timeout = timeout;
+  step.isSuccess = false;
+  return step;
+}
+
+ConnectionAcceptor::Step ConnectionAcceptor::Step::waitClose(int64_t timeout)
+{
+  Step step;
+  step.type = Type::WaitClose;
+  step.size = 0;
+  step.timeout = timeout;
+  step.isSuccess = false;
+  return step;
+}
+
+ConnectionAcceptor::Step ConnectionAcceptor::Step::compute()
+{
+  Step step;
+  step.type = Type::Compute;
+  step.size = 0;
+  step.timeout = 0;
+  step.isSuccess = false;
+  return step;
+}
+
+ConnectionAcceptor::Step ConnectionAcceptor::Step::close(bool isSuccess)
+{
+  Step step;
+  step.type = Type::Close;
+  step.size = 0;
+  step.timeout = 0;
+  step.isSuccess = isSuccess;
+  return step;
+}
+
+ConnectionAcceptor::Session::~Session()
+{
+}
+
+void ConnectionAcceptor::Session::compute()
+{
+}
+
+ConnectionAcceptor::ConnectionAcceptor(Accept accept, SessionFactory sessionFactory, size_t numWorkers, const char *wakeName)
+   : accept_(accept),
+     sessionFactory_(sessionFactory),
+     wakeName_(wakeName),
+     epoll_(-1),
+     wakeFD_(-1),
+     connections_(),
+     workers_(),
+     workQueue_(),
+     computedQueue_(),
+     workMutex_(),
+     workCond_(),
+     isStopping_(false)
+{
+  epoll_ = epoll_create(1);
+  if(epoll_ < 0)
+  {
+    LOG_E_BT_CRASH("ConnectionAcceptor", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  // Workers signal finished computations through an eventfd, so that the
+  // loop wakes up to continue those sessions
+  wakeFD_ = eventfd(0, EFD_NONBLOCK);
+  if(wakeFD_ < 0)
+  {
+    LOG_E_BT_CRASH("ConnectionAcceptor", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = wakeFD_;
+
+  if(epoll_ctl(epoll_, EPOLL_CTL_ADD, wakeFD_, &event) < 0)
+  {
+    LOG_E_BT_CRASH("ConnectionAcceptor", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  for(size_t w = 0; w < numWorkers; w++)
+  {
+    workers_.push_back(thread(&ConnectionAcceptor::work, this));
+  }
+}
+
+ConnectionAcceptor::~ConnectionAcceptor()
+{
+  unique_lock<mutex> workLock(workMutex_);
+  isStopping_ = true;
+  workCond_.notify_all();
+  workLock.unlock();
+
+  for(auto it = workers_.begin(); it != workers_.end(); it++)
+  {
+    it->join();
+  }
+
+  ::close(wakeFD_);
+  ::close(epoll_);
+}
+
+void ConnectionAcceptor::run(int sockListen)
+{
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = sockListen;
+
+  if(epoll_ctl(epoll_, EPOLL_CTL_ADD, sockListen, &event) < 0)
+  {
+    LOG_E_BT_CRASH("ConnectionAcceptor", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  bool isListening = true;
+  while(isListening)
+  {
+    // Sleeping until the earliest deadline of any connection that is waiting
+    // on the remote side (computations are not timed out)
+    uint64_t curTime = getMonoMS();
+    int64_t timeout = -1;
+    for(auto it = connections_.begin(); it != connections_.end(); it++)
+    {
+      if(!it->second.isComputing)
+      {
+        int64_t remainingTime = (it->second.deadline > curTime) ? (it->second.deadline - curTime) : 0;
+        timeout = (timeout < 0) ? remainingTime : min(timeout, remainingTime);
+      }
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    int numEvents = epoll_wait(epoll_, events, MAX_EVENTS, timeout);
+    if(numEvents < 0)
+    {
+      if(errno == EINTR)
+      {
+        continue;
+      }
+
+      LOG_E("ConnectionAcceptor", "Failed to wait for events (Error %d: %s)", errno, strerror(errno));
+      break;
+    }
+
+    for(int e = 0; e < numEvents; e++)
+    {
+      int fd = events[e].data.fd;
+      if(fd == sockListen)
+      {
+        if((events[e].events & (EPOLLERR | EPOLLHUP)) != 0)
+        {
+          LOG_D("ConnectionAcceptor", "Listen socket failed");
+          isListening = false;
+        }
+        else
+        {
+          acceptClient(sockListen);
+        }
+      }
+      else if(fd == wakeFD_)
+      {
+        collectComputed(false);
+      }
+      else
+      {
+        // A connection closed earlier in this batch may still have an event
+        auto it = connections_.find(fd);
+        if((it != connections_.end()) && !it->second.isComputing)
+        {
+          handleEvent(it->second, events[e].events);
+        }
+      }
+    }
+
+    expireConnections();
+  }
+
+  epoll_ctl(epoll_, EPOLL_CTL_DEL, sockListen, NULL);
+
+  // Closing everything that is still open, first waiting on any sessions
+  // that are in the middle of a computation
+  while(!connections_.empty())
+  {
+    vector<int> toClose;
+    for(auto it = connections_.begin(); it != connections_.end(); it++)
+    {
+      if(!it->second.isComputing)
+      {
+        toClose.push_back(it->first);
+      }
+    }
+    for(auto it = toClose.begin(); it != toClose.end(); it++)
+    {
+      closeConnection(*it, false);
+    }
+
+    if(!connections_.empty())
+    {
+      struct pollfd pollDesc;
+      pollDesc.fd = wakeFD_;
+      pollDesc.events = POLLIN;
+
+      if(poll(&pollDesc, 1, -1) > 0)
+      {
+        collectComputed(true);
+      }
+    }
+  }
+}
+
+void ConnectionAcceptor::acceptClient(int sockListen)
+{
+  // Only accepting one client per event, since accept_ blocks if there are no
+  // more pending (the listen socket is still readable if there are)
+  pair<int, Address> clientInfo = accept_(sockListen);
+  int sock = clientInfo.first;
+  if(sock < 0)
+  {
+    return;
+  }
+
+  unique_ptr<Session> session = sessionFactory_(clientInfo.second);
+  if(!session)
+  {
+    ::close(sock);
+    return;
+  }
+
+  int flags = fcntl(sock, F_GETFL, 0);
+  if(fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0)
+  {
+    LOG_E_BT_CRASH("ConnectionAcceptor", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = 0;
+  event.data.fd = sock;
+
+  if(epoll_ctl(epoll_, EPOLL_CTL_ADD, sock, &event) < 0)
+  {
+    LOG_E_BT_CRASH("ConnectionAcceptor", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  if(connections_.empty())
+  {
+    AndroidWake::grab(wakeName_);
+  }
+
+  Connection &connection = connections_[sock];
+  connection.sock = sock;
+  connection.address = clientInfo.second;
+  connection.session = std::move(session);
+  connection.pos = 0;
+  connection.hasFrameSize = false;
+  connection.deadline = 0;
+  connection.isComputing = false;
+
+  LOG_D("ConnectionAcceptor", "Accepted incoming connection from %s (%zu open)", connection.address.toString().c_str(), connections_.size());
+
+  beginStep(connection, connection.session->start());
+}
+
+void ConnectionAcceptor::beginStep(Connection &connection, Step step)
+{
+  connection.step = std::move(step);
+  connection.buffer.clear();
+  connection.pos = 0;
+  connection.hasFrameSize = false;
+  connection.deadline = getMonoMS() + connection.step.timeout;
+
+  switch(connection.step.type)
+  {
+  case Step::Type::Send:
+    updateEvents(connection, EPOLLOUT);
+    break;
+
+  case Step::Type::Receive:
+    connection.buffer.resize(connection.step.size);
+    updateEvents(connection, EPOLLIN);
+    break;
+
+  case Step::Type::ReceiveFramed:
+    connection.buffer.resize(sizeof(uint32_t));
+    updateEvents(connection, EPOLLIN);
+    break;
+
+  case Step::Type::WaitClose:
+    updateEvents(connection, EPOLLIN);
+    break;
+
+  case Step::Type::Compute:
+    {
+      // Removing the socket from the epoll set while computing, since we
+      // would otherwise keep being woken up if the remote side hangs up
+      connection.isComputing = true;
+      if(epoll_ctl(epoll_, EPOLL_CTL_DEL, connection.sock, NULL) < 0)
+      {
+        LOG_E_BT_CRASH("ConnectionAcceptor", "Recovery needed", __FILE__, __LINE__, errno);
+      }
+
+      lock_guard<mutex> workLock(workMutex_);
+      workQueue_.push_back(make_pair(connection.sock, connection.session.get()));
+      workCond_.notify_one();
+    }
+    break;
+
+  case Step::Type::Close:
+    closeConnection(connection.sock, connection.step.isSuccess);
+    break;
+  }
+}
+
+void ConnectionAcceptor::handleEvent(Connection &connection, uint32_t events)
+{
+  switch(connection.step.type)
+  {
+  case Step::Type::Send:
+    {
+      ssize_t numWritten = write(connection.sock, connection.step.data.data() + connection.pos, connection.step.data.size() - connection.pos);
+      if(numWritten < 0)
+      {
+        if((errno != EAGAIN) && (errno != EWOULDBLOCK))
+        {
+          closeConnection(connection.sock, false);
+        }
+        return;
+      }
+
+      connection.pos += numWritten;
+      if(connection.pos == connection.step.data.size())
+      {
+        finishStep(connection);
+      }
+    }
+    break;
+
+  case Step::Type::Receive:
+  case Step::Type::ReceiveFramed:
+    {
+      ssize_t numRead = read(connection.sock, connection.buffer.data() + connection.pos, connection.buffer.size() - connection.pos);
+      if(numRead <= 0)
+      {
+        if((numRead == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK)))
+        {
+          closeConnection(connection.sock, false);
+        }
+        return;
+      }
+
+      connection.pos += numRead;
+      if(connection.pos < connection.buffer.size())
+      {
+        return;
+      }
+
+      // Having read the length of a framed message, now reading its contents
+      if((connection.step.type == Step::Type::ReceiveFramed) && !connection.hasFrameSize)
+      {
+        uint32_t frameSize;
+        memcpy(&frameSize, connection.buffer.data(), sizeof(frameSize));
+        if(frameSize > MAX_FRAME_SIZE)
+        {
+          LOG_W("ConnectionAcceptor", "Message of size %u from %s is too large", frameSize, connection.address.toString().c_str());
+          closeConnection(connection.sock, false);
+          return;
+        }
+
+        connection.hasFrameSize = true;
+        connection.buffer.assign(frameSize, 0);
+        connection.pos = 0;
+        if(frameSize > 0)
+        {
+          return;
+        }
+      }
+
+      finishStep(connection);
+    }
+    break;
+
+  case Step::Type::WaitClose:
+    {
+      // Discarding anything else sent, until the remote side closes
+      uint8_t discard[64];
+      ssize_t numRead = read(connection.sock, discard, sizeof(discard));
+      if((numRead == 0) || ((numRead < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)))
+      {
+        finishStep(connection);
+      }
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+void ConnectionAcceptor::finishStep(Connection &connection)
+{
+  vector<uint8_t> received;
+  if((connection.step.type == Step::Type::Receive) || (connection.step.type == Step::Type::ReceiveFramed))
+  {
+    received.swap(connection.buffer);
+  }
+
+  beginStep(connection, connection.session->advance(received));
+}
+
+void ConnectionAcceptor::closeConnection(int sock, bool isSuccess)
+{
+  auto it = connections_.find(sock);
+  if(it == connections_.end())
+  {
+    return;
+  }
+
+  it->second.session->finish(isSuccess);
+
+  // Closing the socket also removes it from the epoll set
+  ::close(sock);
+  connections_.erase(it);
+
+  if(connections_.empty())
+  {
+    AndroidWake::release(wakeName_);
+  }
+}
+
+void ConnectionAcceptor::updateEvents(Connection &connection, uint32_t events)
+{
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = events;
+  event.data.fd = connection.sock;
+
+  if(epoll_ctl(epoll_, EPOLL_CTL_MOD, connection.sock, &event) < 0)
+  {
+    LOG_E_BT_CRASH("ConnectionAcceptor", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+}
+
+void ConnectionAcceptor::expireConnections()
+{
+  uint64_t curTime = getMonoMS();
+
+  vector<int> expired;
+  for(auto it = connections_.begin(); it != connections_.end(); it++)
+  {
+    if(!it->second.isComputing && (curTime >= it->second.deadline))
+    {
+      expired.push_back(it->first);
+    }
+  }
+
+  for(auto it = expired.begin(); it != expired.end(); it++)
+  {
+    Connection &connection = connections_[*it];
+
+    // Not hearing back from the remote side before closing is expected
+    if(connection.step.type == Step::Type::WaitClose)
+    {
+      finishStep(connection);
+    }
+    else
+    {
+      LOG_D("ConnectionAcceptor", "Timed out with %s", connection.address.toString().c_str());
+      closeConnection(*it, false);
+    }
+  }
+}
+
+void ConnectionAcceptor::collectComputed(bool isClosing)
+{
+  uint64_t count;
+  while(read(wakeFD_, &count, sizeof(count)) > 0)
+  {
+  }
+
+  unique_lock<mutex> workLock(workMutex_);
+  deque<int> computed;
+  computed.swap(computedQueue_);
+  workLock.unlock();
+
+  for(auto it = computed.begin(); it != computed.end(); it++)
+  {
+    Connection &connection = connections_[*it];
+    connection.isComputing = false;
+
+    if(isClosing)
+    {
+      closeConnection(*it, false);
+      continue;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = 0;
+    event.data.fd = connection.sock;
+
+    if(epoll_ctl(epoll_, EPOLL_CTL_ADD, connection.sock, &event) < 0)
+    {
+      LOG_E_BT_CRASH("ConnectionAcceptor", "Recovery needed", __FILE__, __LINE__, errno);
+    }
+
+    finishStep(connection);
+  }
+}
+
+void ConnectionAcceptor::work()
+{
+  while(true)
+  {
+    unique_lock<mutex> workLock(workMutex_);
+    workCond_.wait(workLock, [this]() { return isStopping_ || !workQueue_.empty(); });
+    if(isStopping_)
+    {
+      break;
+    }
+
+    pair<int, Session *> work = workQueue_.front();
+    workQueue_.pop_front();
+    workLock.unlock();
+
+    work.second->compute();
+
+    workLock.lock();
+    computedQueue_.push_back(work.first);
+    workLock.unlock();
+
+    uint64_t count = 1;
+    if(write(wakeFD_, &count, sizeof(count)) < 0)
+    {
+      LOG_E("ConnectionAcceptor", "Failed to signal computation (Error %d: %s)", errno, strerror(errno));
+    }
+  }
+}
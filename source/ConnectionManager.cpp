@@ -0,0 +1,258 @@
+#include "ConnectionManager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "BluetoothHCI.h"
+#include "Logger.h"
+
+using namespace std;
+
+ConnectionManager::ConnectionManager(StartConnect startConnect, size_t maxConnections, int64_t connectTimeout, int64_t exchangeTimeout)
+   : startConnect_(startConnect),
+     maxConnections_(maxConnections),
+     connectTimeout_(connectTimeout),
+     exchangeTimeout_(exchangeTimeout),
+     clock_(Clock::getDefault()),
+     epoll_(-1)
+{
+  epoll_ = epoll_create(1);
+  if(epoll_ < 0)
+  {
+    LOG_E_BT_CRASH("ConnectionManager", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+}
+
+ConnectionManager::~ConnectionManager()
+{
+  if(epoll_ != -1)
+  {
+    close(epoll_);
+  }
+}
+
+vector<ConnectionManager::Result> ConnectionManager::run(const vector<Address> &addresses, const vector<uint8_t> &message, size_t replySize, int64_t startTimeout)
+{
+  vector<Result> results(addresses.size());
+  for(auto it = results.begin(); it != results.end(); it++)
+  {
+    it->isAttempted = false;
+    it->isSuccess = false;
+    it->reply.assign(replySize, 0);
+  }
+
+  vector<Connection> connections;
+  connections.reserve(maxConnections_);
+
+  const uint64_t startDeadline = clock_->getMonoMS() + max<int64_t>(startTimeout, 0);
+  uint64_t retryTime = 0;
+  size_t next = 0;
+
+  while((next < addresses.size()) || !connections.empty())
+  {
+    uint64_t curTime = clock_->getMonoMS();
+    bool canStart = (curTime < startDeadline);
+
+    // Starting as many new connections as we are allowed. The controller may
+    // only be able to create one connection at a time, in which case we will
+    // be told to retry once the pending one is done.
+    while(canStart && (next < addresses.size()) && (connections.size() < maxConnections_) && (curTime >= retryTime))
+    {
+      int sock = startConnect_(addresses[next]);
+      if(sock < 0)
+      {
+        if(errno == EBUSY)
+        {
+          retryTime = curTime + RETRY_INTERVAL;
+          break;
+        }
+
+        results[next].isAttempted = true;
+        next++;
+        continue;
+      }
+
+      struct epoll_event event;
+      memset(&event, 0, sizeof(event));
+      event.events = EPOLLOUT;
+      event.data.fd = sock;
+
+      if(epoll_ctl(epoll_, EPOLL_CTL_ADD, sock, &event) < 0)
+      {
+        LOG_E_BT_CRASH("ConnectionManager", "Recovery needed", __FILE__, __LINE__, errno);
+      }
+
+      LOG_D("ConnectionManager", "Connecting to %s (%zu in flight)", addresses[next].toString().c_str(), connections.size() + 1);
+
+      Connection connection;
+      connection.index = next;
+      connection.sock = sock;
+      connection.state = State::Connecting;
+      connection.deadline = curTime + connectTimeout_;
+      connection.pos = 0;
+      connections.push_back(connection);
+
+      results[next].isAttempted = true;
+      next++;
+    }
+
+    if(!canStart && (next < addresses.size()))
+    {
+      LOG_D("ConnectionManager", "Out of time, skipping %zu remaining devices", addresses.size() - next);
+      next = addresses.size();
+    }
+
+    if(connections.empty())
+    {
+      if((next < addresses.size()) && (retryTime > curTime))
+      {
+        clock_->sleepMS(min(retryTime, startDeadline) - curTime);
+      }
+      continue;
+    }
+
+    // Waiting until the earliest deadline (or retry) for any events
+    uint64_t wakeTime = connections.front().deadline;
+    for(auto it = connections.begin(); it != connections.end(); it++)
+    {
+      wakeTime = min(wakeTime, it->deadline);
+    }
+    if((next < addresses.size()) && (connections.size() < maxConnections_))
+    {
+      wakeTime = min(wakeTime, max(retryTime, curTime));
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    int numEvents = epoll_wait(epoll_, events, MAX_EVENTS, (wakeTime > curTime) ? (wakeTime - curTime) : 0);
+    if((numEvents < 0) && (errno != EINTR))
+    {
+      LOG_E_BT_CRASH("ConnectionManager", "Recovery needed", __FILE__, __LINE__, errno);
+    }
+
+    for(int e = 0; e < numEvents; e++)
+    {
+      auto it = find_if(connections.begin(), connections.end(), [&](const Connection &c) { return c.sock == events[e].data.fd; });
+      if(it == connections.end())
+      {
+        continue;
+      }
+
+      if(handleEvent(*it, events[e].events, message, results[it->index]))
+      {
+        connections.erase(it);
+      }
+    }
+
+    // Giving up on any connections that have run out of time
+    curTime = clock_->getMonoMS();
+    for(auto it = connections.begin(); it != connections.end();)
+    {
+      if(curTime >= it->deadline)
+      {
+        LOG_D("ConnectionManager", "Timed out with %s", addresses[it->index].toString().c_str());
+        finish(*it, results[it->index], false);
+        it = connections.erase(it);
+      }
+      else
+      {
+        it++;
+      }
+    }
+  }
+
+  return results;
+}
+
+bool ConnectionManager::handleEvent(Connection &connection, uint32_t events, const vector<uint8_t> &message, Result &result)
+{
+  if(connection.state == State::Connecting)
+  {
+    int error = 0;
+    socklen_t errorLength = sizeof(error);
+    if((getsockopt(connection.sock, SOL_SOCKET, SO_ERROR, &error, &errorLength) < 0) || (error != 0))
+    {
+      finish(connection, result, false);
+      return true;
+    }
+
+    connection.state = State::Sending;
+    connection.deadline = clock_->getMonoMS() + exchangeTimeout_;
+  }
+  else if((events & (EPOLLERR | EPOLLHUP)) && !(events & EPOLLIN))
+  {
+    finish(connection, result, false);
+    return true;
+  }
+
+  if(connection.state == State::Sending)
+  {
+    ssize_t numWritten = write(connection.sock, message.data() + connection.pos, message.size() - connection.pos);
+    if(numWritten < 0)
+    {
+      if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+      {
+        return false;
+      }
+
+      finish(connection, result, false);
+      return true;
+    }
+
+    connection.pos += numWritten;
+    if(connection.pos < message.size())
+    {
+      return false;
+    }
+
+    connection.state = State::Receiving;
+    connection.deadline = clock_->getMonoMS() + exchangeTimeout_;
+    connection.pos = 0;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = connection.sock;
+
+    if(epoll_ctl(epoll_, EPOLL_CTL_MOD, connection.sock, &event) < 0)
+    {
+      LOG_E_BT_CRASH("ConnectionManager", "Recovery needed", __FILE__, __LINE__, errno);
+    }
+
+    return false;
+  }
+
+  // Receiving
+  ssize_t numRead = read(connection.sock, result.reply.data() + connection.pos, result.reply.size() - connection.pos);
+  if(numRead <= 0)
+  {
+    if((numRead < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+    {
+      return false;
+    }
+
+    finish(connection, result, false);
+    return true;
+  }
+
+  connection.pos += numRead;
+  if(connection.pos < result.reply.size())
+  {
+    return false;
+  }
+
+  finish(connection, result, true);
+  return true;
+}
+
+void ConnectionManager::finish(Connection &connection, Result &result, bool isSuccess)
+{
+  // Closing the socket also removes it from the epoll set
+  close(connection.sock);
+  connection.sock = -1;
+
+  result.isSuccess = isSuccess;
+}
@@ -0,0 +1,94 @@
+#include "CrowdGenerator.h"
+
+#include "Logger.h"
+
+using namespace std;
+
+CrowdGenerator::CrowdGenerator(const Config &config, RadioFactory radioFactory, const LinkValueList &listenSet)
+   : config_(config),
+     clock_(Clock::getDefault()),
+     peers_(),
+     random_(config.seed),
+     numMatching_(0),
+     numEpochChanges_(0)
+{
+  vector<LinkValue> listenValues(listenSet.begin(), listenSet.end());
+  uniform_int_distribution<uint64_t> phase(0, EbNRadio::getEpochInterval() - 1);
+
+  uint64_t curTime = clock_->getTimeMS();
+  peers_.reserve(config_.numPeers);
+  for(size_t p = 0; p < config_.numPeers; p++)
+  {
+    Peer peer;
+    peer.radio = radioFactory(config_.firstAdapterID + p);
+
+    bool isMatching = false;
+    peer.radio->setAdvertisedSet(generateAdvertisedSet(listenValues, isMatching));
+    numMatching_ += isMatching;
+
+    peer.radio->initializePeer();
+
+    // Moving the peer along to where it would be at its phase, having started
+    // its current epoch before we arrived
+    uint64_t remaining = phase(random_);
+    uint64_t numAdverts = (EbNRadio::getEpochInterval() - remaining) / peer.radio->getDiscoverInterval();
+    for(uint64_t a = 0; a < numAdverts; a++)
+    {
+      peer.radio->changePeerAdvert();
+    }
+    peer.nextChangeEpoch = curTime + remaining;
+
+    peers_.push_back(peer);
+  }
+
+  LOG_D("CrowdGenerator", "Created %zu peers (%zu matching) with sets of %zu entries, %.2f overlap", peers_.size(), numMatching_,
+        config_.setSize, config_.overlap);
+}
+
+void CrowdGenerator::advance()
+{
+  uint64_t curTime = clock_->getTimeMS();
+  for(auto it = peers_.begin(); it != peers_.end(); it++)
+  {
+    if(curTime >= it->nextChangeEpoch)
+    {
+      it->radio->changeEpoch();
+      numEpochChanges_++;
+
+      // Skipping any epochs that were missed entirely, keeping the phase
+      while(it->nextChangeEpoch <= curTime)
+      {
+        it->nextChangeEpoch += EbNRadio::getEpochInterval();
+      }
+    }
+
+    it->radio->changePeerAdvert();
+  }
+}
+
+LinkValueList CrowdGenerator::generateAdvertisedSet(const vector<LinkValue> &listenValues, bool &isMatching)
+{
+  bernoulli_distribution isShared(config_.overlap);
+  uniform_int_distribution<int> byte(0, 0xFF);
+
+  LinkValueList advertisedSet;
+  for(size_t e = 0; e < config_.setSize; e++)
+  {
+    if(!listenValues.empty() && isShared(random_))
+    {
+      advertisedSet.push_back(listenValues[uniform_int_distribution<size_t>(0, listenValues.size() - 1)(random_)]);
+      isMatching = true;
+    }
+    else
+    {
+      LinkValue linkValue(new uint8_t[config_.linkValueSize], config_.linkValueSize);
+      for(size_t b = 0; b < config_.linkValueSize; b++)
+      {
+        linkValue[b] = byte(random_);
+      }
+      advertisedSet.push_back(linkValue);
+    }
+  }
+
+  return advertisedSet;
+}
@@ -0,0 +1,115 @@
+#include "DHDecodeBench.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "Logger.h"
+#include "RSErasureDecoder.h"
+#include "RSErasureEncoder.h"
+
+using namespace std;
+
+DHDecodeBench::DHDecodeBench(const EbNRadioBT4 &radio)
+   : matrix_(radio.getDHCodeMatrix()),
+     numEpochSymbols_(radio.getNumAdverts()),
+     numScanAdverts_(radio.getNumScanAdverts()),
+     scanInterval_(radio.getDiscoverInterval())
+{
+}
+
+vector<uint64_t> DHDecodeBench::run(float lossRate, size_t numTrials)
+{
+  const size_t numEpochs = 4;
+  const size_t K = matrix_.K();
+  const size_t W = matrix_.W();
+  const uint64_t epochInterval = EbNRadio::getEpochInterval();
+
+  vector<uint64_t> decodeTimes;
+  for(size_t t = 0; t < numTrials; t++)
+  {
+    vector<vector<uint8_t> > epochData(numEpochs, vector<uint8_t>(K * W));
+    vector<RSErasureEncoder> encoders;
+    vector<RSErasureDecoder> decoders;
+    for(size_t e = 0; e < numEpochs; e++)
+    {
+      for(size_t b = 0; b < epochData[e].size(); b++)
+      {
+        epochData[e][b] = rand() & 0xFF;
+      }
+
+      encoders.push_back(RSErasureEncoder(matrix_));
+      encoders.back().encode(epochData[e].data());
+      decoders.push_back(RSErasureDecoder(matrix_));
+    }
+
+    // Sender schedule, as (time, epoch, advert number) for each advert change
+    vector<pair<uint64_t, pair<size_t, size_t> > > sendSchedule;
+    size_t sendEpoch = 0;
+    size_t sendAdvertNum = 0;
+    for(uint64_t time = rand() % scanInterval_; time < (numEpochs * epochInterval); time += scanInterval_ + (-1000 + (rand() % 2001)))
+    {
+      if((time / epochInterval) != sendEpoch)
+      {
+        sendEpoch = time / epochInterval;
+        sendAdvertNum = 0;
+      }
+
+      if(sendAdvertNum < numEpochSymbols_)
+      {
+        sendSchedule.push_back(make_pair(time, make_pair(sendEpoch, sendAdvertNum)));
+        sendAdvertNum += numScanAdverts_;
+      }
+    }
+
+    // Listener, arriving at a random point within the first epoch
+    uint64_t startTime = rand() % epochInterval;
+    uint64_t decodeTime = UINT64_MAX;
+    size_t s = 0;
+    for(uint64_t time = startTime; (time < (numEpochs * epochInterval)) && (decodeTime == UINT64_MAX); time += scanInterval_ + (-1000 + (rand() % 2001)))
+    {
+      while(((s + 1) < sendSchedule.size()) && (sendSchedule[s + 1].first <= time))
+      {
+        s++;
+      }
+      if(sendSchedule[s].first > time)
+      {
+        continue;
+      }
+
+      size_t epoch = sendSchedule[s].second.first;
+      for(size_t a = 0; a < numScanAdverts_; a++)
+      {
+        size_t advertNum = sendSchedule[s].second.second + a;
+        if((advertNum >= numEpochSymbols_) || ((rand() / (float)RAND_MAX) < lossRate))
+        {
+          continue;
+        }
+
+        decoders[epoch].setSymbol(advertNum, encoders[epoch].getSymbol(advertNum));
+        if((advertNum < (K - 1)) && (epoch > 0))
+        {
+          decoders[epoch - 1].setSymbol(advertNum + numEpochSymbols_, encoders[epoch - 1].getSymbol(advertNum + numEpochSymbols_));
+        }
+      }
+
+      for(size_t e = 0; e < numEpochs; e++)
+      {
+        if(decoders[e].canDecode())
+        {
+          const uint8_t *decoded = decoders[e].decode();
+          if((decoded == NULL) || (memcmp(decoded, epochData[e].data(), epochData[e].size()) != 0))
+          {
+            LOG_E("DHDecodeBench", "Simulated decode of epoch %zu produced an incorrect value", e);
+          }
+
+          decodeTime = time - startTime;
+          break;
+        }
+      }
+    }
+
+    decodeTimes.push_back(decodeTime);
+  }
+
+  return decodeTimes;
+}
@@ -2,6 +2,9 @@
 
 #include <stdexcept>
 
+#include "Metrics.h"
+#include "Probes.h"
+
 using namespace std;
 
 ECDH::ECDH()
@@ -44,6 +47,8 @@ ECDH::ECDH(size_t keySize)
 
 void ECDH::generateSecret()
 {
+  Metrics::Timer timer(Metrics::Histogram::ECDHGenerate);
+
   secret_.reset(EC_KEY_dup(secret_.get()), &EC_KEY_free);
   EC_KEY_generate_key(secret_.get());
   EC_POINT_point2oct(EC_KEY_get0_group(secret_.get()), EC_KEY_get0_public_key(secret_.get()), POINT_CONVERSION_COMPRESSED, localPublic_.data(), localPublic_.size(), NULL);
@@ -60,6 +65,7 @@ bool ECDH::computeSharedSecret(SharedSecret &dest, const uint8_t *remotePublicX,
 
 bool ECDH::computeSharedSecret(SharedSecret &dest, const uint8_t *remotePublic) const
 {
+  Metrics::Timer timer(Metrics::Histogram::ECDHSharedSecret);
   bool success = false;
 
   const EC_GROUP *group = EC_KEY_get0_group(secret_.get());
@@ -73,6 +79,9 @@ bool ECDH::computeSharedSecret(SharedSecret &dest, const uint8_t *remotePublic)
     }
   }
 
+  Metrics::increment(success ? Metrics::Counter::SharedSecrets : Metrics::Counter::SharedSecretFailures);
+  PROBE1(shared_secret, success);
+
   return success;
 }
 
@@ -2,24 +2,40 @@
 
 #include <stdexcept>
 
+#include "BluetoothHCI.h"
 #include "EbNRadioBT2.h"
 #include "EbNRadioBT2NR.h"
 #include "EbNRadioBT2PSI.h"
 #include "EbNRadioBT4.h"
 #include "EbNRadioBT4AR.h"
 #include "Logger.h"
-#include "Timing.h"
+#include "Metrics.h"
+#include "Probes.h"
 
 using namespace std;
 
 EbNController::EbNController(shared_ptr<EbNRadio> radio, EbNHystPolicy hystPolicy, uint64_t rssiReportInterval)
-   : radio_(radio),
+   : EbNController(vector<shared_ptr<EbNRadio> >(1, radio), hystPolicy, rssiReportInterval)
+{
+}
+
+EbNController::EbNController(const vector<shared_ptr<EbNRadio> > &radios, EbNHystPolicy hystPolicy, uint64_t rssiReportInterval)
+   : radios_(radios),
      hystPolicy_(hystPolicy),
      rssiReportInterval_(rssiReportInterval),
+     clock_(Clock::getDefault()),
      encounterCallback_(encounterDefault),
-     sleepCallback_(sleepMS),
-     isRunning_(false)
+     sleepCallback_(bind(&Clock::sleepMS, clock_.get(), placeholders::_1)),
+     isRunning_(false),
+     mergedDevices_(),
+     radioToMerged_(radios.size()),
+     addressToMerged_(),
+     nextMergedID_(0)
 {
+  if(radios_.empty())
+  {
+    throw std::runtime_error("EbNController requires at least one radio");
+  }
 }
 
 void EbNController::setEncounterCallback(const function<void(const EncounterEvent&)> &callback)
@@ -36,13 +52,31 @@ void EbNController::run()
 {
   isRunning_ = true;
 
-  radio_->initialize();
+  for(size_t r = 0; r < radios_.size(); r++)
+  {
+    radios_[r]->initialize();
+
+    // Spreading out the discoveries across the interval, so that the
+    // adapters take turns scanning (and the rest are advertising meanwhile)
+    radios_[r]->delayDiscover((radios_[r]->getDiscoverInterval() * r) / radios_.size());
+  }
 
   while(isRunning_)
   {
-    EbNRadio::ActionInfo actionInfo = radio_->getNextAction();
+    // Performing whichever radio's action is due first
+    size_t radioIndex = 0;
+    EbNRadio::ActionInfo actionInfo = radios_[0]->getNextAction();
+    for(size_t r = 1; r < radios_.size(); r++)
+    {
+      EbNRadio::ActionInfo radioActionInfo = radios_[r]->getNextAction();
+      if(radioActionInfo.timeUntil < actionInfo.timeUntil)
+      {
+        radioIndex = r;
+        actionInfo = radioActionInfo;
+      }
+    }
 
-    LOG_D("EbNController", "Next action is %s after %" PRIu64 " ms", (actionInfo.action == EbNRadio::Action::ChangeEpoch) ? "ChangeEpoch" : "Discover", actionInfo.timeUntil);
+    LOG_D("EbNController", "Next action is %s on radio %zu after %" PRIu64 " ms", (actionInfo.action == EbNRadio::Action::ChangeEpoch) ? "ChangeEpoch" : "Discover", radioIndex, actionInfo.timeUntil);
 
     if(actionInfo.timeUntil > 0)
     {
@@ -54,54 +88,308 @@ void EbNController::run()
       LOG_D("EbNController", "Executing the action immediately");
     }
 
-    switch(actionInfo.action)
+    // Bluetooth errors are recovered from in place, so that all of the
+    // radio's device state is kept
+    try
     {
-    case EbNRadio::Action::ChangeEpoch:
-      radio_->changeEpoch();
-      break;
-
-    case EbNRadio::Action::Discover:
+      switch(actionInfo.action)
+      {
+      case EbNRadio::Action::ChangeEpoch:
       {
-        list<DiscoverEvent> discovered = radio_->discover();
-        list<pair<DeviceID, uint64_t> > newlyDiscovered;
-        set<DeviceID> toHandshake = hystPolicy_.discovered(discovered, newlyDiscovered);
-        hystPolicy_.encountered(radio_->handshake(toHandshake));
+        Metrics::Timer timer(Metrics::Histogram::EpochChange);
+        PROBE1(epoch_create, radioIndex);
+        radios_[radioIndex]->changeEpoch();
+        break;
+      }
+
+      case EbNRadio::Action::Discover:
+        discover(radioIndex);
+        break;
+      }
+    }
+    catch(BluetoothHCIException &ex)
+    {
+      LOG_W("EbNController", "Action failed, recovering radio %zu - %s", radioIndex, ex.what());
+      recover(radioIndex);
+    }
+  }
 
-        list<EncounterEvent> encounters;
+  LOG_D("EbNController", "Stopped");
+}
 
-        for(auto ndIt = newlyDiscovered.begin(); ndIt != newlyDiscovered.end(); ndIt++)
-        {
-          EncounterEvent event(EncounterEvent::UnconfirmedStarted, ndIt->second, ndIt->first);
-          encounters.push_back(event);
-        }
+void EbNController::discover(size_t radioIndex)
+{
+  shared_ptr<EbNRadio> &radio = radios_[radioIndex];
 
-        for(auto discIt = discovered.begin(); discIt != discovered.end(); discIt++)
-        {
-          EncounterEvent event(getTimeMS());
-          if(radio_->getDeviceEvent(event, discIt->id, rssiReportInterval_))
-          {
-            encounters.push_back(event);
-          }
-        }
+  list<DiscoverEvent> discovered = radio->discover();
+  Metrics::increment(Metrics::Counter::DevicesDiscovered, discovered.size());
+  for(auto discIt = discovered.begin(); discIt != discovered.end(); discIt++)
+  {
+    discIt->id = toMergedID(radioIndex, discIt->id);
+  }
+
+  list<pair<DeviceID, uint64_t> > newlyDiscovered;
+  set<DeviceID> toHandshake = hystPolicy_.discovered(discovered, newlyDiscovered);
+
+  // Only handshaking with the devices this radio knows about, where any
+  // others are left to the radios that discovered them
+  set<DeviceID> toHandshakeRadio;
+  for(auto it = toHandshake.begin(); it != toHandshake.end(); it++)
+  {
+    DeviceID id;
+    if(toRadioID(radioIndex, *it, id))
+    {
+      toHandshakeRadio.insert(id);
+    }
+  }
 
-        list<pair<DeviceID, uint64_t> > expired = hystPolicy_.checkExpired();
-        for(auto expIt = expired.begin(); expIt != expired.end(); expIt++)
+  set<DeviceID> encounteredRadio;
+  {
+    Metrics::Timer timer(Metrics::Histogram::Handshake);
+    encounteredRadio = radio->handshake(toHandshakeRadio);
+  }
+  Metrics::increment(Metrics::Counter::DevicesHandshaken, toHandshakeRadio.size());
+  Metrics::increment(Metrics::Counter::DevicesEncountered, encounteredRadio.size());
+
+  set<DeviceID> encountered;
+  for(auto it = encounteredRadio.begin(); it != encounteredRadio.end(); it++)
+  {
+    encountered.insert(toMergedID(radioIndex, *it));
+  }
+  hystPolicy_.encountered(encountered);
+
+  list<EncounterEvent> encounters;
+
+  for(auto ndIt = newlyDiscovered.begin(); ndIt != newlyDiscovered.end(); ndIt++)
+  {
+    EncounterEvent event(EncounterEvent::UnconfirmedStarted, ndIt->second, ndIt->first);
+    encounters.push_back(event);
+  }
+
+  for(auto discIt = discovered.begin(); discIt != discovered.end(); discIt++)
+  {
+    DeviceID id;
+    EncounterEvent event(clock_->getTimeMS());
+    if(toRadioID(radioIndex, discIt->id, id) && radio->getDeviceEvent(event, id, rssiReportInterval_))
+    {
+      // The encounter may have already been started through another radio
+      MergedDevice &merged = mergedDevices_[discIt->id];
+      if(event.type == EncounterEvent::Started)
+      {
+        if(merged.isStarted)
         {
-          EncounterEvent expireEvent = radio_->doneWithDevice(expIt->first);
-          expireEvent.time = expIt->second;
-          encounters.push_back(expireEvent);
+          event.type = EncounterEvent::Updated;
         }
+        merged.isStarted = true;
+      }
+
+      event.id = discIt->id;
+      encounters.push_back(event);
+    }
+  }
+
+  list<pair<DeviceID, uint64_t> > expired = hystPolicy_.checkExpired();
+  for(auto expIt = expired.begin(); expIt != expired.end(); expIt++)
+  {
+    EncounterEvent expireEvent = doneWithDevice(expIt->first);
+    expireEvent.time = expIt->second;
+    encounters.push_back(expireEvent);
+  }
+
+  for(auto encIt = encounters.begin(); encIt != encounters.end(); encIt++)
+  {
+    Metrics::Timer timer(Metrics::Histogram::EventDelivery);
+    encounterCallback_(*encIt);
+  }
+}
+
+void EbNController::recover(size_t radioIndex)
+{
+  Metrics::increment(Metrics::Counter::Recoveries);
+
+  for(int attempt = 1; ; attempt++)
+  {
+    try
+    {
+      radios_[radioIndex]->recover();
+      return;
+    }
+    catch(BluetoothHCIException &ex)
+    {
+      if(attempt >= MAX_RECOVERY_ATTEMPTS)
+      {
+        LOG_E("EbNController", "Failed to recover radio %zu after %d attempts", radioIndex, attempt);
+        throw;
+      }
+
+      LOG_W("EbNController", "Recovery attempt %d failed - %s", attempt, ex.what());
+    }
+  }
+}
+
+DeviceID EbNController::toMergedID(size_t radioIndex, DeviceID id)
+{
+  DeviceIDMap &radioMap = radioToMerged_[radioIndex];
+
+  Address address;
+  bool hasAddress = radios_[radioIndex]->getDeviceAddress(id, address);
+
+  auto it = radioMap.find(id);
+  if(it != radioMap.end())
+  {
+    // Following the device's address as it shifts each epoch, so that radios
+    // which only see it later can still join it
+    if(hasAddress)
+    {
+      setMergedAddress(it->second, address);
+    }
+    return it->second;
+  }
+
+  // Joining the device seen by another radio at the same (or shifted) address,
+  // if any
+  DeviceID mergedID;
+  AddressToIDMap::iterator addressIt;
+  if(hasAddress && ((addressIt = findMergedAddress(address)) != addressToMerged_.end()))
+  {
+    mergedID = addressIt->second;
+    LOG_D("EbNController", "Merging device %d on radio %zu into device %d", id, radioIndex, mergedID);
+    setMergedAddress(mergedID, address);
+  }
+  else
+  {
+    mergedID = nextMergedID_++;
+
+    MergedDevice &merged = mergedDevices_[mergedID];
+    merged.address = address;
+    merged.isStarted = false;
+    if(hasAddress)
+    {
+      addressToMerged_[address] = mergedID;
+    }
+  }
+
+  mergedDevices_[mergedID].members.push_back(make_pair(radioIndex, id));
+  radioMap[id] = mergedID;
+
+  return mergedID;
+}
+
+// Matching addresses the same way as EbNDeviceMap, first exactly, and then
+// as a shift of an address seen before (using the same bucket lookup)
+EbNController::AddressToIDMap::iterator EbNController::findMergedAddress(const Address &address)
+{
+  AddressToIDMap::iterator it = addressToMerged_.find(address);
+  if(it != addressToMerged_.end())
+  {
+    return it;
+  }
+
+  Address oldAddress = address.unshift();
+  size_t bucket = addressToMerged_.bucket(oldAddress);
+  for(auto bucketIt = addressToMerged_.begin(bucket); bucketIt != addressToMerged_.end(bucket); bucketIt++)
+  {
+    if(address.isShift(bucketIt->first))
+    {
+      return addressToMerged_.find(bucketIt->first);
+    }
+  }
+
+  return addressToMerged_.end();
+}
+
+void EbNController::setMergedAddress(DeviceID mergedID, const Address &address)
+{
+  MergedDevice &merged = mergedDevices_[mergedID];
+  if(merged.address == address)
+  {
+    return;
+  }
 
-        for(auto encIt = encounters.begin(); encIt != encounters.end(); encIt++)
+  AddressToIDMap::iterator addressIt = addressToMerged_.find(merged.address);
+  if((addressIt != addressToMerged_.end()) && (addressIt->second == mergedID))
+  {
+    addressToMerged_.erase(addressIt);
+  }
+
+  merged.address = address;
+  addressToMerged_[address] = mergedID;
+}
+
+bool EbNController::toRadioID(size_t radioIndex, DeviceID mergedID, DeviceID &id) const
+{
+  MergedDeviceMap::const_iterator it = mergedDevices_.find(mergedID);
+  if(it != mergedDevices_.end())
+  {
+    for(auto memberIt = it->second.members.begin(); memberIt != it->second.members.end(); memberIt++)
+    {
+      if(memberIt->first == radioIndex)
+      {
+        id = memberIt->second;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+EncounterEvent EbNController::doneWithDevice(DeviceID mergedID)
+{
+  EncounterEvent expireEvent(clock_->getTimeMS());
+  expireEvent.type = EncounterEvent::Ended;
+  expireEvent.id = mergedID;
+
+  MergedDeviceMap::iterator it = mergedDevices_.find(mergedID);
+  if(it == mergedDevices_.end())
+  {
+    return expireEvent;
+  }
+
+  // Combining what each radio knows about the device into a single event
+  bool isFirst = true;
+  for(auto memberIt = it->second.members.begin(); memberIt != it->second.members.end(); memberIt++)
+  {
+    EncounterEvent memberEvent = radios_[memberIt->first]->doneWithDevice(memberIt->second);
+    radioToMerged_[memberIt->first].erase(memberIt->second);
+
+    if(isFirst)
+    {
+      expireEvent = memberEvent;
+      isFirst = false;
+    }
+    else
+    {
+      expireEvent.rssiEvents.splice(expireEvent.rssiEvents.end(), memberEvent.rssiEvents);
+      LinkValueSet matching(expireEvent.matching.begin(), expireEvent.matching.end());
+      for(auto matchIt = memberEvent.matching.begin(); matchIt != memberEvent.matching.end(); matchIt++)
+      {
+        if(matching.insert(*matchIt).second)
         {
-          encounterCallback_(*encIt);
+          expireEvent.matching.push_back(*matchIt);
         }
       }
-      break;
+      expireEvent.sharedSecrets.splice(expireEvent.sharedSecrets.end(), memberEvent.sharedSecrets);
+      expireEvent.matchingSetUpdated |= memberEvent.matchingSetUpdated;
+      expireEvent.sharedSecretsUpdated |= memberEvent.sharedSecretsUpdated;
     }
   }
 
-  LOG_D("EbNController", "Stopped");
+  if(it->second.members.size() > 1)
+  {
+    expireEvent.rssiEvents.sort([](const RSSIEvent &a, const RSSIEvent &b) { return a.time < b.time; });
+  }
+
+  expireEvent.id = mergedID;
+
+  AddressToIDMap::iterator addressIt = addressToMerged_.find(it->second.address);
+  if((addressIt != addressToMerged_.end()) && (addressIt->second == mergedID))
+  {
+    addressToMerged_.erase(addressIt);
+  }
+  mergedDevices_.erase(it);
+
+  return expireEvent;
 }
 
 void EbNController::encounterDefault(const EncounterEvent &event)
@@ -3,6 +3,8 @@
 #include <limits>
 
 #include "Logger.h"
+#include "Metrics.h"
+#include "Probes.h"
 
 extern uint64_t sddrStartTimestamp;
 
@@ -19,9 +21,13 @@ EbNDevice::EbNDevice(DeviceID id, const Address &address, const LinkValueList &l
      sharedSecretsMutex_(),
      rssiToReport_(),
      lastReportTime_(0),
+     clock_(Clock::getDefault()),
      confirmed_(false),
      shakenHands_(false),
-     reported_(false)
+     reported_(false),
+     discoveredTime_(clock_->getMonoMS()),
+     numAdverts_(0),
+     latency_()
 {
 }
 
@@ -36,6 +42,9 @@ void EbNDevice::updateMatching(const BloomFilter *bloom, const uint8_t *prefix,
 
 void EbNDevice::updateMatching(const BloomFilter *bloom, const uint8_t *prefix, uint32_t prefixSize, float pFalseDelta)
 {
+  Metrics::Timer timer(Metrics::Histogram::BloomQuery);
+  size_t numQueries = matching_.size();
+
   LinkValueList::iterator it = matching_.begin();
   while(it != matching_.end())
   {
@@ -51,8 +60,15 @@ void EbNDevice::updateMatching(const BloomFilter *bloom, const uint8_t *prefix,
     }
   }
 
+  PROBE3(bloom_query, id_, numQueries, matching_.size());
+
   matchingPFalse_ *= pFalseDelta;
   LOG_D("EbNDevice", "Updated matching set to %d entries (pFalse %g) for id %d", matching_.size(), matchingPFalse_, id_);
+
+  if(matchingPFalse_ <= MATCHING_CONVERGED_PFALSE)
+  {
+    reachStage(RecognitionLatency::MatchingConverged);
+  }
 }
 
 void EbNDevice::addSharedSecret(const SharedSecret &secret)
@@ -69,6 +85,7 @@ void EbNDevice::addSharedSecret(const SharedSecret &secret)
       if(!it->confirmed && secret.confirmed)
       {
         confirmed_ = true;
+        reachStage(RecognitionLatency::Confirmed);
         it->confirm(secret.confirmedBy);
         secretsToReport_.push_back(secret);
 
@@ -83,9 +100,11 @@ void EbNDevice::addSharedSecret(const SharedSecret &secret)
   if(!found)
   {
     sharedSecrets_.push_back(secret);
+    reachStage(RecognitionLatency::SecretComputed);
     if(secret.confirmed)
     {
       confirmed_ = true;
+      reachStage(RecognitionLatency::Confirmed);
       secretsToReport_.push_back(secret);
     }
 
@@ -100,6 +119,10 @@ void EbNDevice::confirmPassive(const BloomFilter *bloom, const uint8_t *prefix,
 
 void EbNDevice::confirmPassive(const BloomFilter *bloom, const uint8_t *prefix, uint32_t prefixSize, float threshold, float pFalseDelta)
 {
+  Metrics::Timer timer(Metrics::Histogram::BloomQuery);
+  size_t numQueries = 0;
+  size_t numRemaining = 0;
+
   lock_guard<mutex> sharedSecretsLock(sharedSecretsMutex_);
 
   for(auto it = sharedSecrets_.begin(); it != sharedSecrets_.end(); it++)
@@ -107,12 +130,15 @@ void EbNDevice::confirmPassive(const BloomFilter *bloom, const uint8_t *prefix,
     SharedSecret &secret = *it;
     if(!secret.confirmed && (secret.pFalse > threshold))
     {
+      numQueries++;
       if(bloom->query(prefix, prefixSize, secret.value.get(), secret.value.size()))
       {
+        numRemaining++;
         secret.pFalse *= pFalseDelta;
         if(secret.pFalse <= threshold)
         {
           confirmed_ = true;
+          reachStage(RecognitionLatency::Confirmed);
           secret.confirm(SharedSecret::ConfirmScheme::Passive);
           secretsToReport_.push_back(secret);
 
@@ -130,6 +156,8 @@ void EbNDevice::confirmPassive(const BloomFilter *bloom, const uint8_t *prefix,
       }
     }
   }
+
+  PROBE3(bloom_query, id_, numQueries, numRemaining);
 }
 
 bool EbNDevice::getEncounterInfo(EncounterEvent &dest, bool expired)
@@ -147,6 +175,7 @@ bool EbNDevice::getEncounterInfo(EncounterEvent &dest, uint64_t rssiReportingInt
     dest.id = id_;
     dest.address = address_.toString();
     dest.matchingSetUpdated = false;
+    dest.latency = latency_;
 
     if(!rssiToReport_.empty())
     {
@@ -162,7 +191,7 @@ bool EbNDevice::getEncounterInfo(EncounterEvent &dest, uint64_t rssiReportingInt
 
     const bool reportSecrets = !secretsToReport_.empty();
     const bool reportMatching = updatedMatching_;
-    const bool reportRSSI = !rssiToReport_.empty() && ((getTimeMS() - lastReportTime_) > rssiReportingInterval);
+    const bool reportRSSI = !rssiToReport_.empty() && ((clock_->getTimeMS() - lastReportTime_) > rssiReportingInterval);
 
     const bool isUpdated = confirmed_ && shakenHands_ && (reportSecrets || reportMatching || reportRSSI);
     if(isUpdated)
@@ -200,7 +229,7 @@ bool EbNDevice::getEncounterInfo(EncounterEvent &dest, uint64_t rssiReportingInt
       }
 
       reported_ = true;
-      lastReportTime_ = getTimeMS();
+      lastReportTime_ = clock_->getTimeMS();
     }
 
     success = isUpdated;
@@ -209,3 +238,22 @@ bool EbNDevice::getEncounterInfo(EncounterEvent &dest, uint64_t rssiReportingInt
   return success;
 }
 
+// Only the first time each stage is reached counts, with later epochs (new DH
+// values and secrets) ignored
+void EbNDevice::reachStage(RecognitionLatency::Stage stage)
+{
+  RecognitionLatency::Milestone &milestone = latency_.milestones[stage];
+  if(milestone.reached)
+  {
+    return;
+  }
+
+  milestone.reached = true;
+  milestone.time = clock_->getMonoMS() - discoveredTime_;
+  milestone.numAdverts = numAdverts_;
+
+  Metrics::record((Metrics::Histogram)(Metrics::Histogram::TimeToDHDecoded + stage), milestone.time);
+  Metrics::record((Metrics::Histogram)(Metrics::Histogram::AdvertsToDHDecoded + stage), milestone.numAdverts);
+
+  LOG_D("EbNDevice", "Reached recognition stage %d for id %d after %" PRIu64 " ms (%u adverts)", stage, id_, milestone.time, milestone.numAdverts);
+}
@@ -12,10 +12,11 @@ EbNDeviceBT4::Epoch::Epoch(uint32_t advertNum, uint64_t advertTime, const RSMatr
    : lastAdvertNum(advertNum),
      lastAdvertTime(advertTime),
      dhDecoder(dhCodeMatrix),
-     dhExchanges(1, dhExchange),
+     dhExchanges(),
      dhExchangeYCoord(dhExchangeYCoord),
      blooms(),
-     decodeBloomNum(0) 
+     decodeBloomNum(0)
 {
+  dhExchanges.push_back(dhExchange);
 }
 
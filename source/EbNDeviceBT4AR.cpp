@@ -42,7 +42,6 @@ bool EbNDeviceBT4AR::updateMatching()
     {
       it = matching_.erase(it);
       updatedMatching_ = true;
-      it++;
     }
     else
     {
@@ -55,5 +54,10 @@ bool EbNDeviceBT4AR::updateMatching()
   matchingPFalse_ *= 1.0 / (1 << 24);
   LOG_P("EbNDeviceBT4AR", "Updated matching set to %d entries (pFalse %g) for id %d", matching_.size(), matchingPFalse_, id_);
 
+  if(matchingPFalse_ <= MATCHING_CONVERGED_PFALSE)
+  {
+    reachStage(RecognitionLatency::MatchingConverged);
+  }
+
   return updatedMatching_;
 }
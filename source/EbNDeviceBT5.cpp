@@ -0,0 +1,15 @@
+#include "EbNDeviceBT5.h"
+
+EbNDeviceBT5::EbNDeviceBT5(DeviceID id, const Address &address, const LinkValueList &listenSet)
+   : EbNDevice(id, address, listenSet),
+     epochs_()
+{
+}
+
+EbNDeviceBT5::Epoch::Epoch(uint32_t advertNum, uint64_t advertTime, size_t keySize, bool dhRemoteYCoord)
+   : lastAdvertNum(advertNum),
+     lastAdvertTime(advertTime),
+     dhRemotePublic(keySize / 8, 0),
+     dhRemoteYCoord(dhRemoteYCoord)
+{
+}
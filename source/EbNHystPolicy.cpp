@@ -1,7 +1,7 @@
 #include "EbNHystPolicy.h"
 
 #include "Logger.h"
-#include "Timing.h"
+#include "Probes.h"
 
 using namespace std;
 
@@ -13,13 +13,14 @@ EbNHystPolicy::EbNHystPolicy(Scheme scheme, uint64_t minStartTime, uint64_t maxS
      maxStartTime_(maxStartTime),
      startSeen_(startSeen),
      endTime_(endTime),
-     rssiThreshold_(rssiThreshold)
+     rssiThreshold_(rssiThreshold),
+     clock_(Clock::getDefault())
 {
 }
 
 set<DeviceID> EbNHystPolicy::discovered(const list<DiscoverEvent> &events, list<pair<DeviceID, uint64_t>>& newlyDiscovered)
 {
-  uint64_t time = getTimeMS();
+  uint64_t time = clock_->getTimeMS();
   set<DeviceID> toHandshake;
 
   for(auto discIt = events.cbegin(); discIt != events.cend(); discIt++)
@@ -36,6 +37,7 @@ set<DeviceID> EbNHystPolicy::discovered(const list<DiscoverEvent> &events, list<
       {
         infoIt = deviceInfo_.insert(make_pair(discovery.id, DeviceInfo(time))).first;
         newlyDiscovered.push_back(make_pair(discovery.id, time));
+        PROBE3(hyst_transition, discovery.id, -1, HystState::Discovered);
       }
 
       DeviceInfo &info = infoIt->second;
@@ -53,6 +55,7 @@ set<DeviceID> EbNHystPolicy::discovered(const list<DiscoverEvent> &events, list<
         {
           info.state = HystState::Encountered;
           toHandshake.insert(discovery.id);
+          PROBE3(hyst_transition, discovery.id, HystState::Discovered, HystState::Encountered);
 
           LOG_D("EbNHystPolicy", "Changing state for device %d to 'Encountered'", discovery.id);
           LOG_P("EbNHystPolicy", "[EStart] [%" PRIu64 "] %d", discovery.time, discovery.id);
@@ -68,6 +71,7 @@ set<DeviceID> EbNHystPolicy::discovered(const list<DiscoverEvent> &events, list<
     {
       newlyDiscovered.push_back(make_pair(discovery.id, time));
       toHandshake.insert(discovery.id);
+      PROBE3(hyst_transition, discovery.id, -1, HystState::Encountered);
 
       LOG_D("EbNHystPolicy", "Changing state for device %d to 'Encountered'", discovery.id);
       LOG_P("EbNHystPolicy", "[EStart] [%" PRIu64 "] %d", discovery.time, discovery.id);
@@ -79,7 +83,7 @@ set<DeviceID> EbNHystPolicy::discovered(const list<DiscoverEvent> &events, list<
 
 void EbNHystPolicy::encountered(const std::set<DeviceID> &devices)
 {
-  uint64_t time = getTimeMS();
+  uint64_t time = clock_->getTimeMS();
 
   // Note: It *is* possible, when using active or hybrid confirmation, that we
   // confirm a device which we previously have not discovered. Therefore, we
@@ -94,9 +98,11 @@ void EbNHystPolicy::encountered(const std::set<DeviceID> &devices)
     if(infoIt == deviceInfo_.end())
     {
       infoIt = deviceInfo_.insert(make_pair(devID, DeviceInfo(time, HystState::Encountered))).first;
+      PROBE3(hyst_transition, devID, -1, HystState::Encountered);
     }
-    else
+    else if(infoIt->second.state != HystState::Encountered)
     {
+      PROBE3(hyst_transition, devID, infoIt->second.state, HystState::Encountered);
       infoIt->second.state = HystState::Encountered;
     }
   }
@@ -104,7 +110,7 @@ void EbNHystPolicy::encountered(const std::set<DeviceID> &devices)
 
 list<pair<DeviceID, uint64_t> > EbNHystPolicy::checkExpired()
 {
-  uint64_t time = getTimeMS();
+  uint64_t time = clock_->getTimeMS();
   list<pair<DeviceID, uint64_t>> toRemove;
 
   DeviceInfoMap::iterator it = deviceInfo_.begin();
@@ -132,6 +138,7 @@ list<pair<DeviceID, uint64_t> > EbNHystPolicy::checkExpired()
 
     if(remove)
     {
+      PROBE3(hyst_transition, id, info.state, -1);
       toRemove.push_back(make_pair(id, info.lastTime));
       it = deviceInfo_.erase(it);
       LOG_P("EbNHystPolicy", "[EEnd] [%" PRIu64 "] %d", info.lastTime, id);
@@ -1,13 +1,17 @@
 #include "EbNRadio.h"
 
+#include <stdexcept>
+
 #include "Logger.h"
+#include "Metrics.h"
 
 using namespace std;
 
-const char *EbNRadio::versionStrings[] = { "BT2", "BT2NR", "BT2PSI", "BT4", "BT4AR" };
+const char *EbNRadio::versionStrings[] = { "BT2", "BT2NR", "BT2PSI", "BT4", "BT4AR", "BT4RL", "BT5" };
 const char *EbNRadio::versionFullStrings[] = { "Bluetooth 2.1", "Bluetooth 2.1 Name Request",
                                                "Bluetooth 2.1 Private Set Intersection (PSI)",
-                                               "Bluetooth 4.0", "Bluetooth 4.0 Address Resolution" };
+                                               "Bluetooth 4.0", "Bluetooth 4.0 Address Resolution",
+                                               "Bluetooth 4.0 Rateless", "Bluetooth 5.0" };
 const char *EbNRadio::confirmSchemeStrings[] = { "None", "Passive", "Active", "Hybrid" };
 const char *EbNRadio::memorySchemeStrings[] = { "Standard", "No Memory" };
 
@@ -42,7 +46,8 @@ EbNRadio::ConfirmScheme::Type EbNRadio::stringToConfirmScheme(const char* name)
 }
 
 EbNRadio::EbNRadio(size_t keySize, ConfirmScheme confirmScheme, MemoryScheme memoryScheme)
-   : nextDeviceID_(0),
+   : clock_(Clock::getDefault()),
+     nextDeviceID_(0),
      keySize_(keySize),
      confirmScheme_(confirmScheme),
      memoryScheme_(memoryScheme),
@@ -51,8 +56,8 @@ EbNRadio::EbNRadio(size_t keySize, ConfirmScheme confirmScheme, MemoryScheme mem
      setMutex_(),
      recentDevices_(),
      idToRecentDevices_(),
-     nextDiscover_(getTimeMS() + 10000),
-     nextChangeEpoch_(getTimeMS() + EPOCH_INTERVAL)
+     nextDiscover_(clock_->getTimeMS() + 10000),
+     nextChangeEpoch_(clock_->getTimeMS() + EPOCH_INTERVAL)
 {
 }
 
@@ -72,6 +77,16 @@ void EbNRadio::setListenSet(const LinkValueList &listenSet)
   listenSet_ = listenSet;
 }
 
+void EbNRadio::initializePeer()
+{
+  throw std::runtime_error("Acting as a synthetic peer is not supported by this radio.");
+}
+
+void EbNRadio::changePeerAdvert()
+{
+  throw std::runtime_error("Acting as a synthetic peer is not supported by this radio.");
+}
+
 void EbNRadio::fillBloomFilter(BloomFilter *bloom, const uint8_t *prefix, uint32_t prefixSize, bool includePassive)
 {
   lock_guard<mutex> setLock(setMutex_);
@@ -80,6 +95,8 @@ void EbNRadio::fillBloomFilter(BloomFilter *bloom, const uint8_t *prefix, uint32
 
 void EbNRadio::fillBloomFilter(BloomFilter *bloom, const LinkValueList &advertisedSet, const uint8_t *prefix, uint32_t prefixSize, bool includePassive)
 {
+  Metrics::Timer timer(Metrics::Histogram::BloomFill);
+
   int numRandom = 0;
 
   // Inserting link values from the advertised set
@@ -156,7 +173,7 @@ void EbNRadio::removeRecentDevice(DeviceID id)
 EbNRadio::ActionInfo EbNRadio::getNextAction()
 {
   int64_t timeUntil = 0;
-  const uint64_t curTime = getTimeMS();
+  const uint64_t curTime = clock_->getTimeMS();
 
   if(nextChangeEpoch_ < nextDiscover_)
   {
@@ -215,3 +232,15 @@ bool EbNRadio::getDeviceEvent(EncounterEvent &event, DeviceID id, uint64_t rssiR
 
   return false;
 }
+
+bool EbNRadio::getDeviceAddress(DeviceID id, Address &address) const
+{
+  IDToRecentDeviceMap::const_iterator it = idToRecentDevices_.find(id);
+  if(it != idToRecentDevices_.end())
+  {
+    address = (*it->second)->getAddress();
+    return true;
+  }
+
+  return false;
+}
@@ -1,6 +1,8 @@
 #include "EbNRadioBT2.h"
 
 #include "AndroidWake.h"
+#include "Metrics.h"
+#include "Probes.h"
 
 #include <future>
 
@@ -24,6 +26,18 @@ EbNRadioBT2::EbNRadioBT2(size_t keySize, ConfirmScheme confirmScheme, MemorySche
 }
 
 void EbNRadioBT2::initialize()
+{
+  initializePeer();
+
+  // Start a thread to listen for incoming connections in the case of active or
+  // hybrid confirmation schemes
+  if((confirmScheme_.type & ConfirmScheme::Active) != 0)
+  {
+    listenThread_ = thread(&EbNRadioBT2::listen, this);
+  }
+}
+
+void EbNRadioBT2::initializePeer()
 {
   // Disabling discoverable and EIR settings so that we can set up the new
   // address and first payload before remote devices can receive it
@@ -37,13 +51,11 @@ void EbNRadioBT2::initialize()
   hci_.setInquiryMode(BluetoothHCI::InquiryMode::WithRSSIAndEIR);
   hci_.setDiscoverable(true);
   hci_.setConnectable(true);
+}
 
-  // Start a thread to listen for incoming connections in the case of active or
-  // hybrid confirmation schemes
-  if((confirmScheme_.type & ConfirmScheme::Active) != 0)
-  {
-    listenThread_ = thread(&EbNRadioBT2::listen, this);
-  }
+void EbNRadioBT2::changePeerAdvert()
+{
+  changeAdvert();
 }
 
 list<DiscoverEvent> EbNRadioBT2::discover()
@@ -56,7 +68,7 @@ list<DiscoverEvent> EbNRadioBT2::discover()
   changeAdvert();
 
   list<DiscoverEvent> discovered;
-  function<void(const EIRInquiryResponse *)> callback = bind(&EbNRadioBT2::processEIRResponse, this, &discovered, placeholders::_1);
+  auto callback = [&](const EIRInquiryResponse *response) { processEIRResponse(&discovered, response); };
   hci_.performEIRInquiry(callback, DISC_PERIODS);
 
   nextDiscover_ += DISC_INTERVAL - 1000 + (rand() % 2001);
@@ -142,7 +154,7 @@ EncounterEvent EbNRadioBT2::doneWithDevice(DeviceID id)
 {
   EbNDeviceBT2 *device = deviceMap_.get(id);
 
-  EncounterEvent expiredEvent(getTimeMS());
+  EncounterEvent expiredEvent(clock_->getTimeMS());
   device->getEncounterInfo(expiredEvent, true);
 
   deviceMap_.remove(id);
@@ -151,6 +163,16 @@ EncounterEvent EbNRadioBT2::doneWithDevice(DeviceID id)
   return expiredEvent;
 }
 
+void EbNRadioBT2::recover()
+{
+  hci_.recover();
+}
+
+uint64_t EbNRadioBT2::getDiscoverInterval() const
+{
+  return DISC_INTERVAL;
+}
+
 void EbNRadioBT2::changeAdvert()
 {
   if(advertNum_ >= ADV_N)
@@ -170,7 +192,7 @@ void EbNRadioBT2::changeAdvert()
 
 void EbNRadioBT2::processEIRResponse(list<DiscoverEvent> *discovered, const EIRInquiryResponse *resp)
 {
-  uint64_t scanTime = getTimeMS();
+  uint64_t scanTime = clock_->getTimeMS();
 
   bool addressOK = resp->address.verifyChecksum();
   bool lengthOK = (resp->data[0] == 239);
@@ -242,11 +264,16 @@ BitMap EbNRadioBT2::generateAdvert(size_t advertNum)
   fillBloomFilter(&advertBloom, prefix.toByteArray(), prefix.sizeBytes());
   advert.copyFrom(advertBloom.toByteArray(), 0, advertOffset, advertBloom.M() - 16);
 
+  PROBE2(advert_generate, advertNum, advert.sizeBytes());
+
   return advert;
 }
 
 bool EbNRadioBT2::processAdvert(EbNDeviceBT2 *device, uint64_t time, const uint8_t *data, bool computeSecret)
 {
+  Metrics::Timer timer(Metrics::Histogram::AdvertProcess);
+  device->addAdvert();
+
   BitMap advert(240 * 8, data);
   size_t advertOffset = 17;
 
@@ -261,6 +288,7 @@ bool EbNRadioBT2::processAdvert(EbNDeviceBT2 *device, uint64_t time, const uint8
   advertOffset += ADV_N_LOG2;
 
   LOG_D("EbNRadioBT2", "Processing advertisement %u for device %d", advertNum, device->getID());
+  PROBE2(advert_process, device->getID(), advertNum);
 
   if(advertNum < ADV_N)
   {
@@ -300,6 +328,8 @@ bool EbNRadioBT2::processAdvert(EbNDeviceBT2 *device, uint64_t time, const uint8
         curEpoch = &device->epochs_.back();
 
         advert.copyTo(curEpoch->dhRemotePublic.data(), 0, advertOffset, keySize_);
+        device->setDHDecoded();
+        PROBE2(epoch_decode, device->getID(), advertNum);
 
         if(computeSecret)
         {
@@ -4,6 +4,8 @@
 #include <stdexcept>
 
 #include "BinaryToUTF8.h"
+#include "Metrics.h"
+#include "Probes.h"
 
 using namespace std;
 
@@ -28,6 +30,11 @@ EbNRadioBT2NR::EbNRadioBT2NR(size_t keySize, ConfirmScheme confirmScheme, Memory
 }
 
 void EbNRadioBT2NR::initialize()
+{
+  initializePeer();
+}
+
+void EbNRadioBT2NR::initializePeer()
 {
   // Disabling discoverable and EIR settings so that we can set up the new
   // address and first payload before remote devices can receive it
@@ -42,6 +49,11 @@ void EbNRadioBT2NR::initialize()
   hci_.setConnectable(true);
 }
 
+void EbNRadioBT2NR::changePeerAdvert()
+{
+  changeAdvert();
+}
+
 list<DiscoverEvent> EbNRadioBT2NR::discover()
 {
   if(memoryScheme_ == MemoryScheme::NoMemory)
@@ -49,7 +61,7 @@ list<DiscoverEvent> EbNRadioBT2NR::discover()
     deviceMap_.clear();
   }
 
-  uint64_t curTime = getTimeMS();
+  uint64_t curTime = clock_->getTimeMS();
 
   changeAdvert();
 
@@ -98,51 +110,30 @@ set<DeviceID> EbNRadioBT2NR::handshake(const set<DeviceID> &deviceIDs)
 {
   set<DeviceID> encountered;
 
+  vector<EbNDeviceBT2 *> devices;
+  vector<RemoteNameRequest> requests;
   for(auto it = deviceIDs.begin(); it != deviceIDs.end(); it++)
   {
     EbNDeviceBT2 *device = deviceMap_.get(*it);
+    devices.push_back(device);
+    requests.push_back({device->getAddress(), device->clockOffset_, device->pageScanMode_});
+  }
 
-    // Making sure that we have enough time until our next action
-    ActionInfo nextAction = getNextAction();
-    if(nextAction.timeUntil < 2000)
-    {
-      break;
-    }
+  // Reading the names of several devices at once, where requests are only
+  // started while we have enough time until our next action
+  ActionInfo nextAction = getNextAction();
+  hci_.readRemoteNames(requests, MAX_NAME_REQUESTS, NAME_REQUEST_TIMEOUT, nextAction.timeUntil - 2000, [&](size_t index, const RemoteNameResponse *response)
+  {
+    EbNDeviceBT2 *device = devices[index];
+    const string &remoteName = response->name;
 
-    string remoteName;
-    bool readOK = hci_.readRemoteName(remoteName, device->getAddress(), device->clockOffset_, device->pageScanMode_, 2500);
+    bool readOK = (response->status == 0);
     bool lengthOK = (BinaryToUTF8::getNumEncodedBits(NAME_DECODED_SIZE) == (remoteName.size() * 8));
     if(readOK && lengthOK)
     {
       BitMap advert(NAME_DECODED_SIZE);
       BinaryToUTF8::decode(advert.toByteArray(), remoteName);
-
-      LOG_P("EbNRadioBT2NR", "Processing advert from device %d - '%s'", device->getID(), advert.toHexString().c_str());
-
-      // NOTE: Ignoring version bit for now
-      size_t advertOffset = 1;
-
-      // Computing the shared secret
-      bool remotePublicY = advert.get(advertOffset);
-      advertOffset += 1;
-
-      vector<uint8_t> remotePublicX(keySize_ / 8, 0);
-      advert.copyTo(remotePublicX.data(), 0, advertOffset, keySize_);
-      advertOffset += keySize_;
-
-      SharedSecret sharedSecret(confirmScheme_.type == ConfirmScheme::None);
-      if(dhExchange_.computeSharedSecret(sharedSecret, remotePublicX.data(), remotePublicY))
-      {
-        device->addSharedSecret(sharedSecret);
-      }
-      else
-      {
-        LOG_E("EbNRadioBT2NR", "Could not compute shared secret for id %d", device->getID());
-      }
-
-      // Updating the matching set based on the Bloom filter
-      BloomFilter bloom(BF_N, BF_K, advert, advertOffset, BF_M);
-      device->updateMatching(&bloom, remotePublicX.data(), keySize_ / 8);
+      processAdvert(device, advert.toByteArray());
     }
     else if(readOK)
     {
@@ -150,7 +141,7 @@ set<DeviceID> EbNRadioBT2NR::handshake(const set<DeviceID> &deviceIDs)
     }
 
     device->setShakenHands(true);
-  }
+  });
 
   // Going through all devices to report 'encountered' devices, meaning
   // the devices we have shaken hands with and confirmed
@@ -170,7 +161,7 @@ EncounterEvent EbNRadioBT2NR::doneWithDevice(DeviceID id)
 {
   EbNDeviceBT2 *device = deviceMap_.get(id);
 
-  EncounterEvent expiredEvent(getTimeMS());
+  EncounterEvent expiredEvent(clock_->getTimeMS());
   device->getEncounterInfo(expiredEvent, true);
 
   deviceMap_.remove(id);
@@ -179,7 +170,17 @@ EncounterEvent EbNRadioBT2NR::doneWithDevice(DeviceID id)
   return expiredEvent;
 }
 
-void EbNRadioBT2NR::changeAdvert()
+void EbNRadioBT2NR::recover()
+{
+  hci_.recover();
+}
+
+uint64_t EbNRadioBT2NR::getDiscoverInterval() const
+{
+  return DISC_INTERVAL;
+}
+
+BitMap EbNRadioBT2NR::generateAdvert()
 {
   BitMap advert(NAME_DECODED_SIZE);
   size_t advertOffset = 0;
@@ -198,6 +199,57 @@ void EbNRadioBT2NR::changeAdvert()
   fillBloomFilter(&advertBloom, dhExchange_.getPublicX(), keySize_ / 8);
   advert.copyFrom(advertBloom.toByteArray(), 0, advertOffset, advertBloom.M());
 
+  PROBE2(advert_generate, 0, advert.sizeBytes());
+
+  return advert;
+}
+
+bool EbNRadioBT2NR::processAdvert(EbNDeviceBT2 *device, const uint8_t *data)
+{
+  Metrics::Timer timer(Metrics::Histogram::AdvertProcess);
+  device->addAdvert();
+  PROBE2(advert_process, device->getID(), 0);
+
+  BitMap advert(NAME_DECODED_SIZE, data);
+
+  LOG_P("EbNRadioBT2NR", "Processing advert from device %d - '%s'", device->getID(), advert.toHexString().c_str());
+
+  // NOTE: Ignoring version bit for now
+  size_t advertOffset = 1;
+
+  // Computing the shared secret
+  bool remotePublicY = advert.get(advertOffset);
+  advertOffset += 1;
+
+  vector<uint8_t> remotePublicX(keySize_ / 8, 0);
+  advert.copyTo(remotePublicX.data(), 0, advertOffset, keySize_);
+  advertOffset += keySize_;
+  device->setDHDecoded();
+  PROBE2(epoch_decode, device->getID(), 0);
+
+  bool isComputed = false;
+  SharedSecret sharedSecret(confirmScheme_.type == ConfirmScheme::None);
+  if(dhExchange_.computeSharedSecret(sharedSecret, remotePublicX.data(), remotePublicY))
+  {
+    device->addSharedSecret(sharedSecret);
+    isComputed = true;
+  }
+  else
+  {
+    LOG_E("EbNRadioBT2NR", "Could not compute shared secret for id %d", device->getID());
+  }
+
+  // Updating the matching set based on the Bloom filter
+  BloomFilter bloom(BF_N, BF_K, advert, advertOffset, BF_M);
+  device->updateMatching(&bloom, remotePublicX.data(), keySize_ / 8);
+
+  return isComputed;
+}
+
+void EbNRadioBT2NR::changeAdvert()
+{
+  BitMap advert = generateAdvert();
+
   // Setting the advertisement data to respond to name requests
   hci_.writeLocalName(BinaryToUTF8::encode(advert.toByteArray(), advert.size()));
   LOG_P("EbNRadioBT2NR", "Setting advert data to \'%s\'", advert.toHexString().c_str());
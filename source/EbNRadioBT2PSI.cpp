@@ -1,7 +1,5 @@
 #include "EbNRadioBT2PSI.h"
 
-#include "AndroidWake.h"
-
 #include <future>
 
 using namespace std;
@@ -82,7 +80,7 @@ list<DiscoverEvent> EbNRadioBT2PSI::discover()
   discDevicesLock.unlock();
 
   list<DiscoverEvent> discovered;
-  function<void(const EIRInquiryResponse *)> callback = bind(&EbNRadioBT2PSI::processEIRResponse, this, &discovered, placeholders::_1);
+  auto callback = [&](const EIRInquiryResponse *response) { processEIRResponse(&discovered, response); };
   hci_.performEIRInquiry(callback, DISC_PERIODS);
 
   nextDiscover_ += DISC_INTERVAL - 1000 + (rand() % 2001);
@@ -165,6 +163,8 @@ set<DeviceID> EbNRadioBT2PSI::handshake(const set<DeviceID> &deviceIDs)
           vector<uint8_t> remotePublic(dhExchange_.getPublicSize());
           if(success && (success = hci_.recv(sock, remotePublic.data(), dhExchange_.getPublicSize(), 30000)))
           {
+            device->setDHDecoded();
+
             SharedSecret sharedSecret(SharedSecret::ConfirmScheme::Active);
             if(dhExchange_.computeSharedSecret(sharedSecret, remotePublic.data()))
             {
@@ -275,7 +275,7 @@ EncounterEvent EbNRadioBT2PSI::doneWithDevice(DeviceID id)
 {
   EbNDeviceBT2 *device = deviceMap_.get(id);
 
-  EncounterEvent expiredEvent(getTimeMS());
+  EncounterEvent expiredEvent(clock_->getTimeMS());
   device->getEncounterInfo(expiredEvent, true);
 
   deviceMap_.remove(id);
@@ -284,9 +284,19 @@ EncounterEvent EbNRadioBT2PSI::doneWithDevice(DeviceID id)
   return expiredEvent;
 }
 
+void EbNRadioBT2PSI::recover()
+{
+  hci_.recover();
+}
+
+uint64_t EbNRadioBT2PSI::getDiscoverInterval() const
+{
+  return DISC_INTERVAL;
+}
+
 void EbNRadioBT2PSI::processEIRResponse(list<DiscoverEvent> *discovered, const EIRInquiryResponse *resp)
 {
-  uint64_t scanTime = getTimeMS();
+  uint64_t scanTime = clock_->getTimeMS();
 
   bool addressOK = resp->address.verifyChecksum();
   if(addressOK)
@@ -312,139 +322,237 @@ void EbNRadioBT2PSI::processEIRResponse(list<DiscoverEvent> *discovered, const E
   }
 }
 
-void EbNRadioBT2PSI::listen()
+// Serves one incoming handshake: exchanging DH public values, then running
+// PSI as the server first and the client second. Each step of the PSI is
+// computed on a worker, between the sends and receives.
+class EbNRadioBT2PSI::ListenSession : public ConnectionAcceptor::Session
 {
-  while(true)
+private:
+  struct Stage_
   {
-    LOG_D("EbNRadioBT2PSI", "Attempting to listen for incoming BT2 connections");
-
-    int listenSock = hci_.listenBT2(1);
-
-    LOG_D("EbNRadioBT2PSI", "Waiting to accept incoming BT2 connection");
-
-    pair<int, Address> clientInfo;
-    while((clientInfo = hci_.acceptBT2(listenSock)).first != -1)
+    enum Type
     {
-      AndroidWake::grab("EbNListen");
-
-      int sock = clientInfo.first;
-      Address clientAddress = clientInfo.second;
-      LOG_D("EbNRadioBT2PSI", "Accepted incoming connection from %s", clientAddress.toString().c_str());
-
-      unique_lock<mutex> discDevicesLock(discDevicesMutex_);
-      discDevices_.insert(clientAddress);
-      discDevicesLock.unlock();
+      Setup,
+      SendPublic,
+      ReceivePublic,
+      ServerPublish,
+      SendPublished,
+      ReceiveRequest,
+      ServerResponse,
+      SendResponse,
+      ReceivePublished,
+      ClientRequest,
+      SendRequest,
+      ReceiveResponse,
+      ClientResult
+    };
+  };
+  typedef Stage_::Type Stage;
+
+private:
+  EbNRadioBT2PSI *radio_;
+  Address address_;
+  Stage stage_;
+  unique_ptr<Client> psiClient_;
+  unique_ptr<Server> psiServer_;
+  vector<uint8_t> input_;
+  vector<uint8_t> message_;
+
+public:
+  ListenSession(EbNRadioBT2PSI *radio, const Address &address)
+     : radio_(radio),
+       address_(address),
+       stage_(Stage::Setup),
+       psiClient_(),
+       psiServer_(),
+       input_(),
+       message_()
+  {
+  }
 
-      Client *psiClient = new JL10_Client();
-      Server *psiServer = new JL10_Server();
-      psiClient->SetAdaptive();
-      psiServer->SetAdaptive();
-      psiClient->Setup(1024);
-      psiServer->Setup(1024);
+  ConnectionAcceptor::Step start()
+  {
+    return ConnectionAcceptor::Step::compute();
+  }
 
-      unique_lock<mutex> setLock(setMutex_);
-      psiClient->LoadData(psiClientData_);
-      psiServer->LoadData(psiServerData_);
-      setLock.unlock();
+  void compute()
+  {
+    vector<string> output;
 
-      psiClient->Initialize(1024);
-      psiServer->Initialize(1024);
+    switch(stage_)
+    {
+    case Stage::Setup:
+      {
+        psiClient_.reset(new JL10_Client());
+        psiServer_.reset(new JL10_Server());
+        psiClient_->SetAdaptive();
+        psiServer_->SetAdaptive();
+        psiClient_->Setup(1024);
+        psiServer_->Setup(1024);
+
+        unique_lock<mutex> setLock(radio_->setMutex_);
+        psiClient_->LoadData(radio_->psiClientData_);
+        psiServer_->LoadData(radio_->psiServerData_);
+        setLock.unlock();
 
-      LOG_D("EbNRadioBT2PSI", "PSI Server and Client initialized...");
+        psiClient_->Initialize(1024);
+        psiServer_->Initialize(1024);
 
-      uint32_t messageSize = 0;
-      vector<uint8_t> message;
-      vector<string> output;
-      bool success = true;
+        LOG_D("EbNRadioBT2PSI", "PSI Server and Client initialized...");
+      }
+      break;
 
-      //Exchanging and computing the shared secret
-      if(success && (success = hci_.send(sock, dhExchange_.getPublic(), dhExchange_.getPublicSize(), 30000)))
+    case Stage::ServerPublish:
       {
-        vector<uint8_t> remotePublic(dhExchange_.getPublicSize());
-        if(success && (success = hci_.recv(sock, remotePublic.data(), dhExchange_.getPublicSize(), 30000)))
+        SharedSecret sharedSecret(SharedSecret::ConfirmScheme::Active);
+        if(radio_->dhExchange_.computeSharedSecret(sharedSecret, input_.data()))
         {
-          SharedSecret sharedSecret(SharedSecret::ConfirmScheme::Active);
-          if(dhExchange_.computeSharedSecret(sharedSecret, remotePublic.data()))
-          {
-            LOG_E("EbNRadioBT2PSI", "Computed shared secret!");
-            // TODO: Add shared secret for the device
-          }
-          else
-          {
-            LOG_E("EbNRadioBT2PSI", "Could not compute shared secret");
-          }
+          LOG_E("EbNRadioBT2PSI", "Computed shared secret!");
+          // TODO: Add shared secret for the device
+        }
+        else
+        {
+          LOG_E("EbNRadioBT2PSI", "Could not compute shared secret");
         }
+
+        psiServer_->PublishData(output);
+        radio_->constructPSIMessage(message_, output);
       }
+      break;
 
-      //PSI: Act as server first
-      if(success)
+    case Stage::ServerResponse:
       {
-        output.clear();
-        psiServer->PublishData(output);
-        constructPSIMessage(message, output);
-        LOG_D("EbNRadioBT2PSI", "LS1 - Sending message of size %zu", message.size());
-        success = hci_.send(sock, message.data(), message.size(), 30000);
+        vector<string> input = radio_->parsePSIMessage(input_);
+        (psiServer_.get()->*(psiServer_->m_vecOnRequest[0]))(input);
+
+        (psiServer_.get()->*(psiServer_->m_vecResponse[0]))(output);
+        radio_->constructPSIMessage(message_, output);
       }
+      break;
 
-      if(success && (success = hci_.recv(sock, (uint8_t *)&messageSize, 4, 30000)))
+    case Stage::ClientRequest:
       {
-        LOG_D("EbNRadioBT2PSI", "LS2 - Incoming message of size %u", messageSize);
-        message.resize(messageSize);
+        vector<string> publishedData = radio_->parsePSIMessage(input_);
+        psiClient_->StoreData(publishedData);
 
-        if(success && (success = hci_.recv(sock, message.data(), messageSize, 30000)))
-        {
-          vector<string> input = parsePSIMessage(message);
-          (psiServer->*(psiServer->m_vecOnRequest[0]))(input);
+        (psiClient_.get()->*(psiClient_->m_vecRequest[0]))(output);
+        radio_->constructPSIMessage(message_, output);
+      }
+      break;
 
-          output.clear();
-          (psiServer->*(psiServer->m_vecResponse[0]))(output);
+    case Stage::ClientResult:
+      {
+        vector<string> input = radio_->parsePSIMessage(input_);
+        (psiClient_.get()->*(psiClient_->m_vecOnResponse[0]))(input);
 
-          constructPSIMessage(message, output);
-          LOG_D("EbNRadioBT2PSI", "LS2 - Sending message of size %zu", message.size());
-          success = hci_.send(sock, message.data(), message.size(), 30000);
-        }
+        LOG_D("EbNRadioBT2PSI", "LC2 - Result (Size = %zu)", psiClient_->m_vecResult.size());
+
+        // TODO: Process the result to update matching set
       }
+      break;
 
-      //PSI: Act as client second
-      if(success && (success = hci_.recv(sock, (uint8_t *)&messageSize, 4, 30000)))
-      {
-        LOG_D("EbNRadioBT2PSI", "LC1 - Incoming message of size %u", messageSize);
-        message.resize(messageSize);
+    default:
+      break;
+    }
+  }
 
-        if(success && (success = hci_.recv(sock, message.data(), messageSize, 30000)))
-        {
-          vector<string> publishedData = parsePSIMessage(message);
-          psiClient->StoreData(publishedData);
+  ConnectionAcceptor::Step advance(vector<uint8_t> &received)
+  {
+    const ECDH &dhExchange = radio_->dhExchange_;
 
-          output.clear();
-          (psiClient->*(psiClient->m_vecRequest[0]))(output);
+    switch(stage_)
+    {
+    case Stage::Setup:
+      stage_ = Stage::SendPublic;
+      return ConnectionAcceptor::Step::send(vector<uint8_t>(dhExchange.getPublic(), dhExchange.getPublic() + dhExchange.getPublicSize()), LISTEN_EXCHANGE_TIMEOUT);
+
+    case Stage::SendPublic:
+      stage_ = Stage::ReceivePublic;
+      return ConnectionAcceptor::Step::receive(dhExchange.getPublicSize(), LISTEN_EXCHANGE_TIMEOUT);
+
+    case Stage::ReceivePublic:
+      input_.swap(received);
+      stage_ = Stage::ServerPublish;
+      return ConnectionAcceptor::Step::compute();
+
+    case Stage::ServerPublish:
+      LOG_D("EbNRadioBT2PSI", "LS1 - Sending message of size %zu", message_.size());
+      stage_ = Stage::SendPublished;
+      return ConnectionAcceptor::Step::send(message_, LISTEN_EXCHANGE_TIMEOUT);
+
+    case Stage::SendPublished:
+      stage_ = Stage::ReceiveRequest;
+      return ConnectionAcceptor::Step::receiveFramed(LISTEN_EXCHANGE_TIMEOUT);
+
+    case Stage::ReceiveRequest:
+      LOG_D("EbNRadioBT2PSI", "LS2 - Incoming message of size %zu", received.size());
+      input_.swap(received);
+      stage_ = Stage::ServerResponse;
+      return ConnectionAcceptor::Step::compute();
+
+    case Stage::ServerResponse:
+      LOG_D("EbNRadioBT2PSI", "LS2 - Sending message of size %zu", message_.size());
+      stage_ = Stage::SendResponse;
+      return ConnectionAcceptor::Step::send(message_, LISTEN_EXCHANGE_TIMEOUT);
+
+    case Stage::SendResponse:
+      stage_ = Stage::ReceivePublished;
+      return ConnectionAcceptor::Step::receiveFramed(LISTEN_EXCHANGE_TIMEOUT);
+
+    case Stage::ReceivePublished:
+      LOG_D("EbNRadioBT2PSI", "LC1 - Incoming message of size %zu", received.size());
+      input_.swap(received);
+      stage_ = Stage::ClientRequest;
+      return ConnectionAcceptor::Step::compute();
+
+    case Stage::ClientRequest:
+      LOG_D("EbNRadioBT2PSI", "LC1 - Sending message of size %zu", message_.size());
+      stage_ = Stage::SendRequest;
+      return ConnectionAcceptor::Step::send(message_, LISTEN_EXCHANGE_TIMEOUT);
+
+    case Stage::SendRequest:
+      stage_ = Stage::ReceiveResponse;
+      return ConnectionAcceptor::Step::receiveFramed(LISTEN_EXCHANGE_TIMEOUT);
+
+    case Stage::ReceiveResponse:
+      LOG_D("EbNRadioBT2PSI", "LC2 - Incoming message of size %zu", received.size());
+      input_.swap(received);
+      stage_ = Stage::ClientResult;
+      return ConnectionAcceptor::Step::compute();
+
+    default:
+      return ConnectionAcceptor::Step::close(true);
+    }
+  }
 
-          constructPSIMessage(message, output);
-          LOG_D("EbNRadioBT2PSI", "LC1 - Sending message of size %zu", message.size());
-          success = hci_.send(sock, message.data(), message.size(), 30000);
-        }
-      }
+  void finish(bool isSuccess)
+  {
+    LOG_D("EbNRadioBT2PSI", "Done with incoming connection from %s [Success? %d]", address_.toString().c_str(), isSuccess);
+  }
+};
 
-      if(success && (success = hci_.recv(sock, (uint8_t *)&messageSize, 4, 30000)))
-      {
-        LOG_D("EbNRadioBT2PSI", "LC2 - Incoming message of size %u", messageSize);
-        message.resize(messageSize);
+unique_ptr<ConnectionAcceptor::Session> EbNRadioBT2PSI::createListenSession(const Address &address)
+{
+  unique_lock<mutex> discDevicesLock(discDevicesMutex_);
+  discDevices_.insert(address);
+  discDevicesLock.unlock();
 
-        if(success && (success = hci_.recv(sock, message.data(), messageSize, 30000)))
-        {
-          vector<string> input = parsePSIMessage(message);
-          (psiClient->*(psiClient->m_vecOnResponse[0]))(input);
+  return unique_ptr<ConnectionAcceptor::Session>(new ListenSession(this, address));
+}
 
-          LOG_D("EbNRadioBT2PSI", "LC2 - Result (Size = %zu)", psiClient->m_vecResult.size());
-        }
-      }
+void EbNRadioBT2PSI::listen()
+{
+  ConnectionAcceptor acceptor([this](int sockListen) { return hci_.acceptBT2(sockListen); }, [this](const Address &address) { return createListenSession(address); }, LISTEN_WORKERS, "EbNListen");
 
-      // TODO: Process the result to update matching set
+  while(true)
+  {
+    LOG_D("EbNRadioBT2PSI", "Attempting to listen for incoming BT2 connections");
+
+    int listenSock = hci_.listenBT2(1);
 
-      close(sock);
+    LOG_D("EbNRadioBT2PSI", "Waiting to accept incoming BT2 connections");
 
-      AndroidWake::release("EbNListen");
-    }
+    acceptor.run(listenSock);
 
     close(listenSock);
 
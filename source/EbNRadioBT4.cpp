@@ -1,29 +1,51 @@
 #include "EbNRadioBT4.h"
 
+#include <algorithm>
 #include <stdexcept>
 
-#include "AndroidWake.h"
+#include "Metrics.h"
+#include "Probes.h"
 #include "RSErasureDecoder.h"
 #include "Timing.h"
 
 using namespace std;
 
+// Per-device epoch state is bounded, so once a bound is reached the oldest
+// entry makes way for the new one. This is not expected in normal operation,
+// so every eviction is logged and counted.
+template<typename Container>
+static void evictOldest(Container &container, size_t limit, const char *what, DeviceID id)
+{
+  if(container.size() >= limit)
+  {
+    container.erase(container.begin());
+    Metrics::increment(Metrics::Counter::EpochStateEvictions);
+    LOG_W("EbNRadioBT4", "Evicting oldest %s for id %d, keeping at most %zu", what, id, limit);
+  }
+}
+
 EbNRadio::ConfirmScheme EbNRadioBT4::getDefaultConfirmScheme()
 {
   return {ConfirmScheme::Passive, 0.05};
 }
 
-EbNRadioBT4::EbNRadioBT4(size_t keySize, ConfirmScheme confirmScheme, MemoryScheme memoryScheme, int adapterID)
+EbNRadioBT4::EbNRadioBT4(size_t keySize, ConfirmScheme confirmScheme, MemoryScheme memoryScheme, int adapterID, bool dhRateless)
    : EbNRadio(keySize, confirmScheme, memoryScheme),
-     RS_W(computeRSSymbolSize(keySize, (31 * 8) - 1 - ADV_N_LOG2)),
+     ADV_HEADER_BITS(1 + (dhRateless ? 1 : 0) + ADV_N_LOG2),
+     RS_W(computeRSSymbolSize(keySize, (31 * 8) - ADV_HEADER_BITS)),
      RS_K((keySize / 8) / RS_W),
-     RS_M(ADV_N - RS_K),
-     BF_SM((31 * 8) - 1 - ADV_N_LOG2 - (RS_W * 8)),
+     // With a rateless code, every advert number that fits in the advert has a
+     // unique symbol, so adverts keep changing if an epoch runs long
+     RS_M((dhRateless ? (1 << ADV_N_LOG2) : ADV_N) - RS_K),
+     BF_SM((31 * 8) - ADV_HEADER_BITS - (RS_W * 8)),
      BF_K(1),
      BF_B(2),
+     BF_MAX_KEPT(RS_K + (dhRateless ? 1 : 0) + 1),
+     DH_RATELESS(dhRateless),
      hci_(adapterID),
-     deviceMap_(),
-     dhCodeMatrix_(RS_K, RS_M + ((SCAN_ACTIVE ? 2 : 1) * (RS_K - 1)), RS_W),
+     dhCodeMatrix_(RS_K, RS_M + ((SCAN_ACTIVE ? 2 : 1) * (RS_K - 1)), RS_W, dhRateless ? RSMatrix::Backend::Rateless : RS_BACKEND, RS_DECODING_CACHE_SIZE),
+     shards_(),
+     shardRoutes_(),
      dhEncoder_(dhCodeMatrix_),
      dhPrevSymbols_(((SCAN_ACTIVE ? 2 : 1) * (RS_K - 1)) * RS_W),
      dhExchange_(keySize),
@@ -32,20 +54,81 @@ EbNRadioBT4::EbNRadioBT4(size_t keySize, ConfirmScheme confirmScheme, MemorySche
      advertBloom_(),
      advertBloomNum_(-1),
      listenThread_(),
-     listenAdverts_(),
-     listenAdvertsMutex_()
+     listenResults_(),
+     handshakeConnections_()
 {
   LOG_D("EbNRadioBT4", "General Parameters: ADV_N = %zu, ADV_N_LOG2 = %zu", ADV_N, ADV_N_LOG2);
-  LOG_D("EbNRadioBT4", "RS Parameters: W = %zu, K = %zu, M = %zu", RS_W, RS_K, RS_M);
+  LOG_D("EbNRadioBT4", "RS Parameters: W = %zu, K = %zu, M = %zu, Backend = %s", RS_W, RS_K, RS_M, RSMatrix::backendStrings[dhCodeMatrix_.getBackend()]);
   LOG_D("EbNRadioBT4", "BF Parameters: SM = %zu", BF_SM);
 
   dhEncoder_.encode(dhExchange_.getPublicX());
 }
 
+EbNRadioBT4::ProcessShard::ProcessShard()
+   : deviceMap(),
+     reports(),
+     numReports(0),
+     numReportsProcessed(0),
+     discovered(),
+     recentDevices(),
+     thread(),
+     mutex(),
+     cond(),
+     drainedCond(),
+     isWaiting(false),
+     isStopping(false)
+{
+}
+
+EbNRadioBT4::~EbNRadioBT4()
+{
+  for(auto &shard : shards_)
+  {
+    if(shard->thread.joinable())
+    {
+      unique_lock<mutex> shardLock(shard->mutex);
+      shard->isStopping = true;
+      shard->cond.notify_one();
+      shardLock.unlock();
+
+      shard->thread.join();
+    }
+  }
+}
+
 void EbNRadioBT4::initialize()
+{
+  initializePeer();
+
+  // One shard per core, since each has its own processing thread
+  size_t numShards = min<size_t>(max<size_t>(thread::hardware_concurrency(), 1), MAX_PROCESS_SHARDS);
+  for(size_t s = 0; s < numShards; s++)
+  {
+    shards_.push_back(unique_ptr<ProcessShard>(new ProcessShard()));
+  }
+  LOG_D("EbNRadioBT4", "Processing scan reports on %zu shards", numShards);
+
+  handshakeConnections_.reset(new ConnectionManager([this](const Address &address) { return hci_.startConnectBT4(address); }, MAX_HANDSHAKE_CONNECTIONS,
+                                                    HANDSHAKE_CONNECT_TIMEOUT, HANDSHAKE_EXCHANGE_TIMEOUT));
+
+  // Start a thread to listen for incoming connections in the case of active or
+  // hybrid confirmation schemes
+  if((confirmScheme_.type & ConfirmScheme::Active) != 0)
+  {
+    listenThread_ = thread(&EbNRadioBT4::listen, this);
+  }
+
+  for(auto &shard : shards_)
+  {
+    shard->thread = thread(&EbNRadioBT4::processScanReports, this, shard.get());
+  }
+}
+
+void EbNRadioBT4::initializePeer()
 {
   // Disabling advertising so that we can set up the new address and first
   // advertisement before remote devices can receive it
+  hci_.beginAdvertUpdate();
   hci_.enableAdvertising(false);
 
   uint8_t partial = (uint8_t)dhExchange_.getPublicY() << 5;
@@ -53,27 +136,66 @@ void EbNRadioBT4::initialize()
 
   changeAdvert();
   hci_.enableAdvertising(true);
+  hci_.endAdvertUpdate();
+}
 
-  // Start a thread to listen for incoming connections in the case of active or
-  // hybrid confirmation schemes
-  if((confirmScheme_.type & ConfirmScheme::Active) != 0)
-  {
-    listenThread_ = thread(&EbNRadioBT4::listen, this);
-  }
+void EbNRadioBT4::changePeerAdvert()
+{
+  changeAdvert();
 }
 
 list<DiscoverEvent> EbNRadioBT4::discover()
 {
   if(memoryScheme_ == MemoryScheme::NoMemory)
   {
-    deviceMap_.clear();
+    for(auto &shard : shards_)
+    {
+      shard->deviceMap.clear();
+    }
+    shardRoutes_.clear();
   }
 
   changeAdvert();
 
+  // The scan only copies reports into each device's shard, so that reading
+  // HCI events is never held up by decoding and Bloom filter checks, which
+  // instead run on the shards' threads alongside the rest of the scan window
+  auto callback = [&](const ScanResponse *response) { pushScanReport(response); };
+  try
+  {
+    hci_.performScan(SCAN_ACTIVE ? BluetoothHCI::Scan::Active : BluetoothHCI::Scan::Passive, BluetoothHCI::DuplicateFilter::On, SCAN_WINDOW, callback);
+  }
+  catch(...)
+  {
+    // Letting the shards finish what was already queued before giving up, so
+    // that nothing else (such as recovery and the next epoch change) touches
+    // their device maps while they are still processing
+    for(auto &shard : shards_)
+    {
+      waitScanReports(shard.get());
+    }
+    throw;
+  }
+
+  // Merging the results from each shard once they have caught up, in the
+  // order that the reports were received
   list<DiscoverEvent> discovered;
-  function<void(const ScanResponse *)> callback = bind(&EbNRadioBT4::processScanResponse, this, &discovered, placeholders::_1);
-  hci_.performScan(SCAN_ACTIVE ? BluetoothHCI::Scan::Active : BluetoothHCI::Scan::Passive, BluetoothHCI::DuplicateFilter::On, SCAN_WINDOW, callback);
+  vector<pair<uint64_t, EbNDeviceBT4 *> > recentDevices;
+  for(auto &shard : shards_)
+  {
+    waitScanReports(shard.get());
+
+    discovered.splice(discovered.end(), shard->discovered);
+    recentDevices.insert(recentDevices.end(), shard->recentDevices.begin(), shard->recentDevices.end());
+    shard->recentDevices.clear();
+  }
+
+  discovered.sort([](const DiscoverEvent &a, const DiscoverEvent &b) { return a.time < b.time; });
+  stable_sort(recentDevices.begin(), recentDevices.end(), [](const pair<uint64_t, EbNDeviceBT4 *> &a, const pair<uint64_t, EbNDeviceBT4 *> &b) { return a.first < b.first; });
+  for(auto it = recentDevices.begin(); it != recentDevices.end(); it++)
+  {
+    addRecentDevice(it->second);
+  }
 
   nextDiscover_ += SCAN_INTERVAL + (-1000 + (rand() % 2001));
 
@@ -107,28 +229,32 @@ void EbNRadioBT4::changeEpoch()
   // Computing new shared secrets in the case of passive or hybrid confirmation
   if((confirmScheme_.type & ConfirmScheme::Passive) != 0)
   {
-    for(auto it = deviceMap_.begin(); it != deviceMap_.end(); it++)
+    for(auto &shard : shards_)
     {
-      EbNDeviceBT4 *device = it->second;
-      if(!device->epochs_.empty())
+      for(auto it = shard->deviceMap.begin(); it != shard->deviceMap.end(); it++)
       {
-        EbNDeviceBT4::Epoch &curEpoch = device->epochs_.back();
-        if(curEpoch.dhDecoder.isDecoded())
+        EbNDeviceBT4 *device = it->second;
+        if(!device->epochs_.empty())
         {
-          SharedSecret sharedSecret(confirmScheme_.type == ConfirmScheme::None);
-          if(dhExchange_.computeSharedSecret(sharedSecret, curEpoch.dhDecoder.decode(), curEpoch.dhExchangeYCoord))
+          EbNDeviceBT4::Epoch &curEpoch = device->epochs_.back();
+          if(curEpoch.dhDecoder.isDecoded())
           {
-            device->addSharedSecret(sharedSecret);
+            SharedSecret sharedSecret(confirmScheme_.type == ConfirmScheme::None);
+            if(dhExchange_.computeSharedSecret(sharedSecret, curEpoch.dhDecoder.decode(), curEpoch.dhExchangeYCoord))
+            {
+              device->addSharedSecret(sharedSecret);
+            }
+            else
+            {
+              LOG_E("EbNRadioBT4", "Could not compute shared secret for id %d", device->getID());
+            }
           }
           else
           {
-            LOG_E("EbNRadioBT4", "Could not compute shared secret for id %d", device->getID());
+            evictOldest(curEpoch.dhExchanges, EbNDeviceBT4::MAX_DH_EXCHANGES, "DH exchange", device->getID());
+            curEpoch.dhExchanges.push_back(dhExchange_);
           }
         }
-        else
-        {
-          curEpoch.dhExchanges.push_back(dhExchange_);
-        }
       }
     }
   }
@@ -141,20 +267,20 @@ set<DeviceID> EbNRadioBT4::handshake(const set<DeviceID> &deviceIDs)
   set<DeviceID> encountered;
 
   // Processing the results of any adverts that came in from other devices
-  unique_lock<mutex> listenLock(listenAdvertsMutex_);
-
-  for(auto it = listenAdverts_.begin(); it != listenAdverts_.end(); it++)
+  ListenResult result;
+  while(listenResults_.pop(result))
   {
-    Address &address = it->first;
-    vector<uint8_t> &message = it->second;
+    Address &address = result.address;
+    vector<uint8_t> &message = result.message;
 
-    EbNDeviceBT4 *device = deviceMap_.get(address);
+    ProcessShard &shard = routeToShard(address);
+    EbNDeviceBT4 *device = shard.deviceMap.get(address);
     if(device == NULL)
     {
       lock_guard<mutex> setLock(setMutex_);
 
       device = new EbNDeviceBT4(generateDeviceID(), address, listenSet_);
-      deviceMap_.add(address, device);
+      shard.deviceMap.add(address, device);
 
       LOG_P("EbNRadioBT4", "Discovered new EbN device via incoming connection (ID %d, Address %s)", device->getID(), device->getAddress().toString().c_str());
     }
@@ -165,81 +291,91 @@ set<DeviceID> EbNRadioBT4::handshake(const set<DeviceID> &deviceIDs)
     device->setShakenHands(true);
   }
 
-  listenAdverts_.clear();
-  listenLock.unlock();
-
-  // Attempting to confirm the selected set of devices
+  // Collecting the selected devices that still need active confirmation,
+  // which is only performed once per device
+  vector<EbNDeviceBT4 *> toConfirm;
+  vector<Address> toConfirmAddresses;
   for(auto it = deviceIDs.begin(); it != deviceIDs.end(); it++)
   {
-    EbNDeviceBT4 *device = deviceMap_.get(*it);
-
-    // Only perform active confirmation once per device
+    EbNDeviceBT4 *device = getDevice(*it);
     if(!device->isConfirmed() && (getHandshakeScheme() == ConfirmScheme::Active))
     {
-      // Making sure that we have enough time until our next action
-      ActionInfo nextAction = getNextAction();
-      if(nextAction.timeUntil < 2000)
-      {
-        break;
-      }
+      toConfirm.push_back(device);
+      toConfirmAddresses.push_back(device->getAddress());
+    }
+    else
+    {
+      device->setShakenHands(true);
+    }
+  }
+
+  // Attempting to confirm them concurrently, only starting new connections
+  // while we still have enough time until our next action
+  ActionInfo nextAction = getNextAction();
+  if(!toConfirm.empty() && (nextAction.timeUntil >= HANDSHAKE_CONNECT_TIMEOUT))
+  {
+    // Unconnectable advertisement type
+    hci_.setUndirectedAdvertParams(getAdvertType(false), BluetoothHCI::AdvertFilter::ScanAllConnectAll, ADVERT_MIN_INTERVAL, ADVERT_MAX_INTERVAL);
 
-      // Unconnectable advertisement type
-      hci_.setUndirectedAdvertParams(getAdvertType(false), BluetoothHCI::AdvertFilter::ScanAllConnectAll, ADVERT_MIN_INTERVAL, ADVERT_MAX_INTERVAL);
+    LOG_D("EbNRadioBT4", "Attempting to connect to %zu remote devices...", toConfirm.size());
 
-      LOG_D("EbNRadioBT4", "Attempting to connect to remote device (ID %d, Address %s)...", device->getID(), device->getAddress().toString().c_str());
+    // Note: We do not need to lock on dhExchange_ here since it can
+    // only be modified by changeEpoch, which cannot be called while we
+    // are handshaking.
+    vector<uint8_t> localMessage = generateActiveHandshake(dhExchange_);
+    vector<ConnectionManager::Result> results = handshakeConnections_->run(toConfirmAddresses, localMessage, localMessage.size(), nextAction.timeUntil - HANDSHAKE_CONNECT_TIMEOUT);
 
-      int sock = hci_.connectBT4(device->getAddress(), 2000);
-      if(sock >= 0)
+    for(size_t d = 0; d < toConfirm.size(); d++)
+    {
+      EbNDeviceBT4 *device = toConfirm[d];
+      const ConnectionManager::Result &result = results[d];
+      if(!result.isAttempted)
       {
-        // Note: We do not need to lock on dhExchange_ here since it can
-        // only be modified by changeEpoch, which cannot be called while we
-        // are handshaking.
-        vector<uint8_t> localMessage = generateActiveHandshake(dhExchange_);
-        vector<uint8_t> remoteMessage(localMessage.size(), 0);
+        continue;
+      }
 
-        if(hci_.send(sock, localMessage.data(), localMessage.size(), 1000))
-        {
-          if(hci_.recv(sock, remoteMessage.data(), remoteMessage.size(), 1000))
-          {
-            BitMap remoteMessageBM(dhExchange_.getPublicSize() * 8, remoteMessage.data());
-            LOG_D("EbNRadioBT4", "Received '%s' from remote device", remoteMessageBM.toHexString().c_str());
+      if(result.isSuccess)
+      {
+        const vector<uint8_t> &remoteMessage = result.reply;
 
-            // Sometimes we get an all zero message due to some failure, just ignore it if we do
-            bool allZeros = true;
-            for(int b = 0; b < remoteMessage.size(); b++)
-            {
-              if(remoteMessage.data()[b] != 0)
-              {
-                allZeros = false;
-                break;
-              }
-            }
+        BitMap remoteMessageBM(dhExchange_.getPublicSize() * 8, remoteMessage.data());
+        LOG_D("EbNRadioBT4", "Received '%s' from remote device (ID %d, Address %s)", remoteMessageBM.toHexString().c_str(), device->getID(), device->getAddress().toString().c_str());
 
-            if(!allZeros)
-            {
-              processActiveHandshake(remoteMessage, device);
-            }
+        // Sometimes we get an all zero message due to some failure, just ignore it if we do
+        bool allZeros = true;
+        for(int b = 0; b < remoteMessage.size(); b++)
+        {
+          if(remoteMessage.data()[b] != 0)
+          {
+            allZeros = false;
+            break;
           }
         }
-      }
 
-      close(sock);
+        if(!allZeros)
+        {
+          processActiveHandshake(remoteMessage, device);
+        }
+      }
 
-      // Connectable advertisement type
-      hci_.setUndirectedAdvertParams(getAdvertType(true), BluetoothHCI::AdvertFilter::ScanAllConnectAll, ADVERT_MIN_INTERVAL, ADVERT_MAX_INTERVAL);
+      device->setShakenHands(true);
     }
 
-    device->setShakenHands(true);
+    // Connectable advertisement type
+    hci_.setUndirectedAdvertParams(getAdvertType(true), BluetoothHCI::AdvertFilter::ScanAllConnectAll, ADVERT_MIN_INTERVAL, ADVERT_MAX_INTERVAL);
   }
 
   // Going through all devices to report 'encountered' devices, meaning
   // the devices we have shaken hands with and confirmed
-  for(auto it = deviceMap_.begin(); it != deviceMap_.end(); it++)
+  for(auto &shard : shards_)
   {
-    EbNDevice *device = it->second;
-    if(device->hasShakenHands() && device->isConfirmed())
+    for(auto it = shard->deviceMap.begin(); it != shard->deviceMap.end(); it++)
     {
-      encountered.insert(device->getID());
+      EbNDevice *device = it->second;
+      if(device->hasShakenHands() && device->isConfirmed())
+      {
+        encountered.insert(device->getID());
+      }
     }
   }
 
@@ -248,17 +384,31 @@ set<DeviceID> EbNRadioBT4::handshake(const set<DeviceID> &deviceIDs)
 
 EncounterEvent EbNRadioBT4::doneWithDevice(DeviceID id)
 {
-  EbNDeviceBT4 *device = deviceMap_.get(id);
+  EbNDeviceBT4 *device = getDevice(id);
 
-  EncounterEvent expiredEvent(getTimeMS());
+  EncounterEvent expiredEvent(clock_->getTimeMS());
   device->getEncounterInfo(expiredEvent, true);
 
-  deviceMap_.remove(id);
+  shardRoutes_.erase(device->getAddress());
+  for(auto &shard : shards_)
+  {
+    shard->deviceMap.remove(id);
+  }
   removeRecentDevice(id);
 
   return expiredEvent;
 }
 
+void EbNRadioBT4::recover()
+{
+  hci_.recover();
+}
+
+uint64_t EbNRadioBT4::getDiscoverInterval() const
+{
+  return SCAN_INTERVAL;
+}
+
 BluetoothHCI::UndirectedAdvert EbNRadioBT4::getAdvertType(bool canAllowConnections)
 {
   BluetoothHCI::UndirectedAdvert advertType;
@@ -314,6 +464,12 @@ BitMap EbNRadioBT4::generateAdvert(size_t advertNum)
   // NOTE: Version bit is 0, since we are not an infrastructure node
   advertOffset += 1;
 
+  if(DH_RATELESS)
+  {
+    advert.set(advertOffset, true);
+    advertOffset += 1;
+  }
+
   // Inserting the advertisement number as the first portion of the advert
   for(int b = 0; b < ADV_N_LOG2; b++)
   {
@@ -361,12 +517,14 @@ BitMap EbNRadioBT4::generateAdvert(size_t advertNum)
 
   advertBloom_.getSegment(advertNum % BF_B, advert.toByteArray(), advertOffset);
 
+  PROBE2(advert_generate, advertNum, advert.sizeBytes());
+
   return advert;
 }
 
 void EbNRadioBT4::changeAdvert()
 {
-  if(advertNum_ >= ADV_N)
+  if(advertNum_ >= (RS_K + RS_M))
   {
     LOG_D("EbNRadioBT4", "Reached last unique advert, waiting for epoch change\n");
     return;
@@ -374,6 +532,9 @@ void EbNRadioBT4::changeAdvert()
 
   BluetoothHCI::UndirectedAdvert advertType = getAdvertType();
 
+  // Sending the data and any parameter change together once they are all set
+  hci_.beginAdvertUpdate();
+
   // Setting the advertisement data to periodically broadcast
   BitMap advert = generateAdvert(advertNum_);
   hci_.setAdvertData(advert.toByteArray(), 31);
@@ -391,30 +552,30 @@ void EbNRadioBT4::changeAdvert()
 
   // Updating the advertisement parameters if the type has changed
   hci_.setUndirectedAdvertParams(advertType, BluetoothHCI::AdvertFilter::ScanAllConnectAll, ADVERT_MIN_INTERVAL, ADVERT_MAX_INTERVAL);
+
+  hci_.endAdvertUpdate();
 }
 
-void EbNRadioBT4::processScanResponse(list<DiscoverEvent> *discovered, const ScanResponse *resp)
+void EbNRadioBT4::processScanResponse(ProcessShard *shard, uint64_t scanTime, const ScanResponse *resp)
 {
-  uint64_t scanTime = getTimeMS();
-
   bool addressOK = resp->address.verifyChecksum();
   bool lengthOK = (resp->length == 31);
   if(addressOK && lengthOK)
   {
-    EbNDeviceBT4 *device = deviceMap_.get(resp->address);
+    EbNDeviceBT4 *device = shard->deviceMap.get(resp->address);
     if(device == NULL)
     {
       lock_guard<mutex> setLock(setMutex_);
 
       device = new EbNDeviceBT4(generateDeviceID(), resp->address, listenSet_);
-      deviceMap_.add(resp->address, device);
+      shard->deviceMap.add(resp->address, device);
 
       LOG_P("EbNRadioBT4", "Discovered new EbN device (ID %d, Address %s)", device->getID(), device->getAddress().toString().c_str());
     }
 
     device->addRSSIMeasurement(scanTime, resp->rssi);
-    discovered->push_back(DiscoverEvent(scanTime, device->getID(), resp->rssi));
-    addRecentDevice(device);
+    shard->discovered.push_back(DiscoverEvent(scanTime, device->getID(), resp->rssi));
+    shard->recentDevices.push_back(make_pair(scanTime, device));
 
     processAdvert(device, scanTime, resp->data);
     processEpochs(device);
@@ -425,14 +586,158 @@ void EbNRadioBT4::processScanResponse(list<DiscoverEvent> *discovered, const Sca
   }
 }
 
+EbNRadioBT4::ProcessShard& EbNRadioBT4::routeToShard(const Address &address)
+{
+  auto it = shardRoutes_.find(address);
+  if(it != shardRoutes_.end())
+  {
+    return *shards_[it->second];
+  }
+
+  // Devices keep their shard across epochs, so shifted addresses are routed
+  // to the same shard as the address they were shifted from (using the same
+  // bucket lookup as EbNDeviceMap)
+  size_t shardIndex = Address::Hash()(address) % shards_.size();
+
+  Address oldAddress = address.unshift();
+  size_t bucket = shardRoutes_.bucket(oldAddress);
+  for(auto bucketIt = shardRoutes_.begin(bucket); bucketIt != shardRoutes_.end(bucket); bucketIt++)
+  {
+    if(address.isShift(bucketIt->first))
+    {
+      shardIndex = bucketIt->second;
+      shardRoutes_.erase(Address(bucketIt->first));
+      break;
+    }
+  }
+
+  shardRoutes_.insert(make_pair(address, shardIndex));
+
+  return *shards_[shardIndex];
+}
+
+EbNDeviceBT4* EbNRadioBT4::getDevice(DeviceID id)
+{
+  for(auto &shard : shards_)
+  {
+    EbNDeviceBT4 *device = shard->deviceMap.get(id);
+    if(device != NULL)
+    {
+      return device;
+    }
+  }
+
+  return NULL;
+}
+
+void EbNRadioBT4::pushScanReport(const ScanResponse *resp)
+{
+  // Only EbN devices are tracked for routing, others are just spread out
+  ProcessShard *shard;
+  if(resp->address.verifyChecksum())
+  {
+    shard = &routeToShard(resp->address);
+  }
+  else
+  {
+    shard = shards_[Address::Hash()(resp->address) % shards_.size()].get();
+  }
+
+  ScanReport report;
+  report.time = clock_->getTimeMS();
+  memcpy(report.address, resp->address.toByteArray(), 6);
+  report.length = min<uint8_t>(resp->length, sizeof(report.data));
+  memcpy(report.data, resp->data, report.length);
+  report.rssi = resp->rssi;
+
+  if(!shard->reports.push(report))
+  {
+    LOG_W("EbNRadioBT4", "Scan report ring is full, dropping report from %s", resp->address.toString().c_str());
+    return;
+  }
+  shard->numReports++;
+
+  // Only waking the processing thread if it is (about to start) waiting. The
+  // fence orders our push before the check, pairing with the one in
+  // processScanReports(), so that either it sees the report or we see it
+  // waiting
+  atomic_thread_fence(memory_order_seq_cst);
+  if(shard->isWaiting.load(memory_order_relaxed))
+  {
+    lock_guard<mutex> shardLock(shard->mutex);
+    shard->cond.notify_one();
+  }
+}
+
+void EbNRadioBT4::waitScanReports(ProcessShard *shard)
+{
+  unique_lock<mutex> shardLock(shard->mutex);
+  shard->drainedCond.wait(shardLock, [shard]() { return (shard->numReportsProcessed.load() == shard->numReports); });
+}
+
+void EbNRadioBT4::processScanReports(ProcessShard *shard)
+{
+  while(true)
+  {
+    ScanReport report;
+    if(shard->reports.pop(report))
+    {
+      ScanResponse resp;
+      resp.address = Address(6, report.address);
+      resp.data = report.data;
+      resp.length = report.length;
+      resp.rssi = report.rssi;
+      resp.hasMore = false;
+      resp.isTruncated = false;
+
+      processScanResponse(shard, report.time, &resp);
+      shard->numReportsProcessed++;
+      continue;
+    }
+
+    unique_lock<mutex> shardLock(shard->mutex);
+    shard->drainedCond.notify_all();
+
+    shard->isWaiting.store(true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    while(!shard->isStopping && shard->reports.empty())
+    {
+      shard->cond.wait(shardLock);
+    }
+    shard->isWaiting.store(false, memory_order_relaxed);
+
+    if(shard->isStopping)
+    {
+      break;
+    }
+  }
+}
+
 bool EbNRadioBT4::processAdvert(EbNDeviceBT4 *device, uint64_t time, const uint8_t *data)
 {
+  Metrics::Timer timer(Metrics::Histogram::AdvertProcess);
+
   BitMap advert(31 * 8, data);
   size_t advertOffset = 0;
 
   // NOTE: Ignoring the version bit for now
   advertOffset += 1;
 
+  // Adverts in the RS format would decode to a wrong public value. Only the
+  // rateless format has this bit, so RS devices cannot tell the two apart, and
+  // must be configured alike (as with RS_BACKEND)
+  if(DH_RATELESS)
+  {
+    if(!advert.get(advertOffset))
+    {
+      LOG_D("EbNRadioBT4", "Ignoring advert in the RS format from device %d", device->getID());
+      return false;
+    }
+    advertOffset += 1;
+  }
+
+  device->addAdvert();
+
   uint32_t advertNum = 0;
   for(int b = 0; b < ADV_N_LOG2; b++)
   {
@@ -444,6 +749,7 @@ bool EbNRadioBT4::processAdvert(EbNDeviceBT4 *device, uint64_t time, const uint8
   advertOffset += ADV_N_LOG2;
 
   LOG_P("EbNRadioBT4", "Processing advert %u from device %d - '%s'", advertNum, device->getID(), advert.toHexString().c_str());
+  PROBE2(advert_process, device->getID(), advertNum);
 
   if(advertNum < (RS_K + RS_M))
   {
@@ -487,18 +793,25 @@ bool EbNRadioBT4::processAdvert(EbNDeviceBT4 *device, uint64_t time, const uint8
     {
       if(isNew)
       {
-        prevEpoch = curEpoch;
+        // Epochs before the previous one are normally removed by processEpochs(),
+        // but evicting the oldest here in case adverts arrive between calls
+        evictOldest(device->epochs_, EbNDeviceBT4::MAX_EPOCHS, "epoch", device->getID());
 
-        device->epochs_.push_back(EbNDeviceBT4::Epoch(advertNum, time, dhCodeMatrix_, dhExchange_, (device->getAddress().getPartialValue(0x20) >> 5) & 0x1));
+        device->epochs_.emplace_back(advertNum, time, dhCodeMatrix_, dhExchange_, (device->getAddress().getPartialValue(0x20) >> 5) & 0x1);
         curEpoch = &device->epochs_.back();
+        prevEpoch = (device->epochs_.size() > 1) ? &device->epochs_[device->epochs_.size() - 2] : NULL;
 
         LOG_P("EbNRadioBT4", "Creating new epoch, previous epoch %s", (prevEpoch == NULL) ? "does not exist" : "exists");
       }
 
-      // Processing the DH symbol for the current epoch
+      // Processing the DH symbol for the current epoch, skipping symbols that
+      // are duplicates or can no longer contribute to decoding
       uint8_t dhSymbol[RS_W];
-      advert.copyTo(dhSymbol, 0, advertOffset, 8 * RS_W);
-      curEpoch->dhDecoder.setSymbol(advertNum, dhSymbol);
+      if(curEpoch->dhDecoder.isUseful(advertNum))
+      {
+        advert.copyTo(dhSymbol, 0, advertOffset, 8 * RS_W);
+        curEpoch->dhDecoder.setSymbol(advertNum, dhSymbol);
+      }
       advertOffset += 8 * RS_W;
 
       // Processing the DH symbol for the previous epoch if we are within the
@@ -506,7 +819,7 @@ bool EbNRadioBT4::processAdvert(EbNDeviceBT4 *device, uint64_t time, const uint8
       // non-decoded state
       if(advertNum < (RS_K - 1))
       {
-        if((prevEpoch != NULL) && !prevEpoch->dhDecoder.isDecoded())
+        if((prevEpoch != NULL) && prevEpoch->dhDecoder.isUseful(advertNum + RS_K + RS_M))
         {
           advert.copyTo(dhSymbol, 0, advertOffset, 8 * RS_W);
           prevEpoch->dhDecoder.setSymbol(advertNum + RS_K + RS_M, dhSymbol);
@@ -535,7 +848,13 @@ bool EbNRadioBT4::processAdvert(EbNDeviceBT4 *device, uint64_t time, const uint8
           totalSize += segmentSize;
         }
 
-        curEpoch->blooms.push_back(make_pair(bloomNum, SegmentedBloomFilter(BF_N, totalSize, BF_K, BF_B, segmentSizes, true)));
+        if(curEpoch->blooms.empty())
+        {
+          curEpoch->blooms.reserve(BF_MAX_KEPT);
+        }
+        evictOldest(curEpoch->blooms, BF_MAX_KEPT, "Bloom filter", device->getID());
+
+        curEpoch->blooms.emplace_back(bloomNum, SegmentedBloomFilter(BF_N, totalSize, BF_K, BF_B, segmentSizes, true));
         bloom = &curEpoch->blooms.back().second;
       }
 
@@ -561,6 +880,8 @@ void EbNRadioBT4::processEpochs(EbNDeviceBT4 *device)
     {
       const uint8_t *dhRemotePublic = epoch.dhDecoder.decode();
       epoch.decodeBloomNum = epoch.blooms.back().first;
+      device->setDHDecoded();
+      PROBE2(epoch_decode, device->getID(), epoch.decodeBloomNum);
 
       // Computing shared secret(s) from the DH exchange(s), only for non-active confirmation schemes
       if((confirmScheme_.type & ConfirmScheme::Active) != ConfirmScheme::Active)
@@ -694,6 +1015,8 @@ void EbNRadioBT4::processActiveHandshake(const vector<uint8_t> &message, EbNDevi
     return;
   }
 
+  device->setDHDecoded();
+
   // Computing the shared secret
   SharedSecret sharedSecret(SharedSecret::ConfirmScheme::Active);
   if(dhExchange_.computeSharedSecret(sharedSecret, message.data()))
@@ -715,73 +1038,140 @@ void EbNRadioBT4::processActiveHandshake(const vector<uint8_t> &message, EbNDevi
   }
 }
 
-void EbNRadioBT4::listen()
+// Serves one incoming handshake, which mirrors the active side: the remote
+// device sends its message first, we reply with ours, and then wait for it to
+// close the connection since we are sending last
+class EbNRadioBT4::ListenSession : public ConnectionAcceptor::Session
 {
-  while(true)
+private:
+  struct Stage_
   {
-    LOG_D("EbNRadioBT4", "Attempting to listen for incoming BT4 connections");
+    enum Type
+    {
+      Generating,
+      Receiving,
+      Sending,
+      Closing
+    };
+  };
+  typedef Stage_::Type Stage;
+
+private:
+  EbNRadioBT4 *radio_;
+  Address address_;
+  Stage stage_;
+  size_t publicSize_;
+  vector<uint8_t> localMessage_;
+  vector<uint8_t> remoteMessage_;
+
+public:
+  ListenSession(EbNRadioBT4 *radio, const Address &address)
+     : radio_(radio),
+       address_(address),
+       stage_(Stage::Generating),
+       publicSize_(0),
+       localMessage_(),
+       remoteMessage_()
+  {
+  }
 
-    int listenSock = hci_.listenBT4();
+  ConnectionAcceptor::Step start()
+  {
+    // Filling the Bloom filter is the expensive part, so it is left to a worker
+    return ConnectionAcceptor::Step::compute();
+  }
 
-    LOG_D("EbNRadioBT4", "Waiting to accept incoming BT4 connection");
+  void compute()
+  {
+    unique_lock<mutex> dhExchangeLock(radio_->dhExchangeMutex_);
+    ECDH dhExchangeCopy(radio_->dhExchange_);
+    dhExchangeLock.unlock();
 
-    pair<int, Address> clientInfo;
-    while((clientInfo = hci_.acceptBT4(listenSock)).first != -1)
-    {
-      AndroidWake::grab("EbNListen");
+    publicSize_ = dhExchangeCopy.getPublicSize();
+    localMessage_ = radio_->generateActiveHandshake(dhExchangeCopy);
+  }
 
-      int clientSock = clientInfo.first;
-      Address clientAddress = clientInfo.second;
+  ConnectionAcceptor::Step advance(vector<uint8_t> &received)
+  {
+    switch(stage_)
+    {
+    case Stage::Generating:
+      stage_ = Stage::Receiving;
+      return ConnectionAcceptor::Step::receive(localMessage_.size(), LISTEN_EXCHANGE_TIMEOUT);
 
-      if(clientAddress.verifyChecksum())
+    case Stage::Receiving:
       {
-        LOG_D("EbNRadioBT4", "Accepted incoming connection from %s", clientAddress.toString().c_str());
-
-        unique_lock<mutex> dhExchangeLock(dhExchangeMutex_);
-        ECDH dhExchangeCopy(dhExchange_);
-        dhExchangeLock.unlock();
+        remoteMessage_.swap(received);
 
-        vector<uint8_t> localMessage = generateActiveHandshake(dhExchangeCopy);
-        vector<uint8_t> remoteMessage(localMessage.size(), 0);
+        BitMap remoteMessageBM(publicSize_ * 8, remoteMessage_.data());
+        LOG_D("EbNRadioBT4", "Received '%s' from remote device", remoteMessageBM.toHexString().c_str());
 
-        if(hci_.recv(clientSock, remoteMessage.data(), remoteMessage.size(), 1000))
+        bool allZeros = true;
+        for(int b = 0; b < remoteMessage_.size(); b++)
         {
-          BitMap remoteMessageBM(dhExchangeCopy.getPublicSize() * 8, remoteMessage.data());
-          LOG_D("EbNRadioBT4", "Received '%s' from remote device", remoteMessageBM.toHexString().c_str());
-
-          bool allZeros = true;
-          for(int b = 0; b < remoteMessage.size(); b++)
+          if(remoteMessage_.data()[b] != 0)
           {
-            if(remoteMessage.data()[b] != 0)
-            {
-              allZeros = false;
-              break;
-            }
+            allZeros = false;
+            break;
           }
+        }
 
-          if(!allZeros && hci_.send(clientSock, localMessage.data(), localMessage.size(), 1000))
-          {
-            lock_guard<mutex> listenAdvertsLock(listenAdvertsMutex_);
-            listenAdverts_.push_back(make_pair(clientAddress, remoteMessage));
-
-            // Attempting to now wait for the connection to close on the other
-            // side prior to closing it on this side, since we are sending last.
-            // This should have the same timeout as a recv() call.
-            LOG_D("EbNRadioBT4", "Waiting for remote client to close connection...");
-            hci_.waitClose(clientSock, 1000);
-            LOG_D("EbNRadioBT4", "Done!");
-          }
+        if(allZeros)
+        {
+          return ConnectionAcceptor::Step::close(false);
         }
+
+        stage_ = Stage::Sending;
+        return ConnectionAcceptor::Step::send(localMessage_, LISTEN_EXCHANGE_TIMEOUT);
       }
-      else
+
+    case Stage::Sending:
+      if(!radio_->listenResults_.push({address_, remoteMessage_}))
       {
-        LOG_D("EbNRadioBT4", "Rejected incoming connection from address %s [Checksum OK? 0]", clientAddress.toString().c_str());
+        LOG_W("EbNRadioBT4", "Dropping incoming handshake from %s, results are full", address_.toString().c_str());
       }
 
-      close(clientSock);
+      LOG_D("EbNRadioBT4", "Waiting for remote client to close connection...");
+      stage_ = Stage::Closing;
+      return ConnectionAcceptor::Step::waitClose(LISTEN_EXCHANGE_TIMEOUT);
 
-      AndroidWake::release("EbNListen");
+    default:
+      return ConnectionAcceptor::Step::close(true);
     }
+  }
+
+  void finish(bool isSuccess)
+  {
+    LOG_D("EbNRadioBT4", "Done with incoming connection from %s [Success? %d]", address_.toString().c_str(), isSuccess);
+  }
+};
+
+unique_ptr<ConnectionAcceptor::Session> EbNRadioBT4::createListenSession(const Address &address)
+{
+  if(!address.verifyChecksum())
+  {
+    LOG_D("EbNRadioBT4", "Rejected incoming connection from address %s [Checksum OK? 0]", address.toString().c_str());
+    return nullptr;
+  }
+
+  return unique_ptr<ConnectionAcceptor::Session>(new ListenSession(this, address));
+}
+
+void EbNRadioBT4::listen()
+{
+  // Only this thread pushes onto listenResults_, since every session is
+  // advanced from the acceptor's loop (workers only generate messages)
+  ConnectionAcceptor acceptor([this](int sockListen) { return hci_.acceptBT4(sockListen); }, [this](const Address &address) { return createListenSession(address); }, LISTEN_WORKERS, "EbNListen");
+
+  while(true)
+  {
+    LOG_D("EbNRadioBT4", "Attempting to listen for incoming BT4 connections");
+
+    int listenSock = hci_.listenBT4();
+
+    LOG_D("EbNRadioBT4", "Waiting to accept incoming BT4 connections");
+
+    acceptor.run(listenSock);
 
     close(listenSock);
 
@@ -30,6 +30,7 @@ void EbNRadioBT4AR::initialize()
 
   // Disabling advertising so that we can set up the new address and first
   // advertisement before remote devices can receive it
+  hci_.beginAdvertUpdate();
   hci_.enableAdvertising(false);
 
   hci_.setRandomAddress(Address::generate(6));
@@ -39,6 +40,7 @@ void EbNRadioBT4AR::initialize()
   nextChangeEpoch_ -= EPOCH_INTERVAL;
 
   hci_.enableAdvertising(true);
+  hci_.endAdvertUpdate();
 }
 
 list<DiscoverEvent> EbNRadioBT4AR::discover()
@@ -49,7 +51,7 @@ list<DiscoverEvent> EbNRadioBT4AR::discover()
   }
 
   list<DiscoverEvent> discovered;
-  function<void(const ScanResponse *)> callback = bind(&EbNRadioBT4AR::processScanResponse, this, &discovered, placeholders::_1);
+  auto callback = [&](const ScanResponse *response) { processScanResponse(&discovered, response); };
   hci_.performScan(BluetoothHCI::Scan::Passive, BluetoothHCI::DuplicateFilter::On, SCAN_WINDOW, callback);
 
   nextDiscover_ += SCAN_INTERVAL;
@@ -57,26 +59,28 @@ list<DiscoverEvent> EbNRadioBT4AR::discover()
   return discovered;
 }
 
-void EbNRadioBT4AR::changeEpoch()
+void EbNRadioBT4AR::setAdvertisedSet(const LinkValueList &advertisedSet)
 {
-  Address nextAddress = Address::generate(6);
-
-  uint8_t output[16];
-  int updateSize = sizeof(output);
-  int outputSize = sizeof(output);
+  lock_guard<mutex> setLock(setMutex_);
+  advertisedSet_ = advertisedSet;
 
-  EVP_CIPHER_CTX evpContext;
-  EVP_CIPHER_CTX_init(&evpContext);
-  EVP_EncryptInit_ex(&evpContext, EVP_aes_128_ecb(), NULL, keyIRK_.data(), NULL);
-  EVP_EncryptUpdate(&evpContext, output, &updateSize, nextAddress.toByteArray() + 3, 3);
-  EVP_EncryptFinal_ex(&evpContext, output, &outputSize);
-  EVP_CIPHER_CTX_cleanup(&evpContext);
+  keyIRK_.assign(keyIRK_.size(), 0);
+  if(!advertisedSet.empty())
+  {
+    const LinkValue &value = advertisedSet.front();
+    memcpy(keyIRK_.data(), value.get(), min(keyIRK_.size(), value.size()));
+  }
+}
 
-  memcpy(nextAddress.toByteArray(), output + 13, 3);
+void EbNRadioBT4AR::changeEpoch()
+{
+  Address nextAddress = generateAddress();
 
+  hci_.beginAdvertUpdate();
   hci_.enableAdvertising(false);
   hci_.setRandomAddress(nextAddress);
   hci_.enableAdvertising(true);
+  hci_.endAdvertUpdate();
 
   // Setting the next time to change epochs
   nextChangeEpoch_ += EPOCH_INTERVAL;
@@ -104,7 +108,7 @@ EncounterEvent EbNRadioBT4AR::doneWithDevice(DeviceID id)
 {
   EbNDeviceBT4AR *device = deviceMap_.get(id);
 
-  EncounterEvent expiredEvent(getTimeMS());
+  EncounterEvent expiredEvent(clock_->getTimeMS());
   device->getEncounterInfo(expiredEvent, true);
 
   deviceMap_.remove(id);
@@ -113,9 +117,39 @@ EncounterEvent EbNRadioBT4AR::doneWithDevice(DeviceID id)
   return expiredEvent;
 }
 
+void EbNRadioBT4AR::recover()
+{
+  hci_.recover();
+}
+
+uint64_t EbNRadioBT4AR::getDiscoverInterval() const
+{
+  return SCAN_INTERVAL;
+}
+
+Address EbNRadioBT4AR::generateAddress() const
+{
+  Address address = Address::generate(6);
+
+  uint8_t output[16];
+  int updateSize = sizeof(output);
+  int outputSize = sizeof(output);
+
+  EVP_CIPHER_CTX evpContext;
+  EVP_CIPHER_CTX_init(&evpContext);
+  EVP_EncryptInit_ex(&evpContext, EVP_aes_128_ecb(), NULL, keyIRK_.data(), NULL);
+  EVP_EncryptUpdate(&evpContext, output, &updateSize, address.toByteArray() + 3, 3);
+  EVP_EncryptFinal_ex(&evpContext, output, &outputSize);
+  EVP_CIPHER_CTX_cleanup(&evpContext);
+
+  memcpy(address.toByteArray(), output + 13, 3);
+
+  return address;
+}
+
 void EbNRadioBT4AR::processScanResponse(list<DiscoverEvent> *discovered, const ScanResponse *resp)
 {
-  uint64_t scanTime = getTimeMS();
+  uint64_t scanTime = clock_->getTimeMS();
 
   EbNDeviceBT4AR *device = deviceMap_.get(resp->address);
   if(device == NULL)
@@ -0,0 +1,375 @@
+#include "EbNRadioBT5.h"
+
+#include <stdexcept>
+
+#include "Metrics.h"
+#include "Probes.h"
+
+using namespace std;
+
+EbNRadio::ConfirmScheme EbNRadioBT5::getDefaultConfirmScheme()
+{
+  return {ConfirmScheme::Passive, 0.05};
+}
+
+EbNRadioBT5::EbNRadioBT5(size_t keySize, ConfirmScheme confirmScheme, MemoryScheme memoryScheme, int adapterID)
+   : EbNRadio(keySize, confirmScheme, memoryScheme),
+     BF_M(((ADV_SIZE - 2) * 8) - 1 - ADV_N_LOG2 - keySize),
+     BF_K(4),
+     hci_(adapterID),
+     deviceMap_(),
+     dhExchange_(keySize),
+     address_(),
+     advertNum_(0)
+{
+  if((confirmScheme.type & ConfirmScheme::Active) != 0)
+  {
+    throw std::runtime_error("Invalid Confirmation Scheme for EbNRadioBT5: Only supports 'None' and 'Passive'.");
+  }
+
+  LOG_D("EbNRadioBT5", "General Parameters: ADV_N = %zu, ADV_N_LOG2 = %zu", ADV_N, ADV_N_LOG2);
+  LOG_D("EbNRadioBT5", "BF Parameters: M = %u, K = %u", BF_M, BF_K);
+}
+
+void EbNRadioBT5::initialize()
+{
+  // Advertising stays disabled until the first address and advert have been
+  // set, so that remote devices never receive a mismatched pair
+  hci_.enableExtAdvertising(false);
+  hci_.setExtAdvertParams(false, ADVERT_MIN_INTERVAL, ADVERT_MAX_INTERVAL);
+
+  uint8_t partial = (uint8_t)dhExchange_.getPublicY() << 5;
+  address_ = Address::generateWithPartial(6, partial, 0x20);
+
+  changeAdvert();
+  hci_.enableExtAdvertising(true);
+}
+
+list<DiscoverEvent> EbNRadioBT5::discover()
+{
+  if(memoryScheme_ == MemoryScheme::NoMemory)
+  {
+    deviceMap_.clear();
+  }
+
+  changeAdvert();
+
+  // Duplicates are not filtered by the controller (see performExtendedScan()),
+  // so each device is only handled for the first of its adverts in the window
+  list<DiscoverEvent> discovered;
+  unordered_set<DeviceID> scanned;
+  auto callback = [&](const ScanResponse *response) { processScanResponse(&discovered, &scanned, response); };
+  hci_.performExtendedScan(BluetoothHCI::Scan::Passive, SCAN_WINDOW, callback);
+
+  nextDiscover_ += SCAN_INTERVAL + (-1000 + (rand() % 2001));
+
+  return discovered;
+}
+
+void EbNRadioBT5::changeEpoch()
+{
+  advertNum_ = 0;
+
+  // Generate a new secret for this epoch's DH exchanges
+  dhExchange_.generateSecret();
+
+  // Shifting the current address. Uses the 1 bit Y coordinate as part of the
+  // address since compressed ECDH keys are actually (keySize + 1) bits long
+  uint8_t partial = (uint8_t)dhExchange_.getPublicY() << 5;
+  address_ = address_.shiftWithPartial(partial, 0x20);
+
+  // The new address is sent along with the first advert of the epoch
+  changeAdvert();
+
+  // Computing new shared secrets in the case of passive confirmation
+  if((confirmScheme_.type & ConfirmScheme::Passive) != 0)
+  {
+    for(auto it = deviceMap_.begin(); it != deviceMap_.end(); it++)
+    {
+      EbNDeviceBT5 *device = it->second;
+      if(!device->epochs_.empty())
+      {
+        EbNDeviceBT5::Epoch &curEpoch = device->epochs_.back();
+
+        SharedSecret sharedSecret(confirmScheme_.type == ConfirmScheme::None);
+        if(dhExchange_.computeSharedSecret(sharedSecret, curEpoch.dhRemotePublic.data(), curEpoch.dhRemoteYCoord))
+        {
+          device->addSharedSecret(sharedSecret);
+        }
+        else
+        {
+          LOG_E("EbNRadioBT5", "Could not compute shared secret for id %d", device->getID());
+        }
+      }
+    }
+  }
+
+  nextChangeEpoch_ += EPOCH_INTERVAL;
+}
+
+set<DeviceID> EbNRadioBT5::handshake(const set<DeviceID> &deviceIDs)
+{
+  set<DeviceID> encountered;
+
+  for(auto it = deviceIDs.begin(); it != deviceIDs.end(); it++)
+  {
+    deviceMap_.get(*it)->setShakenHands(true);
+  }
+
+  // Going through all devices to report 'encountered' devices, meaning
+  // the devices we have shaken hands with and confirmed
+  for(auto it = deviceMap_.begin(); it != deviceMap_.end(); it++)
+  {
+    EbNDevice *device = it->second;
+    if(device->hasShakenHands() && device->isConfirmed())
+    {
+      encountered.insert(device->getID());
+    }
+  }
+
+  return encountered;
+}
+
+EncounterEvent EbNRadioBT5::doneWithDevice(DeviceID id)
+{
+  EbNDeviceBT5 *device = deviceMap_.get(id);
+
+  EncounterEvent expiredEvent(clock_->getTimeMS());
+  device->getEncounterInfo(expiredEvent, true);
+
+  deviceMap_.remove(id);
+  removeRecentDevice(id);
+
+  return expiredEvent;
+}
+
+void EbNRadioBT5::recover()
+{
+  // The advertising set is part of the adapter's last known state, so it is
+  // restored along with everything else
+  hci_.recover();
+}
+
+uint64_t EbNRadioBT5::getDiscoverInterval() const
+{
+  return SCAN_INTERVAL;
+}
+
+void EbNRadioBT5::changeAdvert()
+{
+  if(advertNum_ >= ADV_N)
+  {
+    LOG_D("EbNRadioBT5", "Reached last unique advert, waiting for epoch change\n");
+    return;
+  }
+
+  BitMap advert = generateAdvert(advertNum_);
+
+  // Setting the address and advertisement data together, so that the Y
+  // coordinate held in the address always matches the advertised key
+  hci_.setExtAdvert(address_, advert.toByteArray(), ADV_SIZE);
+  LOG_P("EbNRadioBT5", "Setting advert data to \'%s\'", advert.toHexString().c_str());
+
+  advertNum_++;
+}
+
+void EbNRadioBT5::processScanResponse(list<DiscoverEvent> *discovered, unordered_set<DeviceID> *scanned, const ScanResponse *resp)
+{
+  uint64_t scanTime = clock_->getTimeMS();
+
+  bool addressOK = resp->address.verifyChecksum();
+  bool lengthOK = (resp->length == ADV_SIZE) && (resp->data[0] == (ADV_SIZE - 1));
+  bool typeOK = (resp->length >= 2) && (resp->data[1] == 0xFF);
+  if(addressOK && lengthOK && typeOK)
+  {
+    EbNDeviceBT5 *device = deviceMap_.get(resp->address);
+    if(device == NULL)
+    {
+      lock_guard<mutex> setLock(setMutex_);
+
+      device = new EbNDeviceBT5(generateDeviceID(), resp->address, listenSet_);
+      deviceMap_.add(resp->address, device);
+
+      LOG_P("EbNRadioBT5", "Discovered new EbN device (ID %d, Address %s)", device->getID(), device->getAddress().toString().c_str());
+    }
+
+    if(!scanned->insert(device->getID()).second)
+    {
+      return;
+    }
+
+    device->addRSSIMeasurement(scanTime, resp->rssi);
+    discovered->push_back(DiscoverEvent(scanTime, device->getID(), resp->rssi));
+    addRecentDevice(device);
+
+    // Processing the advertisement in the case of passive confirmation,
+    // regardless of the state of the stable device detector
+    if((confirmScheme_.type == ConfirmScheme::None) || ((confirmScheme_.type & ConfirmScheme::Passive) != 0))
+    {
+      processAdvert(device, scanTime, resp->data);
+      processEpochs(device);
+    }
+  }
+  else
+  {
+    LOG_D("EbNRadioBT5", "Discovered non-EbN device (Address %s) [Checksum OK? %d] [Length OK? %d (%d)] [Type OK? %d]", resp->address.toString().c_str(), addressOK, lengthOK, resp->length, typeOK);
+  }
+}
+
+BitMap EbNRadioBT5::generateAdvert(size_t advertNum)
+{
+  BitMap advert(ADV_SIZE * 8);
+  size_t advertOffset = 0;
+
+  advert.setAll(false);
+  advert.setByte(0, ADV_SIZE - 1);
+  advert.setByte(1, 0xFF);
+  advertOffset += 16;
+
+  // NOTE: Version bit is 0, since we are not an infrastructure node
+  advertOffset += 1;
+
+  // Inserting the advertisement number as the first portion of the advert
+  for(int b = 0; b < ADV_N_LOG2; b++)
+  {
+    advert.set(b + advertOffset, (advertNum >> b) & 0x1);
+  }
+  advertOffset += ADV_N_LOG2;
+
+  // Insert the current DH exchange public key (with the Y coordinate held in
+  // the address)
+  advert.copyFrom(dhExchange_.getPublicX(), 0, advertOffset, keySize_);
+  advertOffset += keySize_;
+
+  // Computing a new Bloom filter, which fills the rest of the advert
+  BitMap prefix(ADV_N_LOG2 + keySize_);
+  for(int b = 0; b < ADV_N_LOG2; b++)
+  {
+    prefix.set(b, (advertNum >> b) & 0x1);
+  }
+  prefix.copyFrom(dhExchange_.getPublicX(), 0, ADV_N_LOG2, keySize_);
+
+  BloomFilter advertBloom(BF_N, BF_M, BF_K);
+  fillBloomFilter(&advertBloom, prefix.toByteArray(), prefix.sizeBytes());
+  advert.copyFrom(advertBloom.toByteArray(), 0, advertOffset, BF_M);
+
+  PROBE2(advert_generate, advertNum, advert.sizeBytes());
+
+  return advert;
+}
+
+bool EbNRadioBT5::processAdvert(EbNDeviceBT5 *device, uint64_t time, const uint8_t *data, bool computeSecret)
+{
+  Metrics::Timer timer(Metrics::Histogram::AdvertProcess);
+  device->addAdvert();
+
+  BitMap advert(ADV_SIZE * 8, data);
+  size_t advertOffset = 17;
+
+  uint32_t advertNum = 0;
+  for(int b = 0; b < ADV_N_LOG2; b++)
+  {
+    if(advert.get(b + advertOffset))
+    {
+      advertNum |= (1 << b);
+    }
+  }
+  advertOffset += ADV_N_LOG2;
+
+  LOG_D("EbNRadioBT5", "Processing advertisement %u for device %d", advertNum, device->getID());
+  PROBE2(advert_process, device->getID(), advertNum);
+
+  if(advertNum < ADV_N)
+  {
+    EbNDeviceBT5::Epoch *curEpoch;
+    bool isDuplicate = false;
+    bool isNew = true;
+
+    if(!device->epochs_.empty())
+    {
+      curEpoch = &device->epochs_.back();
+
+      uint64_t diffAdvertTime = time - curEpoch->lastAdvertTime;
+      uint32_t diffAdvertNum = advertNum - curEpoch->lastAdvertNum;
+
+      // This is a duplicate advertisement
+      if((curEpoch->lastAdvertNum == advertNum))
+      {
+        if(diffAdvertTime < ((ADV_N - 3) * SCAN_INTERVAL))
+        {
+          isDuplicate = true;
+          isNew = false;
+        }
+      }
+      // This advertisement belongs to the current epoch
+      else if((curEpoch->lastAdvertNum < advertNum) && (diffAdvertTime < ((diffAdvertNum + 3) * SCAN_INTERVAL)))
+      {
+        isNew = false;
+      }
+    }
+
+    // Skip processing any advertisement that we have already seen
+    if(!isDuplicate)
+    {
+      if(isNew)
+      {
+        device->epochs_.push_back(EbNDeviceBT5::Epoch(advertNum, time, keySize_, device->getAddress().getPartialValue(0x20) >> 5));
+        curEpoch = &device->epochs_.back();
+
+        advert.copyTo(curEpoch->dhRemotePublic.data(), 0, advertOffset, keySize_);
+        device->setDHDecoded();
+        PROBE2(epoch_decode, device->getID(), advertNum);
+
+        if(computeSecret)
+        {
+          SharedSecret sharedSecret(confirmScheme_.type == ConfirmScheme::None);
+          if(dhExchange_.computeSharedSecret(sharedSecret, curEpoch->dhRemotePublic.data(), curEpoch->dhRemoteYCoord))
+          {
+            device->addSharedSecret(sharedSecret);
+          }
+          else
+          {
+            LOG_E("EbNRadioBT5", "Could not compute shared secret for id %d", device->getID());
+          }
+        }
+      }
+      else
+      {
+        curEpoch->lastAdvertNum = advertNum;
+        curEpoch->lastAdvertTime = time;
+      }
+      advertOffset += keySize_;
+
+      // Updating the matching set, as well as shared secret confidence in the
+      // case of passive confirmation, based on the Bloom filter contained in
+      // the advertisement
+      BloomFilter bloom(BF_N, BF_K, advert, advertOffset, BF_M);
+
+      BitMap prefix(ADV_N_LOG2 + keySize_);
+      for(int b = 0; b < ADV_N_LOG2; b++)
+      {
+        prefix.set(b, (advertNum >> b) & 0x1);
+      }
+      prefix.copyFrom(curEpoch->dhRemotePublic.data(), 0, ADV_N_LOG2, keySize_);
+
+      device->updateMatching(&bloom, prefix.toByteArray(), prefix.sizeBytes());
+      if(((confirmScheme_.type & ConfirmScheme::Passive) != 0) && !isNew)
+      {
+        device->confirmPassive(&bloom, prefix.toByteArray(), prefix.sizeBytes(), confirmScheme_.threshold);
+      }
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void EbNRadioBT5::processEpochs(EbNDeviceBT5 *device)
+{
+  // Removing any past epochs that we are finished with
+  while(device->epochs_.size() > 1)
+  {
+    device->epochs_.pop_front();
+  }
+}
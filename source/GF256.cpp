@@ -0,0 +1,167 @@
+#include "GF256.h"
+
+#include <cstring>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GF256_NEON
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define GF256_SSSE3
+#endif
+
+using namespace std;
+
+GF256::GF256()
+{
+  uint16_t x = 1;
+  for(int i = 0; i < 255; i++)
+  {
+    exp_[i] = x;
+    exp_[i + 255] = x;
+    log_[x] = i;
+
+    x <<= 1;
+    if(x & 0x100)
+    {
+      x ^= POLYNOMIAL;
+    }
+  }
+  exp_[510] = exp_[0];
+  exp_[511] = exp_[1];
+  log_[0] = 0;
+
+  for(int v = 0; v < 256; v++)
+  {
+    for(int n = 0; n < 16; n++)
+    {
+      splitLow_[v][n] = multiply(v, n);
+      splitHigh_[v][n] = multiply(v, n << 4);
+    }
+  }
+}
+
+void GF256::multiplyRegion(uint8_t *dest, const uint8_t *source, uint8_t value, size_t length) const
+{
+  if(value == 0)
+  {
+    memset(dest, 0, length);
+    return;
+  }
+  else if(value == 1)
+  {
+    memmove(dest, source, length);
+    return;
+  }
+
+  const uint8_t *low = splitLow_[value];
+  const uint8_t *high = splitHigh_[value];
+  size_t b = 0;
+
+#if defined(GF256_NEON)
+  uint8x8x2_t lowTable = {{vld1_u8(low), vld1_u8(low + 8)}};
+  uint8x8x2_t highTable = {{vld1_u8(high), vld1_u8(high + 8)}};
+  uint8x8_t mask = vdup_n_u8(0x0F);
+  for(; (b + 8) <= length; b += 8)
+  {
+    uint8x8_t in = vld1_u8(source + b);
+    uint8x8_t out = veor_u8(vtbl2_u8(lowTable, vand_u8(in, mask)), vtbl2_u8(highTable, vshr_n_u8(in, 4)));
+    vst1_u8(dest + b, out);
+  }
+#elif defined(GF256_SSSE3)
+  __m128i lowTable = _mm_loadu_si128((const __m128i *)low);
+  __m128i highTable = _mm_loadu_si128((const __m128i *)high);
+  __m128i mask = _mm_set1_epi8(0x0F);
+  for(; (b + 16) <= length; b += 16)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i *)(source + b));
+    __m128i out = _mm_xor_si128(_mm_shuffle_epi8(lowTable, _mm_and_si128(in, mask)),
+                                _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi64(in, 4), mask)));
+    _mm_storeu_si128((__m128i *)(dest + b), out);
+  }
+#endif
+
+  for(; b < length; b++)
+  {
+    dest[b] = low[source[b] & 0x0F] ^ high[source[b] >> 4];
+  }
+}
+
+void GF256::multiplyAddRegion(uint8_t *dest, const uint8_t *source, uint8_t value, size_t length) const
+{
+  if(value == 0)
+  {
+    return;
+  }
+  else if(value == 1)
+  {
+    addRegion(dest, source, length);
+    return;
+  }
+
+  const uint8_t *low = splitLow_[value];
+  const uint8_t *high = splitHigh_[value];
+  size_t b = 0;
+
+#if defined(GF256_NEON)
+  uint8x8x2_t lowTable = {{vld1_u8(low), vld1_u8(low + 8)}};
+  uint8x8x2_t highTable = {{vld1_u8(high), vld1_u8(high + 8)}};
+  uint8x8_t mask = vdup_n_u8(0x0F);
+  for(; (b + 8) <= length; b += 8)
+  {
+    uint8x8_t in = vld1_u8(source + b);
+    uint8x8_t out = veor_u8(vtbl2_u8(lowTable, vand_u8(in, mask)), vtbl2_u8(highTable, vshr_n_u8(in, 4)));
+    vst1_u8(dest + b, veor_u8(vld1_u8(dest + b), out));
+  }
+#elif defined(GF256_SSSE3)
+  __m128i lowTable = _mm_loadu_si128((const __m128i *)low);
+  __m128i highTable = _mm_loadu_si128((const __m128i *)high);
+  __m128i mask = _mm_set1_epi8(0x0F);
+  for(; (b + 16) <= length; b += 16)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i *)(source + b));
+    __m128i out = _mm_xor_si128(_mm_shuffle_epi8(lowTable, _mm_and_si128(in, mask)),
+                                _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi64(in, 4), mask)));
+    _mm_storeu_si128((__m128i *)(dest + b), _mm_xor_si128(_mm_loadu_si128((const __m128i *)(dest + b)), out));
+  }
+#endif
+
+  for(; b < length; b++)
+  {
+    dest[b] ^= low[source[b] & 0x0F] ^ high[source[b] >> 4];
+  }
+}
+
+void GF256::addRegion(uint8_t *dest, const uint8_t *source, size_t length) const
+{
+  size_t b = 0;
+
+#if defined(GF256_NEON)
+  for(; (b + 8) <= length; b += 8)
+  {
+    vst1_u8(dest + b, veor_u8(vld1_u8(dest + b), vld1_u8(source + b)));
+  }
+#elif defined(GF256_SSSE3)
+  for(; (b + 16) <= length; b += 16)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i *)(source + b));
+    _mm_storeu_si128((__m128i *)(dest + b), _mm_xor_si128(_mm_loadu_si128((const __m128i *)(dest + b)), in));
+  }
+#endif
+
+  for(; b < length; b++)
+  {
+    dest[b] ^= source[b];
+  }
+}
+
+const char* GF256::getImplementation()
+{
+#if defined(GF256_NEON)
+  return "NEON";
+#elif defined(GF256_SSSE3)
+  return "SSSE3";
+#else
+  return "Scalar";
+#endif
+}
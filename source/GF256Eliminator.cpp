@@ -0,0 +1,171 @@
+#include "GF256Eliminator.h"
+
+#include <cstring>
+
+#include "GF256.h"
+
+using namespace std;
+
+size_t GF256Eliminator::getStorageSize(size_t K, size_t W)
+{
+  // Rows and payloads, followed by scratch space for a single row, payload
+  // and the factors it was reduced by
+  return (K * K) + (K * W) + K + W + K;
+}
+
+GF256Eliminator::GF256Eliminator()
+   : K_(0),
+     W_(0),
+     rows_(NULL),
+     payloads_(NULL),
+     row_(NULL),
+     payload_(NULL),
+     factors_(NULL),
+     rank_(0),
+     reducedCoefficients_(NULL),
+     reducedRank_(0),
+     reducedPivot_(0)
+{
+}
+
+GF256Eliminator::GF256Eliminator(size_t K, size_t W, uint8_t *storage)
+   : K_(K),
+     W_(W),
+     rows_(storage),
+     payloads_(storage + (K * K)),
+     row_(storage + (K * K) + (K * W)),
+     payload_(storage + (K * K) + (K * W) + K),
+     factors_(storage + (K * K) + (K * W) + K + W),
+     rank_(0),
+     reducedCoefficients_(NULL),
+     reducedRank_(0),
+     reducedPivot_(0)
+{
+  reset();
+}
+
+bool GF256Eliminator::add(const uint8_t *coefficients, const uint8_t *payload)
+{
+  if(isComplete())
+  {
+    return false;
+  }
+
+  // Reusing the reduction from isUseful() if nothing was added since
+  size_t pivot = reducedPivot_;
+  if((coefficients != reducedCoefficients_) || (rank_ != reducedRank_))
+  {
+    memcpy(row_, coefficients, K_);
+    pivot = reduce();
+  }
+  reducedCoefficients_ = NULL;
+
+  if(pivot == K_)
+  {
+    return false;
+  }
+
+  // Taking away the same multiples of each row's payload
+  const GF256 &gf = GGF256();
+  memcpy(payload_, payload, W_);
+  for(size_t c = 0; c < K_; c++)
+  {
+    if(factors_[c] != 0)
+    {
+      gf.multiplyAddRegion(payload_, &payloads_[c * W_], factors_[c], W_);
+    }
+  }
+
+  // Normalizing so that the leading coefficient is 1
+  uint8_t scale = gf.inverse(row_[pivot]);
+  gf.multiplyRegion(&rows_[pivot * K_], row_, scale, K_);
+  gf.multiplyRegion(&payloads_[pivot * W_], payload_, scale, W_);
+
+  rank_++;
+
+  return true;
+}
+
+bool GF256Eliminator::isUseful(const uint8_t *coefficients)
+{
+  if(isComplete())
+  {
+    return false;
+  }
+
+  memcpy(row_, coefficients, K_);
+  reducedPivot_ = reduce();
+  reducedCoefficients_ = coefficients;
+  reducedRank_ = rank_;
+
+  return (reducedPivot_ != K_);
+}
+
+bool GF256Eliminator::solve(uint8_t *data)
+{
+  if(!isComplete())
+  {
+    return false;
+  }
+
+  // Back-substitution, where rows below c have already been fully reduced
+  const GF256 &gf = GGF256();
+  for(size_t c = K_; c-- > 0;)
+  {
+    uint8_t *row = &rows_[c * K_];
+    uint8_t *payload = &payloads_[c * W_];
+    for(size_t j = c + 1; j < K_; j++)
+    {
+      if(row[j] != 0)
+      {
+        gf.multiplyAddRegion(payload, &payloads_[j * W_], row[j], W_);
+        row[j] = 0;
+      }
+    }
+  }
+
+  memcpy(data, payloads_, K_ * W_);
+
+  return true;
+}
+
+void GF256Eliminator::reset()
+{
+  // Payloads are always overwritten when their row is added
+  memset(rows_, 0, K_ * K_);
+  rank_ = 0;
+  reducedCoefficients_ = NULL;
+}
+
+size_t GF256Eliminator::reduce()
+{
+  const GF256 &gf = GGF256();
+  uint8_t *row = row_;
+  memset(factors_, 0, K_);
+
+  size_t pivot = K_;
+  for(size_t c = 0; c < K_; c++)
+  {
+    if(row[c] == 0)
+    {
+      continue;
+    }
+
+    // Rows are normalized, so column c has a row iff its diagonal is set
+    if(rows_[(c * K_) + c] == 0)
+    {
+      // Leading coefficients are only ever in columns with a row, so the
+      // first column without one is the pivot for this row
+      if(pivot == K_)
+      {
+        pivot = c;
+      }
+      continue;
+    }
+
+    factors_[c] = row[c];
+    gf.multiplyAddRegion(row, &rows_[c * K_], factors_[c], K_);
+  }
+
+  return pivot;
+}
@@ -0,0 +1,26 @@
+#include "HCIBackend.h"
+
+#include "KernelHCIBackend.h"
+
+using namespace std;
+
+HCIBackend::Factory HCIBackend::factory_;
+
+shared_ptr<HCIBackend> HCIBackend::create(int adapterID)
+{
+  if(factory_)
+  {
+    return factory_(adapterID);
+  }
+
+  return shared_ptr<HCIBackend>(new KernelHCIBackend(adapterID));
+}
+
+void HCIBackend::setFactory(Factory factory)
+{
+  factory_ = factory;
+}
+
+HCIBackend::~HCIBackend()
+{
+}
@@ -0,0 +1,208 @@
+#include "HCICapture.h"
+
+#include <cstring>
+
+#include "bluetooth/bluetooth.h"
+#include "bluetooth/hci.h"
+
+#include "BluetoothHCI.h"
+#include "Logger.h"
+
+using namespace std;
+
+const char HCICapture::MAGIC[8] = { 'S', 'D', 'D', 'R', 'H', 'C', 'I', '1' };
+
+const char *HCICapture::sessionStrings[] = { "Scan", "ExtendedScan", "Inquiry" };
+
+bool HCICapture::isCaptured(const uint8_t *packet, size_t length)
+{
+  if((length < 1 + HCI_EVENT_HDR_SIZE) || (packet[0] != HCI_EVENT_PKT))
+  {
+    return false;
+  }
+
+  if(packet[1] == EVT_EXTENDED_INQUIRY_RESULT)
+  {
+    return true;
+  }
+
+  return (packet[1] == EVT_LE_META_EVENT) && (length > 1 + HCI_EVENT_HDR_SIZE) &&
+         ((packet[1 + HCI_EVENT_HDR_SIZE] == EVT_LE_ADVERTISING_REPORT) || (packet[1 + HCI_EVENT_HDR_SIZE] == EVT_LE_EXTENDED_ADVERTISING_REPORT));
+}
+
+HCICaptureWriter::HCICaptureWriter(const string &path)
+   : file_(fopen(path.c_str(), "wb")),
+     clock_(Clock::getDefault()),
+     lastTime_(clock_->getMonoUS()),
+     numEvents_(0),
+     mutex_()
+{
+  if(file_ == NULL)
+  {
+    LOG_E("HCICaptureWriter", "Could not open '%s' for writing", path.c_str());
+    return;
+  }
+
+  uint8_t header[16];
+  memcpy(header, HCICapture::MAGIC, sizeof(HCICapture::MAGIC));
+
+  uint64_t startTime = clock_->getTimeMS();
+  for(int b = 0; b < 8; b++)
+  {
+    header[8 + b] = (startTime >> (8 * b)) & 0xFF;
+  }
+
+  fwrite(header, 1, sizeof(header), file_);
+}
+
+HCICaptureWriter::~HCICaptureWriter()
+{
+  if(file_ != NULL)
+  {
+    fclose(file_);
+  }
+}
+
+void HCICaptureWriter::beginSession(HCICapture::Session session)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if(file_ == NULL)
+  {
+    return;
+  }
+
+  writeHeader(1 + session);
+  fflush(file_);
+}
+
+void HCICaptureWriter::addEvent(const uint8_t *packet, size_t length)
+{
+  if(!HCICapture::isCaptured(packet, length))
+  {
+    return;
+  }
+
+  lock_guard<mutex> lock(mutex_);
+
+  if(file_ == NULL)
+  {
+    return;
+  }
+
+  // Only writing as much as both the event's own header and the packet
+  // cover, with the recorded length matching what was written
+  uint8_t eventHeader[HCI_EVENT_HDR_SIZE] = { packet[1], (uint8_t)min<size_t>(length - (1 + HCI_EVENT_HDR_SIZE), packet[2]) };
+
+  writeHeader(0);
+  fwrite(eventHeader, 1, sizeof(eventHeader), file_);
+  fwrite(packet + 1 + HCI_EVENT_HDR_SIZE, 1, eventHeader[1], file_);
+  numEvents_++;
+}
+
+void HCICaptureWriter::writeHeader(uint8_t type)
+{
+  uint64_t curTime = clock_->getMonoUS();
+  uint64_t delta = (curTime > lastTime_) ? (curTime - lastTime_) : 0;
+  lastTime_ = curTime;
+
+  uint8_t header[1 + 10];
+  size_t length = 0;
+  header[length++] = type;
+  do
+  {
+    header[length] = delta & 0x7F;
+    delta >>= 7;
+    header[length++] |= (delta != 0) ? 0x80 : 0;
+  }
+  while(delta != 0);
+
+  fwrite(header, 1, length, file_);
+}
+
+HCICaptureReader::HCICaptureReader(const string &path)
+   : file_(fopen(path.c_str(), "rb")),
+     startTime_(0),
+     time_(0)
+{
+  if(file_ == NULL)
+  {
+    LOG_E("HCICaptureReader", "Could not open '%s' for reading", path.c_str());
+    return;
+  }
+
+  uint8_t header[16];
+  if((fread(header, 1, sizeof(header), file_) != sizeof(header)) || (memcmp(header, HCICapture::MAGIC, sizeof(HCICapture::MAGIC)) != 0))
+  {
+    LOG_E("HCICaptureReader", "'%s' is not an HCI capture", path.c_str());
+    fclose(file_);
+    file_ = NULL;
+    return;
+  }
+
+  for(int b = 0; b < 8; b++)
+  {
+    startTime_ |= (uint64_t)header[8 + b] << (8 * b);
+  }
+}
+
+HCICaptureReader::~HCICaptureReader()
+{
+  if(file_ != NULL)
+  {
+    fclose(file_);
+  }
+}
+
+bool HCICaptureReader::next(HCICapture::Record &record)
+{
+  if(file_ == NULL)
+  {
+    return false;
+  }
+
+  int type = getc(file_);
+  if((type == EOF) || (type > HCICapture::Session::END))
+  {
+    return false;
+  }
+
+  uint64_t delta = 0;
+  int shift = 0;
+  int byte;
+  do
+  {
+    if(((byte = getc(file_)) == EOF) || (shift > 63))
+    {
+      return false;
+    }
+    delta |= (uint64_t)(byte & 0x7F) << shift;
+    shift += 7;
+  }
+  while(byte & 0x80);
+
+  time_ += delta;
+  record.time = time_;
+  record.isSession = (type != 0);
+  record.packet.clear();
+
+  if(record.isSession)
+  {
+    record.session = (HCICapture::Session)(type - 1);
+    return true;
+  }
+
+  uint8_t header[HCI_EVENT_HDR_SIZE];
+  if(fread(header, 1, sizeof(header), file_) != sizeof(header))
+  {
+    return false;
+  }
+
+  record.packet.resize(1 + HCI_EVENT_HDR_SIZE + header[1]);
+  record.packet[0] = HCI_EVENT_PKT;
+  record.packet[1] = header[0];
+  record.packet[2] = header[1];
+
+  // An event may have no parameters at all
+  return (header[1] == 0) || (fread(record.packet.data() + 1 + HCI_EVENT_HDR_SIZE, 1, header[1], file_) == header[1]);
+}
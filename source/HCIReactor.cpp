@@ -0,0 +1,53 @@
+#include "HCIReactor.h"
+
+#include "bluetooth/hci_lib.h"
+
+#include "Logger.h"
+
+using namespace std;
+
+HCIReactor::HCIReactor(HCIBackend &backend)
+   : backend_(backend),
+     buffer_(MAX_BATCH * HCI_MAX_EVENT_SIZE)
+{
+  open();
+}
+
+HCIReactor::~HCIReactor()
+{
+  close();
+}
+
+void HCIReactor::open()
+{
+  struct hci_filter filter;
+  hci_filter_clear(&filter);
+  hci_filter_set_ptype(HCI_EVENT_PKT, &filter);
+  hci_filter_set_event(EVT_LE_META_EVENT, &filter);
+  hci_filter_set_event(EVT_EXTENDED_INQUIRY_RESULT, &filter);
+  hci_filter_set_event(EVT_INQUIRY_COMPLETE, &filter);
+  hci_filter_set_event(EVT_CMD_COMPLETE, &filter);
+  hci_filter_set_event(EVT_CMD_STATUS, &filter);
+  hci_filter_set_event(EVT_REMOTE_NAME_REQ_COMPLETE, &filter);
+
+  backend_.openEvents(filter);
+}
+
+void HCIReactor::close()
+{
+  backend_.closeEvents();
+}
+
+void HCIReactor::flush()
+{
+  size_t numFlushed = backend_.flushEvents();
+  if(numFlushed > 0)
+  {
+    LOG_D("HCIReactor", "Flushed %zu stale events", numFlushed);
+  }
+}
+
+size_t HCIReactor::readBatch(int64_t timeout)
+{
+  return backend_.readEvents(timeout, buffer_.data(), lengths_, MAX_BATCH);
+}
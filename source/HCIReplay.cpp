@@ -0,0 +1,105 @@
+#include "HCIReplay.h"
+
+#include "Timing.h"
+
+using namespace std;
+
+HCIReplay::HCIReplay(const string &path)
+   : reader_(path),
+     next_(),
+     hasNext_(false),
+     isFinished_(false),
+     isInSession_(false),
+     sessionStart_(0),
+     numSessions_(0),
+     numSkipped_(0),
+     numEvents_(0),
+     sessionTimes_(),
+     mutex_()
+{
+  // Skipping ahead to the first session
+  while((hasNext_ = reader_.next(next_)) && !next_.isSession)
+  {
+  }
+
+  isFinished_ = !hasNext_;
+}
+
+bool HCIReplay::isFinished() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return isFinished_;
+}
+
+bool HCIReplay::nextSession(HCICapture::Session session, vector<Event> &events)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  events.clear();
+  while(hasNext_)
+  {
+    // Starting on a session, which runs until the next one begins
+    const bool isMatch = (next_.session == session);
+    const uint64_t startTime = next_.time;
+
+    while((hasNext_ = reader_.next(next_)) && !next_.isSession)
+    {
+      if(isMatch)
+      {
+        Event event;
+        event.offset = TIME_US_TO_MS(next_.time - startTime);
+        event.packet.swap(next_.packet);
+        events.push_back(event);
+      }
+    }
+
+    if(isMatch)
+    {
+      numSessions_++;
+      numEvents_ += events.size();
+      isInSession_ = true;
+      sessionStart_ = getMonoUS();
+      return true;
+    }
+
+    numSkipped_++;
+  }
+
+  isFinished_ = true;
+  return false;
+}
+
+void HCIReplay::finishSession()
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if(isInSession_)
+  {
+    sessionTimes_.push_back(getMonoUS() - sessionStart_);
+    isInSession_ = false;
+  }
+}
+
+size_t HCIReplay::getNumSessions() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return numSessions_;
+}
+
+size_t HCIReplay::getNumSkipped() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return numSkipped_;
+}
+
+size_t HCIReplay::getNumEvents() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return numEvents_;
+}
+
+vector<uint64_t> HCIReplay::getSessionTimes() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return sessionTimes_;
+}
@@ -0,0 +1,404 @@
+#include "KernelHCIBackend.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bluetooth/hci_lib.h"
+#include "bluetooth/l2cap.h"
+#include "bluetooth/rfcomm.h"
+
+#include "AndroidBluetooth.h"
+#include "BluetoothHCI.h"
+#include "Logger.h"
+#include "Timing.h"
+
+using namespace std;
+
+KernelHCIBackend::KernelHCIBackend(int adapterID)
+   : adapterID_(adapterID),
+     sock_(-1),
+     eventSock_(-1),
+     epoll_(-1)
+{
+}
+
+KernelHCIBackend::~KernelHCIBackend()
+{
+  closeEvents();
+  close();
+}
+
+int KernelHCIBackend::open()
+{
+  close();
+
+  sock_ = hci_open_dev(adapterID_);
+  return (sock_ < 0) ? -1 : 0;
+}
+
+void KernelHCIBackend::close()
+{
+  if(sock_ != -1)
+  {
+    hci_close_dev(sock_);
+    sock_ = -1;
+  }
+}
+
+int KernelHCIBackend::reset()
+{
+  if(sock_ == -1)
+  {
+    errno = EBADF;
+    return -1;
+  }
+
+  return ioctl(sock_, HCIDEVRESET, adapterID_);
+}
+
+void KernelHCIBackend::restart(const Address *publicAddress)
+{
+  close();
+
+  bt_disable(adapterID_);
+  if(publicAddress != NULL)
+  {
+    // TODO: NOT compatible across systems with different host byte orders
+    Address swappedAddress = publicAddress->swap();
+    system(("echo \"" + swappedAddress.toString() + "\" > `getprop ro.bt.bdaddr_path`").c_str());
+  }
+  while(true)
+  {
+    try
+    {
+      bt_enable(adapterID_);
+      break;
+    }
+    catch(BluetoothHCIException ex)
+    {
+      LOG_D("KernelHCIBackend", "Failed to enable adapter %d - %s", adapterID_, ex.what());
+      bt_disable(adapterID_);
+    }
+  }
+}
+
+int KernelHCIBackend::readDeviceInfo(struct hci_dev_info *info)
+{
+  return hci_devinfo(adapterID_, info);
+}
+
+int KernelHCIBackend::setScanEnable(uint8_t scanEnable)
+{
+  struct hci_dev_req request;
+  memset(&request, 0, sizeof(request));
+
+  request.dev_id  = adapterID_;
+  request.dev_opt = scanEnable;
+
+  return ioctl(sock_, HCISETSCAN, (unsigned long)&request);
+}
+
+int KernelHCIBackend::sendCommand(uint16_t opcode, const void *params, uint8_t length)
+{
+  return hci_send_cmd(sock_, cmd_opcode_ogf(opcode), cmd_opcode_ocf(opcode), length, (void *)params);
+}
+
+int KernelHCIBackend::sendRequest(struct hci_request *request, int timeout)
+{
+  return hci_send_req(sock_, request, timeout);
+}
+
+int KernelHCIBackend::inquiry(int periods, vector<inquiry_info> &responses)
+{
+  inquiry_info *rawResponses = new inquiry_info[255];
+  int numResponses = hci_inquiry(adapterID_, periods, 255, NULL, &rawResponses, IREQ_CACHE_FLUSH);
+  if(numResponses >= 0)
+  {
+    responses.assign(rawResponses, rawResponses + numResponses);
+  }
+
+  delete[] rawResponses;
+
+  return numResponses;
+}
+
+void KernelHCIBackend::openEvents(const struct hci_filter &filter)
+{
+  closeEvents();
+
+  eventSock_ = hci_open_dev(adapterID_);
+  if(eventSock_ < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  if(setsockopt(eventSock_, SOL_HCI, HCI_FILTER, &filter, sizeof(filter)) < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  epoll_ = epoll_create(1);
+  if(epoll_ < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = eventSock_;
+
+  if(epoll_ctl(epoll_, EPOLL_CTL_ADD, eventSock_, &event) < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+}
+
+void KernelHCIBackend::closeEvents()
+{
+  if(epoll_ != -1)
+  {
+    ::close(epoll_);
+    epoll_ = -1;
+  }
+
+  if(eventSock_ != -1)
+  {
+    hci_close_dev(eventSock_);
+    eventSock_ = -1;
+  }
+}
+
+size_t KernelHCIBackend::readEvents(int64_t timeout, uint8_t *buffer, size_t *lengths, size_t maxEvents)
+{
+  // Waiting out whatever remains of the timeout if interrupted by a signal
+  const uint64_t deadline = getMonoMS() + max<int64_t>(timeout, 0);
+  struct epoll_event event;
+  int numReady;
+  while((numReady = epoll_wait(epoll_, &event, 1, timeout)) < 0)
+  {
+    if(errno != EINTR)
+    {
+      LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+    }
+
+    if(timeout >= 0)
+    {
+      uint64_t curTime = getMonoMS();
+      timeout = (curTime < deadline) ? (deadline - curTime) : 0;
+    }
+  }
+
+  if(numReady == 0)
+  {
+    return 0;
+  }
+
+  // Draining everything that is already queued on the socket (up to the size
+  // of a batch), so that a burst of reports costs one wakeup
+  size_t numEvents = 0;
+  while(numEvents < maxEvents)
+  {
+    ssize_t length = ::recv(eventSock_, buffer + (numEvents * HCI_MAX_EVENT_SIZE), HCI_MAX_EVENT_SIZE, MSG_DONTWAIT);
+    if(length <= 0)
+    {
+      if((length < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+      {
+        LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+      }
+      break;
+    }
+
+    lengths[numEvents++] = length;
+  }
+
+  return numEvents;
+}
+
+size_t KernelHCIBackend::flushEvents()
+{
+  uint8_t buffer[HCI_MAX_EVENT_SIZE];
+
+  size_t numFlushed = 0;
+  while(::recv(eventSock_, buffer, HCI_MAX_EVENT_SIZE, MSG_DONTWAIT) > 0)
+  {
+    numFlushed++;
+  }
+
+  return numFlushed;
+}
+
+int KernelHCIBackend::startConnect(Transport transport, const Address &address, uint8_t port)
+{
+  int error;
+
+  int sockConn;
+  if(transport == Transport::RFCOMM)
+  {
+    sockConn = socket(AF_BLUETOOTH, SOCK_STREAM, BTPROTO_RFCOMM);
+  }
+  else
+  {
+    sockConn = socket(AF_BLUETOOTH, SOCK_SEQPACKET, BTPROTO_L2CAP);
+  }
+
+  if(sockConn < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  int flags = fcntl(sockConn, F_GETFL, 0);
+  if((error = fcntl(sockConn, F_SETFL, flags | O_NONBLOCK)) < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  if(transport == Transport::RFCOMM)
+  {
+    struct sockaddr_rc addr = { 0 };
+    addr.rc_family = AF_BLUETOOTH;
+    memcpy(addr.rc_bdaddr.b, address.toByteArray(), 6);
+    addr.rc_channel = port;
+
+    error = connect(sockConn, (struct sockaddr *)&addr, sizeof(addr));
+  }
+  else
+  {
+    struct sockaddr_l2 addr = { 0 };
+    addr.l2_family = AF_BLUETOOTH;
+    memcpy(addr.l2_bdaddr.b, address.toByteArray(), 6);
+    addr.l2_bdaddr_type = BDADDR_LE_RANDOM;
+    addr.l2_cid = htobs(0x0004);
+
+    error = connect(sockConn, (struct sockaddr *)&addr, sizeof(addr));
+  }
+
+  if((error < 0) && (errno != EINPROGRESS))
+  {
+    // EBUSY will occur when an incoming connection is already being handled
+    // (or another connection is being created), and so we can safely ignore
+    // it. We keep errno intact so that the caller can retry later.
+    if(errno != EBUSY)
+    {
+      LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+    }
+
+    ::close(sockConn);
+    errno = EBUSY;
+    return -1;
+  }
+
+  return sockConn;
+}
+
+int KernelHCIBackend::listen(Transport transport, uint8_t port)
+{
+  int error;
+
+  int sockListen;
+  if(transport == Transport::RFCOMM)
+  {
+    sockListen = socket(AF_BLUETOOTH, SOCK_STREAM, BTPROTO_RFCOMM);
+  }
+  else
+  {
+    sockListen = socket(AF_BLUETOOTH, SOCK_SEQPACKET, BTPROTO_L2CAP);
+  }
+
+  if(sockListen < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  // Listening on this adapter only (rather than all of them), so that radios
+  // on several adapters can each listen at once
+  bdaddr_t adapterAddress;
+  if((error = hci_devba(adapterID_, &adapterAddress)) < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  if(transport == Transport::RFCOMM)
+  {
+    struct sockaddr_rc addr = { 0 };
+    addr.rc_family = AF_BLUETOOTH;
+    addr.rc_bdaddr = adapterAddress;
+    addr.rc_channel = port;
+
+    error = bind(sockListen, (struct sockaddr *)&addr, sizeof(addr));
+  }
+  else
+  {
+    struct sockaddr_l2 addr = { 0 };
+    addr.l2_family = AF_BLUETOOTH;
+    addr.l2_bdaddr = adapterAddress;
+    addr.l2_bdaddr_type = BDADDR_LE_RANDOM;
+    addr.l2_cid = htobs(0x0004);
+
+    error = bind(sockListen, (struct sockaddr *)&addr, sizeof(addr));
+  }
+
+  if(error < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  if((error = ::listen(sockListen, 5)) < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  int flags = fcntl(sockListen, F_GETFL, 0);
+  if((error = fcntl(sockListen, F_SETFL, flags | O_NONBLOCK)) < 0)
+  {
+    LOG_E_BT_CRASH("KernelHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  return sockListen;
+}
+
+pair<int, Address> KernelHCIBackend::accept(Transport transport, int sockListen)
+{
+  struct pollfd pollDesc;
+  pollDesc.fd = sockListen;
+  pollDesc.events = POLLIN;
+
+  int error = poll(&pollDesc, 1, -1);
+  if(error <= 0)
+  {
+    return make_pair(-1, Address());
+  }
+
+  Address address;
+  int sockClient;
+  if(transport == Transport::RFCOMM)
+  {
+    struct sockaddr_rc addr;
+    socklen_t addrLength = sizeof(sockaddr_rc);
+    sockClient = ::accept(sockListen, (struct sockaddr *)&addr, &addrLength);
+    if(sockClient >= 0)
+    {
+      address = Address(6, addr.rc_bdaddr.b);
+    }
+  }
+  else
+  {
+    struct sockaddr_l2 addr;
+    socklen_t addrLength = sizeof(sockaddr_l2);
+    sockClient = ::accept(sockListen, (struct sockaddr *)&addr, &addrLength);
+    if(sockClient >= 0)
+    {
+      address = Address(6, addr.l2_bdaddr.b);
+    }
+  }
+
+  return make_pair(sockClient, address);
+}
@@ -1,8 +1,11 @@
 #include "Logger.h"
 
+#include <algorithm>
 #include <android/log.h>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <errno.h>
 #include <stdexcept>
 #include <string>
@@ -11,6 +14,18 @@ using namespace std;
 
 Logger *logger = new Logger();
 
+// The global logger is never destroyed, so anything still queued is written
+// out as the process exits
+static void flushAtExit()
+{
+  if(logger != NULL)
+  {
+    logger->flush();
+  }
+}
+
+static const int flushAtExitRegistered = atexit(&flushAtExit);
+
 const char *Logger::messageTypeStrings[] = { "E", "W", "D", "P" };
 
 const int Logger::androidMessageTypes[] = { ANDROID_LOG_ERROR, ANDROID_LOG_WARN, ANDROID_LOG_DEBUG, ANDROID_LOG_VERBOSE };
@@ -24,13 +39,195 @@ void setupSymlink(const string& filename)
 #endif
 }
 
+// A single printf conversion (following its '%'), as needed to pull its
+// argument off of a va_list and to format it again later on
+struct Conversion
+{
+  enum Length { None, Char, Short, Long, LongLong, Size, Max, PtrDiff, LongDouble };
+
+  const char *end; // Just past the conversion character
+  char type;
+  Length length;
+  int numStars; // Width and/or precision given as arguments
+};
+
+static void parseConversion(const char *spec, Conversion &conv)
+{
+  conv.numStars = 0;
+  conv.length = Conversion::None;
+
+  while((*spec != 0) && (strchr("-+ #0123456789.*", *spec) != NULL))
+  {
+    if(*spec == '*')
+    {
+      conv.numStars++;
+    }
+    spec++;
+  }
+
+  switch(*spec)
+  {
+  case 'h':
+    conv.length = (spec[1] == 'h') ? Conversion::Char : Conversion::Short;
+    spec += (spec[1] == 'h') ? 2 : 1;
+    break;
+  case 'l':
+    conv.length = (spec[1] == 'l') ? Conversion::LongLong : Conversion::Long;
+    spec += (spec[1] == 'l') ? 2 : 1;
+    break;
+  case 'z':
+    conv.length = Conversion::Size;
+    spec++;
+    break;
+  case 'j':
+    conv.length = Conversion::Max;
+    spec++;
+    break;
+  case 't':
+    conv.length = Conversion::PtrDiff;
+    spec++;
+    break;
+  case 'L':
+    conv.length = Conversion::LongDouble;
+    spec++;
+    break;
+  }
+
+  conv.type = *spec;
+  conv.end = (*spec != 0) ? spec + 1 : spec;
+}
+
+static bool putValue(uint8_t *&pos, const uint8_t *end, const void *value, size_t size)
+{
+  if((size_t)(end - pos) < size)
+  {
+    return false;
+  }
+
+  memcpy(pos, value, size);
+  pos += size;
+  return true;
+}
+
+static bool getValue(const uint8_t *&pos, const uint8_t *end, void *value, size_t size)
+{
+  if((size_t)(end - pos) < size)
+  {
+    return false;
+  }
+
+  memcpy(value, pos, size);
+  pos += size;
+  return true;
+}
+
+template<typename T>
+static void appendFormatted(string &dest, const char *spec, T value)
+{
+  char buffer[256];
+  int size = snprintf(buffer, sizeof(buffer), spec, value);
+  if(size < 0)
+  {
+    return;
+  }
+
+  if((size_t)size < sizeof(buffer))
+  {
+    dest.append(buffer, size);
+  }
+  else
+  {
+    vector<char> larger(size + 1);
+    snprintf(larger.data(), larger.size(), spec, value);
+    dest.append(larger.data(), size);
+  }
+}
+
+Logger::ThreadRing::ThreadRing()
+   : head(0),
+     tail(0),
+     numDropped(0),
+     numTruncated(0),
+     isRetired(false)
+{
+}
+
+bool Logger::ThreadRing::push(const Record &record, const uint8_t *args)
+{
+  size_t curHead = head.load(memory_order_relaxed);
+  size_t offset = curHead % RING_SIZE;
+  size_t available = RING_SIZE - (curHead - tail.load(memory_order_acquire));
+
+  // Skipping the rest of the ring when the record would not fit before its end
+  size_t skipped = 0;
+  if((RING_SIZE - offset) < record.size)
+  {
+    skipped = RING_SIZE - offset;
+    offset = 0;
+  }
+
+  if(available < (skipped + record.size))
+  {
+    return false;
+  }
+
+  if(skipped > 0)
+  {
+    // Records are aligned, so there is always room for the size here
+    uint32_t wrap = 0;
+    memcpy(data + (curHead % RING_SIZE), &wrap, sizeof(wrap));
+  }
+
+  memcpy(data + offset, &record, sizeof(Record));
+  memcpy(data + offset + sizeof(Record), args, record.argsSize);
+  head.store(curHead + skipped + record.size, memory_order_release);
+
+  return true;
+}
+
+bool Logger::ThreadRing::pop(vector<uint8_t> &dest)
+{
+  size_t curTail = tail.load(memory_order_relaxed);
+  size_t curHead = head.load(memory_order_acquire);
+
+  while(curTail != curHead)
+  {
+    size_t offset = curTail % RING_SIZE;
+
+    uint32_t size;
+    memcpy(&size, data + offset, sizeof(size));
+    if(size == 0)
+    {
+      curTail += RING_SIZE - offset;
+      continue;
+    }
+
+    dest.insert(dest.end(), data + offset, data + offset + size);
+    tail.store(curTail + size, memory_order_release);
+    return true;
+  }
+
+  tail.store(curTail, memory_order_release);
+  return false;
+}
+
+size_t Logger::ThreadRing::size() const
+{
+  return head.load(memory_order_relaxed) - tail.load(memory_order_relaxed);
+}
+
 Logger::Logger()
    : screenEnabled_(true),
      logcatEnabled_(false),
      fileEnabled_(false),
      fout_(NULL, &fclose),
-     initTime_(getTimeMS())
+     initTime_(getTimeMS()),
+     numFlushRequests_(0),
+     numFlushed_(0),
+     isWakeRequested_(false),
+     isStopping_(false)
 {
+  start();
 }
 
 Logger::Logger(const char *filename)
@@ -38,22 +235,58 @@ Logger::Logger(const char *filename)
      logcatEnabled_(false),
      fileEnabled_(true),
      fout_(fopen(filename, "w"), &fclose),
-     initTime_(getTimeMS())
+     initTime_(getTimeMS()),
+     numFlushRequests_(0),
+     numFlushed_(0),
+     isWakeRequested_(false),
+     isStopping_(false)
 {
+  start();
 }
 
-void Logger::setScreenEnabled(bool value)
+Logger::~Logger()
 {
-  if(screenEnabled_ && !value)
   {
-    fflush(stdout);
+    lock_guard<mutex> flushLock(flushMutex_);
+    isStopping_ = true;
   }
+  flushCondition_.notify_all();
+
+  if(flusher_.joinable())
+  {
+    flusher_.join();
+  }
+
+  pthread_key_delete(ringKey_);
+  for(auto it = rings_.begin(); it != rings_.end(); it++)
+  {
+    delete *it;
+  }
+}
 
+void Logger::start()
+{
+  pthread_key_create(&ringKey_, &Logger::retireRing);
+  batch_.reserve(RING_SIZE);
+  batchOffsets_.reserve(RING_SIZE / sizeof(Record));
+  flusher_ = thread(&Logger::runFlusher, this);
+}
+
+void Logger::setScreenEnabled(bool value)
+{
+  flush();
+
+  lock_guard<mutex> outputLock(outputMutex_);
   screenEnabled_ = value;
 }
 
 bool Logger::setFileEnabled(bool value, const char *filename)
 {
+  // Anything already queued goes to the previous file
+  flush();
+
+  lock_guard<mutex> outputLock(outputMutex_);
+
   if(fileEnabled_ && !value)
   {
     fclose(fout_.get());
@@ -75,31 +308,502 @@ bool Logger::setFileEnabled(bool value, const char *filename)
 
 void Logger::write(MessageType type, const char *tag, const char *format, ...)
 {
-  uint64_t timeDiff = getTimeMS() - initTime_;
+  ThreadRing *ring = getThreadRing();
 
-  va_list args;
-  va_start(args, format);
+  Record record;
+  record.time = getTimeMS() - initTime_;
+  record.type = type;
+  record.tag = tag;
+  record.format = format;
 
-  if(screenEnabled_)
+  uint8_t args[MAX_ARGS_SIZE];
+  va_list argList;
+  va_start(argList, format);
+  encodeArgs(record, args, argList);
+  va_end(argList);
+
+  // Keeping every record aligned within the ring
+  record.size = (sizeof(Record) + record.argsSize + (alignof(Record) - 1)) & ~(alignof(Record) - 1);
+
+  if(record.isTruncated)
   {
-    printf("[%" PRIu64 "] %s(%s) - ", timeDiff, tag, messageTypeStrings[type]);
-    vprintf(format, args);
-    printf("\n");
-    fflush(stdout);
+    ring->numTruncated.fetch_add(1, memory_order_relaxed);
+  }
+
+  if(type == MESSAGE_ERROR)
+  {
+    while(!ring->push(record, args))
+    {
+      flush();
+    }
+    flush();
+  }
+  else if(!ring->push(record, args))
+  {
+    ring->numDropped.fetch_add(1, memory_order_relaxed);
   }
+  else if((ring->size() >= (RING_SIZE / 2)) && !isWakeRequested_.load(memory_order_relaxed))
+  {
+    // Not waiting on the lock here, so the flusher may miss this and only
+    // wake up after the usual interval
+    isWakeRequested_.store(true, memory_order_relaxed);
+    flushCondition_.notify_one();
+  }
+}
 
-  if(logcatEnabled_)
+void Logger::flush()
+{
+  unique_lock<mutex> flushLock(flushMutex_);
+  if(isStopping_)
   {
-    __android_log_vprint(androidMessageTypes[type], tag, format, args);
+    return;
+  }
+
+  uint64_t flushRequest = ++numFlushRequests_;
+  flushCondition_.notify_all();
+  flushCondition_.wait(flushLock, [&]() { return isStopping_ || (numFlushed_ >= flushRequest); });
+}
+
+// The lock is only taken the first time a thread logs something, when it
+// exits, and by the flusher
+Logger::ThreadRing* Logger::getThreadRing()
+{
+  ThreadRing *ring = (ThreadRing *)pthread_getspecific(ringKey_);
+  if(ring == NULL)
+  {
+    ring = new ThreadRing();
+    pthread_setspecific(ringKey_, ring);
+
+    lock_guard<mutex> ringsLock(ringsMutex_);
+    rings_.push_back(ring);
+  }
+
+  return ring;
+}
+
+void Logger::retireRing(void *ring)
+{
+  ((ThreadRing *)ring)->isRetired.store(true, memory_order_release);
+}
+
+void Logger::runFlusher()
+{
+  unique_lock<mutex> flushLock(flushMutex_);
+  while(true)
+  {
+    flushCondition_.wait_for(flushLock, chrono::milliseconds((int64_t)FLUSH_INTERVAL), [&]()
+    {
+      return isStopping_ || (numFlushRequests_ > numFlushed_) || isWakeRequested_.load(memory_order_relaxed);
+    });
+
+    bool isStopping = isStopping_;
+    uint64_t flushRequest = numFlushRequests_;
+    isWakeRequested_.store(false, memory_order_relaxed);
+
+    flushLock.unlock();
+    writeBatch();
+    flushLock.lock();
+
+    numFlushed_ = flushRequest;
+    flushCondition_.notify_all();
+
+    if(isStopping)
+    {
+      break;
+    }
+  }
+}
+
+void Logger::writeBatch()
+{
+  uint64_t numDropped = 0;
+  uint64_t numTruncated = 0;
+
+  {
+    lock_guard<mutex> ringsLock(ringsMutex_);
+
+    auto it = rings_.begin();
+    while(it != rings_.end())
+    {
+      ThreadRing *ring = *it;
+      bool isRetired = ring->isRetired.load(memory_order_acquire);
+
+      size_t offset = batch_.size();
+      while(ring->pop(batch_))
+      {
+        batchOffsets_.push_back(offset);
+        offset = batch_.size();
+      }
+      numDropped += ring->numDropped.exchange(0, memory_order_relaxed);
+      numTruncated += ring->numTruncated.exchange(0, memory_order_relaxed);
+
+      if(isRetired)
+      {
+        delete ring;
+        it = rings_.erase(it);
+      }
+      else
+      {
+        it++;
+      }
+    }
+  }
+
+  if(batchOffsets_.empty() && (numDropped == 0) && (numTruncated == 0))
+  {
+    return;
+  }
+
+  // Interleaving the threads' messages, while keeping each thread's in order.
+  // Records are only ever appended at aligned offsets, so are read in place.
+  auto recordAt = [this](size_t offset) { return (const Record *)(batch_.data() + offset); };
+  stable_sort(batchOffsets_.begin(), batchOffsets_.end(), [&](size_t a, size_t b) { return recordAt(a)->time < recordAt(b)->time; });
+
+  lock_guard<mutex> outputLock(outputMutex_);
+
+  string text;
+  string message;
+  for(auto it = batchOffsets_.begin(); it != batchOffsets_.end(); it++)
+  {
+    const Record &record = *recordAt(*it);
+
+    message.clear();
+    formatRecord(record, (const uint8_t *)(&record + 1), message);
+
+    if(screenEnabled_ || fileEnabled_)
+    {
+      char prefix[64];
+      snprintf(prefix, sizeof(prefix), "[%" PRIu64 "] ", record.time);
+      text.append(prefix);
+      text.append(record.tag);
+      text.append("(");
+      text.append(messageTypeStrings[record.type]);
+      text.append(") - ");
+      text.append(message);
+      text.append("\n");
+    }
+
+    if(logcatEnabled_)
+    {
+      __android_log_write(androidMessageTypes[record.type], record.tag, message.c_str());
+    }
+  }
+  batch_.clear();
+  batchOffsets_.clear();
+
+  if(numDropped > 0)
+  {
+    char dropped[96];
+    snprintf(dropped, sizeof(dropped), "[%" PRIu64 "] Logger(W) - Dropped %" PRIu64 " messages\n", getTimeMS() - initTime_, numDropped);
+    text.append(dropped);
+  }
+
+  if(numTruncated > 0)
+  {
+    char truncated[96];
+    snprintf(truncated, sizeof(truncated), "[%" PRIu64 "] Logger(W) - Truncated %" PRIu64 " messages\n", getTimeMS() - initTime_, numTruncated);
+    text.append(truncated);
+  }
+
+  if(screenEnabled_)
+  {
+    fwrite(text.data(), 1, text.size(), stdout);
+    fflush(stdout);
   }
 
   if(fileEnabled_)
   {
-    fprintf(fout_.get(), "[%" PRIu64 "] %s(%s) - ", timeDiff, tag, messageTypeStrings[type]);
-    vfprintf(fout_.get(), format, args);
-    fprintf(fout_.get(), "\n");
+    fwrite(text.data(), 1, text.size(), fout_.get());
     fflush(fout_.get());
   }
+}
+
+// Pulls each argument off according to the format, with integers and
+// pointers stored as 8 bytes, floating point values as doubles, and strings
+// copied in. Stops at the first argument that does not fit (keeping as much
+// of a string as does), or at an unknown conversion, marking the record as
+// truncated.
+void Logger::encodeArgs(Record &record, uint8_t *args, va_list argList)
+{
+  uint8_t *pos = args;
+  const uint8_t *end = args + MAX_ARGS_SIZE;
+  bool fits = true;
+
+  for(const char *f = record.format; fits && (*f != 0); f++)
+  {
+    if((*f != '%') || (*(++f) == '%'))
+    {
+      continue;
+    }
+
+    Conversion conv;
+    parseConversion(f, conv);
+
+    for(int s = 0; fits && (s < conv.numStars); s++)
+    {
+      int64_t star = va_arg(argList, int);
+      fits = putValue(pos, end, &star, sizeof(star));
+    }
+
+    if(!fits)
+    {
+      break;
+    }
+
+    switch(conv.type)
+    {
+    case 'd':
+    case 'i':
+    {
+      int64_t value;
+      switch(conv.length)
+      {
+      case Conversion::Long: value = va_arg(argList, long); break;
+      case Conversion::LongLong: value = va_arg(argList, long long); break;
+      case Conversion::Size: value = va_arg(argList, ssize_t); break;
+      case Conversion::Max: value = va_arg(argList, intmax_t); break;
+      case Conversion::PtrDiff: value = va_arg(argList, ptrdiff_t); break;
+      default: value = va_arg(argList, int); break;
+      }
+      fits = putValue(pos, end, &value, sizeof(value));
+      break;
+    }
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    {
+      uint64_t value;
+      switch(conv.length)
+      {
+      case Conversion::Long: value = va_arg(argList, unsigned long); break;
+      case Conversion::LongLong: value = va_arg(argList, unsigned long long); break;
+      case Conversion::Size: value = va_arg(argList, size_t); break;
+      case Conversion::Max: value = va_arg(argList, uintmax_t); break;
+      case Conversion::PtrDiff: value = va_arg(argList, ptrdiff_t); break;
+      default: value = va_arg(argList, unsigned int); break;
+      }
+      fits = putValue(pos, end, &value, sizeof(value));
+      break;
+    }
+    case 'c':
+    {
+      int64_t value = va_arg(argList, int);
+      fits = putValue(pos, end, &value, sizeof(value));
+      break;
+    }
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+    {
+      double value = (conv.length == Conversion::LongDouble) ? (double)va_arg(argList, long double) : va_arg(argList, double);
+      fits = putValue(pos, end, &value, sizeof(value));
+      break;
+    }
+    case 'p':
+    {
+      uint64_t value = (uintptr_t)va_arg(argList, void *);
+      fits = putValue(pos, end, &value, sizeof(value));
+      break;
+    }
+    case 's':
+    {
+      const char *value = va_arg(argList, const char *);
+      if(value == NULL)
+      {
+        value = "(null)";
+      }
+
+      size_t available = end - pos;
+      if(available > 0)
+      {
+        size_t length = strlen(value);
+        fits = (length < available);
+        length = min(length, available - 1);
+        memcpy(pos, value, length);
+        pos[length] = 0;
+        pos += length + 1;
+      }
+      else
+      {
+        fits = false;
+      }
+      break;
+    }
+    case 'n':
+      va_arg(argList, void *);
+      break;
+    default:
+      fits = false;
+      break;
+    }
+
+    f = conv.end - 1;
+  }
+
+  record.argsSize = pos - args;
+  record.isTruncated = !fits;
+}
+
+// Formats each conversion on its own, with the same specification as in the
+// original format (apart from any '*', which is replaced by its value)
+void Logger::formatRecord(const Record &record, const uint8_t *args, string &dest)
+{
+  const uint8_t *pos = args;
+  const uint8_t *end = args + record.argsSize;
+
+  const char *f = record.format;
+  while(*f != 0)
+  {
+    const char *literalEnd = strchr(f, '%');
+    if(literalEnd == NULL)
+    {
+      dest.append(f);
+      break;
+    }
+
+    dest.append(f, literalEnd - f);
+    f = literalEnd + 1;
+
+    if(*f == '%')
+    {
+      dest.push_back('%');
+      f++;
+      continue;
+    }
+
+    Conversion conv;
+    parseConversion(f, conv);
+
+    char spec[32];
+    size_t specSize = 0;
+    spec[specSize++] = '%';
+
+    bool isAvailable = true;
+    for(const char *c = f; isAvailable && (c < conv.end) && (specSize < (sizeof(spec) - 12)); c++)
+    {
+      if(*c == '*')
+      {
+        int64_t star;
+        isAvailable = getValue(pos, end, &star, sizeof(star));
+        specSize += snprintf(spec + specSize, sizeof(spec) - specSize, "%d", (int)star);
+      }
+      else
+      {
+        spec[specSize++] = *c;
+      }
+    }
+    spec[specSize] = 0;
+    f = conv.end;
+
+    if(isAvailable)
+    {
+      switch(conv.type)
+      {
+      case 'd':
+      case 'i':
+      case 'c':
+      {
+        int64_t value;
+        if((isAvailable = getValue(pos, end, &value, sizeof(value))))
+        {
+          switch(conv.length)
+          {
+          case Conversion::Long: appendFormatted(dest, spec, (long)value); break;
+          case Conversion::LongLong: appendFormatted(dest, spec, (long long)value); break;
+          case Conversion::Size: appendFormatted(dest, spec, (ssize_t)value); break;
+          case Conversion::Max: appendFormatted(dest, spec, (intmax_t)value); break;
+          case Conversion::PtrDiff: appendFormatted(dest, spec, (ptrdiff_t)value); break;
+          default: appendFormatted(dest, spec, (int)value); break;
+          }
+        }
+        break;
+      }
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      {
+        uint64_t value;
+        if((isAvailable = getValue(pos, end, &value, sizeof(value))))
+        {
+          switch(conv.length)
+          {
+          case Conversion::Long: appendFormatted(dest, spec, (unsigned long)value); break;
+          case Conversion::LongLong: appendFormatted(dest, spec, (unsigned long long)value); break;
+          case Conversion::Size: appendFormatted(dest, spec, (size_t)value); break;
+          case Conversion::Max: appendFormatted(dest, spec, (uintmax_t)value); break;
+          case Conversion::PtrDiff: appendFormatted(dest, spec, (ptrdiff_t)value); break;
+          default: appendFormatted(dest, spec, (unsigned int)value); break;
+          }
+        }
+        break;
+      }
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+      {
+        double value;
+        if((isAvailable = getValue(pos, end, &value, sizeof(value))))
+        {
+          if(conv.length == Conversion::LongDouble)
+          {
+            appendFormatted(dest, spec, (long double)value);
+          }
+          else
+          {
+            appendFormatted(dest, spec, value);
+          }
+        }
+        break;
+      }
+      case 'p':
+      {
+        uint64_t value;
+        if((isAvailable = getValue(pos, end, &value, sizeof(value))))
+        {
+          appendFormatted(dest, spec, (void *)(uintptr_t)value);
+        }
+        break;
+      }
+      case 's':
+      {
+        const char *value = (const char *)pos;
+        const uint8_t *terminator = (const uint8_t *)memchr(pos, 0, end - pos);
+        if((isAvailable = (terminator != NULL)))
+        {
+          appendFormatted(dest, spec, value);
+          pos = terminator + 1;
+        }
+        break;
+      }
+      case 'n':
+        break;
+      default:
+        isAvailable = false;
+        break;
+      }
+    }
+
+    // Everything from the first argument that did not fit is left out
+    if(!isAvailable)
+    {
+      break;
+    }
+  }
 
-  va_end(args);
+  if(record.isTruncated)
+  {
+    dest.append("... [truncated]");
+  }
 }
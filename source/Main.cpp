@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
 #include <cutils/properties.h>
@@ -7,9 +8,12 @@
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <mutex>
 #include <optionparser/optionparser.h>
 #include <sstream>
 #include <stdexcept>
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <stdexcept>
@@ -17,7 +21,10 @@
 #include <unistd.h>
 
 #include "AndroidWake.h"
+#include "CaptureHCIBackend.h"
 #include "Config.h"
+#include "CrowdGenerator.h"
+#include "DHDecodeBench.h"
 #include "EbNController.h"
 #include "EbNHystPolicy.h"
 #include "EbNRadioBT2.h"
@@ -25,9 +32,22 @@
 #include "EbNRadioBT2PSI.h"
 #include "EbNRadioBT4.h"
 #include "EbNRadioBT4AR.h"
+#include "EbNRadioBT5.h"
+#include "GF256.h"
+#include "HCICapture.h"
+#include "HCIReplay.h"
+#include "KernelHCIBackend.h"
 #include "Logger.h"
+#include "Metrics.h"
+#include "RecognitionBench.h"
+#include "RSDecodingCache.h"
+#include "RSErasureDecoder.h"
+#include "RSErasureEncoder.h"
 #include "SipHash.h"
 #include "Timing.h"
+#include "VirtualClock.h"
+#include "VirtualHCIBackend.h"
+#include "VirtualMedium.h"
 
 #include "ebncore.pb.h"
 
@@ -104,14 +124,12 @@ bool recvAll(int sock, uint8_t *dest, size_t size)
   return success;
 }
 
-void requestSleep(int clientSock, uint64_t duration)
-{
-  EbNCore::Event_SleepEvent *sleepEvent = new EbNCore::Event_SleepEvent();
-  sleepEvent->set_duration(duration);
-
-  EbNCore::Event event;
-  event.set_allocated_sleepevent(sleepEvent);
+// Events are sent from both the controller thread (sleeps, encounters) and
+// the message loop (metrics), so each message is written out whole
+mutex sendMutex;
 
+bool sendEvent(int clientSock, const EbNCore::Event &event)
+{
   vector<uint8_t> message(4 + event.ByteSize());
   ArrayOutputStream messageArrayOutput(message.data(), message.size());
   CodedOutputStream messageOutput(&messageArrayOutput);
@@ -121,7 +139,19 @@ void requestSleep(int clientSock, uint64_t duration)
 
   event.SerializeToCodedStream(&messageOutput);
 
-  sendAll(clientSock, message.data(), message.size());
+  lock_guard<mutex> sendLock(sendMutex);
+  return sendAll(clientSock, message.data(), message.size());
+}
+
+void requestSleep(int clientSock, uint64_t duration)
+{
+  EbNCore::Event_SleepEvent *sleepEvent = new EbNCore::Event_SleepEvent();
+  sleepEvent->set_duration(duration);
+
+  EbNCore::Event event;
+  event.set_allocated_sleepevent(sleepEvent);
+
+  sendEvent(clientSock, event);
 
   sleepMS(duration);
 }
@@ -180,19 +210,72 @@ void notifyEncounter(int clientSock, const EncounterEvent &event)
     encounterEvent->add_sharedsecrets(it->value.get(), it->value.size());
   }
 
+  // Only the stages that were reached, and only once the encounter has ended
+  if(event.type == EncounterEvent::Ended)
+  {
+    for(int s = 0; s < RecognitionLatency::NUM_STAGES; s++)
+    {
+      const RecognitionLatency::Milestone &milestone = event.latency.milestones[s];
+      if(milestone.reached)
+      {
+        EbNCore::Event_EncounterEvent_Milestone *milestoneEvent = encounterEvent->add_milestones();
+        milestoneEvent->set_stage((EbNCore::Event_EncounterEvent_Milestone_StageType)s);
+        milestoneEvent->set_time(milestone.time);
+        milestoneEvent->set_numadverts(milestone.numAdverts);
+      }
+    }
+  }
+
   EbNCore::Event fullEvent;
   fullEvent.set_allocated_encounterevent(encounterEvent);
 
-  vector<uint8_t> message(4 + fullEvent.ByteSize());
-  ArrayOutputStream messageArrayOutput(message.data(), message.size());
-  CodedOutputStream messageOutput(&messageArrayOutput);
+  sendEvent(clientSock, fullEvent);
+}
 
-  uint32_t messageSize = htole32(fullEvent.ByteSize());
-  messageOutput.WriteRaw((uint8_t *)&messageSize, 4);
+void sendMetrics(int clientSock)
+{
+  Metrics::Snapshot snapshot = Metrics::getSnapshot();
+
+  EbNCore::Event_MetricsEvent *metricsEvent = new EbNCore::Event_MetricsEvent();
+  metricsEvent->set_time(snapshot.time);
 
-  fullEvent.SerializeToCodedStream(&messageOutput);
+  for(int c = 0; c < Metrics::Counter::END; c++)
+  {
+    EbNCore::Event_MetricsEvent_Counter *counter = metricsEvent->add_counters();
+    counter->set_name(Metrics::counterStrings[c]);
+    counter->set_value(snapshot.counters[c]);
+  }
+
+  for(int h = 0; h < Metrics::Histogram::END; h++)
+  {
+    const Metrics::HistogramSnapshot &histogramSnapshot = snapshot.histograms[h];
+
+    EbNCore::Event_MetricsEvent_Histogram *histogram = metricsEvent->add_histograms();
+    histogram->set_name(Metrics::histogramStrings[h]);
+    histogram->set_count(histogramSnapshot.count);
+    histogram->set_sum(histogramSnapshot.sum);
+    histogram->set_min(histogramSnapshot.min);
+    histogram->set_max(histogramSnapshot.max);
+    histogram->set_p50(histogramSnapshot.getPercentile(50));
+    histogram->set_p90(histogramSnapshot.getPercentile(90));
+    histogram->set_p99(histogramSnapshot.getPercentile(99));
+
+    // Only the non-empty buckets, since most of them are
+    for(size_t b = 0; b < histogramSnapshot.buckets.size(); b++)
+    {
+      if(histogramSnapshot.buckets[b] > 0)
+      {
+        EbNCore::Event_MetricsEvent_Histogram_Bucket *bucket = histogram->add_buckets();
+        bucket->set_lowerbound(Metrics::getBucketValue(b));
+        bucket->set_count(histogramSnapshot.buckets[b]);
+      }
+    }
+  }
 
-  sendAll(clientSock, message.data(), message.size());
+  EbNCore::Event event;
+  event.set_allocated_metricsevent(metricsEvent);
+
+  sendEvent(clientSock, event);
 }
 
 struct Arg: public option::Arg
@@ -277,6 +360,25 @@ struct Arg: public option::Arg
     return option::ARG_ILLEGAL;
   }
 
+  static option::ArgStatus Decimal(const option::Option &opt, bool msg)
+  {
+    char *end = NULL;
+    if(opt.arg != 0)
+    {
+      strtod(opt.arg, &end);
+    }
+    if((end != opt.arg) && (*end == 0))
+    {
+      return option::ARG_OK;
+    }
+
+    if(msg)
+    {
+      LOG_E("Options", "Option %s requires a decimal argument.\n", opt.name);
+    }
+    return option::ARG_ILLEGAL;
+  }
+
   static option::ArgStatus Unknown(const option::Option& opt, bool msg)
   {
     if(msg)
@@ -287,18 +389,21 @@ struct Arg: public option::Arg
   }
 };
 
-enum optionIndex { UNKNOWN, HELP, RADIO, CONFIRM, BENCH, CHURN, PSICMP };
+enum optionIndex { UNKNOWN, HELP, RADIO, CONFIRM, ADAPTERS, BENCH, CHURN, PSICMP, RSCMP, DHSIM, RECOGNIZE, SIMULATE, SIMRANGE, SIMLOSS, SIMTIME, SIMSEED, SIMREALTIME, CAPTURE, REPLAY, CROWD, CROWDOVERLAP, CROWDCYCLES };
 const option::Descriptor usage[] =
 {
   {UNKNOWN, 0,  "",        "", Arg::Unknown,  "USAGE: sddr [options]\n\nOptions:\n"},
   {HELP,    0, "h",    "help", Arg::None,     " --help     (-h)  Print this help information.\n"},
-  {RADIO,   0, "r",   "radio", Arg::Radio,    " --radio    (-r)  Radio version to use: BT2, BT2NR, BT2PSI, BT4, BT4AR.\n"
+  {RADIO,   0, "r",   "radio", Arg::Radio,    " --radio    (-r)  Radio version to use: BT2, BT2NR, BT2PSI, BT4, BT4AR, BT4RL,\n"
+                                              "                  BT5.\n"
                                               "                  The default is 'BT2'.\n"},
   {CONFIRM, 0, "c", "confirm", Arg::Confirm,  " --confirm  (-c)  Confirmation scheme to use: None, Passive, Active, Hybrid.\n"
                                               "                  The default is 'None' for most radios; however, BT2PSI only\n"
                                               "                  supports 'Active' due to using connection-oriented protocol,\n"
                                               "                  and BT4AR only supports 'None' as it does not generate\n"
                                               "                  shared secrets.\n"},
+  {ADAPTERS, 0, "a", "adapters", Arg::Numeric, " --adapters=# (-a) Number of Bluetooth adapters to run radios on at once,\n"
+                                              "                  using adapters 0 through #-1. The default is 1.\n"},
   {BENCH,   0, "b",   "bench", Arg::Numeric,  " --bench=#  (-b)  Benchmarking mode for generating results, specifying a number\n"
                                               "                  of random entries to create in the advertised/listen sets. In\n"
                                               "                  addition, the client runs without a higher-level application\n"
@@ -309,29 +414,109 @@ const option::Descriptor usage[] =
   {PSICMP,  0,  "",  "psicmp", Arg::Numeric,  " --psicmp=# (  )  Specific benchmarking mode to compare the device recognition\n"
                                               "                  portion of the protocol to standard PSI implementations. Only\n"
                                               "                  available in benchmarking mode, and only for 'BT2' radio. The\n"
-                                              "                  value corresponds to how many advertisements to process."},
+                                              "                  value corresponds to how many advertisements to process.\n"},
+  {RSCMP,   0,  "",   "rscmp", Arg::Numeric,  " --rscmp=#  (  )  Specific benchmarking mode to compare the erasure coding\n"
+                                              "                  backends used to distribute the DH public value. Only\n"
+                                              "                  available in benchmarking mode, and only for 'BT4' radio. The\n"
+                                              "                  value corresponds to how many encodes/decodes to perform.\n"},
+  {DHSIM,   0,  "",   "dhsim", Arg::Numeric,  " --dhsim=#  (  )  Specific benchmarking mode to simulate the time taken to decode\n"
+                                              "                  the DH public value under advert loss, comparing the 'BT4' and\n"
+                                              "                  'BT4RL' advert formats. The value corresponds to how many\n"
+                                              "                  listeners to simulate for each loss rate.\n"},
+  {RECOGNIZE, 0, "", "recognize", Arg::Numeric, " --recognize=# (  ) Specific benchmarking mode to compare how the radios\n"
+                                              "                  recognize a device offline, from the adverts of a single\n"
+                                              "                  sender, reporting the processing time and number of adverts\n"
+                                              "                  needed. Sweeps the set sizes in powers of 4 up to the\n"
+                                              "                  benchmarking set size, and a range of advert loss rates. Runs\n"
+                                              "                  every radio other than 'BT2PSI', unless --radio is given.\n"
+                                              "                  The value corresponds to how many trials to run for each.\n"},
+  {SIMULATE, 0, "s", "simulate", Arg::Numeric, " --simulate=# (-s) Specific benchmarking mode to run # devices at once in this\n"
+                                              "                  process, each with its own controller and radio on a\n"
+                                              "                  simulated adapter, sharing a virtual medium in place of\n"
+                                              "                  Bluetooth hardware. CPU and memory usage is reported\n"
+                                              "                  periodically. Unless --sim-realtime is given, time runs\n"
+                                              "                  on a virtual clock, skipping over the idle time between\n"
+                                              "                  actions.\n"},
+  {SIMRANGE, 0, "", "sim-range", Arg::Decimal, " --sim-range=# (  ) Range (in m) of the simulated radios, which are placed at\n"
+                                              "                  random in a 30 m square. The default is 20.\n"},
+  {SIMLOSS, 0,  "",  "sim-loss", Arg::Decimal, " --sim-loss=# (  ) Probability of losing each simulated packet. The default is\n"
+                                              "                  0.1.\n"},
+  {SIMTIME, 0,  "",  "sim-time", Arg::Numeric, " --sim-time=# (  ) Minutes to run the simulation for. The default is 10.\n"},
+  {SIMSEED, 0,  "",  "sim-seed", Arg::Numeric, " --sim-seed=# (  ) Seed for the placement, loss and schedule of the simulated\n"
+                                              "                  devices, so that a run can be repeated. The default is a\n"
+                                              "                  random seed.\n"},
+  {SIMREALTIME, 0, "", "sim-realtime", Arg::None, " --sim-realtime (  ) Run the simulation against the system clock, rather than\n"
+                                              "                  skipping ahead to the next scheduled action on a virtual\n"
+                                              "                  clock.\n"},
+  {CAPTURE, 0,  "", "capture", Arg::NonEmpty, " --capture=<file> (  ) Record the advertising reports and inquiry results seen\n"
+                                              "                  by each adapter to a capture file (with adapters other than\n"
+                                              "                  0 writing to <file>.<adapter>), for use with --replay.\n"
+                                              "                  With --crowd, records what the listener sees instead.\n"},
+  {REPLAY,  0,  "",  "replay", Arg::NonEmpty, " --replay=<file> (  ) Specific benchmarking mode to replay a capture through the\n"
+                                              "                  radio and controller as fast as it can be processed, on a\n"
+                                              "                  simulated adapter. The capture should come from the same\n"
+                                              "                  radio version, since sessions from other kinds of scan are\n"
+                                              "                  skipped.\n"},
+  {CROWD,   0,  "",   "crowd", Arg::Numeric,  " --crowd=#  (  )  Specific benchmarking mode to discover a synthetic crowd of #\n"
+                                              "                  peers, all within range on a virtual medium, reporting the\n"
+                                              "                  processing time of each discovery. Each peer has its own\n"
+                                              "                  keys and epoch phase, advertising as many entries as the\n"
+                                              "                  listen set. Only for 'BT2', 'BT2NR', 'BT4' and 'BT4RL'.\n"},
+  {CROWDOVERLAP, 0, "", "crowd-overlap", Arg::Decimal, " --crowd-overlap=# (  ) Probability of each entry advertised by a peer being\n"
+                                              "                  taken from the listen set. The default is 0.01.\n"},
+  {CROWDCYCLES, 0, "", "crowd-cycles", Arg::Numeric, " --crowd-cycles=# (  ) Number of discoveries to run against the crowd. The\n"
+                                              "                  default is 100."},
   {0, 0, 0, 0, 0, 0}
 };
 
-shared_ptr<EbNRadio> setupRadio(Config config)
+EbNRadio::ConfirmScheme getDefaultConfirmScheme(EbNRadio::Version version)
+{
+  switch(version)
+  {
+  case EbNRadio::Version::Bluetooth2:
+    return EbNRadioBT2::getDefaultConfirmScheme();
+  case EbNRadio::Version::Bluetooth2NR:
+    return EbNRadioBT2NR::getDefaultConfirmScheme();
+  case EbNRadio::Version::Bluetooth2PSI:
+    return EbNRadioBT2PSI::getDefaultConfirmScheme();
+  case EbNRadio::Version::Bluetooth4:
+    return EbNRadioBT4::getDefaultConfirmScheme();
+  case EbNRadio::Version::Bluetooth4AR:
+    return EbNRadioBT4AR::getDefaultConfirmScheme();
+  case EbNRadio::Version::Bluetooth4RL:
+    return EbNRadioBT4::getDefaultConfirmScheme();
+  case EbNRadio::Version::Bluetooth5:
+    return EbNRadioBT5::getDefaultConfirmScheme();
+  }
+
+  throw runtime_error("Invalid radio version");
+}
+
+shared_ptr<EbNRadio> setupRadio(Config config, int adapterID = 0)
 {
   shared_ptr<EbNRadio> radio;
   switch(config.radio.version)
   {
   case EbNRadio::Version::Bluetooth2:
-    radio.reset(new EbNRadioBT2(config.radio.keySize, config.radio.confirm, config.radio.memory, 0));
+    radio.reset(new EbNRadioBT2(config.radio.keySize, config.radio.confirm, config.radio.memory, adapterID));
     break;
   case EbNRadio::Version::Bluetooth2NR:
-    radio.reset(new EbNRadioBT2NR(config.radio.keySize, config.radio.confirm, config.radio.memory, 0));
+    radio.reset(new EbNRadioBT2NR(config.radio.keySize, config.radio.confirm, config.radio.memory, adapterID));
     break;
   case EbNRadio::Version::Bluetooth2PSI:
-    radio.reset(new EbNRadioBT2PSI(config.radio.keySize, config.radio.confirm, config.radio.memory, 0));
+    radio.reset(new EbNRadioBT2PSI(config.radio.keySize, config.radio.confirm, config.radio.memory, adapterID));
     break;
   case EbNRadio::Version::Bluetooth4:
-    radio.reset(new EbNRadioBT4(config.radio.keySize, config.radio.confirm, config.radio.memory, 0));
+    radio.reset(new EbNRadioBT4(config.radio.keySize, config.radio.confirm, config.radio.memory, adapterID));
     break;
   case EbNRadio::Version::Bluetooth4AR:
-    radio.reset(new EbNRadioBT4AR(config.radio.keySize, config.radio.confirm, config.radio.memory, 0));
+    radio.reset(new EbNRadioBT4AR(config.radio.keySize, config.radio.confirm, config.radio.memory, adapterID));
+    break;
+  case EbNRadio::Version::Bluetooth4RL:
+    radio.reset(new EbNRadioBT4(config.radio.keySize, config.radio.confirm, config.radio.memory, adapterID, true));
+    break;
+  case EbNRadio::Version::Bluetooth5:
+    radio.reset(new EbNRadioBT5(config.radio.keySize, config.radio.confirm, config.radio.memory, adapterID));
     break;
   }
 
@@ -340,12 +525,17 @@ shared_ptr<EbNRadio> setupRadio(Config config)
 
 unique_ptr<EbNController> setupController(Config config)
 {
-  shared_ptr<EbNRadio> radio = setupRadio(config);
+  // One radio per adapter, all driven by the same controller
+  vector<shared_ptr<EbNRadio> > radios;
+  for(size_t a = 0; a < config.radio.numAdapters; a++)
+  {
+    radios.push_back(setupRadio(config, a));
+  }
 
   EbNHystPolicy hystPolicy (config.hyst.scheme, config.hyst.minStartTime, config.hyst.maxStartTime,
                             config.hyst.startSeen, config.hyst.endTime, config.hyst.rssiThreshold);
 
-  return unique_ptr<EbNController>(new EbNController(radio, hystPolicy, config.reporting.rssiInterval));
+  return unique_ptr<EbNController>(new EbNController(radios, hystPolicy, config.reporting.rssiInterval));
 }
 
 int main(int argc, char **argv)
@@ -377,6 +567,55 @@ int main(int argc, char **argv)
       return 1;
     }
 
+    if(options[RSCMP] && !options[BENCH])
+    {
+      LOG_E("Options", "Option --rscmp requires benchmarking mode (--bench or -b).");
+      option::printUsage(cout, usage);
+      return 1;
+    }
+
+    if(options[DHSIM] && !options[BENCH])
+    {
+      LOG_E("Options", "Option --dhsim requires benchmarking mode (--bench or -b).");
+      option::printUsage(cout, usage);
+      return 1;
+    }
+
+    if(options[RECOGNIZE] && !options[BENCH])
+    {
+      LOG_E("Options", "Option --recognize requires benchmarking mode (--bench or -b).");
+      option::printUsage(cout, usage);
+      return 1;
+    }
+
+    if(options[SIMULATE] && !options[BENCH])
+    {
+      LOG_E("Options", "Option --simulate requires benchmarking mode (--bench or -b).");
+      option::printUsage(cout, usage);
+      return 1;
+    }
+
+    if(options[REPLAY] && !options[BENCH])
+    {
+      LOG_E("Options", "Option --replay requires benchmarking mode (--bench or -b).");
+      option::printUsage(cout, usage);
+      return 1;
+    }
+
+    if(options[CROWD] && !options[BENCH])
+    {
+      LOG_E("Options", "Option --crowd requires benchmarking mode (--bench or -b).");
+      option::printUsage(cout, usage);
+      return 1;
+    }
+
+    if(options[CAPTURE] && (options[SIMULATE] || options[REPLAY]))
+    {
+      LOG_E("Options", "Option --capture requires real adapters, and so cannot be used with --simulate or --replay.");
+      option::printUsage(cout, usage);
+      return 1;
+    }
+
     // Merging specified command line parameters with the default options
     Config config = configDefaults;
     if(options[RADIO])
@@ -389,24 +628,54 @@ int main(int argc, char **argv)
     }
     else
     {
-      switch(config.radio.version)
+      config.radio.confirm = getDefaultConfirmScheme(config.radio.version);
+    }
+
+    if(options[ADAPTERS])
+    {
+      long numAdapters = strtol(options[ADAPTERS].arg, NULL, 10);
+      if(numAdapters < 1)
       {
-      case EbNRadio::Version::Bluetooth2:
-        config.radio.confirm = EbNRadioBT2::getDefaultConfirmScheme();
-        break;
-      case EbNRadio::Version::Bluetooth2NR:
-        config.radio.confirm = EbNRadioBT2NR::getDefaultConfirmScheme();
-        break;
-      case EbNRadio::Version::Bluetooth2PSI:
-        config.radio.confirm = EbNRadioBT2PSI::getDefaultConfirmScheme();
-        break;
-      case EbNRadio::Version::Bluetooth4:
-        config.radio.confirm = EbNRadioBT4::getDefaultConfirmScheme();
-        break;
-      case EbNRadio::Version::Bluetooth4AR:
-        config.radio.confirm = EbNRadioBT4AR::getDefaultConfirmScheme();
-        break;
+        LOG_E("Options", "Option --adapters requires at least one adapter.");
+        return 1;
       }
+      config.radio.numAdapters = numAdapters;
+    }
+
+    if(options[SIMULATE])
+    {
+      long numDevices = strtol(options[SIMULATE].arg, NULL, 10);
+      if(numDevices < 2)
+      {
+        LOG_E("Options", "Option --simulate requires at least two devices.");
+        return 1;
+      }
+      config.simulation.numDevices = numDevices;
+      config.radio.numAdapters = 1;
+    }
+    if(options[SIMRANGE])
+    {
+      config.simulation.range = strtod(options[SIMRANGE].arg, NULL);
+    }
+    if(options[SIMLOSS])
+    {
+      config.simulation.lossRate = strtod(options[SIMLOSS].arg, NULL);
+    }
+    if(options[SIMTIME])
+    {
+      config.simulation.duration = TIME_MIN_TO_MS(strtol(options[SIMTIME].arg, NULL, 10));
+    }
+    if(options[SIMSEED])
+    {
+      config.simulation.seed = strtoul(options[SIMSEED].arg, NULL, 10);
+    }
+    if(options[SIMREALTIME])
+    {
+      config.simulation.isRealTime = true;
+    }
+    if(options[REPLAY] || options[CROWD])
+    {
+      config.radio.numAdapters = 1;
     }
 
     // Used for benchmarking, acting is if there is 100% churn rate in the set
@@ -421,6 +690,31 @@ int main(int argc, char **argv)
 
     config.dump();
 
+    // Recording what each adapter discovers, where the writers are kept for
+    // the whole run so that each controller that is set up adds to the same
+    // capture. A crowd sets up its own capture of the listener.
+    if(options[CAPTURE] && !options[CROWD])
+    {
+      string path = options[CAPTURE].arg;
+      shared_ptr<map<int, shared_ptr<HCICaptureWriter> > > captures(new map<int, shared_ptr<HCICaptureWriter> >());
+      HCIBackend::setFactory([path, captures](int adapterID)
+      {
+        shared_ptr<HCICaptureWriter> &capture = (*captures)[adapterID];
+        if(!capture)
+        {
+          stringstream adapterPath;
+          adapterPath << path;
+          if(adapterID != 0)
+          {
+            adapterPath << "." << adapterID;
+          }
+          capture = shared_ptr<HCICaptureWriter>(new HCICaptureWriter(adapterPath.str()));
+        }
+
+        return shared_ptr<HCIBackend>(new CaptureHCIBackend(shared_ptr<HCIBackend>(new KernelHCIBackend(adapterID)), capture));
+      });
+    }
+
     // Running in benchmarking mode, without being connected to a
     // higher-level application for control and encounter event reports
     if(options[BENCH])
@@ -494,6 +788,492 @@ int main(int argc, char **argv)
         }
         }
       }
+      // Running for comparing the erasure coding backends on the parameters
+      // used by the BT4 radio for distributing the DH public value
+      else if(options[RSCMP])
+      {
+        if(config.radio.version != EbNRadio::Version::Bluetooth4)
+        {
+          throw std::runtime_error("RS comparison is only supported for the 'Bluetooth4' radio.");
+        }
+
+        char *end;
+        int numRounds = strtol(options[RSCMP].arg, &end, 10);
+
+        shared_ptr<EbNRadio> radio = setupRadio(config);
+        const RSMatrix &dhCodeMatrix = dynamic_cast<EbNRadioBT4 *>(radio.get())->getDHCodeMatrix();
+        size_t K = dhCodeMatrix.K();
+        size_t M = dhCodeMatrix.M();
+        size_t W = dhCodeMatrix.W();
+
+        LOG_P("RSComparison", "Running for K = %zu, M = %zu, W = %zu, over %d rounds (GF256 %s)...", K, M, W, numRounds, GF256::getImplementation());
+
+        vector<uint8_t> data(K * W);
+        for(size_t b = 0; b < data.size(); b++)
+        {
+          data[b] = rand() & 0xFF;
+        }
+
+        // Worst case for decoding, where only coding symbols are received
+        vector<vector<size_t> > received(numRounds, vector<size_t>(K));
+        for(int r = 0; r < numRounds; r++)
+        {
+          size_t start = K + (rand() % (M - K + 1));
+          for(size_t k = 0; k < K; k++)
+          {
+            received[r][k] = start + k;
+          }
+        }
+
+        // Running each backend both without and with the decoding matrix
+        // cache, using the same cache size as the radio. Progressive backends
+        // have no cache, so are only run once.
+        for(int c = 0; c < 2; c++)
+        {
+          for(int b = 0; b < RSMatrix::Backend::END; b++)
+          {
+            RSMatrix matrix(K, M, W, (RSMatrix::Backend)b, (c == 0) ? 0 : EbNRadioBT4::RS_DECODING_CACHE_SIZE);
+            RSDecodingCache *decodingCache = matrix.getDecodingCache();
+            if((c > 0) && (decodingCache == NULL))
+            {
+              continue;
+            }
+
+            RSErasureEncoder encoder(matrix);
+            RSErasureDecoder decoder(matrix);
+
+            uint64_t encodeStartTime = getTimeUS();
+            for(int r = 0; r < numRounds; r++)
+            {
+              encoder.encode(data.data());
+            }
+            uint64_t encodeStopTime = getTimeUS();
+
+            bool isCorrect = true;
+            uint64_t decodeStartTime = getTimeUS();
+            for(int r = 0; r < numRounds; r++)
+            {
+              decoder.reset();
+              for(size_t k = 0; k < K; k++)
+              {
+                decoder.setSymbol(received[r][k], encoder.getSymbol(received[r][k]));
+              }
+
+              const uint8_t *decoded = decoder.decode();
+              isCorrect &= (decoded != NULL) && (memcmp(decoded, data.data(), data.size()) == 0);
+            }
+            uint64_t decodeStopTime = getTimeUS();
+
+            size_t cacheSize = (decodingCache != NULL) ? decodingCache->getCapacity() : 0;
+            size_t cacheHits = (decodingCache != NULL) ? decodingCache->getNumHits() : 0;
+            LOG_P("RSComparison", "%s (Cache %zu, %zu Hits): Encode %" PRIu64 " us, Decode %" PRIu64 " us, Correct = %d", RSMatrix::backendStrings[b],
+                  cacheSize, cacheHits, encodeStopTime - encodeStartTime, decodeStopTime - decodeStartTime, isCorrect);
+          }
+        }
+      }
+      // Simulating the time for a listener to decode the DH public value
+      // under advert loss, for both the fixed-rate and rateless formats
+      else if(options[DHSIM])
+      {
+        char *end;
+        int numTrials = strtol(options[DHSIM].arg, &end, 10);
+
+        const EbNRadio::Version versions[] = { EbNRadio::Version::Bluetooth4, EbNRadio::Version::Bluetooth4RL };
+        const float lossRates[] = { 0.0, 0.2, 0.4, 0.6, 0.8, 0.9 };
+
+        for(int v = 0; v < 2; v++)
+        {
+          Config simConfig = config;
+          simConfig.radio.version = versions[v];
+          shared_ptr<EbNRadio> radio = setupRadio(simConfig);
+          DHDecodeBench bench(*dynamic_cast<EbNRadioBT4 *>(radio.get()));
+
+          for(int l = 0; l < (sizeof(lossRates) / sizeof(lossRates[0])); l++)
+          {
+            vector<uint64_t> decodeTimes = bench.run(lossRates[l], numTrials);
+            sort(decodeTimes.begin(), decodeTimes.end());
+
+            size_t numFailed = count(decodeTimes.begin(), decodeTimes.end(), UINT64_MAX);
+            LOG_P("DHSimulation", "%s, Loss %.2f: p50 %.1f s, p90 %.1f s, p99 %.1f s, %zu/%d not decoded", EbNRadio::versionStrings[versions[v]], lossRates[l],
+                  decodeTimes[decodeTimes.size() / 2] / 1000.0, decodeTimes[(decodeTimes.size() * 9) / 10] / 1000.0,
+                  decodeTimes[(decodeTimes.size() * 99) / 100] / 1000.0, numFailed, numTrials);
+          }
+        }
+      }
+      // Comparing the radios on how much processing it takes to recognize a
+      // device from its adverts, and how many adverts it takes, across set
+      // sizes and advert loss rates
+      else if(options[RECOGNIZE])
+      {
+        char *end;
+        int numTrials = strtol(options[RECOGNIZE].arg, &end, 10);
+
+        vector<EbNRadio::Version> versions;
+        if(options[RADIO])
+        {
+          versions.push_back(config.radio.version);
+        }
+        else
+        {
+          for(int v = 0; v < EbNRadio::Version::END; v++)
+          {
+            if(v != EbNRadio::Version::Bluetooth2PSI)
+            {
+              versions.push_back((EbNRadio::Version)v);
+            }
+          }
+        }
+
+        const float lossRates[] = { 0.0, 0.2, 0.4, 0.6 };
+
+        // The radios are only used for their advert generation and processing,
+        // but still need an adapter to be created on
+        shared_ptr<VirtualMedium> medium(new VirtualMedium(VirtualMedium::getDefaultConfig()));
+        HCIBackend::setFactory(medium->getFactory());
+
+        if(config.simulation.seed != 0)
+        {
+          srand(config.simulation.seed);
+        }
+
+        for(auto it = versions.begin(); it != versions.end(); it++)
+        {
+          // Each radio uses its own default confirmation scheme, unless both
+          // the radio and scheme are given
+          Config recognizeConfig = config;
+          recognizeConfig.radio.version = *it;
+          if(!options[RADIO])
+          {
+            recognizeConfig.radio.confirm = getDefaultConfirmScheme(*it);
+          }
+
+          for(int setSize = 1; setSize <= max(numLinkValues, 1); setSize *= 4)
+          {
+            for(int l = 0; l < (sizeof(lossRates) / sizeof(lossRates[0])); l++)
+            {
+              RecognitionBench::Config benchConfig;
+              benchConfig.setSize = setSize;
+              benchConfig.lossRate = lossRates[l];
+              benchConfig.numTrials = numTrials;
+              benchConfig.linkValueSize = linkValueSize;
+              benchConfig.firstAdapterID = 0;
+              benchConfig.seed = rand();
+
+              RecognitionBench bench(benchConfig, [&](int adapterID) { return setupRadio(recognizeConfig, adapterID); });
+              RecognitionBench::Result result = bench.run();
+
+              vector<uint64_t> &cpuTimes = result.cpuTimes;
+              vector<size_t> &numAdverts = result.numAdverts;
+              if(cpuTimes.empty())
+              {
+                LOG_P("Recognition", "%s, %d Entries, Loss %.2f: %zu/%d not recognized", EbNRadio::versionStrings[*it], setSize, lossRates[l],
+                      result.numFailed, numTrials);
+                continue;
+              }
+
+              sort(cpuTimes.begin(), cpuTimes.end());
+              sort(numAdverts.begin(), numAdverts.end());
+
+              LOG_P("Recognition", "%s, %d Entries, Loss %.2f: CPU p50 %" PRIu64 " us, p90 %" PRIu64 " us, p99 %" PRIu64 " us, "
+                    "Adverts p50 %zu, p90 %zu, p99 %zu, %zu/%d not recognized", EbNRadio::versionStrings[*it], setSize, lossRates[l],
+                    cpuTimes[cpuTimes.size() / 2], cpuTimes[(cpuTimes.size() * 9) / 10], cpuTimes[(cpuTimes.size() * 99) / 100],
+                    numAdverts[numAdverts.size() / 2], numAdverts[(numAdverts.size() * 9) / 10], numAdverts[(numAdverts.size() * 99) / 100],
+                    result.numFailed, numTrials);
+            }
+          }
+        }
+      }
+      // Running many devices at once in this process, each on a simulated
+      // adapter, to see how the protocol (and the host) scales with density
+      else if(options[SIMULATE])
+      {
+        VirtualMedium::Config mediumConfig = VirtualMedium::getDefaultConfig();
+        mediumConfig.range = config.simulation.range;
+        mediumConfig.lossRate = config.simulation.lossRate;
+        if(config.simulation.seed != 0)
+        {
+          srand(config.simulation.seed);
+        }
+        mediumConfig.seed = rand();
+
+        shared_ptr<VirtualMedium> medium(new VirtualMedium(mediumConfig));
+        HCIBackend::setFactory(medium->getFactory());
+
+        // Everything created from here on picks up the virtual clock, which
+        // jumps straight to the next scheduled action once all of the
+        // controllers (and this thread) are waiting on it
+        shared_ptr<VirtualClock> virtualClock;
+        if(!config.simulation.isRealTime)
+        {
+          virtualClock = shared_ptr<VirtualClock>(new VirtualClock(getTimeMS()));
+          Clock::setDefault(virtualClock);
+        }
+        shared_ptr<Clock> clock = Clock::getDefault();
+
+        EbNHystPolicy hystPolicy (config.hyst.scheme, config.hyst.minStartTime, config.hyst.maxStartTime,
+                                  config.hyst.startSeen, config.hyst.endTime, config.hyst.rssiThreshold);
+
+        // Every device advertises and listens for the same set, so each
+        // encounter is also a match
+        vector<unique_ptr<EbNController> > controllers;
+        for(size_t d = 0; d < config.simulation.numDevices; d++)
+        {
+          controllers.push_back(unique_ptr<EbNController>(new EbNController(setupRadio(config, d), hystPolicy, config.reporting.rssiInterval)));
+          controllers.back()->setAdvertisedSet(randLinkValues);
+          controllers.back()->setListenSet(randLinkValues);
+        }
+
+        atomic<size_t> numStarted(0);
+        atomic<size_t> numEnded(0);
+        for(auto it = controllers.begin(); it != controllers.end(); it++)
+        {
+          (*it)->setEncounterCallback([&](const EncounterEvent &event)
+          {
+            if(event.type == EncounterEvent::Started)
+            {
+              numStarted++;
+            }
+            else if(event.type == EncounterEvent::Ended)
+            {
+              numEnded++;
+            }
+          });
+        }
+
+        LOG_P("Simulation", "Running %zu devices for %" PRIu64 " min...", controllers.size(), TIME_MS_TO_MIN(config.simulation.duration));
+
+        size_t mainID = 0;
+        if(virtualClock)
+        {
+          mainID = virtualClock->addParticipant();
+        }
+
+        vector<thread> controllerThreads;
+        for(auto it = controllers.begin(); it != controllers.end(); it++)
+        {
+          EbNController *controller = it->get();
+          if(virtualClock)
+          {
+            size_t id = virtualClock->addParticipant();
+            controllerThreads.push_back(thread([=]()
+            {
+              virtualClock->join(id);
+              controller->run();
+              virtualClock->leave();
+            }));
+          }
+          else
+          {
+            controllerThreads.push_back(thread(&EbNController::run, controller));
+          }
+        }
+
+        if(virtualClock)
+        {
+          virtualClock->join(mainID);
+        }
+
+        uint64_t startTime = clock->getMonoMS();
+        uint64_t realStartTime = getMonoMS();
+        while((clock->getMonoMS() - startTime) < config.simulation.duration)
+        {
+          clock->sleepMS(min<uint64_t>(TIME_MIN_TO_MS(1), config.simulation.duration - (clock->getMonoMS() - startTime)));
+
+          struct rusage usage;
+          getrusage(RUSAGE_SELF, &usage);
+          uint64_t cpuTime = (usage.ru_utime.tv_sec * 1000) + (usage.ru_utime.tv_usec / 1000) + (usage.ru_stime.tv_sec * 1000) + (usage.ru_stime.tv_usec / 1000);
+          uint64_t elapsedTime = clock->getMonoMS() - startTime;
+          uint64_t realElapsedTime = getMonoMS() - realStartTime;
+
+          LOG_P("Simulation", "%" PRIu64 " s (%.1fx real time): CPU %" PRIu64 " ms (%.1f%% of one core), Max RSS %ld kB, %zu encounters started, %zu ended",
+                TIME_MS_TO_SEC(elapsedTime), (double)elapsedTime / max<uint64_t>(realElapsedTime, 1), cpuTime, (100.0 * cpuTime) / max<uint64_t>(realElapsedTime, 1),
+                usage.ru_maxrss, numStarted.load(), numEnded.load());
+        }
+
+        for(auto it = controllers.begin(); it != controllers.end(); it++)
+        {
+          (*it)->stop();
+        }
+
+        // Letting the controllers run on to notice that they were stopped
+        if(virtualClock)
+        {
+          virtualClock->leave();
+        }
+        for(auto it = controllerThreads.begin(); it != controllerThreads.end(); it++)
+        {
+          it->join();
+        }
+      }
+      // Replaying a capture through the radio and controller, where the
+      // virtual clock skips over all of the time spent waiting on scans, so
+      // that only the time spent processing the reports remains
+      else if(options[REPLAY])
+      {
+        shared_ptr<HCIReplay> replay(new HCIReplay(options[REPLAY].arg));
+        if(!replay->isOpen())
+        {
+          return 1;
+        }
+
+        // The radio is alone on the medium, and so only sees what was captured
+        shared_ptr<VirtualMedium> medium(new VirtualMedium(VirtualMedium::getDefaultConfig()));
+        HCIBackend::setFactory([medium, replay](int adapterID)
+        {
+          shared_ptr<HCIBackend> backend = medium->createBackend(adapterID);
+          static_pointer_cast<VirtualHCIBackend>(backend)->setReplay(replay);
+          return backend;
+        });
+
+        shared_ptr<VirtualClock> virtualClock(new VirtualClock(replay->getStartTime()));
+        Clock::setDefault(virtualClock);
+
+        unique_ptr<EbNController> controller = setupController(config);
+        controller->setAdvertisedSet(randLinkValues);
+        controller->setListenSet(randLinkValues);
+
+        atomic<size_t> numStarted(0);
+        controller->setEncounterCallback([&](const EncounterEvent &event)
+        {
+          if(event.type == EncounterEvent::Started)
+          {
+            numStarted++;
+          }
+        });
+
+        LOG_P("Replay", "Replaying '%s'...", options[REPLAY].arg);
+
+        size_t mainID = virtualClock->addParticipant();
+        size_t controllerID = virtualClock->addParticipant();
+
+        EbNController *controllerPtr = controller.get();
+        uint64_t startTime = getMonoUS();
+        thread controllerThread([=]()
+        {
+          virtualClock->join(controllerID);
+          controllerPtr->run();
+          virtualClock->leave();
+        });
+
+        virtualClock->join(mainID);
+        while(!replay->isFinished())
+        {
+          virtualClock->sleepMS(TIME_SEC_TO_MS(1));
+        }
+
+        controller->stop();
+        virtualClock->leave();
+        controllerThread.join();
+
+        uint64_t elapsedTime = getMonoUS() - startTime;
+        size_t numEvents = replay->getNumEvents();
+        vector<uint64_t> sessionTimes = replay->getSessionTimes();
+        sort(sessionTimes.begin(), sessionTimes.end());
+
+        LOG_P("Replay", "%zu sessions (%zu skipped), %zu events, %zu encounters started in %.1f ms (%.0f events/s)",
+              replay->getNumSessions(), replay->getNumSkipped(), numEvents, numStarted.load(), elapsedTime / 1000.0,
+              (1000000.0 * numEvents) / max<uint64_t>(elapsedTime, 1));
+        if(!sessionTimes.empty())
+        {
+          LOG_P("Replay", "Session processing time: p50 %" PRIu64 " us, p90 %" PRIu64 " us, p99 %" PRIu64 " us, max %" PRIu64 " us",
+                sessionTimes[sessionTimes.size() / 2], sessionTimes[(sessionTimes.size() * 9) / 10],
+                sessionTimes[(sessionTimes.size() * 99) / 100], sessionTimes.back());
+        }
+      }
+      // Discovering a synthetic crowd of peers, all within range, to see how
+      // the processing time of each discovery grows with the number of nearby
+      // devices. The virtual clock skips over the scans themselves, so that
+      // only the time spent processing what was heard remains.
+      else if(options[CROWD])
+      {
+        long numPeers = strtol(options[CROWD].arg, NULL, 10);
+        if(numPeers < 1)
+        {
+          LOG_E("Options", "Option --crowd requires at least one peer.");
+          return 1;
+        }
+        double overlap = options[CROWDOVERLAP] ? strtod(options[CROWDOVERLAP].arg, NULL) : 0.01;
+        long numCycles = options[CROWDCYCLES] ? strtol(options[CROWDCYCLES].arg, NULL, 10) : 100;
+
+        if(config.simulation.seed != 0)
+        {
+          srand(config.simulation.seed);
+        }
+
+        VirtualMedium::Config mediumConfig = VirtualMedium::getDefaultConfig();
+        mediumConfig.range = 2 * mediumConfig.areaSize;
+        mediumConfig.lossRate = config.simulation.lossRate;
+        mediumConfig.seed = rand();
+
+        // The listener is on adapter 0, where it can also be captured so that
+        // the same stream can later be used with --replay
+        shared_ptr<VirtualMedium> medium(new VirtualMedium(mediumConfig));
+        if(options[CAPTURE])
+        {
+          shared_ptr<HCICaptureWriter> capture(new HCICaptureWriter(options[CAPTURE].arg));
+          HCIBackend::setFactory([medium, capture](int adapterID)
+          {
+            shared_ptr<HCIBackend> backend = medium->createBackend(adapterID);
+            if(adapterID == 0)
+            {
+              backend = shared_ptr<HCIBackend>(new CaptureHCIBackend(backend, capture));
+            }
+            return backend;
+          });
+        }
+        else
+        {
+          HCIBackend::setFactory(medium->getFactory());
+        }
+
+        // Joining straight away, since this thread is the only one that waits
+        // on the virtual clock, including while the radios are set up
+        shared_ptr<VirtualClock> virtualClock(new VirtualClock(getTimeMS()));
+        Clock::setDefault(virtualClock);
+        virtualClock->join(virtualClock->addParticipant());
+
+        shared_ptr<EbNRadio> listener = setupRadio(config, 0);
+        listener->setAdvertisedSet(randLinkValues);
+        listener->setListenSet(randLinkValues);
+        listener->initialize();
+
+        LOG_P("Crowd", "Creating %ld peers, with %.3f overlap...", numPeers, overlap);
+
+        CrowdGenerator::Config crowdConfig = { (size_t)numPeers, (size_t)numLinkValues, overlap, linkValueSize, 1, (uint32_t)rand() };
+        CrowdGenerator crowd(crowdConfig, [&](int adapterID) { return setupRadio(config, adapterID); }, randLinkValues);
+
+        LOG_P("Crowd", "Running %ld discoveries over %zu peers (%zu matching)...", numCycles, crowd.getNumPeers(), crowd.getNumMatching());
+
+        vector<uint64_t> cycleTimes;
+        size_t numDiscovered = 0;
+        for(long c = 0; c < numCycles; c++)
+        {
+          uint64_t cycleStart = virtualClock->getMonoMS();
+          crowd.advance();
+
+          uint64_t startTime = getMonoUS();
+          numDiscovered += listener->discover().size();
+          cycleTimes.push_back(getMonoUS() - startTime);
+
+          uint64_t elapsed = virtualClock->getMonoMS() - cycleStart;
+          if(elapsed < listener->getDiscoverInterval())
+          {
+            virtualClock->sleepMS(listener->getDiscoverInterval() - elapsed);
+          }
+        }
+
+        virtualClock->leave();
+
+        sort(cycleTimes.begin(), cycleTimes.end());
+        if(!cycleTimes.empty())
+        {
+          LOG_P("Crowd", "%ld discoveries, %.1f devices discovered per discovery, %zu epoch changes", numCycles,
+                (double)numDiscovered / numCycles, crowd.getNumEpochChanges());
+          LOG_P("Crowd", "Discovery processing time: p50 %" PRIu64 " us, p90 %" PRIu64 " us, p99 %" PRIu64 " us, max %" PRIu64 " us (p50 %.2f us per peer)",
+                cycleTimes[cycleTimes.size() / 2], cycleTimes[(cycleTimes.size() * 9) / 10],
+                cycleTimes[(cycleTimes.size() * 99) / 100], cycleTimes.back(), (double)cycleTimes[cycleTimes.size() / 2] / numPeers);
+        }
+      }
       // Standard benchmarking mode
       else
       {
@@ -609,6 +1389,13 @@ int main(int argc, char **argv)
             controller->setAdvertisedSet(advertisedSet);
             controller->setListenSet(listenSet);
           }
+
+          // Reporting the counters and histograms recorded so far
+          if(event.has_metricsrequestevent())
+          {
+            LOG_D("Main", "Sending a metrics snapshot");
+            sendMetrics(clientSock);
+          }
         }
 
         LOG_D("Main", "Connection terminated, stopping the controller");
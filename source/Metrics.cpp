@@ -0,0 +1,195 @@
+#include "Metrics.h"
+
+#include <algorithm>
+
+using namespace std;
+
+const char *Metrics::counterStrings[] = { "DevicesDiscovered", "DevicesHandshaken", "DevicesEncountered", "SharedSecrets", "SharedSecretFailures",
+                                          "RSDecodeFailures", "Recoveries", "EpochStateEvictions" };
+const char *Metrics::histogramStrings[] = { "ScanDuration", "ReportsPerScan", "AdvertProcess", "RSDecode", "ECDHGenerate", "ECDHSharedSecret",
+                                            "BloomFill", "BloomQuery", "Handshake", "EpochChange", "EventDelivery", "TimeToDHDecoded",
+                                            "TimeToSecretComputed", "TimeToMatchingConverged", "TimeToConfirmed", "AdvertsToDHDecoded",
+                                            "AdvertsToSecretComputed", "AdvertsToMatchingConverged", "AdvertsToConfirmed" };
+
+Metrics::Registry *Metrics::registry_ = NULL;
+pthread_once_t Metrics::registryOnce_ = PTHREAD_ONCE_INIT;
+
+// Only the owning thread writes, so there is no need for an atomic add
+static inline void add(atomic<uint64_t> &value, uint64_t amount)
+{
+  value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+uint64_t Metrics::HistogramSnapshot::getPercentile(double percentile) const
+{
+  if(count == 0)
+  {
+    return 0;
+  }
+
+  uint64_t target = (uint64_t)((percentile / 100) * (count - 1));
+  uint64_t seen = 0;
+  for(size_t b = 0; b < buckets.size(); b++)
+  {
+    seen += buckets[b];
+    if(seen > target)
+    {
+      return getBucketValue(b);
+    }
+  }
+
+  return max;
+}
+
+Metrics::ThreadMetrics::ThreadMetrics()
+{
+  for(int c = 0; c < Counter::END; c++)
+  {
+    counters[c].store(0, memory_order_relaxed);
+  }
+
+  for(int h = 0; h < Histogram::END; h++)
+  {
+    ThreadHistogram &histogram = histograms[h];
+    histogram.count.store(0, memory_order_relaxed);
+    histogram.sum.store(0, memory_order_relaxed);
+    histogram.min.store(UINT64_MAX, memory_order_relaxed);
+    histogram.max.store(0, memory_order_relaxed);
+    for(size_t b = 0; b < NUM_BUCKETS; b++)
+    {
+      histogram.buckets[b].store(0, memory_order_relaxed);
+    }
+  }
+}
+
+void Metrics::increment(Counter counter, uint64_t amount)
+{
+  add(getThreadMetrics()->counters[counter], amount);
+}
+
+void Metrics::record(Histogram histogram, uint64_t value)
+{
+  ThreadHistogram &threadHistogram = getThreadMetrics()->histograms[histogram];
+
+  add(threadHistogram.count, 1);
+  add(threadHistogram.sum, value);
+  add(threadHistogram.buckets[getBucket(value)], 1);
+
+  if(value < threadHistogram.min.load(memory_order_relaxed))
+  {
+    threadHistogram.min.store(value, memory_order_relaxed);
+  }
+  if(value > threadHistogram.max.load(memory_order_relaxed))
+  {
+    threadHistogram.max.store(value, memory_order_relaxed);
+  }
+}
+
+Metrics::Snapshot Metrics::getSnapshot()
+{
+  Registry *registry = getRegistry();
+  lock_guard<mutex> registryLock(registry->mutex);
+
+  Snapshot snapshot = registry->retired;
+  snapshot.time = getTimeMS();
+  for(auto it = registry->threads.begin(); it != registry->threads.end(); it++)
+  {
+    merge(snapshot, **it);
+  }
+
+  for(auto it = snapshot.histograms.begin(); it != snapshot.histograms.end(); it++)
+  {
+    if(it->count == 0)
+    {
+      it->min = 0;
+    }
+  }
+
+  return snapshot;
+}
+
+Metrics::Registry* Metrics::getRegistry()
+{
+  pthread_once(&registryOnce_, &Metrics::createRegistry);
+  return registry_;
+}
+
+void Metrics::createRegistry()
+{
+  registry_ = new Registry();
+  registry_->retired = createSnapshot();
+  pthread_key_create(&registry_->threadKey, &Metrics::releaseThreadMetrics);
+}
+
+// The lock is only taken the first time a thread records something, when it
+// exits, and for snapshots
+Metrics::ThreadMetrics* Metrics::getThreadMetrics()
+{
+  Registry *registry = getRegistry();
+
+  ThreadMetrics *metrics = (ThreadMetrics *)pthread_getspecific(registry->threadKey);
+  if(metrics == NULL)
+  {
+    metrics = new ThreadMetrics();
+    pthread_setspecific(registry->threadKey, metrics);
+
+    lock_guard<mutex> registryLock(registry->mutex);
+    registry->threads.push_back(metrics);
+  }
+
+  return metrics;
+}
+
+// Called as each thread that recorded something exits, keeping its totals
+void Metrics::releaseThreadMetrics(void *metrics)
+{
+  ThreadMetrics *threadMetrics = (ThreadMetrics *)metrics;
+
+  {
+    lock_guard<mutex> registryLock(registry_->mutex);
+
+    merge(registry_->retired, *threadMetrics);
+    for(auto it = registry_->threads.begin(); it != registry_->threads.end(); it++)
+    {
+      if(*it == threadMetrics)
+      {
+        registry_->threads.erase(it);
+        break;
+      }
+    }
+  }
+
+  delete threadMetrics;
+}
+
+Metrics::Snapshot Metrics::createSnapshot()
+{
+  Snapshot snapshot;
+  snapshot.time = 0;
+  snapshot.counters.assign(Counter::END, 0);
+  snapshot.histograms.assign(Histogram::END, HistogramSnapshot{0, 0, UINT64_MAX, 0, vector<uint64_t>(NUM_BUCKETS, 0)});
+  return snapshot;
+}
+
+void Metrics::merge(Snapshot &snapshot, const ThreadMetrics &metrics)
+{
+  for(int c = 0; c < Counter::END; c++)
+  {
+    snapshot.counters[c] += metrics.counters[c].load(memory_order_relaxed);
+  }
+
+  for(int h = 0; h < Histogram::END; h++)
+  {
+    HistogramSnapshot &dest = snapshot.histograms[h];
+    const ThreadHistogram &source = metrics.histograms[h];
+
+    dest.count += source.count.load(memory_order_relaxed);
+    dest.sum += source.sum.load(memory_order_relaxed);
+    dest.min = min(dest.min, source.min.load(memory_order_relaxed));
+    dest.max = max(dest.max, source.max.load(memory_order_relaxed));
+    for(size_t b = 0; b < NUM_BUCKETS; b++)
+    {
+      dest.buckets[b] += source.buckets[b].load(memory_order_relaxed);
+    }
+  }
+}
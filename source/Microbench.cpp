@@ -0,0 +1,157 @@
+#include "Microbench.h"
+
+#include <cstdio>
+#include <cstring>
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+#include "Timing.h"
+
+using namespace std;
+
+const char *Microbench::formatStrings[] = { "Text", "CSV", "JSON" };
+
+atomic<uint64_t> Microbench::numAllocs_(0);
+atomic<uint64_t> Microbench::numAllocBytes_(0);
+
+Microbench::Format Microbench::stringToFormat(const char *name)
+{
+  Format format = Format::END;
+
+  for(int f = 0; f < Format::END; f++)
+  {
+    if(strcmp(name, formatStrings[f]) == 0)
+    {
+      format = (Format)f;
+    }
+  }
+
+  return format;
+}
+
+Microbench::Microbench(uint64_t minTime, size_t numRepeats, const string &filter)
+   : minTime_(minTime),
+     numRepeats_(numRepeats),
+     filter_(filter),
+     cases_()
+{
+}
+
+void Microbench::add(const string &name, Body body)
+{
+  if(name.find(filter_) != string::npos)
+  {
+    cases_.push_back({name, body});
+  }
+}
+
+vector<Microbench::Result> Microbench::run(Format format)
+{
+  vector<Result> results;
+
+  printHeader(format);
+  for(auto it = cases_.begin(); it != cases_.end(); it++)
+  {
+    results.push_back(runCase(*it));
+    printResult(results.back(), format, results.size() == 1);
+  }
+  printFooter(format);
+
+  return results;
+}
+
+Microbench::Result Microbench::runCase(const Case &benchCase)
+{
+  // Warming up (caches, lazily built tables) before finding a batch size
+  // that runs for long enough to time
+  benchCase.body(1);
+
+  uint64_t iterations = 1;
+  while(iterations < MAX_ITERATIONS)
+  {
+    uint64_t startTime = getMonoNS();
+    benchCase.body(iterations);
+    uint64_t elapsedTime = getMonoNS() - startTime;
+
+    if(elapsedTime >= (minTime_ * 1000000))
+    {
+      break;
+    }
+    iterations *= 2;
+  }
+
+  Result result;
+  result.name = benchCase.name;
+  result.iterations = iterations;
+  result.nsPerOp = 0;
+  result.allocsPerOp = 0;
+  result.bytesPerOp = 0;
+
+  for(size_t r = 0; r < numRepeats_; r++)
+  {
+    uint64_t startAllocs = numAllocs_.load();
+    uint64_t startAllocBytes = numAllocBytes_.load();
+    uint64_t startTime = getMonoNS();
+    benchCase.body(iterations);
+    uint64_t elapsedTime = getMonoNS() - startTime;
+
+    double nsPerOp = (double)elapsedTime / iterations;
+    if((r == 0) || (nsPerOp < result.nsPerOp))
+    {
+      result.nsPerOp = nsPerOp;
+    }
+    result.allocsPerOp = (double)(numAllocs_.load() - startAllocs) / iterations;
+    result.bytesPerOp = (double)(numAllocBytes_.load() - startAllocBytes) / iterations;
+  }
+
+  return result;
+}
+
+void Microbench::printHeader(Format format)
+{
+  switch(format)
+  {
+  case Format::Text:
+    printf("%-40s %12s %14s %12s %12s\n", "Benchmark", "Iterations", "ns/op", "allocs/op", "B/op");
+    break;
+  case Format::CSV:
+    printf("name,iterations,ns_per_op,allocs_per_op,bytes_per_op\n");
+    break;
+  case Format::JSON:
+    printf("[");
+    break;
+  default:
+    break;
+  }
+  fflush(stdout);
+}
+
+void Microbench::printResult(const Result &result, Format format, bool isFirst)
+{
+  switch(format)
+  {
+  case Format::Text:
+    printf("%-40s %12" PRIu64 " %14.1f %12.2f %12.1f\n", result.name.c_str(), result.iterations, result.nsPerOp, result.allocsPerOp, result.bytesPerOp);
+    break;
+  case Format::CSV:
+    printf("%s,%" PRIu64 ",%.1f,%.2f,%.1f\n", result.name.c_str(), result.iterations, result.nsPerOp, result.allocsPerOp, result.bytesPerOp);
+    break;
+  case Format::JSON:
+    printf("%s\n  {\"name\": \"%s\", \"iterations\": %" PRIu64 ", \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f}",
+           isFirst ? "" : ",", result.name.c_str(), result.iterations, result.nsPerOp, result.allocsPerOp, result.bytesPerOp);
+    break;
+  default:
+    break;
+  }
+  fflush(stdout);
+}
+
+void Microbench::printFooter(Format format)
+{
+  if(format == Format::JSON)
+  {
+    printf("\n]\n");
+  }
+  fflush(stdout);
+}
@@ -0,0 +1,64 @@
+#include "RSDecodingCache.h"
+
+using namespace std;
+
+RSDecodingCache::RSDecodingCache(size_t capacity)
+   : capacity_(capacity),
+     entries_(),
+     index_(),
+     mutex_(),
+     numHits_(0),
+     numMisses_(0)
+{
+}
+
+shared_ptr<const RSDecodingCache::Entry> RSDecodingCache::get(const BitMap &key)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  auto it = index_.find(toKey(key));
+  if(it == index_.end())
+  {
+    numMisses_.fetch_add(1, memory_order_relaxed);
+    return shared_ptr<const Entry>();
+  }
+
+  // Moving the entry to the front, as the most recently used
+  entries_.splice(entries_.begin(), entries_, it->second);
+  numHits_.fetch_add(1, memory_order_relaxed);
+
+  return it->second->second;
+}
+
+void RSDecodingCache::put(const BitMap &key, shared_ptr<const Entry> entry)
+{
+  if(capacity_ == 0)
+  {
+    return;
+  }
+
+  lock_guard<mutex> lock(mutex_);
+
+  string keyString = toKey(key);
+  auto it = index_.find(keyString);
+  if(it != index_.end())
+  {
+    it->second->second = entry;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+
+  if(entries_.size() >= capacity_)
+  {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+
+  entries_.push_front(make_pair(keyString, entry));
+  index_[keyString] = entries_.begin();
+}
+
+string RSDecodingCache::toKey(const BitMap &bitmap)
+{
+  return string((const char *)bitmap.toByteArray(), bitmap.sizeBytes());
+}
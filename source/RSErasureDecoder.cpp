@@ -1,5 +1,7 @@
 #include "RSErasureDecoder.h"
 
+#include <cstring>
+
 extern "C"
 {
 #include "jerasure/jerasure.h"
@@ -7,143 +9,291 @@ extern "C"
 }
 
 #include "Logger.h"
+#include "Metrics.h"
 
 using namespace std;
 
+static size_t alignSize(size_t size, size_t align)
+{
+  return (size + (align - 1)) & ~(align - 1);
+}
+
 RSErasureDecoder::RSErasureDecoder(const RSMatrix &matrix)
-   : matrix_(matrix),
-     partSymbols_(matrix.getNumParts()),
-     partSymbolPtrs_(matrix.getNumParts()),
-     data_(matrix.K() * matrix.W(), 0),
-     received_(matrix.K() + matrix.M()),
+   : matrix_(&matrix),
+     buffer_(),
+     data_(NULL),
+     received_(NULL),
+     partSymbols_(NULL),
+     eliminator_(),
      numReceived_(0),
      isDecoded_(false)
 {
-  received_.setAll(false);
-
+  size_t K = matrix.K();
   size_t KM = matrix.K() + matrix.M();
-  for(size_t p = 0; p < matrix.getNumParts(); p++)
+
+  // Laying out the decoded data, received flags, elimination state (for
+  // progressive backends) and part symbols (for the others) back to back
+  size_t dataSize = alignSize(K * matrix.W(), BUFFER_ALIGN);
+  size_t receivedSize = alignSize((KM + 7) / 8, BUFFER_ALIGN);
+  size_t eliminatorSize = matrix.isProgressive() ? alignSize(GF256Eliminator::getStorageSize(K, matrix.W()), BUFFER_ALIGN) : 0;
+  size_t partSymbolsSize = matrix.getNumParts() * KM * matrix.getPartSize();
+
+  buffer_.reset(new uint8_t[dataSize + receivedSize + eliminatorSize + partSymbolsSize + (BUFFER_ALIGN - 1)]);
+
+  data_ = (uint8_t *)alignSize((uintptr_t)buffer_.get(), BUFFER_ALIGN);
+  received_ = data_ + dataSize;
+  partSymbols_ = (char *)(received_ + receivedSize + eliminatorSize);
+  if(matrix.isProgressive())
   {
-    partSymbols_[p].resize(KM * sizeof(long));
-    partSymbolPtrs_[p].resize(KM);
-    for(size_t s = 0; s < KM; s++)
-    {
-      partSymbolPtrs_[p][s] = &partSymbols_[p][s * sizeof(long)];
-    }
+    eliminator_ = GF256Eliminator(K, matrix.W(), received_ + receivedSize);
   }
+
+  memset(data_, 0, dataSize);
+  memset(received_, 0, receivedSize);
 }
 
-RSErasureDecoder::RSErasureDecoder(const RSErasureDecoder &other)
-   : matrix_(other.matrix_),
-     partSymbols_(other.partSymbols_),
-     partSymbolPtrs_(matrix_.getNumParts()),
-     data_(other.data_),
-     received_(other.received_),
-     numReceived_(other.numReceived_),
-     isDecoded_(other.isDecoded_)
+bool RSErasureDecoder::setSymbol(size_t index, const uint8_t *data)
 {
-  size_t KM = matrix_.K() + matrix_.M();
-  for(size_t p = 0; p < matrix_.getNumParts(); p++)
+  if(!isReceived(index))
   {
-    partSymbolPtrs_[p].resize(KM);
-    for(size_t s = 0; s < KM; s++)
+    received_[index >> 3] |= 1 << (index & 0x7);
+
+    switch(matrix_->getBackend())
     {
-      partSymbolPtrs_[p][s] = &partSymbols_[p][s * sizeof(long)];
+    case RSMatrix::Backend::Jerasure:
+      for(size_t p = 0; p < matrix_->getNumParts(); p++)
+      {
+        long symbol = 0;
+        for(size_t b = 0; b < matrix_->getPartW(p); b++)
+        {
+          symbol |= *(data++) << (8 * b);
+        }
+        *((long *)getPartSymbol(p, index)) = symbol;
+      }
+      break;
+    case RSMatrix::Backend::GF8:
+    case RSMatrix::Backend::Rateless:
+      eliminator_.add(matrix_->getGeneratorRow(index), data);
+      break;
+    case RSMatrix::Backend::CauchyXOR:
+      matrix_->toBitPlanes(data, getPartSymbol(0, index));
+      break;
+    default:
+      break;
     }
+
+    numReceived_++;
   }
+
+  return canDecode();
 }
 
-RSErasureDecoder& RSErasureDecoder::operator = (const RSErasureDecoder &other)
+bool RSErasureDecoder::isUseful(size_t index)
 {
-  matrix_ = other.matrix_;
-  partSymbols_ = other.partSymbols_;
-  partSymbolPtrs_ = vector<vector<char*> >(matrix_.getNumParts());
-  data_ = other.data_;
-  received_ = other.received_;
-  numReceived_ = other.numReceived_;
-  isDecoded_ = other.isDecoded_;
-
-  size_t KM = matrix_.K() + matrix_.M();
-  for(size_t p = 0; p < matrix_.getNumParts(); p++)
+  if(isDecoded_ || isReceived(index))
   {
-    partSymbolPtrs_[p].resize(KM);
-    for(size_t s = 0; s < KM; s++)
-    {
-      partSymbolPtrs_[p][s] = &partSymbols_[p][s * sizeof(long)];
-    }
+    return false;
+  }
+
+  if(matrix_->isProgressive())
+  {
+    return eliminator_.isUseful(matrix_->getGeneratorRow(index));
   }
 
-  return *this;
+  // Other backends decode from the first K distinct symbols received
+  return (numReceived_ < matrix_->K());
 }
 
-bool RSErasureDecoder::setSymbol(size_t index, const uint8_t *data)
+const uint8_t* RSErasureDecoder::decode()
 {
-  if(!received_.getThenSet(index))
+  uint8_t *decoded = NULL;
+
+  if(isDecoded())
+  {
+    decoded = data_;
+  }
+  else if(canDecode())
   {
-    for(size_t p = 0; p < matrix_.getNumParts(); p++)
+    Metrics::Timer timer(Metrics::Histogram::RSDecode);
+
+    bool success = false;
+    if(matrix_->isProgressive())
+    {
+      // Only back-substitution remains, as elimination was done as each
+      // symbol arrived
+      success = eliminator_.solve(data_);
+    }
+    else
     {
-      long symbol = 0;
-      for(size_t b = 0; b < matrix_.getPartW(p); b++)
+      shared_ptr<const RSDecodingCache::Entry> entry = getDecodingEntry();
+      if(entry)
       {
-        symbol |= *(data++) << (8 * b);
+        switch(matrix_->getBackend())
+        {
+        case RSMatrix::Backend::Jerasure:
+          success = decodeJerasure(*entry);
+          break;
+        case RSMatrix::Backend::CauchyXOR:
+          success = decodeCauchyXOR(*entry);
+          break;
+        default:
+          break;
+        }
       }
-      *((long *)&partSymbols_[p][index * sizeof(long)]) = symbol;
     }
 
-    numReceived_++;
+    if(success)
+    {
+      isDecoded_ = true;
+      decoded = data_;
+    }
+    else
+    {
+      Metrics::increment(Metrics::Counter::RSDecodeFailures);
+      LOG_E("RSErasureDecoder", "Failed to decode with %zu received symbols", numReceived_);
+    }
   }
 
-  return canDecode();
+  return decoded;
 }
 
-const uint8_t* RSErasureDecoder::decode()
+shared_ptr<const RSDecodingCache::Entry> RSErasureDecoder::getDecodingEntry() const
 {
-  uint8_t *decoded = NULL;
+  size_t K = matrix_->K();
+  size_t M = matrix_->M();
 
-  if(isDecoded())
+  // Only the first K received symbols are used for decoding, so using them
+  // as the key lets any later symbols still share the same entry
+  BitMap used(K + M);
+  used.setAll(false);
+  vector<int> erased(K + M, 1);
+  for(size_t s = 0, numUsed = 0; (s < (K + M)) && (numUsed < K); s++)
   {
-    decoded = data_.data();
+    if(isReceived(s))
+    {
+      used.set(s);
+      erased[s] = 0;
+      numUsed++;
+    }
   }
-  else if(canDecode())
+
+  RSDecodingCache *cache = matrix_->getDecodingCache();
+  if(cache != NULL)
+  {
+    shared_ptr<const RSDecodingCache::Entry> entry = cache->get(used);
+    if(entry)
+    {
+      return entry;
+    }
+  }
+
+  shared_ptr<RSDecodingCache::Entry> entry = make_shared<RSDecodingCache::Entry>();
+  entry->ids.resize(K);
+
+  switch(matrix_->getBackend())
   {
-    vector<int> erasures;
-    for(size_t s = 0; s < (matrix_.K() + matrix_.M()); s++)
+  case RSMatrix::Backend::Jerasure:
+    entry->matrices.resize(matrix_->getNumParts(), vector<int>(K * K));
+    for(size_t p = 0; p < matrix_->getNumParts(); p++)
     {
-      if(!received_.get(s))
+      if(jerasure_make_decoding_matrix(K, M, 8 * matrix_->getPartW(p), (int *)matrix_->getMatrix(p), erased.data(), entry->matrices[p].data(), entry->ids.data()) < 0)
       {
-        erasures.push_back(s);
+        return shared_ptr<const RSDecodingCache::Entry>();
       }
     }
-    erasures.push_back(-1);
+    break;
+  case RSMatrix::Backend::CauchyXOR:
+    entry->matrices.resize(1, vector<int>(K * K * 8 * 8));
+    if(jerasure_make_decoding_bitmatrix(K, M, 8, matrix_->getBitMatrix(), erased.data(), entry->matrices[0].data(), entry->ids.data()) < 0)
+    {
+      return shared_ptr<const RSDecodingCache::Entry>();
+    }
+    break;
+  default:
+    // Progressive backends are decoded by elimination instead
+    return shared_ptr<const RSDecodingCache::Entry>();
+  }
+
+  if(cache != NULL)
+  {
+    cache->put(used, entry);
+  }
 
-    for(size_t p = 0; p < matrix_.getNumParts(); p++)
+  return entry;
+}
+
+bool RSErasureDecoder::decodeJerasure(const RSDecodingCache::Entry &entry)
+{
+  size_t K = matrix_->K();
+
+  size_t KM = K + matrix_->M();
+
+  vector<char *> ptrs(KM);
+  for(size_t p = 0; p < matrix_->getNumParts(); p++)
+  {
+    for(size_t s = 0; s < KM; s++)
     {
-      jerasure_matrix_decode(matrix_.K(), matrix_.M(), 8 * matrix_.getPartW(p), matrix_.getMatrix(p), 1, erasures.data(), partSymbolPtrs_[p].data(), &partSymbolPtrs_[p][matrix_.K()], sizeof(long));
+      ptrs[s] = getPartSymbol(p, s);
     }
 
-    uint8_t *pData = data_.data();
-    for(size_t s = 0; s < matrix_.K(); s++)
+    for(size_t k = 0; k < K; k++)
     {
-      for(size_t p = 0; p < matrix_.getNumParts(); p++)
+      if(!isReceived(k))
       {
-        long symbol = *((long *)&partSymbols_[p][s * sizeof(long)]);
-        for(size_t b = 0; b < matrix_.getPartW(p); b++)
-        {
-          *(pData++) = (symbol >> (8 * b)) & 0xFF;
-        }
+        jerasure_matrix_dotprod(K, 8 * matrix_->getPartW(p), (int *)&entry.matrices[p][k * K], (int *)entry.ids.data(), k, ptrs.data(), &ptrs[K], sizeof(long));
       }
     }
+  }
 
-    isDecoded_ = true;
-    decoded = data_.data();
+  uint8_t *pData = data_;
+  for(size_t s = 0; s < K; s++)
+  {
+    for(size_t p = 0; p < matrix_->getNumParts(); p++)
+    {
+      long symbol = *((long *)getPartSymbol(p, s));
+      for(size_t b = 0; b < matrix_->getPartW(p); b++)
+      {
+        *(pData++) = (symbol >> (8 * b)) & 0xFF;
+      }
+    }
   }
 
-  return decoded;
+  return true;
+}
+
+bool RSErasureDecoder::decodeCauchyXOR(const RSDecodingCache::Entry &entry)
+{
+  size_t K = matrix_->K();
+  size_t KM = K + matrix_->M();
+
+  vector<char *> ptrs(KM);
+  for(size_t s = 0; s < KM; s++)
+  {
+    ptrs[s] = getPartSymbol(0, s);
+  }
+
+  // Only the data symbols are recovered, since generating a schedule for all
+  // of the erased coding symbols (as jerasure's lazy decode does) dominates
+  // the cost for the large M used here
+  for(size_t k = 0; k < K; k++)
+  {
+    if(!isReceived(k))
+    {
+      jerasure_bitmatrix_dotprod(K, 8, (int *)&entry.matrices[0][k * K * 8 * 8], (int *)entry.ids.data(), k, ptrs.data(), &ptrs[K], matrix_->getPartSize(), matrix_->getPacketSize());
+    }
+    matrix_->fromBitPlanes(ptrs[k], &data_[k * matrix_->W()]);
+  }
+
+  return true;
 }
 
 void RSErasureDecoder::reset()
 {
-  received_.setAll(false);
+  if(matrix_->isProgressive())
+  {
+    eliminator_.reset();
+  }
+  memset(received_, 0, (matrix_->K() + matrix_->M() + 7) / 8);
   numReceived_ = 0;
   isDecoded_ = false;
 }
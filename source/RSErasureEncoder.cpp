@@ -6,6 +6,8 @@ extern "C"
 #include "jerasure/reed_sol.h"
 }
 
+#include "GF256.h"
+
 using namespace std;
 
 RSErasureEncoder::RSErasureEncoder(const RSMatrix &matrix)
@@ -17,13 +19,10 @@ RSErasureEncoder::RSErasureEncoder(const RSMatrix &matrix)
   size_t KM = matrix.K() + matrix.M();
   for(size_t p = 0; p < matrix.getNumParts(); p++)
   {
-    partSymbols_[p].resize(KM * sizeof(long));
-    partSymbolPtrs_[p].resize(KM);
-    for(size_t s = 0; s < KM; s++)
-    {
-      partSymbolPtrs_[p][s] = &partSymbols_[p][s * sizeof(long)];
-    }
+    partSymbols_[p].resize(KM * matrix.getPartSize());
   }
+
+  setupPartPointers();
 }
 
 RSErasureEncoder::RSErasureEncoder(const RSErasureEncoder &other)
@@ -32,15 +31,7 @@ RSErasureEncoder::RSErasureEncoder(const RSErasureEncoder &other)
      partSymbolPtrs_(matrix_.getNumParts()),
      symbols_(other.symbols_)
 {
-  size_t KM = matrix_.K() + matrix_.M();
-  for(size_t p = 0; p < matrix_.getNumParts(); p++)
-  {
-    partSymbolPtrs_[p].resize(KM);
-    for(size_t s = 0; s < KM; s++)
-    {
-      partSymbolPtrs_[p][s] = &partSymbols_[p][s * sizeof(long)];
-    }
-  }
+  setupPartPointers();
 }
 
 RSErasureEncoder& RSErasureEncoder::operator = (const RSErasureEncoder &other)
@@ -50,20 +41,44 @@ RSErasureEncoder& RSErasureEncoder::operator = (const RSErasureEncoder &other)
   partSymbolPtrs_ = vector<vector<char*> >(matrix_.getNumParts());
   symbols_ = other.symbols_;
 
+  setupPartPointers();
+
+  return *this;
+}
+
+void RSErasureEncoder::encode(const uint8_t *data)
+{
+  switch(matrix_.getBackend())
+  {
+  case RSMatrix::Backend::Jerasure:
+    encodeJerasure(data);
+    break;
+  case RSMatrix::Backend::GF8:
+  case RSMatrix::Backend::Rateless:
+    encodeGenerator(data);
+    break;
+  case RSMatrix::Backend::CauchyXOR:
+    encodeCauchyXOR(data);
+    break;
+  default:
+    break;
+  }
+}
+
+void RSErasureEncoder::setupPartPointers()
+{
   size_t KM = matrix_.K() + matrix_.M();
   for(size_t p = 0; p < matrix_.getNumParts(); p++)
   {
     partSymbolPtrs_[p].resize(KM);
     for(size_t s = 0; s < KM; s++)
     {
-      partSymbolPtrs_[p][s] = &partSymbols_[p][s * sizeof(long)];
+      partSymbolPtrs_[p][s] = &partSymbols_[p][s * matrix_.getPartSize()];
     }
   }
-
-  return *this;
 }
 
-void RSErasureEncoder::encode(const uint8_t *data)
+void RSErasureEncoder::encodeJerasure(const uint8_t *data)
 {
   for(size_t k = 0; k < matrix_.K(); k++)
   {
@@ -97,3 +112,42 @@ void RSErasureEncoder::encode(const uint8_t *data)
   }
 }
 
+void RSErasureEncoder::encodeGenerator(const uint8_t *data)
+{
+  const GF256 &gf = GGF256();
+  size_t K = matrix_.K();
+  size_t W = matrix_.W();
+
+  memcpy(symbols_.data(), data, K * W);
+
+  for(size_t m = 0; m < matrix_.M(); m++)
+  {
+    const uint8_t *row = matrix_.getGeneratorRow(K + m);
+    uint8_t *symbol = &symbols_[(K + m) * W];
+    gf.multiplyRegion(symbol, &symbols_[0], row[0], W);
+    for(size_t k = 1; k < K; k++)
+    {
+      gf.multiplyAddRegion(symbol, &symbols_[k * W], row[k], W);
+    }
+  }
+}
+
+void RSErasureEncoder::encodeCauchyXOR(const uint8_t *data)
+{
+  size_t K = matrix_.K();
+  size_t W = matrix_.W();
+  vector<char*> &ptrs = partSymbolPtrs_[0];
+
+  for(size_t k = 0; k < K; k++)
+  {
+    matrix_.toBitPlanes(data + (k * W), ptrs[k]);
+  }
+
+  jerasure_schedule_encode(K, matrix_.M(), 8, matrix_.getSchedule(), ptrs.data(), &ptrs[K], matrix_.getPartSize(), matrix_.getPacketSize());
+
+  memcpy(symbols_.data(), data, K * W);
+  for(size_t m = 0; m < matrix_.M(); m++)
+  {
+    matrix_.fromBitPlanes(ptrs[K + m], &symbols_[(K + m) * W]);
+  }
+}
@@ -1,29 +1,173 @@
 #include "RSMatrix.h"
 
+#include <cstring>
+#include <stdexcept>
+
 extern "C"
 {
+#include "jerasure/cauchy.h"
+#include "jerasure/jerasure.h"
 #include "jerasure/reed_sol.h"
 }
 
 using namespace std;
 
-RSMatrix::RSMatrix(uint32_t K, uint32_t M, uint32_t W)
+const char *RSMatrix::backendStrings[] = { "Jerasure", "GF8", "CauchyXOR", "Rateless" };
+
+// Generates the coefficients for a rateless coding symbol from its index, so
+// that all devices agree without exchanging anything beyond the index
+static void generateRatelessRow(uint32_t index, size_t K, uint8_t *row)
+{
+  uint32_t state = (index * 0x9E3779B9) ^ 0xA5A5A5A5;
+  if(state == 0)
+  {
+    state = 1;
+  }
+
+  bool isZero = true;
+  for(size_t k = 0; k < K; k++)
+  {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    row[k] = state >> 24;
+    isZero &= (row[k] == 0);
+  }
+
+  if(isZero)
+  {
+    row[0] = 1;
+  }
+}
+
+RSMatrix::Backend RSMatrix::stringToBackend(const char* name)
 {
+  Backend backend = Backend::END;
+
+  for(int b = 0; b < Backend::END; b++)
+  {
+    if(strcmp(name, RSMatrix::backendStrings[b]) == 0)
+    {
+      backend = (Backend)b;
+    }
+  }
+
+  return backend;
+}
+
+RSMatrix::RSMatrix(uint32_t K, uint32_t M, uint32_t W, Backend backend, uint32_t decodingCacheSize)
+{
+  backend_ = backend;
   K_ = K;
   M_ = M;
   W_ = W;
+  packetSize_ = 0;
 
-  // TODO: Can optimize by specifying a length longer than sizeof(long) for
-  // cases where a given value of 'w' is used more than once
-  for(int w = 4; w >= 1; w /= 2)
+  switch(backend)
   {
-    for(; W >= w; W -= w)
+  case Backend::Jerasure:
+    // TODO: Can optimize by specifying a length longer than sizeof(long) for
+    // cases where a given value of 'w' is used more than once
+    for(int w = 4; w >= 1; w /= 2)
     {
-      partW_.push_back(w);
+      for(; W >= w; W -= w)
+      {
+        partW_.push_back(w);
+
+        int *matrix = reed_sol_vandermonde_coding_matrix(K, M, 8 * w);
+        partMatrices_.push_back(shared_ptr<int>(matrix, free));
+      }
+    }
+    break;
 
-      int *matrix = reed_sol_vandermonde_coding_matrix(K, M, 8 * w);
-      partMatrices_.push_back(shared_ptr<int>(matrix, free));
+  case Backend::GF8:
+    if((K + M) > 256)
+    {
+      throw runtime_error("RSMatrix: GF8 backend requires K + M <= 256.");
+    }
+
+    codingMatrix_ = shared_ptr<int>(reed_sol_vandermonde_coding_matrix(K, M, 8), free);
+
+    // Identity rows for the data symbols, followed by the coding rows, used
+    // by decoders to eliminate symbols as they arrive
+    generatorMatrix_ = make_shared<vector<uint8_t> >((K + M) * K, 0);
+    for(size_t k = 0; k < K; k++)
+    {
+      (*generatorMatrix_)[(k * K) + k] = 1;
+    }
+    for(size_t m = 0; m < M; m++)
+    {
+      for(size_t k = 0; k < K; k++)
+      {
+        (*generatorMatrix_)[((K + m) * K) + k] = codingMatrix_.get()[(m * K) + k];
+      }
     }
+    break;
+
+  case Backend::CauchyXOR:
+  {
+    if((K + M) > 256)
+    {
+      throw runtime_error("RSMatrix: CauchyXOR backend requires K + M <= 256.");
+    }
+
+    // Each of the 8 packets holds one bit-plane of the symbol (one bit per
+    // byte), padded up to a multiple of sizeof(long) as jerasure requires
+    packetSize_ = (((W + 7) / 8) + (sizeof(long) - 1)) & ~(sizeof(long) - 1);
+
+    codingMatrix_ = shared_ptr<int>(cauchy_good_general_coding_matrix(K, M, 8), free);
+    bitMatrix_ = shared_ptr<int>(jerasure_matrix_to_bitmatrix(K, M, 8, codingMatrix_.get()), free);
+    schedule_ = shared_ptr<int *>(jerasure_smart_bitmatrix_to_schedule(K, M, 8, bitMatrix_.get()), jerasure_free_schedule);
+
+    partW_.push_back(W);
+    partMatrices_.push_back(codingMatrix_);
+    break;
+  }
+
+  case Backend::Rateless:
+    generatorMatrix_ = make_shared<vector<uint8_t> >((K + M) * K, 0);
+    for(size_t k = 0; k < K; k++)
+    {
+      (*generatorMatrix_)[(k * K) + k] = 1;
+    }
+    for(size_t m = 0; m < M; m++)
+    {
+      generateRatelessRow(K + m, K, &(*generatorMatrix_)[(K + m) * K]);
+    }
+    break;
+
+  default:
+    throw runtime_error("RSMatrix: Unknown backend.");
+  }
+
+  // Progressive backends never invert a matrix, so have nothing to cache
+  if((decodingCacheSize > 0) && !isProgressive())
+  {
+    decodingCache_ = make_shared<RSDecodingCache>(decodingCacheSize);
   }
 }
 
+void RSMatrix::toBitPlanes(const uint8_t *symbol, char *planes) const
+{
+  memset(planes, 0, 8 * packetSize_);
+  for(size_t b = 0; b < W_; b++)
+  {
+    for(size_t p = 0; p < 8; p++)
+    {
+      planes[(p * packetSize_) + (b >> 3)] |= ((symbol[b] >> p) & 0x1) << (b & 0x7);
+    }
+  }
+}
+
+void RSMatrix::fromBitPlanes(const char *planes, uint8_t *symbol) const
+{
+  for(size_t b = 0; b < W_; b++)
+  {
+    uint8_t value = 0;
+    for(size_t p = 0; p < 8; p++)
+    {
+      value |= ((planes[(p * packetSize_) + (b >> 3)] >> (b & 0x7)) & 0x1) << p;
+    }
+    symbol[b] = value;
+  }
+}
@@ -0,0 +1,235 @@
+#include "RecognitionBench.h"
+
+#include <stdexcept>
+
+#include "EbNRadioBT2.h"
+#include "EbNRadioBT2NR.h"
+#include "EbNRadioBT4.h"
+#include "EbNRadioBT4AR.h"
+#include "EbNRadioBT5.h"
+#include "Logger.h"
+#include "Timing.h"
+
+using namespace std;
+
+RecognitionBench::RecognitionBench(const Config &config, RadioFactory radioFactory)
+   : config_(config),
+     radioFactory_(radioFactory),
+     random_(config.seed)
+{
+}
+
+RecognitionBench::Result RecognitionBench::run()
+{
+  Result result;
+  result.numFailed = 0;
+
+  // The lower-level advert methods are not a part of the EbNRadio interface,
+  // so each radio version is driven through its own type
+  shared_ptr<EbNRadio> receiver = radioFactory_(config_.firstAdapterID);
+  EbNRadioBT2 *receiverBT2 = dynamic_cast<EbNRadioBT2 *>(receiver.get());
+  EbNRadioBT2NR *receiverBT2NR = dynamic_cast<EbNRadioBT2NR *>(receiver.get());
+  EbNRadioBT4 *receiverBT4 = dynamic_cast<EbNRadioBT4 *>(receiver.get());
+  EbNRadioBT4AR *receiverBT4AR = dynamic_cast<EbNRadioBT4AR *>(receiver.get());
+  EbNRadioBT5 *receiverBT5 = dynamic_cast<EbNRadioBT5 *>(receiver.get());
+
+  if((receiverBT2 == NULL) && (receiverBT2NR == NULL) && (receiverBT4 == NULL) && (receiverBT4AR == NULL) && (receiverBT5 == NULL))
+  {
+    throw runtime_error("Recognition benchmark is not supported by this radio.");
+  }
+
+  // Radios only transmit one discovery's worth of data (a name or address) at
+  // a time when there is no sequence of distinct adverts
+  const size_t maxDiscoveries = EbNRadio::getEpochInterval() / receiver->getDiscoverInterval();
+
+  for(size_t t = 0; t < config_.numTrials; t++)
+  {
+    Trial trial = generateTrial();
+    receiver->setListenSet(trial.listenSet);
+
+    shared_ptr<EbNRadio> sender = radioFactory_(config_.firstAdapterID + 1);
+    sender->setAdvertisedSet(trial.advertisedSet);
+
+    if(receiverBT2 != NULL)
+    {
+      EbNRadioBT2 *senderBT2 = dynamic_cast<EbNRadioBT2 *>(sender.get());
+      senderBT2->initializePeer();
+
+      EbNDeviceBT2 device(0, senderBT2->getLocalAddress(), 0, 0, trial.listenSet);
+      processAdverts(senderBT2, receiverBT2, &device, true, trial);
+    }
+    else if(receiverBT4 != NULL)
+    {
+      EbNRadioBT4 *senderBT4 = dynamic_cast<EbNRadioBT4 *>(sender.get());
+      senderBT4->initializePeer();
+
+      // Secrets are only computed from the adverts without active confirmation
+      bool hasSecrets = (receiver->getHandshakeScheme() != EbNRadio::ConfirmScheme::Active);
+
+      EbNDeviceBT4 device(0, senderBT4->getLocalAddress(), trial.listenSet);
+      processAdverts(senderBT4, receiverBT4, &device, hasSecrets, trial);
+    }
+    else if(receiverBT5 != NULL)
+    {
+      // Starts no threads of its own, only setting up the address and advert
+      EbNRadioBT5 *senderBT5 = dynamic_cast<EbNRadioBT5 *>(sender.get());
+      senderBT5->initialize();
+
+      EbNDeviceBT5 device(0, senderBT5->getLocalAddress(), trial.listenSet);
+      processAdverts(senderBT5, receiverBT5, &device, true, trial);
+    }
+    else if(receiverBT2NR != NULL)
+    {
+      // The whole advert is carried in the name, which is requested again
+      // after each discovery until it gets through
+      EbNRadioBT2NR *senderBT2NR = dynamic_cast<EbNRadioBT2NR *>(sender.get());
+      BitMap advert = senderBT2NR->generateAdvert();
+      EbNDeviceBT2 device(0, Address(), 0, 0, trial.listenSet);
+
+      for(size_t d = 0; (d < maxDiscoveries) && !trial.isRecognized; d++)
+      {
+        trial.numAdverts++;
+        if(!isLost())
+        {
+          uint64_t startTime = getThreadCPUUS();
+          receiverBT2NR->processAdvert(&device, advert.toByteArray());
+          trial.cpuTime += getThreadCPUUS() - startTime;
+
+          trial.isRecognized = isRecognized(&device, trial.shared, true);
+        }
+      }
+    }
+    else if(receiverBT4AR != NULL)
+    {
+      // Recognition comes from resolving the address alone, against the
+      // first advertised entry (which is always shared)
+      EbNRadioBT4AR *senderBT4AR = dynamic_cast<EbNRadioBT4AR *>(sender.get());
+      LinkValueSet resolvable;
+      resolvable.insert(trial.advertisedSet.front());
+
+      for(size_t d = 0; (d < maxDiscoveries) && !trial.isRecognized; d++)
+      {
+        trial.numAdverts++;
+        if(!isLost())
+        {
+          Address address = senderBT4AR->generateAddress();
+
+          uint64_t startTime = getThreadCPUUS();
+          EbNDeviceBT4AR device(0, address, trial.listenSet);
+          trial.cpuTime += getThreadCPUUS() - startTime;
+
+          trial.isRecognized = isRecognized(&device, resolvable, false);
+        }
+      }
+    }
+
+    if(trial.isRecognized)
+    {
+      result.cpuTimes.push_back(trial.cpuTime);
+      result.numAdverts.push_back(trial.numAdverts);
+    }
+    else
+    {
+      result.numFailed++;
+    }
+  }
+
+  LOG_D("RecognitionBench", "Ran %zu trials with sets of %zu entries, %.2f loss (%zu not recognized)", config_.numTrials, config_.setSize,
+        config_.lossRate, result.numFailed);
+
+  return result;
+}
+
+// The first half (rounded up) of the advertised set is taken from the listen
+// set, and the rest is random
+RecognitionBench::Trial RecognitionBench::generateTrial()
+{
+  Trial trial;
+  trial.isRecognized = false;
+  trial.cpuTime = 0;
+  trial.numAdverts = 0;
+
+  size_t numShared = (config_.setSize + 1) / 2;
+  for(size_t e = 0; e < config_.setSize; e++)
+  {
+    LinkValue linkValue = generateLinkValue();
+    trial.listenSet.push_back(linkValue);
+
+    if(e < numShared)
+    {
+      trial.advertisedSet.push_back(linkValue);
+      trial.shared.insert(linkValue);
+    }
+  }
+
+  for(size_t e = numShared; e < config_.setSize; e++)
+  {
+    trial.advertisedSet.push_back(generateLinkValue());
+  }
+
+  return trial;
+}
+
+LinkValue RecognitionBench::generateLinkValue()
+{
+  uniform_int_distribution<int> byte(0, 0xFF);
+
+  LinkValue linkValue(new uint8_t[config_.linkValueSize], config_.linkValueSize);
+  for(size_t b = 0; b < config_.linkValueSize; b++)
+  {
+    linkValue[b] = byte(random_);
+  }
+
+  return linkValue;
+}
+
+bool RecognitionBench::isLost()
+{
+  return bernoulli_distribution(config_.lossRate)(random_);
+}
+
+// Sending each of the epoch's adverts in order, spread evenly over the epoch,
+// and stopping at the first one after which the device is recognized
+template <typename Radio, typename Device>
+void RecognitionBench::processAdverts(Radio *sender, Radio *receiver, Device *device, bool hasSecrets, Trial &trial)
+{
+  const size_t numAdverts = sender->getNumAdverts();
+  const uint64_t startTime = EbNRadio::getEpochInterval();
+
+  for(size_t a = 0; (a < numAdverts) && !trial.isRecognized; a++)
+  {
+    BitMap advert = sender->generateAdvert(a);
+
+    trial.numAdverts++;
+    if(!isLost())
+    {
+      uint64_t time = startTime + ((a * EbNRadio::getEpochInterval()) / numAdverts);
+
+      uint64_t cpuStartTime = getThreadCPUUS();
+      receiver->processAdvert(device, time, advert.toByteArray());
+      receiver->processEpochs(device);
+      trial.cpuTime += getThreadCPUUS() - cpuStartTime;
+
+      trial.isRecognized = isRecognized(device, trial.shared, hasSecrets);
+    }
+  }
+}
+
+bool RecognitionBench::isRecognized(EbNDevice *device, const LinkValueSet &shared, bool hasSecrets)
+{
+  const LinkValueList &matching = device->getMatching();
+  if((matching.size() != shared.size()) || (device->getMatchingPFalse() > EbNDevice::MATCHING_CONVERGED_PFALSE))
+  {
+    return false;
+  }
+
+  for(auto it = matching.begin(); it != matching.end(); it++)
+  {
+    if(shared.find(*it) == shared.end())
+    {
+      return false;
+    }
+  }
+
+  return !hasSecrets || !device->getSharedSecrets().empty();
+}
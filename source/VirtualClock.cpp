@@ -0,0 +1,117 @@
+#include "VirtualClock.h"
+
+#include <algorithm>
+
+using namespace std;
+
+VirtualClock::VirtualClock(uint64_t epoch)
+   : epoch_(epoch),
+     time_(0),
+     nextID_(0),
+     numStarting_(0),
+     running_(NONE),
+     waiting_(),
+     threadToID_(),
+     mutex_(),
+     cond_()
+{
+}
+
+size_t VirtualClock::addParticipant()
+{
+  lock_guard<mutex> lock(mutex_);
+  numStarting_++;
+  return nextID_++;
+}
+
+void VirtualClock::join(size_t id)
+{
+  unique_lock<mutex> lock(mutex_);
+
+  threadToID_[this_thread::get_id()] = id;
+  numStarting_--;
+  waiting_.insert(make_pair(time_, id));
+  dispatch();
+
+  cond_.wait(lock, [&]() { return running_ == id; });
+}
+
+void VirtualClock::leave()
+{
+  lock_guard<mutex> lock(mutex_);
+
+  ThreadToIDMap::iterator it = threadToID_.find(this_thread::get_id());
+  if(it == threadToID_.end())
+  {
+    return;
+  }
+
+  if(running_ == it->second)
+  {
+    running_ = NONE;
+  }
+  threadToID_.erase(it);
+
+  dispatch();
+}
+
+uint64_t VirtualClock::getTimeMS() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return epoch_ + time_;
+}
+
+uint64_t VirtualClock::getMonoMS() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return time_;
+}
+
+uint64_t VirtualClock::getMonoUS() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return time_ * 1000;
+}
+
+void VirtualClock::sleepMS(uint64_t time)
+{
+  unique_lock<mutex> lock(mutex_);
+
+  const uint64_t wakeTime = time_ + min(time, UINT64_MAX - time_);
+
+  ThreadToIDMap::iterator it = threadToID_.find(this_thread::get_id());
+  if(it == threadToID_.end())
+  {
+    cond_.wait(lock, [&]() { return time_ >= wakeTime; });
+    return;
+  }
+
+  // Handing over to whichever participant is due next, which may well be
+  // this one again
+  const size_t id = it->second;
+  waiting_.insert(make_pair(wakeTime, id));
+  running_ = NONE;
+  dispatch();
+
+  cond_.wait(lock, [&]() { return running_ == id; });
+}
+
+void VirtualClock::waitFor(unique_lock<mutex> &lock, condition_variable &cond, uint64_t timeout)
+{
+  lock.unlock();
+  sleepMS(timeout);
+  lock.lock();
+}
+
+void VirtualClock::dispatch()
+{
+  if((running_ == NONE) && (numStarting_ == 0) && !waiting_.empty())
+  {
+    WaitSet::iterator next = waiting_.begin();
+    time_ = max(time_, next->first);
+    running_ = next->second;
+    waiting_.erase(next);
+  }
+
+  cond_.notify_all();
+}
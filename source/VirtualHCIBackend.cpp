@@ -0,0 +1,1065 @@
+#include "VirtualHCIBackend.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "bluetooth/hci_lib.h"
+
+#include "BluetoothHCI.h"
+#include "Logger.h"
+
+using namespace std;
+
+VirtualHCIBackend::VirtualHCIBackend(shared_ptr<VirtualMedium> medium, int adapterID)
+   : medium_(medium),
+     clock_(Clock::getDefault()),
+     replay_(),
+     adapterID_(adapterID),
+     isOpen_(false),
+     isEventsOpen_(false),
+     filter_(),
+     state_(),
+     inquiryMode_(0),
+     isScanning_(false),
+     isExtendedScan_(false),
+     scanType_(0),
+     scanFilterDup_(false),
+     scanWindow_(0),
+     extScanType_(0),
+     extScanWindow_(0),
+     numPendingNames_(0),
+     events_(),
+     mutex_(),
+     eventsCond_()
+{
+  lock_guard<mutex> lock(mutex_);
+  resetState(Address::generate(6));
+}
+
+VirtualHCIBackend::~VirtualHCIBackend()
+{
+  // Taking everything off the air, since nothing will be answering for it
+  lock_guard<mutex> lock(mutex_);
+  state_ = VirtualMedium::OnAir();
+  state_.publicAddress = Address(6);
+  state_.randomAddress = Address(6);
+  state_.extAdvertAddress = Address(6);
+  publish();
+}
+
+void VirtualHCIBackend::setReplay(shared_ptr<HCIReplay> replay)
+{
+  lock_guard<mutex> lock(mutex_);
+  replay_ = replay;
+}
+
+int VirtualHCIBackend::open()
+{
+  lock_guard<mutex> lock(mutex_);
+  isOpen_ = true;
+  return 0;
+}
+
+void VirtualHCIBackend::close()
+{
+  lock_guard<mutex> lock(mutex_);
+  isOpen_ = false;
+}
+
+int VirtualHCIBackend::reset()
+{
+  lock_guard<mutex> lock(mutex_);
+  resetState(state_.publicAddress);
+  return 0;
+}
+
+void VirtualHCIBackend::restart(const Address *publicAddress)
+{
+  lock_guard<mutex> lock(mutex_);
+  resetState((publicAddress != NULL) ? *publicAddress : state_.publicAddress);
+}
+
+int VirtualHCIBackend::readDeviceInfo(struct hci_dev_info *info)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  memset(info, 0, sizeof(*info));
+  info->dev_id = adapterID_;
+  snprintf(info->name, sizeof(info->name), "hci%d", adapterID_);
+  memcpy(info->bdaddr.b, state_.publicAddress.toByteArray(), 6);
+
+  hci_set_bit(HCI_UP, &info->flags);
+  if(state_.isConnectable)
+  {
+    hci_set_bit(HCI_PSCAN, &info->flags);
+  }
+  if(state_.isDiscoverable)
+  {
+    hci_set_bit(HCI_ISCAN, &info->flags);
+  }
+
+  return 0;
+}
+
+int VirtualHCIBackend::setScanEnable(uint8_t scanEnable)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  state_.isConnectable = ((scanEnable & SCAN_PAGE) != 0);
+  state_.isDiscoverable = ((scanEnable & SCAN_INQUIRY) != 0);
+  publish();
+
+  return 0;
+}
+
+int VirtualHCIBackend::sendCommand(uint16_t opcode, const void *params, uint8_t length)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if(!isOpen_)
+  {
+    errno = EBADF;
+    return -1;
+  }
+
+  uint64_t curTime = clock_->getMonoMS();
+  checkReplay();
+
+  // Commands which start a lengthy process only return a status at first,
+  // with the outcome following in its own event
+  if(opcode == cmd_opcode_pack(OGF_LINK_CTL, OCF_INQUIRY))
+  {
+    const inquiry_cp *param = (const inquiry_cp *)params;
+    if(length < INQUIRY_CP_SIZE)
+    {
+      queueCommandStatus(curTime, opcode, 0x12);
+    }
+    else
+    {
+      queueCommandStatus(curTime, opcode, 0);
+      scheduleInquiry(curTime, param->length);
+    }
+  }
+  else if(opcode == cmd_opcode_pack(OGF_LINK_CTL, OCF_REMOTE_NAME_REQ))
+  {
+    const remote_name_req_cp *param = (const remote_name_req_cp *)params;
+    if(length < REMOTE_NAME_REQ_CP_SIZE)
+    {
+      queueCommandStatus(curTime, opcode, 0x12);
+    }
+    else if(numPendingNames_ >= MAX_PENDING_NAMES)
+    {
+      // As with most controllers, which can only page a few devices at once
+      queueCommandStatus(curTime, opcode, 0x0C);
+    }
+    else
+    {
+      queueCommandStatus(curTime, opcode, 0);
+      scheduleRemoteName(curTime, Address(6, param->bdaddr.b));
+    }
+  }
+  else
+  {
+    vector<uint8_t> reply;
+    uint8_t status = handleCommand(opcode, (const uint8_t *)params, length, reply, curTime);
+    queueCommandComplete(curTime, opcode, status, reply);
+  }
+  checkReplay();
+
+  eventsCond_.notify_all();
+  return 0;
+}
+
+int VirtualHCIBackend::sendRequest(struct hci_request *request, int timeout)
+{
+  uint16_t opcode = cmd_opcode_pack(request->ogf, request->ocf);
+
+  if(request->event == EVT_REMOTE_NAME_REQ_COMPLETE)
+  {
+    const remote_name_req_cp *param = (const remote_name_req_cp *)request->cparam;
+    if(request->clen < REMOTE_NAME_REQ_CP_SIZE)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+    evt_remote_name_req_complete complete;
+    bool isFound = lookupName(Address(6, param->bdaddr.b), complete);
+
+    // Blocking for as long as the page would take, or until the caller gives
+    // up on it
+    uint64_t latency = isFound ? NAME_LATENCY : PAGE_TIMEOUT;
+    if((timeout > 0) && (timeout < latency))
+    {
+      clock_->sleepMS(timeout);
+      errno = ETIMEDOUT;
+      return -1;
+    }
+    clock_->sleepMS(latency);
+
+    memcpy(request->rparam, &complete, min<size_t>(request->rlen, EVT_REMOTE_NAME_REQ_COMPLETE_SIZE));
+    return 0;
+  }
+
+  lock_guard<mutex> lock(mutex_);
+
+  if(!isOpen_)
+  {
+    errno = EBADF;
+    return -1;
+  }
+
+  checkReplay();
+
+  vector<uint8_t> reply(1);
+  uint8_t status = handleCommand(opcode, (const uint8_t *)request->cparam, request->clen, reply, clock_->getMonoMS());
+  reply[0] = status;
+
+  checkReplay();
+  memcpy(request->rparam, reply.data(), min<size_t>(request->rlen, reply.size()));
+
+  eventsCond_.notify_all();
+  return 0;
+}
+
+int VirtualHCIBackend::inquiry(int periods, vector<inquiry_info> &responses)
+{
+  clock_->sleepMS(periods * 1280);
+
+  vector<VirtualMedium::Neighbour> neighbours = medium_->getNeighbours(adapterID_);
+  for(auto it = neighbours.begin(); it != neighbours.end(); it++)
+  {
+    if(!it->onAir->isDiscoverable || medium_->sampleLoss())
+    {
+      continue;
+    }
+
+    inquiry_info info;
+    memset(&info, 0, sizeof(info));
+    memcpy(info.bdaddr.b, it->onAir->publicAddress.toByteArray(), 6);
+    info.pscan_rep_mode = 0x01;
+    responses.push_back(info);
+  }
+
+  return responses.size();
+}
+
+void VirtualHCIBackend::openEvents(const struct hci_filter &filter)
+{
+  lock_guard<mutex> lock(mutex_);
+  filter_ = filter;
+  isEventsOpen_ = true;
+}
+
+void VirtualHCIBackend::closeEvents()
+{
+  lock_guard<mutex> lock(mutex_);
+  isEventsOpen_ = false;
+}
+
+size_t VirtualHCIBackend::readEvents(int64_t timeout, uint8_t *buffer, size_t *lengths, size_t maxEvents)
+{
+  unique_lock<mutex> lock(mutex_);
+
+  uint64_t deadline = (timeout >= 0) ? (clock_->getMonoMS() + timeout) : UINT64_MAX;
+  while(true)
+  {
+    uint64_t curTime = clock_->getMonoMS();
+
+    size_t numEvents = 0;
+    while(!events_.empty() && (events_.begin()->first <= curTime) && (numEvents < maxEvents))
+    {
+      PendingEvent &event = events_.begin()->second;
+      if(event.source == Source::RemoteName)
+      {
+        numPendingNames_--;
+      }
+
+      // Only passing on the events that a filtered socket would receive
+      if(isEventsOpen_ && hci_filter_test_event(event.packet[1], &filter_))
+      {
+        memcpy(buffer + (numEvents * HCI_MAX_EVENT_SIZE), event.packet.data(), event.packet.size());
+        lengths[numEvents++] = event.packet.size();
+      }
+
+      events_.erase(events_.begin());
+    }
+
+    if(numEvents > 0)
+    {
+      return numEvents;
+    }
+    else if(curTime >= deadline)
+    {
+      return 0;
+    }
+
+    uint64_t wakeTime = deadline;
+    if(!events_.empty())
+    {
+      wakeTime = min(wakeTime, events_.begin()->first);
+    }
+
+    clock_->waitFor(lock, eventsCond_, (wakeTime == UINT64_MAX) ? UINT64_MAX : (wakeTime - curTime));
+  }
+}
+
+size_t VirtualHCIBackend::flushEvents()
+{
+  lock_guard<mutex> lock(mutex_);
+
+  uint64_t curTime = clock_->getMonoMS();
+
+  size_t numFlushed = 0;
+  while(!events_.empty() && (events_.begin()->first <= curTime))
+  {
+    if(events_.begin()->second.source == Source::RemoteName)
+    {
+      numPendingNames_--;
+    }
+
+    events_.erase(events_.begin());
+    numFlushed++;
+  }
+
+  return numFlushed;
+}
+
+int VirtualHCIBackend::startConnect(Transport transport, const Address &address, uint8_t port)
+{
+  shared_ptr<const VirtualMedium::OnAir> onAir;
+  int target = medium_->findNeighbour(adapterID_, address, transport, &onAir);
+
+  bool isReachable = false;
+  if(target >= 0)
+  {
+    if(transport == Transport::RFCOMM)
+    {
+      isReachable = onAir->isConnectable;
+    }
+    else
+    {
+      bool isAdvertConnectable = ((onAir->advertType == BluetoothHCI::UndirectedAdvert::Connectable) || (onAir->advertType == 0x01));
+      isReachable = (onAir->isAdvertising && (onAir->randomAddress == address) && isAdvertConnectable) ||
+                    (onAir->isExtAdvertising && (onAir->extAdvertAddress == address) && onAir->isExtConnectable);
+    }
+  }
+
+  // Lost connection requests fail just as those to devices out of range
+  if(!isReachable || medium_->sampleLoss())
+  {
+    errno = EHOSTUNREACH;
+    return -1;
+  }
+
+  int sockConn = socket(AF_UNIX, ((transport == Transport::RFCOMM) ? SOCK_STREAM : SOCK_SEQPACKET) | SOCK_NONBLOCK, 0);
+  if(sockConn < 0)
+  {
+    LOG_E_BT_CRASH("VirtualHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  // The listener sees the address that we would connect from, which is the
+  // random address for LE
+  Address ownAddress;
+  {
+    lock_guard<mutex> lock(mutex_);
+    ownAddress = (transport == Transport::RFCOMM) ? state_.publicAddress : state_.randomAddress;
+  }
+
+  if(bindConnectName(sockConn, ownAddress) < 0)
+  {
+    LOG_E_BT_CRASH("VirtualHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  string name = medium_->getListenName(target, transport, port);
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path + 1, name.data(), min(name.size(), sizeof(addr.sun_path) - 1));
+  socklen_t addrLength = offsetof(struct sockaddr_un, sun_path) + 1 + min(name.size(), sizeof(addr.sun_path) - 1);
+
+  if(connect(sockConn, (struct sockaddr *)&addr, addrLength) < 0)
+  {
+    int error = errno;
+    ::close(sockConn);
+
+    // A full backlog means the listener is busy with other connections, which
+    // the caller should retry later (as with EBUSY from a real controller)
+    errno = ((error == EAGAIN) || (error == EWOULDBLOCK)) ? EBUSY : error;
+    return -1;
+  }
+
+  return sockConn;
+}
+
+int VirtualHCIBackend::listen(Transport transport, uint8_t port)
+{
+  int sockListen = socket(AF_UNIX, ((transport == Transport::RFCOMM) ? SOCK_STREAM : SOCK_SEQPACKET) | SOCK_NONBLOCK, 0);
+  if(sockListen < 0)
+  {
+    LOG_E_BT_CRASH("VirtualHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  string name = medium_->getListenName(adapterID_, transport, port);
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path + 1, name.data(), min(name.size(), sizeof(addr.sun_path) - 1));
+  socklen_t addrLength = offsetof(struct sockaddr_un, sun_path) + 1 + min(name.size(), sizeof(addr.sun_path) - 1);
+
+  if(bind(sockListen, (struct sockaddr *)&addr, addrLength) < 0)
+  {
+    LOG_E_BT_CRASH("VirtualHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  if(::listen(sockListen, 5) < 0)
+  {
+    LOG_E_BT_CRASH("VirtualHCIBackend", "Recovery needed", __FILE__, __LINE__, errno);
+  }
+
+  return sockListen;
+}
+
+pair<int, Address> VirtualHCIBackend::accept(Transport transport, int sockListen)
+{
+  struct pollfd pollDesc;
+  pollDesc.fd = sockListen;
+  pollDesc.events = POLLIN;
+
+  int error = poll(&pollDesc, 1, -1);
+  if(error <= 0)
+  {
+    return make_pair(-1, Address());
+  }
+
+  struct sockaddr_un addr;
+  socklen_t addrLength = sizeof(addr);
+  int sockClient = ::accept(sockListen, (struct sockaddr *)&addr, &addrLength);
+
+  Address address;
+  if(sockClient >= 0)
+  {
+    size_t nameOffset = offsetof(struct sockaddr_un, sun_path) + 1;
+    if((addrLength <= nameOffset) || !VirtualMedium::parseConnectName(string(addr.sun_path + 1, addrLength - nameOffset), address))
+    {
+      address = Address(6);
+    }
+  }
+
+  return make_pair(sockClient, address);
+}
+
+uint8_t VirtualHCIBackend::handleCommand(uint16_t opcode, const uint8_t *params, uint8_t length, vector<uint8_t> &reply, uint64_t curTime)
+{
+  switch(opcode)
+  {
+  case cmd_opcode_pack(OGF_HOST_CTL, OCF_RESET):
+    resetState(state_.publicAddress);
+    return 0;
+
+  case cmd_opcode_pack(OGF_HOST_CTL, OCF_WRITE_SCAN_ENABLE):
+    if(length < 1)
+    {
+      return 0x12;
+    }
+    state_.isConnectable = ((params[0] & SCAN_PAGE) != 0);
+    state_.isDiscoverable = ((params[0] & SCAN_INQUIRY) != 0);
+    publish();
+    return 0;
+
+  case cmd_opcode_pack(OGF_HOST_CTL, OCF_WRITE_INQUIRY_MODE):
+    if(length < WRITE_INQUIRY_MODE_CP_SIZE)
+    {
+      return 0x12;
+    }
+    inquiryMode_ = ((const write_inquiry_mode_cp *)params)->mode;
+    return 0;
+
+  case cmd_opcode_pack(OGF_HOST_CTL, OCF_CHANGE_LOCAL_NAME):
+    if(length < CHANGE_LOCAL_NAME_CP_SIZE)
+    {
+      return 0x12;
+    }
+    state_.localName = string((const char *)params, strnlen((const char *)params, HCI_MAX_NAME_LENGTH));
+    publish();
+    return 0;
+
+  case cmd_opcode_pack(OGF_HOST_CTL, OCF_READ_LOCAL_NAME):
+    reply.resize(reply.size() + HCI_MAX_NAME_LENGTH, 0);
+    memcpy(&reply[reply.size() - HCI_MAX_NAME_LENGTH], state_.localName.data(), min<size_t>(state_.localName.size(), HCI_MAX_NAME_LENGTH));
+    return 0;
+
+  case cmd_opcode_pack(OGF_HOST_CTL, OCF_WRITE_EXT_INQUIRY_RESPONSE):
+    if(length < WRITE_EXT_INQUIRY_RESPONSE_CP_SIZE)
+    {
+      return 0x12;
+    }
+    state_.extInquiryResponse.assign(params + 1, params + 1 + HCI_MAX_EIR_LENGTH);
+    publish();
+    return 0;
+
+  case cmd_opcode_pack(OGF_INFO_PARAM, OCF_READ_BD_ADDR):
+    reply.insert(reply.end(), state_.publicAddress.toByteArray(), state_.publicAddress.toByteArray() + 6);
+    return 0;
+
+  case cmd_opcode_pack(OGF_LINK_CTL, OCF_INQUIRY_CANCEL):
+    cancelEvents(Source::Inquiry);
+    return 0;
+
+  case cmd_opcode_pack(OGF_LINK_CTL, OCF_REMOTE_NAME_REQ_CANCEL):
+  {
+    if(length < REMOTE_NAME_REQ_CANCEL_CP_SIZE)
+    {
+      return 0x12;
+    }
+    Address address(6, ((const remote_name_req_cancel_cp *)params)->bdaddr.b);
+    reply.insert(reply.end(), address.toByteArray(), address.toByteArray() + 6);
+    cancelEvents(Source::RemoteName, address);
+    return 0;
+  }
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_RANDOM_ADDRESS):
+    if(length < LE_SET_RANDOM_ADDRESS_CP_SIZE)
+    {
+      return 0x12;
+    }
+    state_.randomAddress = Address(6, ((const le_set_random_address_cp *)params)->bdaddr.b);
+    publish();
+    return 0;
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_ADVERTISING_PARAMETERS):
+  {
+    if(length < LE_SET_ADVERTISING_PARAMETERS_CP_SIZE)
+    {
+      return 0x12;
+    }
+    else if(state_.isAdvertising)
+    {
+      return 0x0C;
+    }
+
+    const le_set_advertising_parameters_cp *param = (const le_set_advertising_parameters_cp *)params;
+    state_.advertType = param->advtype;
+    state_.advertInterval = (btohs(param->min_interval) * 5) / 8;
+    publish();
+    return 0;
+  }
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_ADVERTISING_DATA):
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_SCAN_RESPONSE_DATA):
+  {
+    if((length < 1) || (params[0] > 31) || (length < (1 + params[0])))
+    {
+      return 0x12;
+    }
+
+    vector<uint8_t> &data = (opcode == cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_ADVERTISING_DATA)) ? state_.advertData : state_.responseData;
+    data.assign(params + 1, params + 1 + params[0]);
+    publish();
+    return 0;
+  }
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_ADVERTISE_ENABLE):
+    if(length < 1)
+    {
+      return 0x12;
+    }
+    else if(state_.isAdvertising == (params[0] != 0))
+    {
+      return 0x0C;
+    }
+    state_.isAdvertising = (params[0] != 0);
+    publish();
+    return 0;
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_SCAN_PARAMETERS):
+  {
+    if(length < LE_SET_SCAN_PARAMETERS_CP_SIZE)
+    {
+      return 0x12;
+    }
+    else if(isScanning_)
+    {
+      return 0x0C;
+    }
+
+    const le_set_scan_parameters_cp *param = (const le_set_scan_parameters_cp *)params;
+    scanType_ = param->type;
+    scanWindow_ = (btohs(param->window) * 5) / 8;
+    return 0;
+  }
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_SCAN_ENABLE):
+  {
+    if(length < LE_SET_SCAN_ENABLE_CP_SIZE)
+    {
+      return 0x12;
+    }
+
+    const le_set_scan_enable_cp *param = (const le_set_scan_enable_cp *)params;
+    cancelEvents(Source::Scan);
+    isScanning_ = (param->enable != 0);
+    isExtendedScan_ = false;
+    scanFilterDup_ = (param->filter_dup != 0);
+    if(isScanning_)
+    {
+      scheduleScan(curTime);
+    }
+    return 0;
+  }
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_ADVERTISING_SET_RANDOM_ADDRESS):
+    if(length < LE_SET_ADVERTISING_SET_RANDOM_ADDRESS_CP_SIZE)
+    {
+      return 0x12;
+    }
+    state_.extAdvertAddress = Address(6, ((const le_set_advertising_set_random_address_cp *)params)->bdaddr.b);
+    publish();
+    return 0;
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_ADVERTISING_PARAMETERS):
+  {
+    if(length < LE_SET_EXTENDED_ADVERTISING_PARAMETERS_CP_SIZE)
+    {
+      return 0x12;
+    }
+    else if(state_.isExtAdvertising)
+    {
+      return 0x0C;
+    }
+
+    const le_set_extended_advertising_parameters_cp *param = (const le_set_extended_advertising_parameters_cp *)params;
+    uint32_t minInterval = param->min_interval[0] | (param->min_interval[1] << 8) | (param->min_interval[2] << 16);
+    state_.isExtConnectable = ((btohs(param->properties) & 0x0001) != 0);
+    state_.extAdvertInterval = (minInterval * 5) / 8;
+    publish();
+    return 0;
+  }
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_ADVERTISING_DATA):
+  {
+    const le_set_extended_advertising_data_cp *param = (const le_set_extended_advertising_data_cp *)params;
+    if((length < LE_SET_EXTENDED_ADVERTISING_DATA_CP_SIZE) || (length < (LE_SET_EXTENDED_ADVERTISING_DATA_CP_SIZE + param->length)))
+    {
+      return 0x12;
+    }
+    state_.extAdvertData.assign(param->data, param->data + param->length);
+    publish();
+    return 0;
+  }
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_ADVERTISING_ENABLE):
+    if(length < 1)
+    {
+      return 0x12;
+    }
+    state_.isExtAdvertising = (params[0] != 0);
+    publish();
+    return 0;
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_SCAN_PARAMETERS):
+  {
+    if(length < LE_SET_EXTENDED_SCAN_PARAMETERS_CP_SIZE)
+    {
+      return 0x12;
+    }
+    else if(isScanning_)
+    {
+      return 0x0C;
+    }
+
+    const le_set_extended_scan_parameters_cp *param = (const le_set_extended_scan_parameters_cp *)params;
+    extScanType_ = param->type;
+    extScanWindow_ = (btohs(param->window) * 5) / 8;
+    return 0;
+  }
+
+  case cmd_opcode_pack(OGF_LE_CTL, OCF_LE_SET_EXTENDED_SCAN_ENABLE):
+  {
+    if(length < LE_SET_EXTENDED_SCAN_ENABLE_CP_SIZE)
+    {
+      return 0x12;
+    }
+
+    const le_set_extended_scan_enable_cp *param = (const le_set_extended_scan_enable_cp *)params;
+    cancelEvents(Source::Scan);
+    isScanning_ = (param->enable != 0);
+    isExtendedScan_ = isScanning_;
+    scanFilterDup_ = (param->filter_dup != 0);
+    if(isScanning_)
+    {
+      scheduleExtendedScan(curTime);
+    }
+    return 0;
+  }
+  }
+
+  // Unknown HCI command
+  return 0x01;
+}
+
+void VirtualHCIBackend::resetState(const Address &publicAddress)
+{
+  // Copying first, since this may be the address that is being cleared
+  Address address = publicAddress;
+
+  state_ = VirtualMedium::OnAir();
+  state_.publicAddress = address;
+  state_.randomAddress = Address(6);
+  state_.extAdvertAddress = Address(6);
+
+  inquiryMode_ = 0;
+  isScanning_ = false;
+  isExtendedScan_ = false;
+  numPendingNames_ = 0;
+  events_.clear();
+
+  publish();
+}
+
+void VirtualHCIBackend::publish()
+{
+  medium_->publish(adapterID_, shared_ptr<const VirtualMedium::OnAir>(new VirtualMedium::OnAir(state_)));
+}
+
+void VirtualHCIBackend::scheduleScan(uint64_t curTime)
+{
+  if(replay_)
+  {
+    scheduleReplay(curTime, HCICapture::Session::Scan, Source::Scan, scanWindow_);
+    return;
+  }
+
+  const uint64_t endTime = curTime + scanWindow_;
+
+  vector<VirtualMedium::Neighbour> neighbours = medium_->getNeighbours(adapterID_);
+  for(auto it = neighbours.begin(); it != neighbours.end(); it++)
+  {
+    const VirtualMedium::OnAir &onAir = *it->onAir;
+    if(!onAir.isAdvertising)
+    {
+      continue;
+    }
+
+    // Connectable and scannable undirected adverts can be scanned for more
+    bool isScannable = (scanType_ == BluetoothHCI::Scan::Active) &&
+                       ((onAir.advertType == BluetoothHCI::UndirectedAdvert::Connectable) || (onAir.advertType == BluetoothHCI::UndirectedAdvert::Scannable));
+    uint64_t interval = max<uint64_t>(onAir.advertInterval, 20);
+
+    bool isReported = false;
+    bool isResponded = false;
+    for(uint64_t time = curTime + (uint64_t)(medium_->sampleUniform() * interval); time < endTime; time += interval + (uint64_t)(medium_->sampleUniform() * ADVERT_JITTER))
+    {
+      if(scanFilterDup_ && isReported && (!isScannable || isResponded))
+      {
+        break;
+      }
+
+      if(medium_->sampleLoss())
+      {
+        continue;
+      }
+
+      uint8_t body[2 + LE_ADVERTISING_INFO_SIZE + 31 + 1];
+      le_advertising_info *info = (le_advertising_info *)(body + 2);
+      body[0] = EVT_LE_ADVERTISING_REPORT;
+      body[1] = 1;
+      info->bdaddr_type = LE_RANDOM_ADDRESS;
+      memcpy(info->bdaddr.b, onAir.randomAddress.toByteArray(), 6);
+
+      if(!scanFilterDup_ || !isReported)
+      {
+        info->evt_type = onAir.advertType;
+        info->length = onAir.advertData.size();
+        memcpy(info->data, onAir.advertData.data(), info->length);
+        info->data[info->length] = medium_->sampleRSSI(it->distance);
+
+        queueEvent(time, Source::Scan, onAir.randomAddress, EVT_LE_META_EVENT, body, 2 + LE_ADVERTISING_INFO_SIZE + info->length + 1);
+        isReported = true;
+      }
+
+      if(isScannable && (!scanFilterDup_ || !isResponded) && !medium_->sampleLoss())
+      {
+        info->evt_type = 0x04;
+        info->length = onAir.responseData.size();
+        memcpy(info->data, onAir.responseData.data(), info->length);
+        info->data[info->length] = medium_->sampleRSSI(it->distance);
+
+        queueEvent(time + 1, Source::Scan, onAir.randomAddress, EVT_LE_META_EVENT, body, 2 + LE_ADVERTISING_INFO_SIZE + info->length + 1);
+        isResponded = true;
+      }
+    }
+  }
+}
+
+void VirtualHCIBackend::scheduleExtendedScan(uint64_t curTime)
+{
+  if(replay_)
+  {
+    scheduleReplay(curTime, HCICapture::Session::ExtendedScan, Source::Scan, extScanWindow_);
+    return;
+  }
+
+  const uint64_t endTime = curTime + extScanWindow_;
+
+  // Only extended adverts are reported, since all radios in a simulation use
+  // the same version (and so the same kind of advert)
+  vector<VirtualMedium::Neighbour> neighbours = medium_->getNeighbours(adapterID_);
+  for(auto it = neighbours.begin(); it != neighbours.end(); it++)
+  {
+    const VirtualMedium::OnAir &onAir = *it->onAir;
+    if(!onAir.isExtAdvertising)
+    {
+      continue;
+    }
+
+    uint64_t interval = max<uint64_t>(onAir.extAdvertInterval, 20);
+
+    bool isReported = false;
+    for(uint64_t time = curTime + (uint64_t)(medium_->sampleUniform() * interval); time < endTime; time += interval + (uint64_t)(medium_->sampleUniform() * ADVERT_JITTER))
+    {
+      if(scanFilterDup_ && isReported)
+      {
+        break;
+      }
+
+      if(medium_->sampleLoss())
+      {
+        continue;
+      }
+
+      // Payloads longer than one event are split across several, each but
+      // the last marked as having more to come
+      int8_t rssi = medium_->sampleRSSI(it->distance);
+      size_t pos = 0;
+      do
+      {
+        size_t fragmentSize = min<size_t>(onAir.extAdvertData.size() - pos, (size_t)EXT_FRAGMENT_SIZE);
+        bool hasMore = ((pos + fragmentSize) < onAir.extAdvertData.size());
+
+        uint8_t body[2 + LE_EXTENDED_ADVERTISING_INFO_SIZE + EXT_FRAGMENT_SIZE];
+        memset(body, 0, 2 + LE_EXTENDED_ADVERTISING_INFO_SIZE);
+        le_extended_advertising_info *info = (le_extended_advertising_info *)(body + 2);
+        body[0] = EVT_LE_EXTENDED_ADVERTISING_REPORT;
+        body[1] = 1;
+        info->evt_type = htobs((onAir.isExtConnectable ? 0x0001 : 0x0000) | (hasMore ? (1 << 5) : 0));
+        info->bdaddr_type = LE_RANDOM_ADDRESS;
+        memcpy(info->bdaddr.b, onAir.extAdvertAddress.toByteArray(), 6);
+        info->primary_phy = 0x01;
+        info->secondary_phy = 0x01;
+        info->tx_power = 127;
+        info->rssi = rssi;
+        info->length = fragmentSize;
+        memcpy(info->data, onAir.extAdvertData.data() + pos, fragmentSize);
+
+        queueEvent(time, Source::Scan, onAir.extAdvertAddress, EVT_LE_META_EVENT, body, 2 + LE_EXTENDED_ADVERTISING_INFO_SIZE + fragmentSize);
+        pos += fragmentSize;
+      }
+      while(pos < onAir.extAdvertData.size());
+
+      isReported = true;
+    }
+  }
+}
+
+void VirtualHCIBackend::scheduleInquiry(uint64_t curTime, uint8_t periods)
+{
+  const uint64_t duration = periods * 1280;
+
+  // Only extended results are generated, which is all that is read from the
+  // event stream (standard inquiries go through inquiry() instead)
+  if(replay_)
+  {
+    scheduleReplay(curTime, HCICapture::Session::Inquiry, Source::Inquiry, duration);
+  }
+  else if(inquiryMode_ == BluetoothHCI::InquiryMode::WithRSSIAndEIR)
+  {
+    vector<VirtualMedium::Neighbour> neighbours = medium_->getNeighbours(adapterID_);
+    for(auto it = neighbours.begin(); it != neighbours.end(); it++)
+    {
+      const VirtualMedium::OnAir &onAir = *it->onAir;
+      if(!onAir.isDiscoverable || medium_->sampleLoss())
+      {
+        continue;
+      }
+
+      uint8_t body[1 + EXTENDED_INQUIRY_INFO_SIZE];
+      memset(body, 0, sizeof(body));
+      extended_inquiry_info *info = (extended_inquiry_info *)(body + 1);
+      body[0] = 1;
+      memcpy(info->bdaddr.b, onAir.publicAddress.toByteArray(), 6);
+      info->pscan_rep_mode = 0x01;
+      info->rssi = medium_->sampleRSSI(it->distance);
+      memcpy(info->data, onAir.extInquiryResponse.data(), min<size_t>(onAir.extInquiryResponse.size(), HCI_MAX_EIR_LENGTH));
+
+      uint64_t time = curTime + (uint64_t)(medium_->sampleUniform() * duration);
+      queueEvent(time, Source::Inquiry, onAir.publicAddress, EVT_EXTENDED_INQUIRY_RESULT, body, sizeof(body));
+    }
+  }
+
+  uint8_t status = 0;
+  queueEvent(curTime + duration, Source::Inquiry, Address(6), EVT_INQUIRY_COMPLETE, &status, 1);
+}
+
+void VirtualHCIBackend::scheduleRemoteName(uint64_t curTime, const Address &address)
+{
+  evt_remote_name_req_complete complete;
+  bool isFound = lookupName(address, complete);
+
+  queueEvent(curTime + (isFound ? NAME_LATENCY : PAGE_TIMEOUT), Source::RemoteName, address, EVT_REMOTE_NAME_REQ_COMPLETE,
+             (const uint8_t *)&complete, EVT_REMOTE_NAME_REQ_COMPLETE_SIZE);
+  numPendingNames_++;
+}
+
+void VirtualHCIBackend::scheduleReplay(uint64_t curTime, HCICapture::Session session, Source source, uint64_t duration)
+{
+  vector<HCIReplay::Event> events;
+  if(!replay_->nextSession(session, events))
+  {
+    return;
+  }
+
+  // Anything captured after this scan (or inquiry) would have ended is lost,
+  // just as it would be from the medium
+  for(auto it = events.begin(); (it != events.end()) && (it->offset < duration); it++)
+  {
+    PendingEvent pending;
+    pending.source = source;
+    pending.address = Address(6);
+    pending.packet.swap(it->packet);
+
+    events_.insert(make_pair(curTime + it->offset, pending));
+  }
+}
+
+void VirtualHCIBackend::checkReplay()
+{
+  if(!replay_)
+  {
+    return;
+  }
+
+  for(auto it = events_.begin(); it != events_.end(); it++)
+  {
+    if((it->second.source == Source::Scan) || (it->second.source == Source::Inquiry))
+    {
+      return;
+    }
+  }
+
+  replay_->finishSession();
+}
+
+void VirtualHCIBackend::cancelEvents(Source source)
+{
+  for(auto it = events_.begin(); it != events_.end();)
+  {
+    if(it->second.source == source)
+    {
+      if(source == Source::RemoteName)
+      {
+        numPendingNames_--;
+      }
+      it = events_.erase(it);
+    }
+    else
+    {
+      it++;
+    }
+  }
+}
+
+void VirtualHCIBackend::cancelEvents(Source source, const Address &address)
+{
+  for(auto it = events_.begin(); it != events_.end();)
+  {
+    if((it->second.source == source) && (it->second.address == address))
+    {
+      if(source == Source::RemoteName)
+      {
+        numPendingNames_--;
+      }
+      it = events_.erase(it);
+    }
+    else
+    {
+      it++;
+    }
+  }
+}
+
+void VirtualHCIBackend::queueEvent(uint64_t time, Source source, const Address &address, uint8_t event, const uint8_t *body, size_t length)
+{
+  PendingEvent pending;
+  pending.source = source;
+  pending.address = address;
+  pending.packet.resize(1 + HCI_EVENT_HDR_SIZE + length);
+  pending.packet[0] = HCI_EVENT_PKT;
+  pending.packet[1] = event;
+  pending.packet[2] = length;
+  memcpy(&pending.packet[1 + HCI_EVENT_HDR_SIZE], body, length);
+
+  events_.insert(make_pair(time, pending));
+}
+
+void VirtualHCIBackend::queueCommandComplete(uint64_t time, uint16_t opcode, uint8_t status, const vector<uint8_t> &reply)
+{
+  vector<uint8_t> body(EVT_CMD_COMPLETE_SIZE + 1);
+  evt_cmd_complete *complete = (evt_cmd_complete *)body.data();
+  complete->ncmd = 1;
+  complete->opcode = htobs(opcode);
+  body[EVT_CMD_COMPLETE_SIZE] = status;
+  body.insert(body.end(), reply.begin(), reply.end());
+
+  queueEvent(time, Source::Command, Address(6), EVT_CMD_COMPLETE, body.data(), body.size());
+}
+
+void VirtualHCIBackend::queueCommandStatus(uint64_t time, uint16_t opcode, uint8_t status)
+{
+  evt_cmd_status commandStatus;
+  commandStatus.status = status;
+  commandStatus.ncmd = 1;
+  commandStatus.opcode = htobs(opcode);
+
+  queueEvent(time, Source::Command, Address(6), EVT_CMD_STATUS, (const uint8_t *)&commandStatus, EVT_CMD_STATUS_SIZE);
+}
+
+bool VirtualHCIBackend::lookupName(const Address &address, evt_remote_name_req_complete &complete)
+{
+  memset(&complete, 0, sizeof(complete));
+  memcpy(complete.bdaddr.b, address.toByteArray(), 6);
+
+  // Names are read over a connection, and so need the device to be page
+  // scanning (and the page not to be lost)
+  shared_ptr<const VirtualMedium::OnAir> onAir;
+  if((medium_->findNeighbour(adapterID_, address, Transport::RFCOMM, &onAir) < 0) || !onAir->isConnectable || medium_->sampleLoss())
+  {
+    complete.status = HCI_PAGE_TIMEOUT;
+    return false;
+  }
+
+  complete.status = 0;
+  memcpy(complete.name, onAir->localName.data(), min<size_t>(onAir->localName.size(), HCI_MAX_NAME_LENGTH));
+  return true;
+}
+
+int VirtualHCIBackend::bindConnectName(int sock, const Address &address)
+{
+  string name = medium_->getConnectName(address);
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path + 1, name.data(), min(name.size(), sizeof(addr.sun_path) - 1));
+  socklen_t addrLength = offsetof(struct sockaddr_un, sun_path) + 1 + min(name.size(), sizeof(addr.sun_path) - 1);
+
+  return bind(sock, (struct sockaddr *)&addr, addrLength);
+}
@@ -0,0 +1,227 @@
+#include "VirtualMedium.h"
+
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <unistd.h>
+
+#include "VirtualHCIBackend.h"
+
+using namespace std;
+
+VirtualMedium::VirtualMedium(const Config &config)
+   : config_(config),
+     nodes_(),
+     random_(config.seed),
+     rssiNoise_(0, config.rssiDeviation),
+     uniform_(0, 1),
+     namePrefix_(),
+     numConnects_(0),
+     mutex_()
+{
+  stringstream prefixSS;
+  prefixSS << "sddr-sim-" << getpid();
+  namePrefix_ = prefixSS.str();
+}
+
+VirtualMedium::Config VirtualMedium::getDefaultConfig()
+{
+  Config config;
+  config.areaSize = 30;
+  config.range = 20;
+  config.lossRate = 0.1;
+  config.rssiAtOneMetre = -45;
+  config.pathLossExponent = 2.5;
+  config.rssiDeviation = 4;
+  config.seed = 0;
+
+  return config;
+}
+
+shared_ptr<HCIBackend> VirtualMedium::createBackend(int adapterID)
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+
+    if(adapterID >= nodes_.size())
+    {
+      nodes_.resize(adapterID + 1, Node());
+    }
+
+    Node &node = nodes_[adapterID];
+    node.isPresent = true;
+    node.x = uniform_(random_) * config_.areaSize;
+    node.y = uniform_(random_) * config_.areaSize;
+    node.onAir.reset(new OnAir());
+  }
+
+  return shared_ptr<HCIBackend>(new VirtualHCIBackend(shared_from_this(), adapterID));
+}
+
+HCIBackend::Factory VirtualMedium::getFactory()
+{
+  shared_ptr<VirtualMedium> medium = shared_from_this();
+  return [medium](int adapterID) { return medium->createBackend(adapterID); };
+}
+
+void VirtualMedium::setPosition(int adapterID, double x, double y)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if(adapterID < nodes_.size())
+  {
+    nodes_[adapterID].x = x;
+    nodes_[adapterID].y = y;
+  }
+}
+
+void VirtualMedium::publish(int adapterID, shared_ptr<const OnAir> onAir)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if(adapterID < nodes_.size())
+  {
+    nodes_[adapterID].onAir = onAir;
+  }
+}
+
+vector<VirtualMedium::Neighbour> VirtualMedium::getNeighbours(int adapterID) const
+{
+  vector<Neighbour> neighbours;
+
+  lock_guard<mutex> lock(mutex_);
+
+  if(adapterID >= nodes_.size())
+  {
+    return neighbours;
+  }
+
+  const Node &self = nodes_[adapterID];
+  for(size_t n = 0; n < nodes_.size(); n++)
+  {
+    if((n == adapterID) || !nodes_[n].isPresent)
+    {
+      continue;
+    }
+
+    double distance = getDistance(self, nodes_[n]);
+    if(distance <= config_.range)
+    {
+      Neighbour neighbour;
+      neighbour.adapterID = n;
+      neighbour.distance = distance;
+      neighbour.onAir = nodes_[n].onAir;
+      neighbours.push_back(neighbour);
+    }
+  }
+
+  return neighbours;
+}
+
+int VirtualMedium::findNeighbour(int adapterID, const Address &address, HCIBackend::Transport transport, shared_ptr<const OnAir> *onAir) const
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if(adapterID >= nodes_.size())
+  {
+    return -1;
+  }
+
+  const Node &self = nodes_[adapterID];
+  for(size_t n = 0; n < nodes_.size(); n++)
+  {
+    if((n == adapterID) || !nodes_[n].isPresent || (getDistance(self, nodes_[n]) > config_.range))
+    {
+      continue;
+    }
+
+    const OnAir &other = *nodes_[n].onAir;
+    bool isMatch;
+    if(transport == HCIBackend::Transport::RFCOMM)
+    {
+      isMatch = (other.publicAddress == address);
+    }
+    else
+    {
+      isMatch = (other.isAdvertising && (other.randomAddress == address)) || (other.isExtAdvertising && (other.extAdvertAddress == address));
+    }
+
+    if(isMatch)
+    {
+      if(onAir != NULL)
+      {
+        *onAir = nodes_[n].onAir;
+      }
+      return n;
+    }
+  }
+
+  return -1;
+}
+
+int8_t VirtualMedium::sampleRSSI(double distance)
+{
+  // Log-distance path loss, with log-normal shadowing
+  double rssi = config_.rssiAtOneMetre - (10 * config_.pathLossExponent * log10(max(distance, 0.1)));
+
+  lock_guard<mutex> lock(mutex_);
+  rssi += rssiNoise_(random_);
+
+  return (int8_t)max(-127.0, min(20.0, round(rssi)));
+}
+
+bool VirtualMedium::sampleLoss()
+{
+  return (sampleUniform() < config_.lossRate);
+}
+
+double VirtualMedium::sampleUniform()
+{
+  lock_guard<mutex> lock(mutex_);
+  return uniform_(random_);
+}
+
+string VirtualMedium::getListenName(int adapterID, HCIBackend::Transport transport, uint8_t port) const
+{
+  stringstream nameSS;
+  nameSS << namePrefix_ << "-L-" << adapterID << "-" << (int)transport << "-" << (int)port;
+  return nameSS.str();
+}
+
+string VirtualMedium::getConnectName(const Address &address)
+{
+  size_t connectNum;
+  {
+    lock_guard<mutex> lock(mutex_);
+    connectNum = numConnects_++;
+  }
+
+  stringstream nameSS;
+  nameSS << namePrefix_ << "-C-" << address.toString() << "-" << connectNum;
+  return nameSS.str();
+}
+
+bool VirtualMedium::parseConnectName(const string &name, Address &address)
+{
+  size_t pos = name.find("-C-");
+  if(pos == string::npos)
+  {
+    return false;
+  }
+
+  uint8_t value[6];
+  if(sscanf(name.c_str() + pos + 3, "%2hhx:%2hhx:%2hhx:%2hhx:%2hhx:%2hhx", &value[0], &value[1], &value[2], &value[3], &value[4], &value[5]) != 6)
+  {
+    return false;
+  }
+
+  address = Address(6, value);
+  return true;
+}
+
+double VirtualMedium::getDistance(const Node &a, const Node &b) const
+{
+  double dx = a.x - b.x;
+  double dy = a.y - b.y;
+  return sqrt((dx * dx) + (dy * dy));
+}
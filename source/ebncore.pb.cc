@@ -36,10 +36,29 @@ const ::google::protobuf::internal::GeneratedMessageReflection*
 const ::google::protobuf::Descriptor* Event_EncounterEvent_RSSIEvent_descriptor_ = NULL;
 const ::google::protobuf::internal::GeneratedMessageReflection*
   Event_EncounterEvent_RSSIEvent_reflection_ = NULL;
+const ::google::protobuf::Descriptor* Event_EncounterEvent_Milestone_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  Event_EncounterEvent_Milestone_reflection_ = NULL;
+const ::google::protobuf::EnumDescriptor* Event_EncounterEvent_Milestone_StageType_descriptor_ = NULL;
 const ::google::protobuf::EnumDescriptor* Event_EncounterEvent_EventType_descriptor_ = NULL;
 const ::google::protobuf::Descriptor* Event_SleepEvent_descriptor_ = NULL;
 const ::google::protobuf::internal::GeneratedMessageReflection*
   Event_SleepEvent_reflection_ = NULL;
+const ::google::protobuf::Descriptor* Event_MetricsRequestEvent_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  Event_MetricsRequestEvent_reflection_ = NULL;
+const ::google::protobuf::Descriptor* Event_MetricsEvent_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  Event_MetricsEvent_reflection_ = NULL;
+const ::google::protobuf::Descriptor* Event_MetricsEvent_Counter_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  Event_MetricsEvent_Counter_reflection_ = NULL;
+const ::google::protobuf::Descriptor* Event_MetricsEvent_Histogram_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  Event_MetricsEvent_Histogram_reflection_ = NULL;
+const ::google::protobuf::Descriptor* Event_MetricsEvent_Histogram_Bucket_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  Event_MetricsEvent_Histogram_Bucket_reflection_ = NULL;
 
 }  // namespace
 
@@ -51,10 +70,12 @@ void protobuf_AssignDesc_ebncore_2eproto() {
       "ebncore.proto");
   GOOGLE_CHECK(file != NULL);
   Event_descriptor_ = file->message_type(0);
-  static const int Event_offsets_[3] = {
+  static const int Event_offsets_[5] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event, linkabilityevent_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event, encounterevent_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event, sleepevent_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event, metricsrequestevent_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event, metricsevent_),
   };
   Event_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -100,7 +121,7 @@ void protobuf_AssignDesc_ebncore_2eproto() {
       sizeof(Event_LinkabilityEvent_Entry));
   Event_LinkabilityEvent_Entry_ModeType_descriptor_ = Event_LinkabilityEvent_Entry_descriptor_->enum_type(0);
   Event_EncounterEvent_descriptor_ = Event_descriptor_->nested_type(1);
-  static const int Event_EncounterEvent_offsets_[9] = {
+  static const int Event_EncounterEvent_offsets_[10] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent, type_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent, time_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent, id_),
@@ -110,6 +131,7 @@ void protobuf_AssignDesc_ebncore_2eproto() {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent, sharedsecrets_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent, pkid_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent, matchingsetupdated_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent, milestones_),
   };
   Event_EncounterEvent_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -138,6 +160,24 @@ void protobuf_AssignDesc_ebncore_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(Event_EncounterEvent_RSSIEvent));
+  Event_EncounterEvent_Milestone_descriptor_ = Event_EncounterEvent_descriptor_->nested_type(1);
+  static const int Event_EncounterEvent_Milestone_offsets_[3] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent_Milestone, stage_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent_Milestone, time_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent_Milestone, numadverts_),
+  };
+  Event_EncounterEvent_Milestone_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      Event_EncounterEvent_Milestone_descriptor_,
+      Event_EncounterEvent_Milestone::default_instance_,
+      Event_EncounterEvent_Milestone_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent_Milestone, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_EncounterEvent_Milestone, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(Event_EncounterEvent_Milestone));
+  Event_EncounterEvent_Milestone_StageType_descriptor_ = Event_EncounterEvent_Milestone_descriptor_->enum_type(0);
   Event_EncounterEvent_EventType_descriptor_ = Event_EncounterEvent_descriptor_->enum_type(0);
   Event_SleepEvent_descriptor_ = Event_descriptor_->nested_type(2);
   static const int Event_SleepEvent_offsets_[1] = {
@@ -154,6 +194,92 @@ void protobuf_AssignDesc_ebncore_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(Event_SleepEvent));
+  Event_MetricsRequestEvent_descriptor_ = Event_descriptor_->nested_type(3);
+  static const int Event_MetricsRequestEvent_offsets_[1] = {
+  };
+  Event_MetricsRequestEvent_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      Event_MetricsRequestEvent_descriptor_,
+      Event_MetricsRequestEvent::default_instance_,
+      Event_MetricsRequestEvent_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsRequestEvent, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsRequestEvent, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(Event_MetricsRequestEvent));
+  Event_MetricsEvent_descriptor_ = Event_descriptor_->nested_type(4);
+  static const int Event_MetricsEvent_offsets_[3] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent, time_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent, counters_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent, histograms_),
+  };
+  Event_MetricsEvent_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      Event_MetricsEvent_descriptor_,
+      Event_MetricsEvent::default_instance_,
+      Event_MetricsEvent_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(Event_MetricsEvent));
+  Event_MetricsEvent_Counter_descriptor_ = Event_MetricsEvent_descriptor_->nested_type(0);
+  static const int Event_MetricsEvent_Counter_offsets_[2] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Counter, name_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Counter, value_),
+  };
+  Event_MetricsEvent_Counter_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      Event_MetricsEvent_Counter_descriptor_,
+      Event_MetricsEvent_Counter::default_instance_,
+      Event_MetricsEvent_Counter_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Counter, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Counter, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(Event_MetricsEvent_Counter));
+  Event_MetricsEvent_Histogram_descriptor_ = Event_MetricsEvent_descriptor_->nested_type(1);
+  static const int Event_MetricsEvent_Histogram_offsets_[9] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, name_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, count_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, sum_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, min_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, max_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, p50_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, p90_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, p99_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, buckets_),
+  };
+  Event_MetricsEvent_Histogram_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      Event_MetricsEvent_Histogram_descriptor_,
+      Event_MetricsEvent_Histogram::default_instance_,
+      Event_MetricsEvent_Histogram_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(Event_MetricsEvent_Histogram));
+  Event_MetricsEvent_Histogram_Bucket_descriptor_ = Event_MetricsEvent_Histogram_descriptor_->nested_type(0);
+  static const int Event_MetricsEvent_Histogram_Bucket_offsets_[2] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram_Bucket, lowerbound_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram_Bucket, count_),
+  };
+  Event_MetricsEvent_Histogram_Bucket_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      Event_MetricsEvent_Histogram_Bucket_descriptor_,
+      Event_MetricsEvent_Histogram_Bucket::default_instance_,
+      Event_MetricsEvent_Histogram_Bucket_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram_Bucket, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Event_MetricsEvent_Histogram_Bucket, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(Event_MetricsEvent_Histogram_Bucket));
 }
 
 namespace {
@@ -176,8 +302,20 @@ void protobuf_RegisterTypes(const ::std::string&) {
     Event_EncounterEvent_descriptor_, &Event_EncounterEvent::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
     Event_EncounterEvent_RSSIEvent_descriptor_, &Event_EncounterEvent_RSSIEvent::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    Event_EncounterEvent_Milestone_descriptor_, &Event_EncounterEvent_Milestone::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
     Event_SleepEvent_descriptor_, &Event_SleepEvent::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    Event_MetricsRequestEvent_descriptor_, &Event_MetricsRequestEvent::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    Event_MetricsEvent_descriptor_, &Event_MetricsEvent::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    Event_MetricsEvent_Counter_descriptor_, &Event_MetricsEvent_Counter::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    Event_MetricsEvent_Histogram_descriptor_, &Event_MetricsEvent_Histogram::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    Event_MetricsEvent_Histogram_Bucket_descriptor_, &Event_MetricsEvent_Histogram_Bucket::default_instance());
 }
 
 }  // namespace
@@ -193,8 +331,20 @@ void protobuf_ShutdownFile_ebncore_2eproto() {
   delete Event_EncounterEvent_reflection_;
   delete Event_EncounterEvent_RSSIEvent::default_instance_;
   delete Event_EncounterEvent_RSSIEvent_reflection_;
+  delete Event_EncounterEvent_Milestone::default_instance_;
+  delete Event_EncounterEvent_Milestone_reflection_;
   delete Event_SleepEvent::default_instance_;
   delete Event_SleepEvent_reflection_;
+  delete Event_MetricsRequestEvent::default_instance_;
+  delete Event_MetricsRequestEvent_reflection_;
+  delete Event_MetricsEvent::default_instance_;
+  delete Event_MetricsEvent_reflection_;
+  delete Event_MetricsEvent_Counter::default_instance_;
+  delete Event_MetricsEvent_Counter_reflection_;
+  delete Event_MetricsEvent_Histogram::default_instance_;
+  delete Event_MetricsEvent_Histogram_reflection_;
+  delete Event_MetricsEvent_Histogram_Bucket::default_instance_;
+  delete Event_MetricsEvent_Histogram_Bucket_reflection_;
 }
 
 void protobuf_AddDesc_ebncore_2eproto() {
@@ -204,28 +354,48 @@ void protobuf_AddDesc_ebncore_2eproto() {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
-    "\n\rebncore.proto\022\007EbNCore\"\221\006\n\005Event\0229\n\020li"
+    "\n\rebncore.proto\022\007EbNCore\"\277\014\n\005Event\0229\n\020li"
     "nkabilityEvent\030\001 \001(\0132\037.EbNCore.Event.Lin"
     "kabilityEvent\0225\n\016encounterEvent\030\002 \001(\0132\035."
     "EbNCore.Event.EncounterEvent\022-\n\nsleepEve"
-    "nt\030\003 \001(\0132\031.EbNCore.Event.SleepEvent\032\322\001\n\020"
-    "LinkabilityEvent\0226\n\007entries\030\001 \003(\0132%.EbNC"
-    "ore.Event.LinkabilityEvent.Entry\032\205\001\n\005Ent"
-    "ry\022\021\n\tlinkValue\030\001 \002(\014\022<\n\004mode\030\002 \002(\0162..Eb"
-    "NCore.Event.LinkabilityEvent.Entry.ModeT"
-    "ype\"+\n\010ModeType\022\n\n\006Listen\020\000\022\023\n\017AdvertAnd"
-    "Listen\020\001\032\361\002\n\016EncounterEvent\0225\n\004type\030\001 \002("
-    "\0162\'.EbNCore.Event.EncounterEvent.EventTy"
-    "pe\022\014\n\004time\030\002 \002(\004\022\n\n\002id\030\003 \002(\005\022\017\n\007address\030"
-    "\004 \002(\t\022;\n\nrssiEvents\030\005 \003(\0132\'.EbNCore.Even"
-    "t.EncounterEvent.RSSIEvent\022\023\n\013matchingSe"
-    "t\030\006 \003(\014\022\025\n\rsharedSecrets\030\007 \003(\014\022\014\n\004pkid\030\010"
-    " \002(\004\022\032\n\022matchingSetUpdated\030\t \002(\010\032\'\n\tRSSI"
-    "Event\022\014\n\004time\030\001 \002(\004\022\014\n\004rssi\030\002 \002(\021\"A\n\tEve"
-    "ntType\022\024\n\020UnconfirmedStart\020\003\022\t\n\005Start\020\000\022"
-    "\n\n\006Update\020\001\022\007\n\003End\020\002\032\036\n\nSleepEvent\022\020\n\010du"
-    "ration\030\001 \002(\004B&\n\026org.mpisws.fog.ebncoreB\014"
-    "EbNCoreProto", 852);
+    "nt\030\003 \001(\0132\031.EbNCore.Event.SleepEvent\022\?\n\023m"
+    "etricsRequestEvent\030\004 \001(\0132\".EbNCore.Event"
+    ".MetricsRequestEvent\0221\n\014metricsEvent\030\005 \001"
+    "(\0132\033.EbNCore.Event.MetricsEvent\032\322\001\n\020Link"
+    "abilityEvent\0226\n\007entries\030\001 \003(\0132%.EbNCore."
+    "Event.LinkabilityEvent.Entry\032\205\001\n\005Entry\022\021"
+    "\n\tlinkValue\030\001 \002(\014\022<\n\004mode\030\002 \002(\0162..EbNCor"
+    "e.Event.LinkabilityEvent.Entry.ModeType\""
+    "+\n\010ModeType\022\n\n\006Listen\020\000\022\023\n\017AdvertAndList"
+    "en\020\001\032\366\004\n\016EncounterEvent\0225\n\004type\030\001 \002(\0162\'."
+    "EbNCore.Event.EncounterEvent.EventType\022\014"
+    "\n\004time\030\002 \002(\004\022\n\n\002id\030\003 \002(\005\022\017\n\007address\030\004 \002("
+    "\t\022;\n\nrssiEvents\030\005 \003(\0132\'.EbNCore.Event.En"
+    "counterEvent.RSSIEvent\022\023\n\013matchingSet\030\006 "
+    "\003(\014\022\025\n\rsharedSecrets\030\007 \003(\014\022\014\n\004pkid\030\010 \002(\004"
+    "\022\032\n\022matchingSetUpdated\030\t \002(\010\022;\n\nmileston"
+    "es\030\n \003(\0132\'.EbNCore.Event.EncounterEvent."
+    "Milestone\032\'\n\tRSSIEvent\022\014\n\004time\030\001 \002(\004\022\014\n\004"
+    "rssi\030\002 \002(\021\032\305\001\n\tMilestone\022@\n\005stage\030\001 \002(\0162"
+    "1.EbNCore.Event.EncounterEvent.Milestone"
+    ".StageType\022\014\n\004time\030\002 \002(\004\022\022\n\nnumAdverts\030\003"
+    " \002(\r\"T\n\tStageType\022\r\n\tDHDecoded\020\000\022\022\n\016Secr"
+    "etComputed\020\001\022\025\n\021MatchingConverged\020\002\022\r\n\tC"
+    "onfirmed\020\003\"A\n\tEventType\022\024\n\020UnconfirmedSt"
+    "art\020\003\022\t\n\005Start\020\000\022\n\n\006Update\020\001\022\007\n\003End\020\002\032\036\n"
+    "\nSleepEvent\022\020\n\010duration\030\001 \002(\004\032\025\n\023Metrics"
+    "RequestEvent\032\233\003\n\014MetricsEvent\022\014\n\004time\030\001 "
+    "\002(\004\0225\n\010counters\030\002 \003(\0132#.EbNCore.Event.Me"
+    "tricsEvent.Counter\0229\n\nhistograms\030\003 \003(\0132%"
+    ".EbNCore.Event.MetricsEvent.Histogram\032&\n"
+    "\007Counter\022\014\n\004name\030\001 \002(\t\022\r\n\005value\030\002 \002(\004\032\342\001"
+    "\n\tHistogram\022\014\n\004name\030\001 \002(\t\022\r\n\005count\030\002 \002(\004"
+    "\022\013\n\003sum\030\003 \002(\004\022\013\n\003min\030\004 \002(\004\022\013\n\003max\030\005 \002(\004\022"
+    "\013\n\003p50\030\006 \002(\004\022\013\n\003p90\030\007 \002(\004\022\013\n\003p99\030\010 \002(\004\022="
+    "\n\007buckets\030\t \003(\0132,.EbNCore.Event.MetricsE"
+    "vent.Histogram.Bucket\032+\n\006Bucket\022\022\n\nlower"
+    "Bound\030\001 \002(\004\022\r\n\005count\030\002 \002(\004B&\n\026org.mpisws"
+    ".fog.ebncoreB\014EbNCoreProto", 1666);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "ebncore.proto", &protobuf_RegisterTypes);
   Event::default_instance_ = new Event();
@@ -233,13 +403,25 @@ void protobuf_AddDesc_ebncore_2eproto() {
   Event_LinkabilityEvent_Entry::default_instance_ = new Event_LinkabilityEvent_Entry();
   Event_EncounterEvent::default_instance_ = new Event_EncounterEvent();
   Event_EncounterEvent_RSSIEvent::default_instance_ = new Event_EncounterEvent_RSSIEvent();
+  Event_EncounterEvent_Milestone::default_instance_ = new Event_EncounterEvent_Milestone();
   Event_SleepEvent::default_instance_ = new Event_SleepEvent();
+  Event_MetricsRequestEvent::default_instance_ = new Event_MetricsRequestEvent();
+  Event_MetricsEvent::default_instance_ = new Event_MetricsEvent();
+  Event_MetricsEvent_Counter::default_instance_ = new Event_MetricsEvent_Counter();
+  Event_MetricsEvent_Histogram::default_instance_ = new Event_MetricsEvent_Histogram();
+  Event_MetricsEvent_Histogram_Bucket::default_instance_ = new Event_MetricsEvent_Histogram_Bucket();
   Event::default_instance_->InitAsDefaultInstance();
   Event_LinkabilityEvent::default_instance_->InitAsDefaultInstance();
   Event_LinkabilityEvent_Entry::default_instance_->InitAsDefaultInstance();
   Event_EncounterEvent::default_instance_->InitAsDefaultInstance();
   Event_EncounterEvent_RSSIEvent::default_instance_->InitAsDefaultInstance();
+  Event_EncounterEvent_Milestone::default_instance_->InitAsDefaultInstance();
   Event_SleepEvent::default_instance_->InitAsDefaultInstance();
+  Event_MetricsRequestEvent::default_instance_->InitAsDefaultInstance();
+  Event_MetricsEvent::default_instance_->InitAsDefaultInstance();
+  Event_MetricsEvent_Counter::default_instance_->InitAsDefaultInstance();
+  Event_MetricsEvent_Histogram::default_instance_->InitAsDefaultInstance();
+  Event_MetricsEvent_Histogram_Bucket::default_instance_->InitAsDefaultInstance();
   ::google::protobuf::internal::OnShutdown(&protobuf_ShutdownFile_ebncore_2eproto);
 }
 
@@ -1016,105 +1198,106 @@ void Event_EncounterEvent_RSSIEvent::Swap(Event_EncounterEvent_RSSIEvent* other)
 
 // -------------------------------------------------------------------
 
+const ::google::protobuf::EnumDescriptor* Event_EncounterEvent_Milestone_StageType_descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return Event_EncounterEvent_Milestone_StageType_descriptor_;
+}
+bool Event_EncounterEvent_Milestone_StageType_IsValid(int value) {
+  switch(value) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+      return true;
+    default:
+      return false;
+  }
+}
+
 #ifndef _MSC_VER
-const int Event_EncounterEvent::kTypeFieldNumber;
-const int Event_EncounterEvent::kTimeFieldNumber;
-const int Event_EncounterEvent::kIdFieldNumber;
-const int Event_EncounterEvent::kAddressFieldNumber;
-const int Event_EncounterEvent::kRssiEventsFieldNumber;
-const int Event_EncounterEvent::kMatchingSetFieldNumber;
-const int Event_EncounterEvent::kSharedSecretsFieldNumber;
-const int Event_EncounterEvent::kPkidFieldNumber;
-const int Event_EncounterEvent::kMatchingSetUpdatedFieldNumber;
+const Event_EncounterEvent_Milestone_StageType Event_EncounterEvent_Milestone::DHDecoded;
+const Event_EncounterEvent_Milestone_StageType Event_EncounterEvent_Milestone::SecretComputed;
+const Event_EncounterEvent_Milestone_StageType Event_EncounterEvent_Milestone::MatchingConverged;
+const Event_EncounterEvent_Milestone_StageType Event_EncounterEvent_Milestone::Confirmed;
+const Event_EncounterEvent_Milestone_StageType Event_EncounterEvent_Milestone::StageType_MIN;
+const Event_EncounterEvent_Milestone_StageType Event_EncounterEvent_Milestone::StageType_MAX;
+const int Event_EncounterEvent_Milestone::StageType_ARRAYSIZE;
+#endif  // _MSC_VER
+#ifndef _MSC_VER
+const int Event_EncounterEvent_Milestone::kStageFieldNumber;
+const int Event_EncounterEvent_Milestone::kTimeFieldNumber;
+const int Event_EncounterEvent_Milestone::kNumAdvertsFieldNumber;
 #endif  // !_MSC_VER
 
-Event_EncounterEvent::Event_EncounterEvent()
+Event_EncounterEvent_Milestone::Event_EncounterEvent_Milestone()
   : ::google::protobuf::Message() {
   SharedCtor();
 }
 
-void Event_EncounterEvent::InitAsDefaultInstance() {
+void Event_EncounterEvent_Milestone::InitAsDefaultInstance() {
 }
 
-Event_EncounterEvent::Event_EncounterEvent(const Event_EncounterEvent& from)
+Event_EncounterEvent_Milestone::Event_EncounterEvent_Milestone(const Event_EncounterEvent_Milestone& from)
   : ::google::protobuf::Message() {
   SharedCtor();
   MergeFrom(from);
 }
 
-void Event_EncounterEvent::SharedCtor() {
+void Event_EncounterEvent_Milestone::SharedCtor() {
   _cached_size_ = 0;
-  type_ = 3;
+  stage_ = 0;
   time_ = GOOGLE_ULONGLONG(0);
-  id_ = 0;
-  address_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
-  pkid_ = GOOGLE_ULONGLONG(0);
-  matchingsetupdated_ = false;
+  numadverts_ = 0u;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
-Event_EncounterEvent::~Event_EncounterEvent() {
+Event_EncounterEvent_Milestone::~Event_EncounterEvent_Milestone() {
   SharedDtor();
 }
 
-void Event_EncounterEvent::SharedDtor() {
-  if (address_ != &::google::protobuf::internal::kEmptyString) {
-    delete address_;
-  }
+void Event_EncounterEvent_Milestone::SharedDtor() {
   if (this != default_instance_) {
   }
 }
 
-void Event_EncounterEvent::SetCachedSize(int size) const {
+void Event_EncounterEvent_Milestone::SetCachedSize(int size) const {
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
   _cached_size_ = size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
 }
-const ::google::protobuf::Descriptor* Event_EncounterEvent::descriptor() {
+const ::google::protobuf::Descriptor* Event_EncounterEvent_Milestone::descriptor() {
   protobuf_AssignDescriptorsOnce();
-  return Event_EncounterEvent_descriptor_;
+  return Event_EncounterEvent_Milestone_descriptor_;
 }
 
-const Event_EncounterEvent& Event_EncounterEvent::default_instance() {
+const Event_EncounterEvent_Milestone& Event_EncounterEvent_Milestone::default_instance() {
   if (default_instance_ == NULL) protobuf_AddDesc_ebncore_2eproto();
   return *default_instance_;
 }
 
-Event_EncounterEvent* Event_EncounterEvent::default_instance_ = NULL;
+Event_EncounterEvent_Milestone* Event_EncounterEvent_Milestone::default_instance_ = NULL;
 
-Event_EncounterEvent* Event_EncounterEvent::New() const {
-  return new Event_EncounterEvent;
+Event_EncounterEvent_Milestone* Event_EncounterEvent_Milestone::New() const {
+  return new Event_EncounterEvent_Milestone;
 }
 
-void Event_EncounterEvent::Clear() {
+void Event_EncounterEvent_Milestone::Clear() {
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    type_ = 3;
+    stage_ = 0;
     time_ = GOOGLE_ULONGLONG(0);
-    id_ = 0;
-    if (has_address()) {
-      if (address_ != &::google::protobuf::internal::kEmptyString) {
-        address_->clear();
-      }
-    }
-    pkid_ = GOOGLE_ULONGLONG(0);
+    numadverts_ = 0u;
   }
-  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
-    matchingsetupdated_ = false;
-  }
-  rssievents_.Clear();
-  matchingset_.Clear();
-  sharedsecrets_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
   mutable_unknown_fields()->Clear();
 }
 
-bool Event_EncounterEvent::MergePartialFromCodedStream(
+bool Event_EncounterEvent_Milestone::MergePartialFromCodedStream(
     ::google::protobuf::io::CodedInputStream* input) {
 #define DO_(EXPRESSION) if (!(EXPRESSION)) return false
   ::google::protobuf::uint32 tag;
   while ((tag = input->ReadTag()) != 0) {
     switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
-      // required .EbNCore.Event.EncounterEvent.EventType type = 1;
+      // required .EbNCore.Event.EncounterEvent.Milestone.StageType stage = 1;
       case 1: {
         if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
             ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
@@ -1122,8 +1305,8 @@ bool Event_EncounterEvent::MergePartialFromCodedStream(
           DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
                    int, ::google::protobuf::internal::WireFormatLite::TYPE_ENUM>(
                  input, &value)));
-          if (::EbNCore::Event_EncounterEvent_EventType_IsValid(value)) {
-            set_type(static_cast< ::EbNCore::Event_EncounterEvent_EventType >(value));
+          if (::EbNCore::Event_EncounterEvent_Milestone_StageType_IsValid(value)) {
+            set_stage(static_cast< ::EbNCore::Event_EncounterEvent_Milestone_StageType >(value));
           } else {
             mutable_unknown_fields()->AddVarint(1, value);
           }
@@ -1146,113 +1329,19 @@ bool Event_EncounterEvent::MergePartialFromCodedStream(
         } else {
           goto handle_uninterpreted;
         }
-        if (input->ExpectTag(24)) goto parse_id;
+        if (input->ExpectTag(24)) goto parse_numAdverts;
         break;
       }
 
-      // required int32 id = 3;
+      // required uint32 numAdverts = 3;
       case 3: {
         if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
             ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
-         parse_id:
-          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
-                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
-                 input, &id_)));
-          set_has_id();
-        } else {
-          goto handle_uninterpreted;
-        }
-        if (input->ExpectTag(34)) goto parse_address;
-        break;
-      }
-
-      // required string address = 4;
-      case 4: {
-        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
-            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
-         parse_address:
-          DO_(::google::protobuf::internal::WireFormatLite::ReadString(
-                input, this->mutable_address()));
-          ::google::protobuf::internal::WireFormat::VerifyUTF8String(
-            this->address().data(), this->address().length(),
-            ::google::protobuf::internal::WireFormat::PARSE);
-        } else {
-          goto handle_uninterpreted;
-        }
-        if (input->ExpectTag(42)) goto parse_rssiEvents;
-        break;
-      }
-
-      // repeated .EbNCore.Event.EncounterEvent.RSSIEvent rssiEvents = 5;
-      case 5: {
-        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
-            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
-         parse_rssiEvents:
-          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
-                input, add_rssievents()));
-        } else {
-          goto handle_uninterpreted;
-        }
-        if (input->ExpectTag(42)) goto parse_rssiEvents;
-        if (input->ExpectTag(50)) goto parse_matchingSet;
-        break;
-      }
-
-      // repeated bytes matchingSet = 6;
-      case 6: {
-        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
-            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
-         parse_matchingSet:
-          DO_(::google::protobuf::internal::WireFormatLite::ReadBytes(
-                input, this->add_matchingset()));
-        } else {
-          goto handle_uninterpreted;
-        }
-        if (input->ExpectTag(50)) goto parse_matchingSet;
-        if (input->ExpectTag(58)) goto parse_sharedSecrets;
-        break;
-      }
-
-      // repeated bytes sharedSecrets = 7;
-      case 7: {
-        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
-            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
-         parse_sharedSecrets:
-          DO_(::google::protobuf::internal::WireFormatLite::ReadBytes(
-                input, this->add_sharedsecrets()));
-        } else {
-          goto handle_uninterpreted;
-        }
-        if (input->ExpectTag(58)) goto parse_sharedSecrets;
-        if (input->ExpectTag(64)) goto parse_pkid;
-        break;
-      }
-
-      // required uint64 pkid = 8;
-      case 8: {
-        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
-            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
-         parse_pkid:
-          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
-                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
-                 input, &pkid_)));
-          set_has_pkid();
-        } else {
-          goto handle_uninterpreted;
-        }
-        if (input->ExpectTag(72)) goto parse_matchingSetUpdated;
-        break;
-      }
-
-      // required bool matchingSetUpdated = 9;
-      case 9: {
-        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
-            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
-         parse_matchingSetUpdated:
+         parse_numAdverts:
           DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
-                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
-                 input, &matchingsetupdated_)));
-          set_has_matchingsetupdated();
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &numadverts_)));
+          set_has_numadverts();
         } else {
           goto handle_uninterpreted;
         }
@@ -1276,12 +1365,12 @@ bool Event_EncounterEvent::MergePartialFromCodedStream(
 #undef DO_
 }
 
-void Event_EncounterEvent::SerializeWithCachedSizes(
+void Event_EncounterEvent_Milestone::SerializeWithCachedSizes(
     ::google::protobuf::io::CodedOutputStream* output) const {
-  // required .EbNCore.Event.EncounterEvent.EventType type = 1;
-  if (has_type()) {
+  // required .EbNCore.Event.EncounterEvent.Milestone.StageType stage = 1;
+  if (has_stage()) {
     ::google::protobuf::internal::WireFormatLite::WriteEnum(
-      1, this->type(), output);
+      1, this->stage(), output);
   }
 
   // required uint64 time = 2;
@@ -1289,46 +1378,9 @@ void Event_EncounterEvent::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteUInt64(2, this->time(), output);
   }
 
-  // required int32 id = 3;
-  if (has_id()) {
-    ::google::protobuf::internal::WireFormatLite::WriteInt32(3, this->id(), output);
-  }
-
-  // required string address = 4;
-  if (has_address()) {
-    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
-      this->address().data(), this->address().length(),
-      ::google::protobuf::internal::WireFormat::SERIALIZE);
-    ::google::protobuf::internal::WireFormatLite::WriteString(
-      4, this->address(), output);
-  }
-
-  // repeated .EbNCore.Event.EncounterEvent.RSSIEvent rssiEvents = 5;
-  for (int i = 0; i < this->rssievents_size(); i++) {
-    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
-      5, this->rssievents(i), output);
-  }
-
-  // repeated bytes matchingSet = 6;
-  for (int i = 0; i < this->matchingset_size(); i++) {
-    ::google::protobuf::internal::WireFormatLite::WriteBytes(
-      6, this->matchingset(i), output);
-  }
-
-  // repeated bytes sharedSecrets = 7;
-  for (int i = 0; i < this->sharedsecrets_size(); i++) {
-    ::google::protobuf::internal::WireFormatLite::WriteBytes(
-      7, this->sharedsecrets(i), output);
-  }
-
-  // required uint64 pkid = 8;
-  if (has_pkid()) {
-    ::google::protobuf::internal::WireFormatLite::WriteUInt64(8, this->pkid(), output);
-  }
-
-  // required bool matchingSetUpdated = 9;
-  if (has_matchingsetupdated()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(9, this->matchingsetupdated(), output);
+  // required uint32 numAdverts = 3;
+  if (has_numadverts()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(3, this->numadverts(), output);
   }
 
   if (!unknown_fields().empty()) {
@@ -1337,12 +1389,12 @@ void Event_EncounterEvent::SerializeWithCachedSizes(
   }
 }
 
-::google::protobuf::uint8* Event_EncounterEvent::SerializeWithCachedSizesToArray(
+::google::protobuf::uint8* Event_EncounterEvent_Milestone::SerializeWithCachedSizesToArray(
     ::google::protobuf::uint8* target) const {
-  // required .EbNCore.Event.EncounterEvent.EventType type = 1;
-  if (has_type()) {
+  // required .EbNCore.Event.EncounterEvent.Milestone.StageType stage = 1;
+  if (has_stage()) {
     target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(
-      1, this->type(), target);
+      1, this->stage(), target);
   }
 
   // required uint64 time = 2;
@@ -1350,48 +1402,1967 @@ void Event_EncounterEvent::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(2, this->time(), target);
   }
 
-  // required int32 id = 3;
-  if (has_id()) {
+  // required uint32 numAdverts = 3;
+  if (has_numadverts()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(3, this->numadverts(), target);
+  }
+
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int Event_EncounterEvent_Milestone::ByteSize() const {
+  int total_size = 0;
+
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // required .EbNCore.Event.EncounterEvent.Milestone.StageType stage = 1;
+    if (has_stage()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::EnumSize(this->stage());
+    }
+
+    // required uint64 time = 2;
+    if (has_time()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->time());
+    }
+
+    // required uint32 numAdverts = 3;
+    if (has_numadverts()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->numadverts());
+    }
+
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void Event_EncounterEvent_Milestone::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const Event_EncounterEvent_Milestone* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const Event_EncounterEvent_Milestone*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void Event_EncounterEvent_Milestone::MergeFrom(const Event_EncounterEvent_Milestone& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_stage()) {
+      set_stage(from.stage());
+    }
+    if (from.has_time()) {
+      set_time(from.time());
+    }
+    if (from.has_numadverts()) {
+      set_numadverts(from.numadverts());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void Event_EncounterEvent_Milestone::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void Event_EncounterEvent_Milestone::CopyFrom(const Event_EncounterEvent_Milestone& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool Event_EncounterEvent_Milestone::IsInitialized() const {
+  if ((_has_bits_[0] & 0x00000007) != 0x00000007) return false;
+
+  return true;
+}
+
+void Event_EncounterEvent_Milestone::Swap(Event_EncounterEvent_Milestone* other) {
+  if (other != this) {
+    std::swap(stage_, other->stage_);
+    std::swap(time_, other->time_);
+    std::swap(numadverts_, other->numadverts_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata Event_EncounterEvent_Milestone::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = Event_EncounterEvent_Milestone_descriptor_;
+  metadata.reflection = Event_EncounterEvent_Milestone_reflection_;
+  return metadata;
+}
+
+
+// -------------------------------------------------------------------
+
+#ifndef _MSC_VER
+const int Event_EncounterEvent::kTypeFieldNumber;
+const int Event_EncounterEvent::kTimeFieldNumber;
+const int Event_EncounterEvent::kIdFieldNumber;
+const int Event_EncounterEvent::kAddressFieldNumber;
+const int Event_EncounterEvent::kRssiEventsFieldNumber;
+const int Event_EncounterEvent::kMatchingSetFieldNumber;
+const int Event_EncounterEvent::kSharedSecretsFieldNumber;
+const int Event_EncounterEvent::kPkidFieldNumber;
+const int Event_EncounterEvent::kMatchingSetUpdatedFieldNumber;
+const int Event_EncounterEvent::kMilestonesFieldNumber;
+#endif  // !_MSC_VER
+
+Event_EncounterEvent::Event_EncounterEvent()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void Event_EncounterEvent::InitAsDefaultInstance() {
+}
+
+Event_EncounterEvent::Event_EncounterEvent(const Event_EncounterEvent& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void Event_EncounterEvent::SharedCtor() {
+  _cached_size_ = 0;
+  type_ = 3;
+  time_ = GOOGLE_ULONGLONG(0);
+  id_ = 0;
+  address_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  pkid_ = GOOGLE_ULONGLONG(0);
+  matchingsetupdated_ = false;
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+Event_EncounterEvent::~Event_EncounterEvent() {
+  SharedDtor();
+}
+
+void Event_EncounterEvent::SharedDtor() {
+  if (address_ != &::google::protobuf::internal::kEmptyString) {
+    delete address_;
+  }
+  if (this != default_instance_) {
+  }
+}
+
+void Event_EncounterEvent::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* Event_EncounterEvent::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return Event_EncounterEvent_descriptor_;
+}
+
+const Event_EncounterEvent& Event_EncounterEvent::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_ebncore_2eproto();
+  return *default_instance_;
+}
+
+Event_EncounterEvent* Event_EncounterEvent::default_instance_ = NULL;
+
+Event_EncounterEvent* Event_EncounterEvent::New() const {
+  return new Event_EncounterEvent;
+}
+
+void Event_EncounterEvent::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    type_ = 3;
+    time_ = GOOGLE_ULONGLONG(0);
+    id_ = 0;
+    if (has_address()) {
+      if (address_ != &::google::protobuf::internal::kEmptyString) {
+        address_->clear();
+      }
+    }
+    pkid_ = GOOGLE_ULONGLONG(0);
+  }
+  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    matchingsetupdated_ = false;
+  }
+  rssievents_.Clear();
+  matchingset_.Clear();
+  sharedsecrets_.Clear();
+  milestones_.Clear();
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool Event_EncounterEvent::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // required .EbNCore.Event.EncounterEvent.EventType type = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+          int value;
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   int, ::google::protobuf::internal::WireFormatLite::TYPE_ENUM>(
+                 input, &value)));
+          if (::EbNCore::Event_EncounterEvent_EventType_IsValid(value)) {
+            set_type(static_cast< ::EbNCore::Event_EncounterEvent_EventType >(value));
+          } else {
+            mutable_unknown_fields()->AddVarint(1, value);
+          }
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(16)) goto parse_time;
+        break;
+      }
+
+      // required uint64 time = 2;
+      case 2: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_time:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &time_)));
+          set_has_time();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(24)) goto parse_id;
+        break;
+      }
+
+      // required int32 id = 3;
+      case 3: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_id:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &id_)));
+          set_has_id();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(34)) goto parse_address;
+        break;
+      }
+
+      // required string address = 4;
+      case 4: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_address:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadString(
+                input, this->mutable_address()));
+          ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+            this->address().data(), this->address().length(),
+            ::google::protobuf::internal::WireFormat::PARSE);
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(42)) goto parse_rssiEvents;
+        break;
+      }
+
+      // repeated .EbNCore.Event.EncounterEvent.RSSIEvent rssiEvents = 5;
+      case 5: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_rssiEvents:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_rssievents()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(42)) goto parse_rssiEvents;
+        if (input->ExpectTag(50)) goto parse_matchingSet;
+        break;
+      }
+
+      // repeated bytes matchingSet = 6;
+      case 6: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_matchingSet:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadBytes(
+                input, this->add_matchingset()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(50)) goto parse_matchingSet;
+        if (input->ExpectTag(58)) goto parse_sharedSecrets;
+        break;
+      }
+
+      // repeated bytes sharedSecrets = 7;
+      case 7: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_sharedSecrets:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadBytes(
+                input, this->add_sharedsecrets()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(58)) goto parse_sharedSecrets;
+        if (input->ExpectTag(64)) goto parse_pkid;
+        break;
+      }
+
+      // required uint64 pkid = 8;
+      case 8: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_pkid:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &pkid_)));
+          set_has_pkid();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(72)) goto parse_matchingSetUpdated;
+        break;
+      }
+
+      // required bool matchingSetUpdated = 9;
+      case 9: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_matchingSetUpdated:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &matchingsetupdated_)));
+          set_has_matchingsetupdated();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(82)) goto parse_milestones;
+        break;
+      }
+
+      // repeated .EbNCore.Event.EncounterEvent.Milestone milestones = 10;
+      case 10: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_milestones:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_milestones()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(82)) goto parse_milestones;
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void Event_EncounterEvent::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // required .EbNCore.Event.EncounterEvent.EventType type = 1;
+  if (has_type()) {
+    ::google::protobuf::internal::WireFormatLite::WriteEnum(
+      1, this->type(), output);
+  }
+
+  // required uint64 time = 2;
+  if (has_time()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(2, this->time(), output);
+  }
+
+  // required int32 id = 3;
+  if (has_id()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(3, this->id(), output);
+  }
+
+  // required string address = 4;
+  if (has_address()) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->address().data(), this->address().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    ::google::protobuf::internal::WireFormatLite::WriteString(
+      4, this->address(), output);
+  }
+
+  // repeated .EbNCore.Event.EncounterEvent.RSSIEvent rssiEvents = 5;
+  for (int i = 0; i < this->rssievents_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      5, this->rssievents(i), output);
+  }
+
+  // repeated bytes matchingSet = 6;
+  for (int i = 0; i < this->matchingset_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteBytes(
+      6, this->matchingset(i), output);
+  }
+
+  // repeated bytes sharedSecrets = 7;
+  for (int i = 0; i < this->sharedsecrets_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteBytes(
+      7, this->sharedsecrets(i), output);
+  }
+
+  // required uint64 pkid = 8;
+  if (has_pkid()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(8, this->pkid(), output);
+  }
+
+  // required bool matchingSetUpdated = 9;
+  if (has_matchingsetupdated()) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(9, this->matchingsetupdated(), output);
+  }
+
+  // repeated .EbNCore.Event.EncounterEvent.Milestone milestones = 10;
+  for (int i = 0; i < this->milestones_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      10, this->milestones(i), output);
+  }
+
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* Event_EncounterEvent::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // required .EbNCore.Event.EncounterEvent.EventType type = 1;
+  if (has_type()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(
+      1, this->type(), target);
+  }
+
+  // required uint64 time = 2;
+  if (has_time()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(2, this->time(), target);
+  }
+
+  // required int32 id = 3;
+  if (has_id()) {
     target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(3, this->id(), target);
   }
 
-  // required string address = 4;
-  if (has_address()) {
+  // required string address = 4;
+  if (has_address()) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->address().data(), this->address().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    target =
+      ::google::protobuf::internal::WireFormatLite::WriteStringToArray(
+        4, this->address(), target);
+  }
+
+  // repeated .EbNCore.Event.EncounterEvent.RSSIEvent rssiEvents = 5;
+  for (int i = 0; i < this->rssievents_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        5, this->rssievents(i), target);
+  }
+
+  // repeated bytes matchingSet = 6;
+  for (int i = 0; i < this->matchingset_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteBytesToArray(6, this->matchingset(i), target);
+  }
+
+  // repeated bytes sharedSecrets = 7;
+  for (int i = 0; i < this->sharedsecrets_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteBytesToArray(7, this->sharedsecrets(i), target);
+  }
+
+  // required uint64 pkid = 8;
+  if (has_pkid()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(8, this->pkid(), target);
+  }
+
+  // required bool matchingSetUpdated = 9;
+  if (has_matchingsetupdated()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(9, this->matchingsetupdated(), target);
+  }
+
+  // repeated .EbNCore.Event.EncounterEvent.Milestone milestones = 10;
+  for (int i = 0; i < this->milestones_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        10, this->milestones(i), target);
+  }
+
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int Event_EncounterEvent::ByteSize() const {
+  int total_size = 0;
+
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // required .EbNCore.Event.EncounterEvent.EventType type = 1;
+    if (has_type()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::EnumSize(this->type());
+    }
+
+    // required uint64 time = 2;
+    if (has_time()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->time());
+    }
+
+    // required int32 id = 3;
+    if (has_id()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->id());
+    }
+
+    // required string address = 4;
+    if (has_address()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::StringSize(
+          this->address());
+    }
+
+    // required uint64 pkid = 8;
+    if (has_pkid()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->pkid());
+    }
+
+  }
+  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    // required bool matchingSetUpdated = 9;
+    if (has_matchingsetupdated()) {
+      total_size += 1 + 1;
+    }
+
+  }
+  // repeated .EbNCore.Event.EncounterEvent.RSSIEvent rssiEvents = 5;
+  total_size += 1 * this->rssievents_size();
+  for (int i = 0; i < this->rssievents_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->rssievents(i));
+  }
+
+  // repeated bytes matchingSet = 6;
+  total_size += 1 * this->matchingset_size();
+  for (int i = 0; i < this->matchingset_size(); i++) {
+    total_size += ::google::protobuf::internal::WireFormatLite::BytesSize(
+      this->matchingset(i));
+  }
+
+  // repeated bytes sharedSecrets = 7;
+  total_size += 1 * this->sharedsecrets_size();
+  for (int i = 0; i < this->sharedsecrets_size(); i++) {
+    total_size += ::google::protobuf::internal::WireFormatLite::BytesSize(
+      this->sharedsecrets(i));
+  }
+
+  // repeated .EbNCore.Event.EncounterEvent.Milestone milestones = 10;
+  total_size += 1 * this->milestones_size();
+  for (int i = 0; i < this->milestones_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->milestones(i));
+  }
+
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void Event_EncounterEvent::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const Event_EncounterEvent* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const Event_EncounterEvent*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void Event_EncounterEvent::MergeFrom(const Event_EncounterEvent& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  rssievents_.MergeFrom(from.rssievents_);
+  matchingset_.MergeFrom(from.matchingset_);
+  sharedsecrets_.MergeFrom(from.sharedsecrets_);
+  milestones_.MergeFrom(from.milestones_);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_type()) {
+      set_type(from.type());
+    }
+    if (from.has_time()) {
+      set_time(from.time());
+    }
+    if (from.has_id()) {
+      set_id(from.id());
+    }
+    if (from.has_address()) {
+      set_address(from.address());
+    }
+    if (from.has_pkid()) {
+      set_pkid(from.pkid());
+    }
+  }
+  if (from._has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    if (from.has_matchingsetupdated()) {
+      set_matchingsetupdated(from.matchingsetupdated());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void Event_EncounterEvent::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void Event_EncounterEvent::CopyFrom(const Event_EncounterEvent& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool Event_EncounterEvent::IsInitialized() const {
+  if ((_has_bits_[0] & 0x0000018f) != 0x0000018f) return false;
+
+  for (int i = 0; i < rssievents_size(); i++) {
+    if (!this->rssievents(i).IsInitialized()) return false;
+  }
+  for (int i = 0; i < milestones_size(); i++) {
+    if (!this->milestones(i).IsInitialized()) return false;
+  }
+  return true;
+}
+
+void Event_EncounterEvent::Swap(Event_EncounterEvent* other) {
+  if (other != this) {
+    std::swap(type_, other->type_);
+    std::swap(time_, other->time_);
+    std::swap(id_, other->id_);
+    std::swap(address_, other->address_);
+    rssievents_.Swap(&other->rssievents_);
+    matchingset_.Swap(&other->matchingset_);
+    sharedsecrets_.Swap(&other->sharedsecrets_);
+    std::swap(pkid_, other->pkid_);
+    std::swap(matchingsetupdated_, other->matchingsetupdated_);
+    milestones_.Swap(&other->milestones_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata Event_EncounterEvent::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = Event_EncounterEvent_descriptor_;
+  metadata.reflection = Event_EncounterEvent_reflection_;
+  return metadata;
+}
+
+
+// -------------------------------------------------------------------
+
+#ifndef _MSC_VER
+const int Event_SleepEvent::kDurationFieldNumber;
+#endif  // !_MSC_VER
+
+Event_SleepEvent::Event_SleepEvent()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void Event_SleepEvent::InitAsDefaultInstance() {
+}
+
+Event_SleepEvent::Event_SleepEvent(const Event_SleepEvent& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void Event_SleepEvent::SharedCtor() {
+  _cached_size_ = 0;
+  duration_ = GOOGLE_ULONGLONG(0);
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+Event_SleepEvent::~Event_SleepEvent() {
+  SharedDtor();
+}
+
+void Event_SleepEvent::SharedDtor() {
+  if (this != default_instance_) {
+  }
+}
+
+void Event_SleepEvent::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* Event_SleepEvent::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return Event_SleepEvent_descriptor_;
+}
+
+const Event_SleepEvent& Event_SleepEvent::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_ebncore_2eproto();
+  return *default_instance_;
+}
+
+Event_SleepEvent* Event_SleepEvent::default_instance_ = NULL;
+
+Event_SleepEvent* Event_SleepEvent::New() const {
+  return new Event_SleepEvent;
+}
+
+void Event_SleepEvent::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    duration_ = GOOGLE_ULONGLONG(0);
+  }
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool Event_SleepEvent::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // required uint64 duration = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &duration_)));
+          set_has_duration();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void Event_SleepEvent::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // required uint64 duration = 1;
+  if (has_duration()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(1, this->duration(), output);
+  }
+
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* Event_SleepEvent::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // required uint64 duration = 1;
+  if (has_duration()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(1, this->duration(), target);
+  }
+
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int Event_SleepEvent::ByteSize() const {
+  int total_size = 0;
+
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // required uint64 duration = 1;
+    if (has_duration()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->duration());
+    }
+
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void Event_SleepEvent::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const Event_SleepEvent* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const Event_SleepEvent*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void Event_SleepEvent::MergeFrom(const Event_SleepEvent& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_duration()) {
+      set_duration(from.duration());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void Event_SleepEvent::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void Event_SleepEvent::CopyFrom(const Event_SleepEvent& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool Event_SleepEvent::IsInitialized() const {
+  if ((_has_bits_[0] & 0x00000001) != 0x00000001) return false;
+
+  return true;
+}
+
+void Event_SleepEvent::Swap(Event_SleepEvent* other) {
+  if (other != this) {
+    std::swap(duration_, other->duration_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata Event_SleepEvent::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = Event_SleepEvent_descriptor_;
+  metadata.reflection = Event_SleepEvent_reflection_;
+  return metadata;
+}
+
+
+// -------------------------------------------------------------------
+
+#ifndef _MSC_VER
+#endif  // !_MSC_VER
+
+Event_MetricsRequestEvent::Event_MetricsRequestEvent()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void Event_MetricsRequestEvent::InitAsDefaultInstance() {
+}
+
+Event_MetricsRequestEvent::Event_MetricsRequestEvent(const Event_MetricsRequestEvent& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void Event_MetricsRequestEvent::SharedCtor() {
+  _cached_size_ = 0;
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+Event_MetricsRequestEvent::~Event_MetricsRequestEvent() {
+  SharedDtor();
+}
+
+void Event_MetricsRequestEvent::SharedDtor() {
+  if (this != default_instance_) {
+  }
+}
+
+void Event_MetricsRequestEvent::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* Event_MetricsRequestEvent::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return Event_MetricsRequestEvent_descriptor_;
+}
+
+const Event_MetricsRequestEvent& Event_MetricsRequestEvent::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_ebncore_2eproto();
+  return *default_instance_;
+}
+
+Event_MetricsRequestEvent* Event_MetricsRequestEvent::default_instance_ = NULL;
+
+Event_MetricsRequestEvent* Event_MetricsRequestEvent::New() const {
+  return new Event_MetricsRequestEvent;
+}
+
+void Event_MetricsRequestEvent::Clear() {
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool Event_MetricsRequestEvent::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+        ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+      return true;
+    }
+    DO_(::google::protobuf::internal::WireFormat::SkipField(
+          input, tag, mutable_unknown_fields()));
+  }
+  return true;
+#undef DO_
+}
+
+void Event_MetricsRequestEvent::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* Event_MetricsRequestEvent::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int Event_MetricsRequestEvent::ByteSize() const {
+  int total_size = 0;
+
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void Event_MetricsRequestEvent::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const Event_MetricsRequestEvent* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const Event_MetricsRequestEvent*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void Event_MetricsRequestEvent::MergeFrom(const Event_MetricsRequestEvent& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void Event_MetricsRequestEvent::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void Event_MetricsRequestEvent::CopyFrom(const Event_MetricsRequestEvent& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool Event_MetricsRequestEvent::IsInitialized() const {
+
+  return true;
+}
+
+void Event_MetricsRequestEvent::Swap(Event_MetricsRequestEvent* other) {
+  if (other != this) {
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata Event_MetricsRequestEvent::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = Event_MetricsRequestEvent_descriptor_;
+  metadata.reflection = Event_MetricsRequestEvent_reflection_;
+  return metadata;
+}
+
+
+// -------------------------------------------------------------------
+
+#ifndef _MSC_VER
+const int Event_MetricsEvent_Counter::kNameFieldNumber;
+const int Event_MetricsEvent_Counter::kValueFieldNumber;
+#endif  // !_MSC_VER
+
+Event_MetricsEvent_Counter::Event_MetricsEvent_Counter()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void Event_MetricsEvent_Counter::InitAsDefaultInstance() {
+}
+
+Event_MetricsEvent_Counter::Event_MetricsEvent_Counter(const Event_MetricsEvent_Counter& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void Event_MetricsEvent_Counter::SharedCtor() {
+  _cached_size_ = 0;
+  name_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  value_ = GOOGLE_ULONGLONG(0);
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+Event_MetricsEvent_Counter::~Event_MetricsEvent_Counter() {
+  SharedDtor();
+}
+
+void Event_MetricsEvent_Counter::SharedDtor() {
+  if (name_ != &::google::protobuf::internal::kEmptyString) {
+    delete name_;
+  }
+  if (this != default_instance_) {
+  }
+}
+
+void Event_MetricsEvent_Counter::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* Event_MetricsEvent_Counter::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return Event_MetricsEvent_Counter_descriptor_;
+}
+
+const Event_MetricsEvent_Counter& Event_MetricsEvent_Counter::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_ebncore_2eproto();
+  return *default_instance_;
+}
+
+Event_MetricsEvent_Counter* Event_MetricsEvent_Counter::default_instance_ = NULL;
+
+Event_MetricsEvent_Counter* Event_MetricsEvent_Counter::New() const {
+  return new Event_MetricsEvent_Counter;
+}
+
+void Event_MetricsEvent_Counter::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (has_name()) {
+      if (name_ != &::google::protobuf::internal::kEmptyString) {
+        name_->clear();
+      }
+    }
+    value_ = GOOGLE_ULONGLONG(0);
+  }
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool Event_MetricsEvent_Counter::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // required string name = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadString(
+                input, this->mutable_name()));
+          ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+            this->name().data(), this->name().length(),
+            ::google::protobuf::internal::WireFormat::PARSE);
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(16)) goto parse_value;
+        break;
+      }
+
+      // required uint64 value = 2;
+      case 2: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_value:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &value_)));
+          set_has_value();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void Event_MetricsEvent_Counter::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // required string name = 1;
+  if (has_name()) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->name().data(), this->name().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    ::google::protobuf::internal::WireFormatLite::WriteString(
+      1, this->name(), output);
+  }
+
+  // required uint64 value = 2;
+  if (has_value()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(2, this->value(), output);
+  }
+
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* Event_MetricsEvent_Counter::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // required string name = 1;
+  if (has_name()) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->name().data(), this->name().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    target =
+      ::google::protobuf::internal::WireFormatLite::WriteStringToArray(
+        1, this->name(), target);
+  }
+
+  // required uint64 value = 2;
+  if (has_value()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(2, this->value(), target);
+  }
+
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int Event_MetricsEvent_Counter::ByteSize() const {
+  int total_size = 0;
+
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // required string name = 1;
+    if (has_name()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::StringSize(
+          this->name());
+    }
+
+    // required uint64 value = 2;
+    if (has_value()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->value());
+    }
+
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void Event_MetricsEvent_Counter::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const Event_MetricsEvent_Counter* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const Event_MetricsEvent_Counter*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void Event_MetricsEvent_Counter::MergeFrom(const Event_MetricsEvent_Counter& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_name()) {
+      set_name(from.name());
+    }
+    if (from.has_value()) {
+      set_value(from.value());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void Event_MetricsEvent_Counter::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void Event_MetricsEvent_Counter::CopyFrom(const Event_MetricsEvent_Counter& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool Event_MetricsEvent_Counter::IsInitialized() const {
+  if ((_has_bits_[0] & 0x00000003) != 0x00000003) return false;
+
+  return true;
+}
+
+void Event_MetricsEvent_Counter::Swap(Event_MetricsEvent_Counter* other) {
+  if (other != this) {
+    std::swap(name_, other->name_);
+    std::swap(value_, other->value_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata Event_MetricsEvent_Counter::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = Event_MetricsEvent_Counter_descriptor_;
+  metadata.reflection = Event_MetricsEvent_Counter_reflection_;
+  return metadata;
+}
+
+
+// -------------------------------------------------------------------
+
+#ifndef _MSC_VER
+const int Event_MetricsEvent_Histogram_Bucket::kLowerBoundFieldNumber;
+const int Event_MetricsEvent_Histogram_Bucket::kCountFieldNumber;
+#endif  // !_MSC_VER
+
+Event_MetricsEvent_Histogram_Bucket::Event_MetricsEvent_Histogram_Bucket()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void Event_MetricsEvent_Histogram_Bucket::InitAsDefaultInstance() {
+}
+
+Event_MetricsEvent_Histogram_Bucket::Event_MetricsEvent_Histogram_Bucket(const Event_MetricsEvent_Histogram_Bucket& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void Event_MetricsEvent_Histogram_Bucket::SharedCtor() {
+  _cached_size_ = 0;
+  lowerbound_ = GOOGLE_ULONGLONG(0);
+  count_ = GOOGLE_ULONGLONG(0);
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+Event_MetricsEvent_Histogram_Bucket::~Event_MetricsEvent_Histogram_Bucket() {
+  SharedDtor();
+}
+
+void Event_MetricsEvent_Histogram_Bucket::SharedDtor() {
+  if (this != default_instance_) {
+  }
+}
+
+void Event_MetricsEvent_Histogram_Bucket::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* Event_MetricsEvent_Histogram_Bucket::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return Event_MetricsEvent_Histogram_Bucket_descriptor_;
+}
+
+const Event_MetricsEvent_Histogram_Bucket& Event_MetricsEvent_Histogram_Bucket::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_ebncore_2eproto();
+  return *default_instance_;
+}
+
+Event_MetricsEvent_Histogram_Bucket* Event_MetricsEvent_Histogram_Bucket::default_instance_ = NULL;
+
+Event_MetricsEvent_Histogram_Bucket* Event_MetricsEvent_Histogram_Bucket::New() const {
+  return new Event_MetricsEvent_Histogram_Bucket;
+}
+
+void Event_MetricsEvent_Histogram_Bucket::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    lowerbound_ = GOOGLE_ULONGLONG(0);
+    count_ = GOOGLE_ULONGLONG(0);
+  }
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool Event_MetricsEvent_Histogram_Bucket::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // required uint64 lowerBound = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &lowerbound_)));
+          set_has_lowerbound();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(16)) goto parse_count;
+        break;
+      }
+
+      // required uint64 count = 2;
+      case 2: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_count:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &count_)));
+          set_has_count();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void Event_MetricsEvent_Histogram_Bucket::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // required uint64 lowerBound = 1;
+  if (has_lowerbound()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(1, this->lowerbound(), output);
+  }
+
+  // required uint64 count = 2;
+  if (has_count()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(2, this->count(), output);
+  }
+
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* Event_MetricsEvent_Histogram_Bucket::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // required uint64 lowerBound = 1;
+  if (has_lowerbound()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(1, this->lowerbound(), target);
+  }
+
+  // required uint64 count = 2;
+  if (has_count()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(2, this->count(), target);
+  }
+
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int Event_MetricsEvent_Histogram_Bucket::ByteSize() const {
+  int total_size = 0;
+
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // required uint64 lowerBound = 1;
+    if (has_lowerbound()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->lowerbound());
+    }
+
+    // required uint64 count = 2;
+    if (has_count()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->count());
+    }
+
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void Event_MetricsEvent_Histogram_Bucket::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const Event_MetricsEvent_Histogram_Bucket* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const Event_MetricsEvent_Histogram_Bucket*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void Event_MetricsEvent_Histogram_Bucket::MergeFrom(const Event_MetricsEvent_Histogram_Bucket& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_lowerbound()) {
+      set_lowerbound(from.lowerbound());
+    }
+    if (from.has_count()) {
+      set_count(from.count());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void Event_MetricsEvent_Histogram_Bucket::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void Event_MetricsEvent_Histogram_Bucket::CopyFrom(const Event_MetricsEvent_Histogram_Bucket& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool Event_MetricsEvent_Histogram_Bucket::IsInitialized() const {
+  if ((_has_bits_[0] & 0x00000003) != 0x00000003) return false;
+
+  return true;
+}
+
+void Event_MetricsEvent_Histogram_Bucket::Swap(Event_MetricsEvent_Histogram_Bucket* other) {
+  if (other != this) {
+    std::swap(lowerbound_, other->lowerbound_);
+    std::swap(count_, other->count_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata Event_MetricsEvent_Histogram_Bucket::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = Event_MetricsEvent_Histogram_Bucket_descriptor_;
+  metadata.reflection = Event_MetricsEvent_Histogram_Bucket_reflection_;
+  return metadata;
+}
+
+
+// -------------------------------------------------------------------
+
+#ifndef _MSC_VER
+const int Event_MetricsEvent_Histogram::kNameFieldNumber;
+const int Event_MetricsEvent_Histogram::kCountFieldNumber;
+const int Event_MetricsEvent_Histogram::kSumFieldNumber;
+const int Event_MetricsEvent_Histogram::kMinFieldNumber;
+const int Event_MetricsEvent_Histogram::kMaxFieldNumber;
+const int Event_MetricsEvent_Histogram::kP50FieldNumber;
+const int Event_MetricsEvent_Histogram::kP90FieldNumber;
+const int Event_MetricsEvent_Histogram::kP99FieldNumber;
+const int Event_MetricsEvent_Histogram::kBucketsFieldNumber;
+#endif  // !_MSC_VER
+
+Event_MetricsEvent_Histogram::Event_MetricsEvent_Histogram()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void Event_MetricsEvent_Histogram::InitAsDefaultInstance() {
+}
+
+Event_MetricsEvent_Histogram::Event_MetricsEvent_Histogram(const Event_MetricsEvent_Histogram& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void Event_MetricsEvent_Histogram::SharedCtor() {
+  _cached_size_ = 0;
+  name_ = const_cast< ::std::string*>(&::google::protobuf::internal::kEmptyString);
+  count_ = GOOGLE_ULONGLONG(0);
+  sum_ = GOOGLE_ULONGLONG(0);
+  min_ = GOOGLE_ULONGLONG(0);
+  max_ = GOOGLE_ULONGLONG(0);
+  p50_ = GOOGLE_ULONGLONG(0);
+  p90_ = GOOGLE_ULONGLONG(0);
+  p99_ = GOOGLE_ULONGLONG(0);
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+Event_MetricsEvent_Histogram::~Event_MetricsEvent_Histogram() {
+  SharedDtor();
+}
+
+void Event_MetricsEvent_Histogram::SharedDtor() {
+  if (name_ != &::google::protobuf::internal::kEmptyString) {
+    delete name_;
+  }
+  if (this != default_instance_) {
+  }
+}
+
+void Event_MetricsEvent_Histogram::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* Event_MetricsEvent_Histogram::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return Event_MetricsEvent_Histogram_descriptor_;
+}
+
+const Event_MetricsEvent_Histogram& Event_MetricsEvent_Histogram::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_ebncore_2eproto();
+  return *default_instance_;
+}
+
+Event_MetricsEvent_Histogram* Event_MetricsEvent_Histogram::default_instance_ = NULL;
+
+Event_MetricsEvent_Histogram* Event_MetricsEvent_Histogram::New() const {
+  return new Event_MetricsEvent_Histogram;
+}
+
+void Event_MetricsEvent_Histogram::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (has_name()) {
+      if (name_ != &::google::protobuf::internal::kEmptyString) {
+        name_->clear();
+      }
+    }
+    count_ = GOOGLE_ULONGLONG(0);
+    sum_ = GOOGLE_ULONGLONG(0);
+    min_ = GOOGLE_ULONGLONG(0);
+    max_ = GOOGLE_ULONGLONG(0);
+    p50_ = GOOGLE_ULONGLONG(0);
+    p90_ = GOOGLE_ULONGLONG(0);
+    p99_ = GOOGLE_ULONGLONG(0);
+  }
+  buckets_.Clear();
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool Event_MetricsEvent_Histogram::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // required string name = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadString(
+                input, this->mutable_name()));
+          ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+            this->name().data(), this->name().length(),
+            ::google::protobuf::internal::WireFormat::PARSE);
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(16)) goto parse_count;
+        break;
+      }
+
+      // required uint64 count = 2;
+      case 2: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_count:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &count_)));
+          set_has_count();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(24)) goto parse_sum;
+        break;
+      }
+
+      // required uint64 sum = 3;
+      case 3: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_sum:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &sum_)));
+          set_has_sum();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(32)) goto parse_min;
+        break;
+      }
+
+      // required uint64 min = 4;
+      case 4: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_min:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &min_)));
+          set_has_min();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(40)) goto parse_max;
+        break;
+      }
+
+      // required uint64 max = 5;
+      case 5: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_max:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &max_)));
+          set_has_max();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(48)) goto parse_p50;
+        break;
+      }
+
+      // required uint64 p50 = 6;
+      case 6: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_p50:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &p50_)));
+          set_has_p50();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(56)) goto parse_p90;
+        break;
+      }
+
+      // required uint64 p90 = 7;
+      case 7: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_p90:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &p90_)));
+          set_has_p90();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(64)) goto parse_p99;
+        break;
+      }
+
+      // required uint64 p99 = 8;
+      case 8: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_p99:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &p99_)));
+          set_has_p99();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(74)) goto parse_buckets;
+        break;
+      }
+
+      // repeated .EbNCore.Event.MetricsEvent.Histogram.Bucket buckets = 9;
+      case 9: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_buckets:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_buckets()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(74)) goto parse_buckets;
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void Event_MetricsEvent_Histogram::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // required string name = 1;
+  if (has_name()) {
     ::google::protobuf::internal::WireFormat::VerifyUTF8String(
-      this->address().data(), this->address().length(),
+      this->name().data(), this->name().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    ::google::protobuf::internal::WireFormatLite::WriteString(
+      1, this->name(), output);
+  }
+
+  // required uint64 count = 2;
+  if (has_count()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(2, this->count(), output);
+  }
+
+  // required uint64 sum = 3;
+  if (has_sum()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(3, this->sum(), output);
+  }
+
+  // required uint64 min = 4;
+  if (has_min()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(4, this->min(), output);
+  }
+
+  // required uint64 max = 5;
+  if (has_max()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(5, this->max(), output);
+  }
+
+  // required uint64 p50 = 6;
+  if (has_p50()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(6, this->p50(), output);
+  }
+
+  // required uint64 p90 = 7;
+  if (has_p90()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(7, this->p90(), output);
+  }
+
+  // required uint64 p99 = 8;
+  if (has_p99()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(8, this->p99(), output);
+  }
+
+  // repeated .EbNCore.Event.MetricsEvent.Histogram.Bucket buckets = 9;
+  for (int i = 0; i < this->buckets_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      9, this->buckets(i), output);
+  }
+
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* Event_MetricsEvent_Histogram::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // required string name = 1;
+  if (has_name()) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->name().data(), this->name().length(),
       ::google::protobuf::internal::WireFormat::SERIALIZE);
     target =
       ::google::protobuf::internal::WireFormatLite::WriteStringToArray(
-        4, this->address(), target);
+        1, this->name(), target);
   }
 
-  // repeated .EbNCore.Event.EncounterEvent.RSSIEvent rssiEvents = 5;
-  for (int i = 0; i < this->rssievents_size(); i++) {
-    target = ::google::protobuf::internal::WireFormatLite::
-      WriteMessageNoVirtualToArray(
-        5, this->rssievents(i), target);
+  // required uint64 count = 2;
+  if (has_count()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(2, this->count(), target);
   }
 
-  // repeated bytes matchingSet = 6;
-  for (int i = 0; i < this->matchingset_size(); i++) {
-    target = ::google::protobuf::internal::WireFormatLite::
-      WriteBytesToArray(6, this->matchingset(i), target);
+  // required uint64 sum = 3;
+  if (has_sum()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(3, this->sum(), target);
   }
 
-  // repeated bytes sharedSecrets = 7;
-  for (int i = 0; i < this->sharedsecrets_size(); i++) {
-    target = ::google::protobuf::internal::WireFormatLite::
-      WriteBytesToArray(7, this->sharedsecrets(i), target);
+  // required uint64 min = 4;
+  if (has_min()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(4, this->min(), target);
   }
 
-  // required uint64 pkid = 8;
-  if (has_pkid()) {
-    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(8, this->pkid(), target);
+  // required uint64 max = 5;
+  if (has_max()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(5, this->max(), target);
+  }
+
+  // required uint64 p50 = 6;
+  if (has_p50()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(6, this->p50(), target);
+  }
+
+  // required uint64 p90 = 7;
+  if (has_p90()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(7, this->p90(), target);
+  }
+
+  // required uint64 p99 = 8;
+  if (has_p99()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(8, this->p99(), target);
   }
 
-  // required bool matchingSetUpdated = 9;
-  if (has_matchingsetupdated()) {
-    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(9, this->matchingsetupdated(), target);
+  // repeated .EbNCore.Event.MetricsEvent.Histogram.Bucket buckets = 9;
+  for (int i = 0; i < this->buckets_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        9, this->buckets(i), target);
   }
 
   if (!unknown_fields().empty()) {
@@ -1401,72 +3372,73 @@ void Event_EncounterEvent::SerializeWithCachedSizes(
   return target;
 }
 
-int Event_EncounterEvent::ByteSize() const {
+int Event_MetricsEvent_Histogram::ByteSize() const {
   int total_size = 0;
 
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    // required .EbNCore.Event.EncounterEvent.EventType type = 1;
-    if (has_type()) {
+    // required string name = 1;
+    if (has_name()) {
       total_size += 1 +
-        ::google::protobuf::internal::WireFormatLite::EnumSize(this->type());
+        ::google::protobuf::internal::WireFormatLite::StringSize(
+          this->name());
     }
 
-    // required uint64 time = 2;
-    if (has_time()) {
+    // required uint64 count = 2;
+    if (has_count()) {
       total_size += 1 +
         ::google::protobuf::internal::WireFormatLite::UInt64Size(
-          this->time());
+          this->count());
     }
 
-    // required int32 id = 3;
-    if (has_id()) {
+    // required uint64 sum = 3;
+    if (has_sum()) {
       total_size += 1 +
-        ::google::protobuf::internal::WireFormatLite::Int32Size(
-          this->id());
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->sum());
     }
 
-    // required string address = 4;
-    if (has_address()) {
+    // required uint64 min = 4;
+    if (has_min()) {
       total_size += 1 +
-        ::google::protobuf::internal::WireFormatLite::StringSize(
-          this->address());
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->min());
     }
 
-    // required uint64 pkid = 8;
-    if (has_pkid()) {
+    // required uint64 max = 5;
+    if (has_max()) {
       total_size += 1 +
         ::google::protobuf::internal::WireFormatLite::UInt64Size(
-          this->pkid());
+          this->max());
     }
 
-  }
-  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
-    // required bool matchingSetUpdated = 9;
-    if (has_matchingsetupdated()) {
-      total_size += 1 + 1;
+    // required uint64 p50 = 6;
+    if (has_p50()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->p50());
+    }
+
+    // required uint64 p90 = 7;
+    if (has_p90()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->p90());
+    }
+
+    // required uint64 p99 = 8;
+    if (has_p99()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->p99());
     }
 
   }
-  // repeated .EbNCore.Event.EncounterEvent.RSSIEvent rssiEvents = 5;
-  total_size += 1 * this->rssievents_size();
-  for (int i = 0; i < this->rssievents_size(); i++) {
+  // repeated .EbNCore.Event.MetricsEvent.Histogram.Bucket buckets = 9;
+  total_size += 1 * this->buckets_size();
+  for (int i = 0; i < this->buckets_size(); i++) {
     total_size +=
       ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
-        this->rssievents(i));
-  }
-
-  // repeated bytes matchingSet = 6;
-  total_size += 1 * this->matchingset_size();
-  for (int i = 0; i < this->matchingset_size(); i++) {
-    total_size += ::google::protobuf::internal::WireFormatLite::BytesSize(
-      this->matchingset(i));
-  }
-
-  // repeated bytes sharedSecrets = 7;
-  total_size += 1 * this->sharedsecrets_size();
-  for (int i = 0; i < this->sharedsecrets_size(); i++) {
-    total_size += ::google::protobuf::internal::WireFormatLite::BytesSize(
-      this->sharedsecrets(i));
+        this->buckets(i));
   }
 
   if (!unknown_fields().empty()) {
@@ -1480,10 +3452,10 @@ int Event_EncounterEvent::ByteSize() const {
   return total_size;
 }
 
-void Event_EncounterEvent::MergeFrom(const ::google::protobuf::Message& from) {
+void Event_MetricsEvent_Histogram::MergeFrom(const ::google::protobuf::Message& from) {
   GOOGLE_CHECK_NE(&from, this);
-  const Event_EncounterEvent* source =
-    ::google::protobuf::internal::dynamic_cast_if_available<const Event_EncounterEvent*>(
+  const Event_MetricsEvent_Histogram* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const Event_MetricsEvent_Histogram*>(
       &from);
   if (source == NULL) {
     ::google::protobuf::internal::ReflectionOps::Merge(from, this);
@@ -1492,79 +3464,81 @@ void Event_EncounterEvent::MergeFrom(const ::google::protobuf::Message& from) {
   }
 }
 
-void Event_EncounterEvent::MergeFrom(const Event_EncounterEvent& from) {
+void Event_MetricsEvent_Histogram::MergeFrom(const Event_MetricsEvent_Histogram& from) {
   GOOGLE_CHECK_NE(&from, this);
-  rssievents_.MergeFrom(from.rssievents_);
-  matchingset_.MergeFrom(from.matchingset_);
-  sharedsecrets_.MergeFrom(from.sharedsecrets_);
+  buckets_.MergeFrom(from.buckets_);
   if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    if (from.has_type()) {
-      set_type(from.type());
+    if (from.has_name()) {
+      set_name(from.name());
     }
-    if (from.has_time()) {
-      set_time(from.time());
+    if (from.has_count()) {
+      set_count(from.count());
     }
-    if (from.has_id()) {
-      set_id(from.id());
+    if (from.has_sum()) {
+      set_sum(from.sum());
     }
-    if (from.has_address()) {
-      set_address(from.address());
+    if (from.has_min()) {
+      set_min(from.min());
     }
-    if (from.has_pkid()) {
-      set_pkid(from.pkid());
+    if (from.has_max()) {
+      set_max(from.max());
     }
-  }
-  if (from._has_bits_[8 / 32] & (0xffu << (8 % 32))) {
-    if (from.has_matchingsetupdated()) {
-      set_matchingsetupdated(from.matchingsetupdated());
+    if (from.has_p50()) {
+      set_p50(from.p50());
+    }
+    if (from.has_p90()) {
+      set_p90(from.p90());
+    }
+    if (from.has_p99()) {
+      set_p99(from.p99());
     }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
 
-void Event_EncounterEvent::CopyFrom(const ::google::protobuf::Message& from) {
+void Event_MetricsEvent_Histogram::CopyFrom(const ::google::protobuf::Message& from) {
   if (&from == this) return;
   Clear();
   MergeFrom(from);
 }
 
-void Event_EncounterEvent::CopyFrom(const Event_EncounterEvent& from) {
+void Event_MetricsEvent_Histogram::CopyFrom(const Event_MetricsEvent_Histogram& from) {
   if (&from == this) return;
   Clear();
   MergeFrom(from);
 }
 
-bool Event_EncounterEvent::IsInitialized() const {
-  if ((_has_bits_[0] & 0x0000018f) != 0x0000018f) return false;
+bool Event_MetricsEvent_Histogram::IsInitialized() const {
+  if ((_has_bits_[0] & 0x000000ff) != 0x000000ff) return false;
 
-  for (int i = 0; i < rssievents_size(); i++) {
-    if (!this->rssievents(i).IsInitialized()) return false;
+  for (int i = 0; i < buckets_size(); i++) {
+    if (!this->buckets(i).IsInitialized()) return false;
   }
   return true;
 }
 
-void Event_EncounterEvent::Swap(Event_EncounterEvent* other) {
+void Event_MetricsEvent_Histogram::Swap(Event_MetricsEvent_Histogram* other) {
   if (other != this) {
-    std::swap(type_, other->type_);
-    std::swap(time_, other->time_);
-    std::swap(id_, other->id_);
-    std::swap(address_, other->address_);
-    rssievents_.Swap(&other->rssievents_);
-    matchingset_.Swap(&other->matchingset_);
-    sharedsecrets_.Swap(&other->sharedsecrets_);
-    std::swap(pkid_, other->pkid_);
-    std::swap(matchingsetupdated_, other->matchingsetupdated_);
+    std::swap(name_, other->name_);
+    std::swap(count_, other->count_);
+    std::swap(sum_, other->sum_);
+    std::swap(min_, other->min_);
+    std::swap(max_, other->max_);
+    std::swap(p50_, other->p50_);
+    std::swap(p90_, other->p90_);
+    std::swap(p99_, other->p99_);
+    buckets_.Swap(&other->buckets_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
   }
 }
 
-::google::protobuf::Metadata Event_EncounterEvent::GetMetadata() const {
+::google::protobuf::Metadata Event_MetricsEvent_Histogram::GetMetadata() const {
   protobuf_AssignDescriptorsOnce();
   ::google::protobuf::Metadata metadata;
-  metadata.descriptor = Event_EncounterEvent_descriptor_;
-  metadata.reflection = Event_EncounterEvent_reflection_;
+  metadata.descriptor = Event_MetricsEvent_Histogram_descriptor_;
+  metadata.reflection = Event_MetricsEvent_Histogram_reflection_;
   return metadata;
 }
 
@@ -1572,84 +3546,118 @@ void Event_EncounterEvent::Swap(Event_EncounterEvent* other) {
 // -------------------------------------------------------------------
 
 #ifndef _MSC_VER
-const int Event_SleepEvent::kDurationFieldNumber;
+const int Event_MetricsEvent::kTimeFieldNumber;
+const int Event_MetricsEvent::kCountersFieldNumber;
+const int Event_MetricsEvent::kHistogramsFieldNumber;
 #endif  // !_MSC_VER
 
-Event_SleepEvent::Event_SleepEvent()
+Event_MetricsEvent::Event_MetricsEvent()
   : ::google::protobuf::Message() {
   SharedCtor();
 }
 
-void Event_SleepEvent::InitAsDefaultInstance() {
+void Event_MetricsEvent::InitAsDefaultInstance() {
 }
 
-Event_SleepEvent::Event_SleepEvent(const Event_SleepEvent& from)
+Event_MetricsEvent::Event_MetricsEvent(const Event_MetricsEvent& from)
   : ::google::protobuf::Message() {
   SharedCtor();
   MergeFrom(from);
 }
 
-void Event_SleepEvent::SharedCtor() {
+void Event_MetricsEvent::SharedCtor() {
   _cached_size_ = 0;
-  duration_ = GOOGLE_ULONGLONG(0);
+  time_ = GOOGLE_ULONGLONG(0);
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
-Event_SleepEvent::~Event_SleepEvent() {
+Event_MetricsEvent::~Event_MetricsEvent() {
   SharedDtor();
 }
 
-void Event_SleepEvent::SharedDtor() {
+void Event_MetricsEvent::SharedDtor() {
   if (this != default_instance_) {
   }
 }
 
-void Event_SleepEvent::SetCachedSize(int size) const {
+void Event_MetricsEvent::SetCachedSize(int size) const {
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
   _cached_size_ = size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
 }
-const ::google::protobuf::Descriptor* Event_SleepEvent::descriptor() {
+const ::google::protobuf::Descriptor* Event_MetricsEvent::descriptor() {
   protobuf_AssignDescriptorsOnce();
-  return Event_SleepEvent_descriptor_;
+  return Event_MetricsEvent_descriptor_;
 }
 
-const Event_SleepEvent& Event_SleepEvent::default_instance() {
+const Event_MetricsEvent& Event_MetricsEvent::default_instance() {
   if (default_instance_ == NULL) protobuf_AddDesc_ebncore_2eproto();
   return *default_instance_;
 }
 
-Event_SleepEvent* Event_SleepEvent::default_instance_ = NULL;
+Event_MetricsEvent* Event_MetricsEvent::default_instance_ = NULL;
 
-Event_SleepEvent* Event_SleepEvent::New() const {
-  return new Event_SleepEvent;
+Event_MetricsEvent* Event_MetricsEvent::New() const {
+  return new Event_MetricsEvent;
 }
 
-void Event_SleepEvent::Clear() {
+void Event_MetricsEvent::Clear() {
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    duration_ = GOOGLE_ULONGLONG(0);
+    time_ = GOOGLE_ULONGLONG(0);
   }
+  counters_.Clear();
+  histograms_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
   mutable_unknown_fields()->Clear();
 }
 
-bool Event_SleepEvent::MergePartialFromCodedStream(
+bool Event_MetricsEvent::MergePartialFromCodedStream(
     ::google::protobuf::io::CodedInputStream* input) {
 #define DO_(EXPRESSION) if (!(EXPRESSION)) return false
   ::google::protobuf::uint32 tag;
   while ((tag = input->ReadTag()) != 0) {
     switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
-      // required uint64 duration = 1;
+      // required uint64 time = 1;
       case 1: {
         if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
             ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
           DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
                    ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
-                 input, &duration_)));
-          set_has_duration();
+                 input, &time_)));
+          set_has_time();
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(18)) goto parse_counters;
+        break;
+      }
+
+      // repeated .EbNCore.Event.MetricsEvent.Counter counters = 2;
+      case 2: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_counters:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_counters()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(18)) goto parse_counters;
+        if (input->ExpectTag(26)) goto parse_histograms;
+        break;
+      }
+
+      // repeated .EbNCore.Event.MetricsEvent.Histogram histograms = 3;
+      case 3: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_histograms:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_histograms()));
         } else {
           goto handle_uninterpreted;
         }
+        if (input->ExpectTag(26)) goto parse_histograms;
         if (input->ExpectAtEnd()) return true;
         break;
       }
@@ -1670,11 +3678,23 @@ bool Event_SleepEvent::MergePartialFromCodedStream(
 #undef DO_
 }
 
-void Event_SleepEvent::SerializeWithCachedSizes(
+void Event_MetricsEvent::SerializeWithCachedSizes(
     ::google::protobuf::io::CodedOutputStream* output) const {
-  // required uint64 duration = 1;
-  if (has_duration()) {
-    ::google::protobuf::internal::WireFormatLite::WriteUInt64(1, this->duration(), output);
+  // required uint64 time = 1;
+  if (has_time()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(1, this->time(), output);
+  }
+
+  // repeated .EbNCore.Event.MetricsEvent.Counter counters = 2;
+  for (int i = 0; i < this->counters_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      2, this->counters(i), output);
+  }
+
+  // repeated .EbNCore.Event.MetricsEvent.Histogram histograms = 3;
+  for (int i = 0; i < this->histograms_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      3, this->histograms(i), output);
   }
 
   if (!unknown_fields().empty()) {
@@ -1683,11 +3703,25 @@ void Event_SleepEvent::SerializeWithCachedSizes(
   }
 }
 
-::google::protobuf::uint8* Event_SleepEvent::SerializeWithCachedSizesToArray(
+::google::protobuf::uint8* Event_MetricsEvent::SerializeWithCachedSizesToArray(
     ::google::protobuf::uint8* target) const {
-  // required uint64 duration = 1;
-  if (has_duration()) {
-    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(1, this->duration(), target);
+  // required uint64 time = 1;
+  if (has_time()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(1, this->time(), target);
+  }
+
+  // repeated .EbNCore.Event.MetricsEvent.Counter counters = 2;
+  for (int i = 0; i < this->counters_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        2, this->counters(i), target);
+  }
+
+  // repeated .EbNCore.Event.MetricsEvent.Histogram histograms = 3;
+  for (int i = 0; i < this->histograms_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        3, this->histograms(i), target);
   }
 
   if (!unknown_fields().empty()) {
@@ -1697,18 +3731,34 @@ void Event_SleepEvent::SerializeWithCachedSizes(
   return target;
 }
 
-int Event_SleepEvent::ByteSize() const {
+int Event_MetricsEvent::ByteSize() const {
   int total_size = 0;
 
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    // required uint64 duration = 1;
-    if (has_duration()) {
+    // required uint64 time = 1;
+    if (has_time()) {
       total_size += 1 +
         ::google::protobuf::internal::WireFormatLite::UInt64Size(
-          this->duration());
+          this->time());
     }
 
   }
+  // repeated .EbNCore.Event.MetricsEvent.Counter counters = 2;
+  total_size += 1 * this->counters_size();
+  for (int i = 0; i < this->counters_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->counters(i));
+  }
+
+  // repeated .EbNCore.Event.MetricsEvent.Histogram histograms = 3;
+  total_size += 1 * this->histograms_size();
+  for (int i = 0; i < this->histograms_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->histograms(i));
+  }
+
   if (!unknown_fields().empty()) {
     total_size +=
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
@@ -1720,10 +3770,10 @@ int Event_SleepEvent::ByteSize() const {
   return total_size;
 }
 
-void Event_SleepEvent::MergeFrom(const ::google::protobuf::Message& from) {
+void Event_MetricsEvent::MergeFrom(const ::google::protobuf::Message& from) {
   GOOGLE_CHECK_NE(&from, this);
-  const Event_SleepEvent* source =
-    ::google::protobuf::internal::dynamic_cast_if_available<const Event_SleepEvent*>(
+  const Event_MetricsEvent* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const Event_MetricsEvent*>(
       &from);
   if (source == NULL) {
     ::google::protobuf::internal::ReflectionOps::Merge(from, this);
@@ -1732,48 +3782,58 @@ void Event_SleepEvent::MergeFrom(const ::google::protobuf::Message& from) {
   }
 }
 
-void Event_SleepEvent::MergeFrom(const Event_SleepEvent& from) {
+void Event_MetricsEvent::MergeFrom(const Event_MetricsEvent& from) {
   GOOGLE_CHECK_NE(&from, this);
+  counters_.MergeFrom(from.counters_);
+  histograms_.MergeFrom(from.histograms_);
   if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    if (from.has_duration()) {
-      set_duration(from.duration());
+    if (from.has_time()) {
+      set_time(from.time());
     }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
 
-void Event_SleepEvent::CopyFrom(const ::google::protobuf::Message& from) {
+void Event_MetricsEvent::CopyFrom(const ::google::protobuf::Message& from) {
   if (&from == this) return;
   Clear();
   MergeFrom(from);
 }
 
-void Event_SleepEvent::CopyFrom(const Event_SleepEvent& from) {
+void Event_MetricsEvent::CopyFrom(const Event_MetricsEvent& from) {
   if (&from == this) return;
   Clear();
   MergeFrom(from);
 }
 
-bool Event_SleepEvent::IsInitialized() const {
+bool Event_MetricsEvent::IsInitialized() const {
   if ((_has_bits_[0] & 0x00000001) != 0x00000001) return false;
 
+  for (int i = 0; i < counters_size(); i++) {
+    if (!this->counters(i).IsInitialized()) return false;
+  }
+  for (int i = 0; i < histograms_size(); i++) {
+    if (!this->histograms(i).IsInitialized()) return false;
+  }
   return true;
 }
 
-void Event_SleepEvent::Swap(Event_SleepEvent* other) {
+void Event_MetricsEvent::Swap(Event_MetricsEvent* other) {
   if (other != this) {
-    std::swap(duration_, other->duration_);
+    std::swap(time_, other->time_);
+    counters_.Swap(&other->counters_);
+    histograms_.Swap(&other->histograms_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
   }
 }
 
-::google::protobuf::Metadata Event_SleepEvent::GetMetadata() const {
+::google::protobuf::Metadata Event_MetricsEvent::GetMetadata() const {
   protobuf_AssignDescriptorsOnce();
   ::google::protobuf::Metadata metadata;
-  metadata.descriptor = Event_SleepEvent_descriptor_;
-  metadata.reflection = Event_SleepEvent_reflection_;
+  metadata.descriptor = Event_MetricsEvent_descriptor_;
+  metadata.reflection = Event_MetricsEvent_reflection_;
   return metadata;
 }
 
@@ -1784,6 +3844,8 @@ void Event_SleepEvent::Swap(Event_SleepEvent* other) {
 const int Event::kLinkabilityEventFieldNumber;
 const int Event::kEncounterEventFieldNumber;
 const int Event::kSleepEventFieldNumber;
+const int Event::kMetricsRequestEventFieldNumber;
+const int Event::kMetricsEventFieldNumber;
 #endif  // !_MSC_VER
 
 Event::Event()
@@ -1795,6 +3857,8 @@ void Event::InitAsDefaultInstance() {
   linkabilityevent_ = const_cast< ::EbNCore::Event_LinkabilityEvent*>(&::EbNCore::Event_LinkabilityEvent::default_instance());
   encounterevent_ = const_cast< ::EbNCore::Event_EncounterEvent*>(&::EbNCore::Event_EncounterEvent::default_instance());
   sleepevent_ = const_cast< ::EbNCore::Event_SleepEvent*>(&::EbNCore::Event_SleepEvent::default_instance());
+  metricsrequestevent_ = const_cast< ::EbNCore::Event_MetricsRequestEvent*>(&::EbNCore::Event_MetricsRequestEvent::default_instance());
+  metricsevent_ = const_cast< ::EbNCore::Event_MetricsEvent*>(&::EbNCore::Event_MetricsEvent::default_instance());
 }
 
 Event::Event(const Event& from)
@@ -1808,6 +3872,8 @@ void Event::SharedCtor() {
   linkabilityevent_ = NULL;
   encounterevent_ = NULL;
   sleepevent_ = NULL;
+  metricsrequestevent_ = NULL;
+  metricsevent_ = NULL;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -1820,6 +3886,8 @@ void Event::SharedDtor() {
     delete linkabilityevent_;
     delete encounterevent_;
     delete sleepevent_;
+    delete metricsrequestevent_;
+    delete metricsevent_;
   }
 }
 
@@ -1855,6 +3923,12 @@ void Event::Clear() {
     if (has_sleepevent()) {
       if (sleepevent_ != NULL) sleepevent_->::EbNCore::Event_SleepEvent::Clear();
     }
+    if (has_metricsrequestevent()) {
+      if (metricsrequestevent_ != NULL) metricsrequestevent_->::EbNCore::Event_MetricsRequestEvent::Clear();
+    }
+    if (has_metricsevent()) {
+      if (metricsevent_ != NULL) metricsevent_->::EbNCore::Event_MetricsEvent::Clear();
+    }
   }
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
   mutable_unknown_fields()->Clear();
@@ -1903,6 +3977,34 @@ bool Event::MergePartialFromCodedStream(
         } else {
           goto handle_uninterpreted;
         }
+        if (input->ExpectTag(34)) goto parse_metricsRequestEvent;
+        break;
+      }
+
+      // optional .EbNCore.Event.MetricsRequestEvent metricsRequestEvent = 4;
+      case 4: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_metricsRequestEvent:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+               input, mutable_metricsrequestevent()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(42)) goto parse_metricsEvent;
+        break;
+      }
+
+      // optional .EbNCore.Event.MetricsEvent metricsEvent = 5;
+      case 5: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_metricsEvent:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+               input, mutable_metricsevent()));
+        } else {
+          goto handle_uninterpreted;
+        }
         if (input->ExpectAtEnd()) return true;
         break;
       }
@@ -1943,6 +4045,18 @@ void Event::SerializeWithCachedSizes(
       3, this->sleepevent(), output);
   }
 
+  // optional .EbNCore.Event.MetricsRequestEvent metricsRequestEvent = 4;
+  if (has_metricsrequestevent()) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      4, this->metricsrequestevent(), output);
+  }
+
+  // optional .EbNCore.Event.MetricsEvent metricsEvent = 5;
+  if (has_metricsevent()) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      5, this->metricsevent(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -1972,6 +4086,20 @@ void Event::SerializeWithCachedSizes(
         3, this->sleepevent(), target);
   }
 
+  // optional .EbNCore.Event.MetricsRequestEvent metricsRequestEvent = 4;
+  if (has_metricsrequestevent()) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        4, this->metricsrequestevent(), target);
+  }
+
+  // optional .EbNCore.Event.MetricsEvent metricsEvent = 5;
+  if (has_metricsevent()) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        5, this->metricsevent(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -2004,6 +4132,20 @@ int Event::ByteSize() const {
           this->sleepevent());
     }
 
+    // optional .EbNCore.Event.MetricsRequestEvent metricsRequestEvent = 4;
+    if (has_metricsrequestevent()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+          this->metricsrequestevent());
+    }
+
+    // optional .EbNCore.Event.MetricsEvent metricsEvent = 5;
+    if (has_metricsevent()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+          this->metricsevent());
+    }
+
   }
   if (!unknown_fields().empty()) {
     total_size +=
@@ -2040,6 +4182,12 @@ void Event::MergeFrom(const Event& from) {
     if (from.has_sleepevent()) {
       mutable_sleepevent()->::EbNCore::Event_SleepEvent::MergeFrom(from.sleepevent());
     }
+    if (from.has_metricsrequestevent()) {
+      mutable_metricsrequestevent()->::EbNCore::Event_MetricsRequestEvent::MergeFrom(from.metricsrequestevent());
+    }
+    if (from.has_metricsevent()) {
+      mutable_metricsevent()->::EbNCore::Event_MetricsEvent::MergeFrom(from.metricsevent());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -2067,6 +4215,9 @@ bool Event::IsInitialized() const {
   if (has_sleepevent()) {
     if (!this->sleepevent().IsInitialized()) return false;
   }
+  if (has_metricsevent()) {
+    if (!this->metricsevent().IsInitialized()) return false;
+  }
   return true;
 }
 
@@ -2075,6 +4226,8 @@ void Event::Swap(Event* other) {
     std::swap(linkabilityevent_, other->linkabilityevent_);
     std::swap(encounterevent_, other->encounterevent_);
     std::swap(sleepevent_, other->sleepevent_);
+    std::swap(metricsrequestevent_, other->metricsrequestevent_);
+    std::swap(metricsevent_, other->metricsevent_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);